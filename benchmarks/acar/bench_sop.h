@@ -0,0 +1,73 @@
+// Shared body of the sum-of-products benchmarks. Each benchmark_sop*.c
+// includes a bigint layout and an Acar kernel, defines KERNEL_NAME and
+// KERNEL_N0, and then includes this file.
+//
+// For k = 2 to 16, times sum(a[i] * b[i]) with one reduction
+// (mont_sum_of_products) against k mont_muls and k - 1 field_adds.
+
+#include "../../c/field.h"
+
+#define MAX_TERMS 16
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_sop(BigInt *a, BigInt *b, int k, bool fused, MontField *f) {
+    if (fused) {
+        return mont_sum_of_products(a, b, k, &f->p, f->n0);
+    }
+    BigInt acc = mont_mul(&a[0], &b[0], &f->p, f->n0);
+    for (int i = 1; i < k; i ++) {
+        BigInt prod = mont_mul(&a[i], &b[i], &f->p, f->n0);
+        acc = field_add(&acc, &prod, f);
+    }
+    return acc;
+}
+
+// Unoptimised function to compute a sum of products `cost` times. Each
+// result feeds the next, so that the calls can't be overlapped.
+NO_OPT
+uint64_t reference_func(BigInt *a, BigInt *b, int k, bool fused, MontField *f, int cost) {
+    BigInt x = a[0];
+    for (int i = 0; i < cost; i ++) {
+        a[0] = x;
+        x = optimised_sop(a, b, k, fused, f);
+    }
+    return black_box(x.v[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    MontField f;
+    int result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+
+    BigInt a[MAX_TERMS], b[MAX_TERMS];
+    for (int i = 0; i < MAX_TERMS; i ++) {
+        result = bigint_from_hex(data[i % length].a_hex, &a[i]);
+        assert(result == 0);
+        result = bigint_from_hex(data[i % length].b_hex, &b[i]);
+        assert(result == 0);
+    }
+
+    int cost = 1 << 16;
+    int num_runs = 5;
+    printf("%s:\n", KERNEL_NAME);
+    for (int k = 2; k <= MAX_TERMS; k ++) {
+        double avg[2] = {0, 0};
+        for (int fused = 0; fused < 2; fused ++) {
+            for (int i = 0; i < num_runs; i ++) {
+                BigInt a0 = a[0];
+                double start = get_now_ms();
+                reference_func(a, b, k, fused, &f, cost);
+                double end = get_now_ms();
+                a[0] = a0;
+                avg[fused] += end - start;
+            }
+            avg[fused] /= num_runs;
+        }
+        printf("%d sums of %2d products: one reduction took: %f ms, one per product took: %f ms (avg over %d runs), %.2fx\n",
+            cost, k, avg[1], avg[0], num_runs, avg[0] / avg[1]);
+    }
+}
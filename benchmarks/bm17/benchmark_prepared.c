@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares multiplying by the same operand over and over with mont_mul,
+// which prepares b on every call, against preparing it once with
+// mont_prepare: for a chain x = x * b, and for scaling a vector by b.
+
+#define N 4096
+
+// What a caller without a prepared operand does for each product
+static inline BigInt unprepared_mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    return mont_mul(a, b, p, n0);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_chain(BigInt *x, BigInt *b, BigInt *p, uint64_t n0, MontPrepared *prep, bool prepared, int cost) {
+    BigInt r = *x;
+    for (int i = 0; i < cost; i ++) {
+        r = prepared ? mont_mul_prepared(&r, prep) : unprepared_mul(&r, b, p, n0);
+    }
+    return r;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void optimised_scale(BigInt *out, BigInt *in, BigInt *b, BigInt *p, uint64_t n0, MontPrepared *prep, bool prepared) {
+    if (prepared) {
+        mont_scale_vector(out, in, prep, N);
+        return;
+    }
+    for (int i = 0; i < N; i ++) {
+        out[i] = unprepared_mul(&in[i], b, p, n0);
+    }
+}
+
+// Unoptimised function to run a workload `cost` times
+NO_OPT
+uint64_t reference_func(BigInt *v, BigInt *b, BigInt *p, uint64_t n0, bool vector, bool prepared, int cost) {
+    MontPrepared prep;
+    mont_prepare(&prep, b, p, n0);
+    if (!vector) {
+        BigInt r = optimised_chain(&v[0], b, p, n0, &prep, prepared, cost);
+        return black_box(r.v[0]);
+    }
+    for (int i = 0; i < cost / N; i ++) {
+        optimised_scale(v, v, b, p, n0, &prep, prepared);
+    }
+    return black_box(v[0].v[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    uint64_t n0 = BN254_SCALAR_BM17_MU_4x64;
+    BigInt a, b, p;
+
+    int result;
+    result = bigint_from_hex(BN254_SCALAR_HEX, &p);
+    assert(result == 0);
+    result = bigint_from_hex(data[length - 1].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[length - 1].b_hex, &b);
+    assert(result == 0);
+    int cost = data[length - 1].cost;
+
+    static BigInt v[N];
+    for (int i = 0; i < N; i ++) {
+        v[i] = a;
+        a = unprepared_mul(&a, &b, &p, n0);
+    }
+
+    const char *labels[] = {"a chain x = x * b", "scaling vectors of 4096 by b"};
+    int num_runs = 5;
+    for (int vector = 0; vector < 2; vector ++) {
+        double avg[2] = {0, 0};
+        for (int prepared = 0; prepared < 2; prepared ++) {
+            for (int i = 0; i < num_runs; i++) {
+                double start = get_now_ms();
+                reference_func(v, &b, &p, n0, vector, prepared, cost);
+                double end = get_now_ms();
+                avg[prepared] += end - start;
+            }
+            avg[prepared] /= num_runs;
+        }
+        printf("%d Mont muls with BM17 (%s), b prepared on every call took: %f ms (avg over %d runs)\n",
+            cost, labels[vector], avg[0], num_runs);
+        printf("%d Mont muls with BM17 (%s), b prepared once took: %f ms (avg over %d runs)\n",
+            cost, labels[vector], avg[1], num_runs);
+    }
+}
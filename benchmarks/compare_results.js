@@ -0,0 +1,292 @@
+// Compares two benchmark result files written by benchmarks/results.h, and
+// regenerates the README results table from one.
+//
+// Usage:
+//     node benchmarks/compare_results.js base.json new.json [--alpha 0.05] [--threshold 0.02]
+//     node benchmarks/compare_results.js --table results.json
+//     node benchmarks/compare_results.js --update-readme README.md results.json
+//
+// Results may be JSON or CSV. For each kernel, limb size, mode and size in
+// both files, the samples are compared with a two-sided Mann-Whitney U test,
+// which assumes nothing about their distribution (benchmark timings are
+// skewed by the occasional interruption). A change is flagged as a regression
+// or an improvement if the test rejects equal distributions at level alpha
+// and the median moved by more than threshold, as a fraction, so that tiny
+// but consistent shifts are not reported. The p-value is exact for small
+// samples without ties, and from the normal approximation with tie and
+// continuity corrections otherwise. Exits with status 1 if there is a
+// regression, for use in CI.
+//
+// --table prints the latency results as the Markdown table of the README's
+// "Preliminary results" section, and --update-readme replaces that section
+// with it.
+
+const fs = require('fs');
+
+function parseCsvLine(line) {
+    const fields = [];
+    let field = '';
+    let quoted = false;
+    for (let i = 0; i < line.length; i++) {
+        const c = line[i];
+        if (quoted) {
+            if (c === '"' && line[i + 1] === '"') {
+                field += '"';
+                i++;
+            } else if (c === '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c === '"') {
+            quoted = true;
+        } else if (c === ',') {
+            fields.push(field);
+            field = '';
+        } else {
+            field += c;
+        }
+    }
+    fields.push(field);
+    return fields;
+}
+
+// Reads a result file into the shape of the JSON format.
+function load(path) {
+    const text = fs.readFileSync(path, 'utf8');
+    if (text.trimStart().startsWith('{')) {
+        return JSON.parse(text);
+    }
+    const lines = text.split('\n').filter((l) => l.trim() !== '');
+    const header = parseCsvLine(lines[0]);
+    const rows = lines.slice(1).map((l) => {
+        const fields = parseCsvLine(l);
+        const row = {};
+        header.forEach((name, i) => { row[name] = fields[i]; });
+        return row;
+    });
+    const first = rows[0] || {};
+    return {
+        device: {
+            model: first.model, hardware: first.hardware, cpu_part: first.cpu_part,
+            arch: first.arch, cores: Number(first.cores),
+        },
+        compiler: first.compiler,
+        date: first.date,
+        unit: first.unit,
+        results: rows.map((row) => ({
+            kernel: row.kernel,
+            limbs: row.limbs,
+            mode: row.mode,
+            size: Number(row.size),
+            median: Number(row.median),
+            samples: row.samples.trim().split(/\s+/).map(Number),
+        })),
+    };
+}
+
+function key(r) {
+    return `${r.kernel} | ${r.limbs} | ${r.mode} | ${r.size}`;
+}
+
+function median(xs) {
+    const s = [...xs].sort((a, b) => a - b);
+    const n = s.length;
+    return n % 2 ? s[(n - 1) / 2] : (s[n / 2 - 1] + s[n / 2]) / 2;
+}
+
+// The standard normal CDF, with erf from Abramowitz and Stegun 7.1.26
+function normalCdf(z) {
+    const x = Math.abs(z) / Math.SQRT2;
+    const t = 1 / (1 + 0.3275911 * x);
+    const poly = t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + t * (-1.453152027 + t * 1.061405429))));
+    const erf = 1 - poly * Math.exp(-x * x);
+    return z >= 0 ? (1 + erf) / 2 : (1 - erf) / 2;
+}
+
+// The number of ways to split ranks 1..n1+n2 so that the first sample's U
+// statistic is u, for each u, by counting over the largest rank.
+function exactUCounts(n1, n2) {
+    // counts[a][b][u], built up one sample size at a time
+    let prev = [];
+    for (let a = 0; a <= n1; a++) {
+        prev.push([]);
+        for (let b = 0; b <= n2; b++) {
+            const counts = new Array(a * b + 1).fill(0);
+            if (a === 0 || b === 0) {
+                counts[0] = 1;
+            } else {
+                // The largest rank is in the first sample, and beats all b of
+                // the second, or in the second and beats none of the first.
+                const withA = prev[a - 1][b];
+                const withB = prev[a][b - 1];
+                withA.forEach((c, u) => { counts[u + b] += c; });
+                withB.forEach((c, u) => { counts[u] += c; });
+            }
+            prev[a].push(counts);
+        }
+    }
+    return prev[n1][n2];
+}
+
+// The two-sided p-value of the Mann-Whitney U test of x against y.
+function mannWhitney(x, y) {
+    const n1 = x.length;
+    const n2 = y.length;
+    const all = x.map((v) => [v, 0]).concat(y.map((v) => [v, 1])).sort((a, b) => a[0] - b[0]);
+    const ranks = new Array(all.length);
+    let tieTerm = 0;
+    for (let i = 0; i < all.length;) {
+        let j = i;
+        while (j + 1 < all.length && all[j + 1][0] === all[i][0]) {
+            j++;
+        }
+        const t = j - i + 1;
+        tieTerm += t * t * t - t;
+        for (let k = i; k <= j; k++) {
+            ranks[k] = (i + j) / 2 + 1;
+        }
+        i = j + 1;
+    }
+    let r1 = 0;
+    all.forEach((entry, i) => { if (entry[1] === 0) { r1 += ranks[i]; } });
+    const u = r1 - n1 * (n1 + 1) / 2;
+    const mean = n1 * n2 / 2;
+
+    if (tieTerm === 0 && n1 + n2 <= 40) {
+        const counts = exactUCounts(n1, n2);
+        const total = counts.reduce((a, b) => a + b, 0);
+        const dev = Math.abs(u - mean);
+        let tail = 0;
+        counts.forEach((c, v) => { if (Math.abs(v - mean) >= dev - 1e-9) { tail += c; } });
+        return Math.min(1, tail / total);
+    }
+    const n = n1 + n2;
+    const variance = n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance === 0) {
+        return 1;
+    }
+    const z = (Math.abs(u - mean) - 0.5) / Math.sqrt(variance);
+    return Math.min(1, 2 * (1 - normalCdf(Math.max(z, 0))));
+}
+
+function describe(results) {
+    const d = results.device || {};
+    const parts = [d.model, d.hardware, d.cpu_part].filter((s) => s);
+    return `${parts.join(', ') || 'unknown device'} (${d.arch}, ${d.cores} cores), ${results.compiler}`;
+}
+
+function compare(basePath, newPath, alpha, threshold) {
+    const base = load(basePath);
+    const next = load(newPath);
+    console.log(`base: ${describe(base)}`);
+    console.log(`new:  ${describe(next)}`);
+    if (describe(base) !== describe(next)) {
+        console.log('Warning: the device or compiler differs between the two runs.');
+    }
+    console.log(`Unit: ${next.unit}\n`);
+
+    const baseByKey = new Map(base.results.map((r) => [key(r), r]));
+    const rows = [['Kernel | limbs | mode | size', 'base median', 'new median', 'change', 'p', 'verdict']];
+    let regressions = 0;
+    for (const r of next.results) {
+        const b = baseByKey.get(key(r));
+        if (b === undefined) {
+            rows.push([key(r), '-', median(r.samples).toFixed(2), '-', '-', 'new']);
+            continue;
+        }
+        const m0 = median(b.samples);
+        const m1 = median(r.samples);
+        const change = (m1 - m0) / m0;
+        const p = mannWhitney(b.samples, r.samples);
+        let verdict = '~';
+        if (p < alpha && change > threshold) {
+            verdict = 'REGRESSION';
+            regressions++;
+        } else if (p < alpha && change < -threshold) {
+            verdict = 'improvement';
+        }
+        rows.push([key(r), m0.toFixed(2), m1.toFixed(2), `${change >= 0 ? '+' : ''}${(100 * change).toFixed(1)}%`, p.toPrecision(2), verdict]);
+    }
+    const widths = rows[0].map((_, i) => Math.max(...rows.map((row) => row[i].length)));
+    for (const row of rows) {
+        console.log(row.map((cell, i) => (i === 0 ? cell.padEnd(widths[i]) : cell.padStart(widths[i]))).join('  '));
+    }
+    console.log(`\n${regressions} regression(s) at alpha = ${alpha}, threshold = ${100 * threshold}%`);
+    return regressions;
+}
+
+// The README's "Preliminary results" section, from the latency results
+function readmeSection(results) {
+    const rows = results.results.filter((r) => r.mode === 'latency');
+    const n = rows.length ? rows[0].samples.length : 0;
+    const name = (r) => r.kernel.padEnd(9);
+    const limbs = (r) => r.limbs.padEnd(9);
+    const lines = [
+        '## Preliminary results',
+        '',
+        'The following benchmarks are of 2^20 sequential Montgomery multiplications over',
+        `the BN254 scalar field, run on ${describe(results)} by`,
+        `\`benchmarks/cpp/benchmark_all.cpp\`, which reports the median of ${n} interleaved`,
+        'rounds. The final reduction is included.',
+        '',
+        '| Algorithm | Limb size | Time taken (ms) |',
+        '|-----------|-----------|-----------------|',
+        ...rows.map((r) => `| ${name(r)} | ${limbs(r)} | ${String(Math.round(median(r.samples))).padEnd(15)} |`),
+        '',
+    ];
+    return lines.join('\n');
+}
+
+function updateReadme(readmePath, resultsPath) {
+    const readme = fs.readFileSync(readmePath, 'utf8');
+    const start = readme.indexOf('## Preliminary results\n');
+    if (start < 0) {
+        throw new Error(`${readmePath} has no "## Preliminary results" section`);
+    }
+    let end = readme.indexOf('\n## ', start + 1);
+    end = end < 0 ? readme.length : end + 1;
+    const section = readmeSection(load(resultsPath));
+    fs.writeFileSync(readmePath, readme.slice(0, start) + section + '\n' + readme.slice(end));
+}
+
+function main(args) {
+    let alpha = 0.05;
+    let threshold = 0.02;
+    const files = [];
+    let mode = 'compare';
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--alpha') {
+            alpha = Number(args[++i]);
+        } else if (args[i] === '--threshold') {
+            threshold = Number(args[++i]);
+        } else if (args[i] === '--table') {
+            mode = 'table';
+        } else if (args[i] === '--update-readme') {
+            mode = 'readme';
+        } else {
+            files.push(args[i]);
+        }
+    }
+    if (mode === 'table' && files.length === 1) {
+        console.log(readmeSection(load(files[0])));
+        return 0;
+    }
+    if (mode === 'readme' && files.length === 2) {
+        updateReadme(files[0], files[1]);
+        return 0;
+    }
+    if (mode === 'compare' && files.length === 2) {
+        return compare(files[0], files[1], alpha, threshold) > 0 ? 1 : 0;
+    }
+    console.error('Usage: node benchmarks/compare_results.js base.json new.json [--alpha 0.05] [--threshold 0.02]');
+    console.error('       node benchmarks/compare_results.js --table results.json');
+    console.error('       node benchmarks/compare_results.js --update-readme README.md results.json');
+    return 2;
+}
+
+if (require.main === module) {
+    process.exitCode = main(process.argv.slice(2));
+}
+
+module.exports = { mannWhitney, median, load, readmeSection };
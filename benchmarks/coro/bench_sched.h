@@ -0,0 +1,119 @@
+// Shared body of the coroutine scheduler benchmarks. Each benchmark_*.cpp
+// includes a bigint layout, a Montgomery multiplication kernel, c/field.h
+// and c/coro/sched.hpp, defines KERNEL_NAME and KERNEL_N0, and then includes
+// this file.
+//
+// Runs NUM_CHAINS independent chains of ROUNDS rounds of x = x^5 + c, the
+// shape of a Poseidon S-box layer, three ways: one chain after another with
+// field_mul, batched by hand with FieldScheduler::mul_batch across all the
+// chains at each step, and as one coroutine per chain on a FieldScheduler.
+
+#define NUM_CHAINS 64
+#define ROUNDS 2000
+
+static MontField f;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void chains_scalar(BigInt *x, BigInt *c) {
+    for (int i = 0; i < NUM_CHAINS; i ++) {
+        for (int r = 0; r < ROUNDS; r ++) {
+            BigInt x2 = field_mul(&x[i], &x[i], &f);
+            BigInt x4 = field_mul(&x2, &x2, &f);
+            x[i] = field_mul(&x4, &x[i], &f);
+            x[i] = field_add(&x[i], &c[i], &f);
+        }
+    }
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void chains_manual(FieldScheduler &s, BigInt *x, BigInt *c) {
+    BigInt x2[NUM_CHAINS], x4[NUM_CHAINS];
+    for (int r = 0; r < ROUNDS; r ++) {
+        s.mul_batch(x, x, x2, NUM_CHAINS);
+        s.mul_batch(x2, x2, x4, NUM_CHAINS);
+        s.mul_batch(x4, x, x, NUM_CHAINS);
+        for (int i = 0; i < NUM_CHAINS; i ++) {
+            x[i] = field_add(&x[i], &c[i], &f);
+        }
+    }
+}
+
+static FieldTask chain(FieldScheduler &s, BigInt *x, BigInt c) {
+    for (int r = 0; r < ROUNDS; r ++) {
+        BigInt x2 = co_await s.sqr(*x);
+        BigInt x4 = co_await s.sqr(x2);
+        *x = co_await s.mul(x4, *x);
+        *x = field_add(x, &c, s.field());
+    }
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void chains_coro(FieldScheduler &s, BigInt *x, BigInt *c) {
+    for (int i = 0; i < NUM_CHAINS; i ++) {
+        s.spawn(chain(s, &x[i], c[i]));
+    }
+    s.run();
+}
+
+// Unoptimised function to run the chains with the given method
+NO_OPT
+uint64_t reference_func(FieldScheduler &s, BigInt *x0, BigInt *c, int method) {
+    BigInt x[NUM_CHAINS];
+    for (int i = 0; i < NUM_CHAINS; i ++) {
+        x[i] = x0[i];
+    }
+    if (method == 0) {
+        chains_scalar(x, c);
+    } else if (method == 1) {
+        chains_manual(s, x, c);
+    } else {
+        chains_coro(s, x, c);
+    }
+    uint64_t r = 0;
+    for (int i = 0; i < NUM_CHAINS; i ++) {
+        r ^= x[i].v[0];
+    }
+    return black_box(r);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    FieldScheduler s(&f);
+
+    BigInt x[NUM_CHAINS], c[NUM_CHAINS];
+    int result;
+    for (int i = 0; i < NUM_CHAINS; i ++) {
+        result = bigint_from_hex(data[i % length].a_hex, &x[i]);
+        assert(result == 0);
+        result = bigint_from_hex(data[i % length].b_hex, &c[i]);
+        assert(result == 0);
+    }
+
+    // All three must agree
+    uint64_t check[3];
+    for (int method = 0; method < 3; method ++) {
+        check[method] = reference_func(s, x, c, method);
+    }
+    assert(check[0] == check[1] && check[0] == check[2]);
+
+    const char *names[3] = {"one chain at a time", "batched by hand", "coroutines"};
+    int num_runs = 5;
+    for (int method = 0; method < 3; method ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(s, x, c, method);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%d Mont muls in %d chains with %s, %s took: %f ms (avg over %d runs)\n",
+            3 * ROUNDS * NUM_CHAINS, NUM_CHAINS, KERNEL_NAME, names[method], avg, num_runs);
+    }
+}
@@ -0,0 +1,17 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/coro/sched.hpp"
+#include "../data/benchmark_mont_data.h"
+
+#define KERNEL_NAME "Acar (64-bit limbs, interleaved)"
+#define KERNEL_N0 BN254_SCALAR_N0_4x64
+
+#include "bench_sched.h"
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "../../c/constants.h"
+#include "../../c/cpp/field.hpp"
+#include "../black_box.h"
+#include "../results.h"
+#include "../perf.h"
+#include "../data/benchmark_mont_data.h"
+
+// Runs every Montgomery multiplication kernel in one process and prints one
+// comparison table, instead of one executable per kernel. The kernels come
+// from c/cpp/backends.hpp, which includes each of them with its limb layout
+// in a namespace of its own.
+//
+// Each kernel is timed as a chain of dependent products (latency), and the
+// ones that multiply several independent products at once are also timed on
+// four chains side by side (throughput). The samples of all kernels are
+// interleaved: each round runs one sample of every kernel, in a random
+// order, so that changes in clock speed and temperature over the run fall on
+// all of them alike instead of on whichever ran last. The table gives the
+// median, minimum and maximum over the rounds, scaled to 2^20 products.
+//
+// Usage: benchmark_all [--json file] [--csv file] [--perf] [rounds] [seed]
+//
+// --json and --csv also write the samples, statistics, device and compiler
+// to a file (benchmarks/results.h), for benchmarks/compare_results.js.
+// --perf runs each kernel once more under the hardware performance counters
+// (benchmarks/perf.h), and prints a second table of IPC and of instructions
+// and other events per product.
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+#define BENCH_PRODUCTS (1 << 20) // The table is per this many products
+#define BENCH_SAMPLE (1 << 16)   // Products per sample
+
+// The operands, as words, set by main from the benchmark data
+static field_detail::Words operand_a, operand_b;
+
+// cost dependent products x = x * y
+template <class Backend>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t latency(int cost) {
+    using F = Field<Backend, Bn254Scalar>;
+    using BigInt = typename F::BigInt;
+    BigInt x = field_detail::to_limbs<BigInt, F::N, F::B>(operand_a);
+    BigInt y = field_detail::to_limbs<BigInt, F::N, F::B>(operand_b);
+    BigInt p = F::P;
+    for (int i = 0; i < cost; i ++) {
+        x = Backend::mul(&x, &y, &p, F::N0);
+    }
+    return x.v[0];
+}
+
+// cost products as four chains through the 4-way interleaved kernel
+template <class Backend>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t throughput_4way(int cost) {
+    using F = Field<Backend, Bn254Scalar>;
+    using BigInt = typename F::BigInt;
+    BigInt x[4], y[4];
+    for (int j = 0; j < 4; j ++) {
+        x[j] = field_detail::to_limbs<BigInt, F::N, F::B>(operand_a);
+        y[j] = field_detail::to_limbs<BigInt, F::N, F::B>(operand_b);
+    }
+    BigInt p = F::P;
+    // Each chain starts one product ahead of the one before, so that the
+    // compiler can't tell that they are alike and merge them.
+    for (int j = 1; j < 4; j ++) {
+        x[j] = Backend::mul(&x[j - 1], &y[j], &p, F::N0);
+    }
+    for (int i = 0; i < cost / 4; i ++) {
+        Backend::mul4(x, y, &p, F::N0, x);
+    }
+    return x[0].v[0];
+}
+
+#ifdef __ARM_NEON
+// latency<SLGCK14>, but with y transposed into lane pairs once rather than
+// by every SLGCK14::mul, as the other kernels pay nothing like it per product
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t latency_slgck14(int cost) {
+    using F = Field<SLGCK14, Bn254Scalar>;
+    using BigInt = F::BigInt;
+    BigInt x = field_detail::to_limbs<BigInt, F::N, F::B>(operand_a);
+    BigInt y = field_detail::to_limbs<BigInt, F::N, F::B>(operand_b);
+    BigInt p = F::P;
+    slgck14_8x32::MontPrepared prep;
+    slgck14_8x32::mont_prepare(&prep, &y, &p, F::N0);
+    for (int i = 0; i < cost; i ++) {
+        x = slgck14_8x32::mont_mul_prepared(&x, &prep);
+    }
+    return x.v[0];
+}
+
+// cost products as four chains in the NEON lanes of mont_mul_x4
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t throughput_x4(int cost) {
+    using F = Field<Acar8x32, Bn254Scalar>;
+    using namespace multibuf_8x32;
+    // The chains start one product apart, as for the 4-way kernels
+    Acar8x32::BigInt ax = field_detail::to_limbs<Acar8x32::BigInt, F::N, F::B>(operand_a);
+    Acar8x32::BigInt ay = field_detail::to_limbs<Acar8x32::BigInt, F::N, F::B>(operand_b);
+    Acar8x32::BigInt ap = F::P;
+    BigInt x[4], y[4], p = {};
+    for (int j = 0; j < 4; j ++) {
+        for (int i = 0; i < F::N; i ++) {
+            x[j].v[i] = ax.v[i];
+            y[j].v[i] = ay.v[i];
+        }
+        ax = Acar8x32::mul(&ax, &ay, &ap, F::N0);
+    }
+    for (int i = 0; i < F::N; i ++) {
+        p.v[i] = F::P.v[i];
+    }
+    BigIntX4 xv = bigint_x4_pack(x);
+    BigIntX4 yv = bigint_x4_pack(y);
+    BigIntX4 pv = bigint_x4_splat(&p);
+    for (int i = 0; i < cost / 4; i ++) {
+        xv = mont_mul_x4(&xv, &yv, &pv, F::N0);
+    }
+    bigint_x4_unpack(&xv, x);
+    return x[0].v[0];
+}
+#endif
+
+struct Kernel {
+    const char *name;
+    const char *limbs;
+    const char *mode;
+    uint64_t (*run)(int cost);
+    std::vector<double> ms; // Per BENCH_PRODUCTS products, one per round
+};
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static uint64_t xorshift64(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static double percentile(std::vector<double> v, double q) {
+    std::sort(v.begin(), v.end());
+    return v[(size_t)(q * (v.size() - 1) + 0.5)];
+}
+
+// v to the given precision, or "n/a" if the counter was unavailable
+static void print_count(double v, int width, int precision) {
+    if (v < 0) {
+        printf(" %*s |", width, "n/a");
+    } else {
+        printf(" %*.*f |", width, precision, v);
+    }
+}
+
+// Runs each kernel for one sample under the performance counters, and prints
+// what they counted per product. This is a separate pass, so the counters
+// don't disturb the timed samples.
+static void report_counters(std::vector<Kernel> &kernels) {
+    PerfCounters pc;
+    if (perf_counters_open(&pc) == 0) {
+        printf("\nHardware performance counters are unavailable (no PMU access in this VM or\n"
+            "container, or perf_event_paranoid is too high); skipping --perf.\n");
+        return;
+    }
+    printf("\n| Algorithm   | Limb size | Mode       |  IPC | Instr/mul | Cycles/mul | Br-miss/mul | L1D-miss/mul | ASE/mul | VFP/mul |\n");
+    printf("|-------------|-----------|------------|------|-----------|------------|-------------|--------------|---------|---------|\n");
+    uint64_t sink = 0;
+    for (Kernel &k : kernels) {
+        sink ^= k.run(BENCH_SAMPLE);
+        perf_counters_start(&pc);
+        sink ^= k.run(BENCH_SAMPLE);
+        perf_counters_stop(&pc);
+        printf("| %-11s | %-9s | %-10s |", k.name, k.limbs, k.mode);
+        print_count(perf_counters_ipc(&pc), 4, 2);
+        print_count(perf_counters_per(&pc, PERF_INSTRUCTIONS, BENCH_SAMPLE), 9, 1);
+        print_count(perf_counters_per(&pc, PERF_CYCLES, BENCH_SAMPLE), 10, 1);
+        print_count(perf_counters_per(&pc, PERF_BRANCH_MISSES, BENCH_SAMPLE), 11, 3);
+        print_count(perf_counters_per(&pc, PERF_L1D_MISSES, BENCH_SAMPLE), 12, 3);
+        print_count(perf_counters_per(&pc, PERF_ASE_SPEC, BENCH_SAMPLE), 7, 1);
+        print_count(perf_counters_per(&pc, PERF_VFP_SPEC, BENCH_SAMPLE), 7, 1);
+        printf("\n");
+    }
+    black_box(sink);
+    perf_counters_close(&pc);
+    printf("\nCounts are per product, over %d products, in user space.\n", BENCH_SAMPLE);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+    operand_a = field_detail::parse_hex(data[length - 1].a_hex);
+    operand_b = field_detail::parse_hex(data[length - 1].b_hex);
+    int rounds = 15;
+    uint64_t seed = (uint64_t)time(NULL);
+    const char *json_path = NULL;
+    const char *csv_path = NULL;
+    bool perf = false;
+    int positional = 0;
+    for (int i = 1; i < argc; i ++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++ i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csv_path = argv[++ i];
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        } else if (argv[i][0] == '-' || positional > 1) {
+            rounds = 0;
+            break;
+        } else if (positional ++ == 0) {
+            rounds = atoi(argv[i]);
+        } else {
+            seed = strtoull(argv[i], NULL, 10);
+        }
+    }
+    if (rounds < 1) {
+        fprintf(stderr, "Usage: %s [--json file] [--csv file] [--perf] [rounds] [seed]\n"
+            "rounds must be at least 1 (default 15)\n", argv[0]);
+        return 1;
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    std::vector<Kernel> kernels = {
+        {"Acar", "32 bits", "latency", latency<Acar8x32>, {}},
+        {"Acar", "64 bits", "latency", latency<Acar4x64>, {}},
+        {"BH23", "32 bits", "latency", latency<BH23_8x32>, {}},
+        {"BH23", "64 bits", "latency", latency<BH23_4x64>, {}},
+        {"Domb", "64 bits", "latency", latency<Domb4x64>, {}},
+#ifdef __ARM_NEON
+        {"BM17", "32 bits", "latency", latency<BM17>, {}},
+        {"SLGCK14", "32 bits", "latency", latency_slgck14, {}},
+#endif
+        {"Acar 4-way", "64 bits", "throughput", throughput_4way<Acar4x64>, {}},
+        {"BH23 4-way", "64 bits", "throughput", throughput_4way<BH23_4x64>, {}},
+        {"Domb 4-way", "64 bits", "throughput", throughput_4way<Domb4x64>, {}},
+#ifdef __ARM_NEON
+        {"Multibuf x4", "32 bits", "throughput", throughput_x4, {}},
+#endif
+    };
+
+    // The kernels must agree: 16 products per chain give the same low 32
+    // bits in every layout
+    uint64_t expected = latency<Acar4x64>(16) & 0xffffffff;
+    for (Kernel &k : kernels) {
+        int cost = strcmp(k.mode, "latency") == 0 ? 16 : 64;
+        assert((k.run(cost) & 0xffffffff) == expected);
+    }
+
+    printf("%zu kernels, %d rounds of %d products each, seed %llu\n",
+        kernels.size(), rounds, BENCH_SAMPLE, (unsigned long long)seed);
+
+    std::vector<size_t> order(kernels.size());
+    for (size_t k = 0; k < order.size(); k ++) {
+        order[k] = k;
+    }
+    uint64_t sink = 0;
+    // Round 0 warms up the caches and the clock, and is not recorded.
+    for (int r = 0; r <= rounds; r ++) {
+        for (size_t k = order.size() - 1; k > 0; k --) {
+            std::swap(order[k], order[xorshift64(&seed) % (k + 1)]);
+        }
+        for (size_t k : order) {
+            double start = now_ms();
+            sink ^= kernels[k].run(BENCH_SAMPLE);
+            double end = now_ms();
+            if (r > 0) {
+                kernels[k].ms.push_back((end - start) * (BENCH_PRODUCTS / BENCH_SAMPLE));
+            }
+        }
+    }
+    black_box(sink);
+
+    double fastest = 0;
+    for (Kernel &k : kernels) {
+        double median = percentile(k.ms, 0.5);
+        if (fastest == 0 || median < fastest) {
+            fastest = median;
+        }
+    }
+    printf("\n| Algorithm   | Limb size | Mode       | Median (ms) | Min (ms) | Max (ms) | vs fastest |\n");
+    printf("|-------------|-----------|------------|-------------|----------|----------|------------|\n");
+    for (Kernel &k : kernels) {
+        double median = percentile(k.ms, 0.5);
+        printf("| %-11s | %-9s | %-10s | %11.1f | %8.1f | %8.1f | %9.2fx |\n",
+            k.name, k.limbs, k.mode, median, percentile(k.ms, 0), percentile(k.ms, 1), median / fastest);
+    }
+    printf("\nTimes are per %d products.\n", BENCH_PRODUCTS);
+    if (perf) {
+        report_counters(kernels);
+    }
+
+    if (json_path != NULL || csv_path != NULL) {
+        BenchDevice device;
+        bench_device_detect(&device);
+        char unit[64];
+        snprintf(unit, sizeof(unit), "ms per %d products", BENCH_PRODUCTS);
+        std::vector<BenchRecord> records;
+        for (Kernel &k : kernels) {
+            records.push_back({k.name, k.limbs, k.mode, BENCH_SAMPLE, k.ms.data(), k.ms.size()});
+        }
+        if (json_path != NULL && bench_write_json(json_path, &device, unit, records.data(), records.size()) != 0) {
+            fprintf(stderr, "Could not write %s\n", json_path);
+            return 1;
+        }
+        if (csv_path != NULL && bench_write_csv(csv_path, &device, unit, records.data(), records.size()) != 0) {
+            fprintf(stderr, "Could not write %s\n", csv_path);
+            return 1;
+        }
+    }
+}
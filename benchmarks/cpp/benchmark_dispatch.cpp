@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/cpp/dispatch.hpp"
+
+// Times batches of multiplications through FieldDispatch against every
+// kernel it can choose from, at each batch size it tunes for, and how long
+// the tuning at first use takes. The dispatched batches should take as long
+// as the fastest kernel.
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+using Dispatch = FieldDispatch<Bn254Scalar>;
+using Words = field_detail::Words;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_dispatch(Dispatch *d, Words *a, Words *b, Words *out, size_t n, int passes) {
+    for (int i = 0; i < passes; i ++) {
+        d->mul(a, b, out, n);
+    }
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_kernel(const Dispatch::Kernel *k, Words *a, Words *b, Words *out, size_t n, int passes) {
+    for (int i = 0; i < passes; i ++) {
+        k->mul(a, b, out, n);
+    }
+}
+
+// Unoptimised function to time one batch size
+NO_OPT
+void reference_func(Dispatch *d, size_t n, Words *a, Words *b, Words *out) {
+    int cost = (1 << 20) / n;
+    int num_runs = 5;
+    size_t count;
+    const Dispatch::Kernel *list = Dispatch::kernels(&count);
+    for (size_t k = 0; k <= count; k ++) {
+        if (k < count && !d->supported(&list[k])) {
+            continue;
+        }
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            if (k == count) {
+                run_dispatch(d, a, b, out, n, cost);
+            } else {
+                run_kernel(&list[k], a, b, out, n, cost);
+            }
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        black_box(out[0].w[0]);
+        avg /= num_runs;
+        if (k == count) {
+            printf("%d batches of %zu Mont muls dispatched (to %s) took: %f ms (avg over %d runs)\n",
+                cost, n, d->kernel(FIELD_DISPATCH_MUL, n)->name, avg, num_runs);
+        } else {
+            printf("%d batches of %zu Mont muls with %s took: %f ms (avg over %d runs)\n",
+                cost, n, list[k].name, avg, num_runs);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const size_t max_n = 512;
+    Words *a = new Words[max_n], *b = new Words[max_n], *out = new Words[max_n];
+    field_detail::Words p = field_detail::parse_hex(BN254_SCALAR_HEX);
+    Words x = field_detail::pow2_mod(256, p);
+    for (size_t i = 0; i < max_n; i ++) {
+        a[i] = x;
+        x = field_detail::double_mod(x, p);
+        b[i] = x;
+    }
+
+    char features[160];
+    Dispatch d;
+    cpu_features_string(&d.cpu(), features, sizeof(features));
+    printf("CPU: %s\n", features);
+
+    double start = get_now_ms();
+    d.tune_all();
+    double end = get_now_ms();
+    printf("Tuning %d operations and batch sizes took: %f ms\n", FIELD_DISPATCH_OPS * FIELD_DISPATCH_BUCKETS, end - start);
+
+    for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k ++) {
+        reference_func(&d, Dispatch::bucket_size(k), a, b, out);
+    }
+    delete[] a;
+    delete[] b;
+    delete[] out;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/cpp/field.hpp"
+#include "../data/benchmark_mont_data.h"
+
+// Times a * b + c * d - e evaluated one operation at a time, with each
+// intermediate result reduced, against the fused expression, which reduces
+// once; and out = x * y + z over arrays as two passes with a temporary array
+// against one pass of the vector expression.
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+template <class F>
+static F from_mont_hex(const char *hex) {
+    field_detail::Words w = field_detail::parse_hex(hex);
+    return F::from_mont(field_detail::to_limbs<typename F::BigInt, F::N, F::B>(w));
+}
+
+// x = x * y + x * z - y, cost times, one reduced operation at a time
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+F eager_chain(F x, F y, F z, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        F xy = x * y;
+        F xz = x * z;
+        F s = xy + xz;
+        x = s - y;
+    }
+    return x;
+}
+
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+F fused_chain(F x, F y, F z, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        x = x * y + x * z - y;
+    }
+    return x;
+}
+
+// out = x * y + z, through a temporary array
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void eager_vector(FieldSpan<F> out, FieldSpan<F> tmp, FieldSpan<F> x, FieldSpan<F> y, FieldSpan<F> z) {
+    for (size_t i = 0; i < out.size(); i ++) {
+        tmp.data()[i] = F(x[i] * y[i]).mont();
+    }
+    for (size_t i = 0; i < out.size(); i ++) {
+        out.data()[i] = F(tmp[i] + z[i]).mont();
+    }
+}
+
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void fused_vector(FieldSpan<F> out, FieldSpan<F> x, FieldSpan<F> y, FieldSpan<F> z) {
+    out = x * y + z;
+}
+
+// Unoptimised function to time one backend
+template <class F>
+NO_OPT
+void reference_func(const char *name, const BenchmarkData *data, int length) {
+    using BigInt = typename F::BigInt;
+    F a = from_mont_hex<F>(data[length - 1].a_hex);
+    F b = from_mont_hex<F>(data[length - 1].b_hex);
+    F c = a * b;
+    int cost = data[length - 1].cost;
+
+    // The two must agree
+    assert(eager_chain<F>(a, b, c, 16) == fused_chain<F>(a, b, c, 16));
+
+    const size_t n = 1 << 14;
+    BigInt *xs = new BigInt[n], *ys = new BigInt[n], *zs = new BigInt[n];
+    BigInt *os = new BigInt[n], *ts = new BigInt[n];
+    F v = a;
+    for (size_t i = 0; i < n; i ++) {
+        xs[i] = v.mont();
+        v = v * b;
+        ys[i] = v.mont();
+        v = v + c;
+        zs[i] = v.mont();
+    }
+    FieldSpan<F> x(xs, n), y(ys, n), z(zs, n), out(os, n), tmp(ts, n);
+    int passes = cost / (int)n > 0 ? cost / (int)n : 1;
+
+    int num_runs = 5;
+    for (int method = 0; method < 4; method ++) {
+        double avg = 0;
+        uint64_t sink = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            if (method == 0) {
+                sink ^= eager_chain<F>(a, b, c, cost).mont().v[0];
+            } else if (method == 1) {
+                sink ^= fused_chain<F>(a, b, c, cost).mont().v[0];
+            } else {
+                for (int k = 0; k < passes; k ++) {
+                    if (method == 2) {
+                        eager_vector<F>(out, tmp, x, y, z);
+                    } else {
+                        fused_vector<F>(out, x, y, z);
+                    }
+                    sink ^= os[k % n].v[0];
+                }
+            }
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        black_box(sink);
+        avg /= num_runs;
+        if (method < 2) {
+            const char *methods[2] = {"eager", "fused"};
+            printf("%d %s a * b + c * d - e with %s took: %f ms (avg over %d runs)\n", cost, methods[method], name, avg, num_runs);
+        } else {
+            const char *methods[2] = {"two-pass", "one-pass"};
+            printf("%d %s out = x * y + z over %zu elements with %s took: %f ms (avg over %d runs)\n", passes, methods[method - 2], n, name, avg, num_runs);
+        }
+    }
+    delete[] xs;
+    delete[] ys;
+    delete[] zs;
+    delete[] os;
+    delete[] ts;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    reference_func<Field<Acar8x32, Bn254Scalar>>("Acar (32-bit limbs)", data, length);
+    reference_func<Field<Acar4x64, Bn254Scalar>>("Acar (64-bit limbs)", data, length);
+    reference_func<Field<BH23_8x32, Bn254Scalar>>("BH23 (32-bit limbs)", data, length);
+    reference_func<Field<BH23_4x64, Bn254Scalar>>("BH23 (64-bit limbs)", data, length);
+    reference_func<Field<Domb4x64, Bn254Scalar>>("Domb (64-bit limbs)", data, length);
+    reference_func<Field<BM17, Bn254Scalar>>("BM17 (NEON)", data, length);
+}
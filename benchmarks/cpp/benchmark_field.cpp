@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/cpp/field.hpp"
+#include "../data/benchmark_mont_data.h"
+
+// Times chains of Montgomery multiplications through Field<Backend,
+// Modulus> against the same chains through the C entry points with the
+// constants of constants.h, for every backend in one binary, and chains of
+// Field additions. Each pair of multiplication chains should take the same
+// time.
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+template <class F>
+static F from_mont_hex(const char *hex) {
+    field_detail::Words w = field_detail::parse_hex(hex);
+    return F::from_mont(field_detail::to_limbs<typename F::BigInt, F::N, F::B>(w));
+}
+
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+F field_mul_chain(F x, F y, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        x = x * y;
+    }
+    return x;
+}
+
+// MUL is the kernel's mont_mul, called directly as from C
+template <class BigInt, BigInt (*MUL)(BigInt *, BigInt *, BigInt *, uint64_t)>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt c_mul_chain(BigInt x, BigInt y, BigInt p, uint64_t n0, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        x = MUL(&x, &y, &p, n0);
+    }
+    return x;
+}
+
+template <class F>
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+F field_add_chain(F x, F y, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        x = x + y;
+    }
+    return x;
+}
+
+// Unoptimised function to time one backend
+template <class F, typename F::BigInt (*MUL)(typename F::BigInt *, typename F::BigInt *, typename F::BigInt *, uint64_t)>
+NO_OPT
+void reference_func(const char *name, uint64_t n0, const BenchmarkData *data, int length) {
+    using BigInt = typename F::BigInt;
+    F a = from_mont_hex<F>(data[length - 1].a_hex);
+    F b = from_mont_hex<F>(data[length - 1].b_hex);
+    int cost = data[length - 1].cost;
+
+    // The two must agree
+    F r1 = field_mul_chain<F>(a, b, 16);
+    BigInt r2 = c_mul_chain<BigInt, MUL>(a.mont(), b.mont(), F::P, n0, 16);
+    assert(r1 == F::from_mont(r2));
+
+    int num_runs = 5;
+    for (int method = 0; method < 3; method ++) {
+        double avg = 0;
+        uint64_t sink = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            if (method == 0) {
+                sink ^= c_mul_chain<BigInt, MUL>(a.mont(), b.mont(), F::P, n0, cost).v[0];
+            } else if (method == 1) {
+                sink ^= field_mul_chain<F>(a, b, cost).mont().v[0];
+            } else {
+                sink ^= field_add_chain<F>(a, b, cost).mont().v[0];
+            }
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        black_box(sink);
+        avg /= num_runs;
+        const char *methods[3] = {"Mont muls through the C entry point", "Mont muls through Field", "additions through Field"};
+        printf("%d %s with %s took: %f ms (avg over %d runs)\n", cost, methods[method], name, avg, num_runs);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    reference_func<Field<Acar8x32, Bn254Scalar>, acar_8x32::mont_mul>("Acar (32-bit limbs)", BN254_SCALAR_N0_8x32, data, length);
+    reference_func<Field<Acar4x64, Bn254Scalar>, acar_4x64::mont_mul>("Acar (64-bit limbs)", BN254_SCALAR_N0_4x64, data, length);
+    reference_func<Field<BH23_8x32, Bn254Scalar>, bh23_8x32::mont_mul>("BH23 (32-bit limbs)", BN254_SCALAR_N0_8x32, data, length);
+    reference_func<Field<BH23_4x64, Bn254Scalar>, bh23_4x64::mont_mul>("BH23 (64-bit limbs)", BN254_SCALAR_N0_4x64, data, length);
+    reference_func<Field<Domb4x64, Bn254Scalar>, domb_4x64::mont_mul>("Domb (64-bit limbs)", BN254_SCALAR_N0_4x64, data, length);
+    reference_func<Field<BM17, Bn254Scalar>, bm17_8x32::mont_mul>("BM17 (NEON)", BN254_SCALAR_BM17_MU_4x64, data, length);
+}
@@ -0,0 +1,132 @@
+#define _XOPEN_SOURCE 700 // For pread and mkstemp
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/fieldfile/fieldfile.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares three ways of getting a vector of field elements from disk into
+// a kernel, each followed by one multiplication pass over the elements:
+// parsing hex strings with bigint_from_hex, mapping a field file, and
+// reading a field file in chunks with the streaming reader. The file is
+// written once up front and stays in the page cache, so this measures the
+// parse and copy costs rather than the disk.
+
+#define N (1 << 16)
+#define CHUNK 4096
+
+static MontField f;
+static char **hex_strs;
+static BigInt *parsed;
+static char path[] = "/tmp/fieldfile_bench_XXXXXX";
+
+// Multiplies adjacent pairs and folds the results together.
+static inline uint64_t mul_pass(const BigInt *elems, size_t n) {
+    uint64_t acc = 0;
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        BigInt r = field_mul((BigInt *)&elems[i], (BigInt *)&elems[i + 1], &f);
+        acc ^= r.v[0];
+    }
+    return acc;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t run_case(int which) {
+    uint64_t acc = 0;
+    if (which == 0) {
+        for (size_t i = 0; i < N; i ++) {
+            bigint_from_hex(hex_strs[i], &parsed[i]);
+        }
+        acc = mul_pass(parsed, N);
+    } else if (which == 1) {
+        FieldFileMap m;
+        int result = fieldfile_map(&m, path, &f.p);
+        assert(result == 0);
+        acc = mul_pass(m.elems, m.header.count);
+        fieldfile_unmap(&m);
+    } else {
+        FieldFileReader r;
+        int result = fieldfile_reader_open(&r, path, CHUNK, &f.p);
+        assert(result == 0);
+        const BigInt *elems;
+        long n;
+        while ((n = fieldfile_reader_next(&r, &elems)) > 0) {
+            acc ^= mul_pass(elems, n);
+        }
+        fieldfile_reader_close(&r);
+    }
+    return acc;
+}
+
+// Unoptimised function to run a case `cost` times
+NO_OPT
+uint64_t reference_func(int which, int cost) {
+    uint64_t acc = 0;
+    for (int i = 0; i < cost; i ++) {
+        acc ^= run_case(which);
+    }
+    return black_box(acc);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    assert(result == 0);
+
+    hex_strs = malloc(N * sizeof(char *));
+    parsed = aligned_alloc(64, N * sizeof(BigInt));
+    assert(hex_strs != NULL && parsed != NULL);
+    BigInt a, b;
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 0; i < N; i ++) {
+        parsed[i] = a;
+        hex_strs[i] = strdup(bigint_to_hex(&a));
+        a = field_mul(&a, &b, &f);
+    }
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    result = fieldfile_write(path, parsed, N, true, &f.p);
+    assert(result == 0);
+
+    const char *labels[] = {
+        "hex strings, bigint_from_hex",
+        "field file, fieldfile_map",
+        "field file, fieldfile_reader_next",
+    };
+    int cost = 4;
+    int num_runs = 5;
+    printf("Loading %d elements and multiplying pairs, Acar (64-bit limbs):\n", N);
+    for (int c = 0; c < 3; c ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(c, cost);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%s x %d took: %f ms (avg over %d runs)\n", labels[c], cost, avg, num_runs);
+    }
+
+    unlink(path);
+    for (size_t i = 0; i < N; i ++) {
+        free(hex_strs[i]);
+    }
+    free(hex_strs);
+    free(parsed);
+}
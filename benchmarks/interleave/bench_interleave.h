@@ -0,0 +1,90 @@
+// Shared body of the interleaved multiplication benchmarks. Each
+// benchmark_<kernel>.c includes a bigint layout and a Montgomery
+// multiplication kernel with mont_mul_2way and mont_mul_4way, defines
+// KERNEL_NAME and KERNEL_N0, and then includes this file.
+//
+// Times four independent chains x[k] = x[k] * y[k] computed with mont_mul one
+// product at a time, with mont_mul_2way, and with mont_mul_4way, and reports
+// the time per product, so the three are measured by throughput.
+
+#define NUM_CHAINS 4
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_mont_mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    return mont_mul(a, b, p, n0);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void optimised_mont_mul_2way(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    mont_mul_2way(a, b, p, n0, a);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void optimised_mont_mul_4way(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    mont_mul_4way(a, b, p, n0, a);
+}
+
+// Unoptimised function to compute `cost` products in each of the chains
+NO_OPT
+uint64_t reference_func(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, int ways, int cost) {
+    BigInt x[NUM_CHAINS];
+    BigInt y[NUM_CHAINS];
+    for (int k = 0; k < NUM_CHAINS; k ++) {
+        x[k] = a[k];
+        y[k] = b[k];
+    }
+    for (int i = 0; i < cost; i ++) {
+        if (ways == 4) {
+            optimised_mont_mul_4way(x, y, p, n0);
+        } else if (ways == 2) {
+            optimised_mont_mul_2way(&x[0], &y[0], p, n0);
+            optimised_mont_mul_2way(&x[2], &y[2], p, n0);
+        } else {
+            for (int k = 0; k < NUM_CHAINS; k ++) {
+                x[k] = optimised_mont_mul(&x[k], &y[k], p, n0);
+            }
+        }
+    }
+    uint64_t r = 0;
+    for (int k = 0; k < NUM_CHAINS; k ++) {
+        r ^= x[k].v[0];
+    }
+    return black_box(r);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    BigInt a[NUM_CHAINS], b[NUM_CHAINS], p;
+
+    int result;
+    result = bigint_from_hex(BN254_SCALAR_HEX, &p);
+    assert(result == 0);
+    for (int k = 0; k < NUM_CHAINS; k ++) {
+        result = bigint_from_hex(data[length - 1 - k].a_hex, &a[k]);
+        assert(result == 0);
+        result = bigint_from_hex(data[length - 1 - k].b_hex, &b[k]);
+        assert(result == 0);
+    }
+    int cost = data[length - 1].cost;
+
+    int num_runs = 5;
+    int ways[3] = {1, 2, 4};
+    for (int w = 0; w < 3; w ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(a, b, &p, KERNEL_N0, ways[w], cost);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%d Mont muls with %s, %d-way took: %f ms (avg over %d runs), %f ns per product\n",
+            NUM_CHAINS * cost, KERNEL_NAME, ways[w], avg, num_runs,
+            avg * 1e6 / (NUM_CHAINS * cost));
+    }
+}
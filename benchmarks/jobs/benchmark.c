@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/jobs/jobs.h"
+#include "../data/benchmark_mont_data.h"
+
+// One application thread submits many small jobs to the queue as fast as it
+// can, then waits for all of them. For each batching delay, reports
+// throughput, how full the lane groups were, and the latency percentiles.
+
+#define NUM_MUL_JOBS (1 << 16)
+#define NUM_HASH_JOBS (1 << 10)
+#define NUM_WORKERS 3
+
+static MontField f;
+static PoseidonParams params;
+static Job *jobs;
+static BigInt *inputs, *outputs;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void submit_and_wait(JobQueue *q, JobType type, int num_jobs) {
+    for (int j = 0; j < num_jobs; j ++) {
+        if (type == JOB_MUL) {
+            job_mul_init(&jobs[j], &outputs[j], &inputs[2 * j], &inputs[2 * j + 1], 1, NULL, NULL);
+        } else {
+            job_hash_init(&jobs[j], &outputs[j], &inputs[2 * j], 1, NULL, NULL);
+        }
+        while (job_submit(q, &jobs[j]) != 0) {
+            sched_yield();
+        }
+    }
+    for (int j = 0; j < num_jobs; j ++) {
+        job_wait(q, &jobs[j]);
+    }
+}
+
+void run(JobType type, int num_jobs, uint64_t delay_ns) {
+    JobQueue q;
+    int result = job_queue_init(&q, NUM_WORKERS, 1024, delay_ns, &f, &params);
+    assert(result == 0);
+
+    double start = get_now_ms();
+    submit_and_wait(&q, type, num_jobs);
+    double end = get_now_ms();
+    black_box(outputs[num_jobs - 1].v[0]);
+
+    double lanes = (double)atomic_load(&q.lanes_used) / atomic_load(&q.lane_groups);
+    double jobs_per_batch = (double)atomic_load(&q.jobs_done) / atomic_load(&q.batches);
+    printf("%d %s jobs, batch delay %llu us took: %f ms, %.0f jobs/s, %.2f jobs per batch, %.2f of %d lanes used, latency p50 < %llu us, p99 < %llu us\n",
+        num_jobs, type == JOB_MUL ? "mont_mul" : "Poseidon",
+        (unsigned long long)(delay_ns / 1000), end - start, num_jobs / (end - start) * 1000,
+        jobs_per_batch, lanes, JOB_LANES,
+        (unsigned long long)job_latency_percentile(&q, 50),
+        (unsigned long long)job_latency_percentile(&q, 99));
+    job_queue_destroy(&q);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_8x32);
+    assert(result == 0);
+    result = poseidon_init(&params, 3, &f);
+    assert(result == 0);
+
+    jobs = malloc(NUM_MUL_JOBS * sizeof(Job));
+    inputs = malloc(2 * NUM_MUL_JOBS * sizeof(BigInt));
+    outputs = malloc(NUM_MUL_JOBS * sizeof(BigInt));
+    assert(jobs != NULL && inputs != NULL && outputs != NULL);
+    BigInt b;
+    result = bigint_from_hex(data[0].a_hex, &inputs[0]);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 1; i < 2 * NUM_MUL_JOBS; i ++) {
+        inputs[i] = field_mul(&inputs[i - 1], &b, &f);
+    }
+
+    printf("Job queue with Acar (32-bit limbs) and %d workers:\n", NUM_WORKERS);
+    uint64_t delays[] = {0, 10000, 100000, 1000000};
+    for (int d = 0; d < sizeof(delays) / sizeof(delays[0]); d ++) {
+        run(JOB_MUL, NUM_MUL_JOBS, delays[d]);
+    }
+    for (int d = 0; d < sizeof(delays) / sizeof(delays[0]); d ++) {
+        run(JOB_HASH, NUM_HASH_JOBS, delays[d]);
+    }
+
+    free(jobs);
+    free(inputs);
+    free(outputs);
+}
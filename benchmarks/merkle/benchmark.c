@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/domb/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+#include "../../c/merkle/merkle.h"
+#include "../data/benchmark_mont_data.h"
+
+// Override with -DMERKLE_BENCH_DEPTH=20 for a full-size tree on the device.
+#ifndef MERKLE_BENCH_DEPTH
+#define MERKLE_BENCH_DEPTH 14
+#endif
+
+#define MAX_BENCH_THREADS 4
+
+static MontField f;
+static PoseidonParams params;
+static BigInt leaf;
+
+static int leaf_source(BigInt *leaves, size_t first, size_t count, void *ctx) {
+    for (size_t i = 0; i < count; i ++) {
+        leaves[i] = leaf;
+        leaves[i].v[0] ^= first + i;
+    }
+    return 0;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+uint64_t build_tree(MerkleTree *tree, int num_threads) {
+    int result = merkle_build(tree, num_threads, &params, &f);
+    assert(result == 0);
+    return merkle_root(tree).v[0];
+}
+
+double time_build(MerkleTree *tree, int num_threads, int num_runs) {
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        leaf_source(merkle_leaves(tree), 0, tree->num_leaves, NULL);
+        double start = get_now_ms();
+        black_box(build_tree(tree, num_threads));
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    assert(result == 0);
+    result = poseidon_init(&params, 3, &f);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].a_hex, &leaf);
+    assert(result == 0);
+
+    MerkleTree tree;
+    result = merkle_tree_init(&tree, MERKLE_BENCH_DEPTH);
+    assert(result == 0);
+
+    int num_runs = 3;
+    double single = 0;
+
+    printf("Poseidon Merkle tree of depth %d with Domb (64-bit limbs), %d nodes per batch:\n",
+        MERKLE_BENCH_DEPTH, MERKLE_BATCH);
+    for (int num_threads = 1; num_threads <= MAX_BENCH_THREADS; num_threads ++) {
+        double avg = time_build(&tree, num_threads, num_runs);
+        if (num_threads == 1) {
+            single = avg;
+        }
+        printf("%d thread(s) took: %f ms (avg over %d runs), %.0f leaves/s, speedup %.2fx\n",
+            num_threads, avg, num_runs, tree.num_leaves / avg * 1000, single / avg);
+    }
+
+    // The same tree, 2^4 subtrees at a time
+    double start = get_now_ms();
+    BigInt root;
+    result = merkle_build_streaming(&root, MERKLE_BENCH_DEPTH, MERKLE_BENCH_DEPTH - 4,
+        leaf_source, NULL, -1, MAX_BENCH_THREADS, &params, &f);
+    assert(result == 0);
+    double end = get_now_ms();
+    printf("Streaming build with %d threads took: %f ms, %.0f leaves/s\n",
+        MAX_BENCH_THREADS, end - start, tree.num_leaves / (end - start) * 1000);
+
+    merkle_tree_free(&tree);
+}
@@ -0,0 +1,66 @@
+// Shared body of the dual product benchmarks. Each benchmark_<kernel>.c
+// includes a bigint layout and a Montgomery multiplication kernel with
+// mont_mul2, defines KERNEL_NAME and KERNEL_N0, and then includes this file.
+//
+// Times (b, c) = (a * b, a * c) with mont_mul2 against two mont_mul calls.
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void optimised_mul2(BigInt *a, BigInt *b, BigInt *c, BigInt *p, uint64_t n0) {
+    mont_mul2(a, b, c, p, n0, b, c);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_mont_mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    return mont_mul(a, b, p, n0);
+}
+
+// Unoptimised function to compute `cost` pairs of products
+NO_OPT
+uint64_t reference_func(BigInt *a, BigInt *b, BigInt *c, BigInt *p, uint64_t n0, bool dual, int cost) {
+    BigInt x = *a;
+    BigInt y = *b;
+    BigInt z = *c;
+    for (int i = 0; i < cost; i ++) {
+        if (dual) {
+            optimised_mul2(&x, &y, &z, p, n0);
+        } else {
+            y = optimised_mont_mul(&x, &y, p, n0);
+            z = optimised_mont_mul(&x, &z, p, n0);
+        }
+    }
+    return black_box(y.v[0] ^ z.v[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+    int length = get_benchmark_data_length();
+
+    BigInt a, b, c, p;
+
+    int result;
+    result = bigint_from_hex(BN254_SCALAR_HEX, &p);
+    assert(result == 0);
+    result = bigint_from_hex(data[length - 1].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[length - 1].b_hex, &b);
+    assert(result == 0);
+    result = bigint_from_hex(data[length - 1].result_hex, &c);
+    assert(result == 0);
+    int cost = data[length - 1].cost;
+
+    int num_runs = 5;
+    for (int dual = 0; dual < 2; dual ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(&a, &b, &c, &p, KERNEL_N0, dual, cost);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%d pairs of Mont muls with %s, %s took: %f ms (avg over %d runs)\n",
+            cost, KERNEL_NAME, dual ? "mont_mul2" : "two mont_mul calls", avg, num_runs);
+    }
+}
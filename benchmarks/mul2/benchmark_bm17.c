@@ -0,0 +1,15 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../data/benchmark_mont_data.h"
+
+#define KERNEL_NAME "BM17"
+#define KERNEL_N0 BN254_SCALAR_BM17_MU_4x64
+
+#include "bench_mul2.h"
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/multibuf/mont_x2.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares batches of Fermat inversions (x^(p - 2) via an addition chain),
+// computed one at a time with BM17, two at a time with the interleaved BM17
+// kernel, and four at a time with the lane-parallel CIOS kernel.
+
+#define NUM_POWS (1 << 12)
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_pow_x1(
+    BigInt *ar,
+    BigInt *p,
+    uint64_t mu
+) {
+    return mont_pow_addchain(ar, &BN254_SCALAR_INV_CHAIN, p, mu);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigIntX2 optimised_pow_x2(
+    BigIntX2 *ar,
+    BigInt *p,
+    uint64_t mu
+) {
+    return mont_pow_addchain_x2(ar, &BN254_SCALAR_INV_CHAIN, p, mu);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigIntX4 optimised_pow_x4(
+    BigIntX4 *ar,
+    BigInt *p,
+    uint64_t n0
+) {
+    return mont_pow_addchain_x4(ar, &BN254_SCALAR_INV_CHAIN, p, n0);
+}
+
+// Unoptimised function to run `cost` exponentiations one at a time
+NO_OPT
+uint64_t reference_func_x1(BigInt a[4], BigInt *p, uint64_t mu, int cost) {
+    BigInt x = a[0];
+    for (int i = 0; i < cost; i ++) {
+        x = optimised_pow_x1(&x, p, mu);
+    }
+    return black_box(x.v[0]);
+}
+
+// Unoptimised function to run `cost` exponentiations two at a time
+NO_OPT
+uint64_t reference_func_x2(BigInt a[4], BigInt *p, uint64_t mu, int cost) {
+    BigIntX2 x = {{a[0], a[1]}};
+    for (int i = 0; i < cost; i += 2) {
+        x = optimised_pow_x2(&x, p, mu);
+    }
+    return black_box(x.v[0].v[0]);
+}
+
+// Unoptimised function to run `cost` exponentiations four at a time
+NO_OPT
+uint64_t reference_func_x4(BigInt a[4], BigInt *p, uint64_t n0, int cost) {
+    BigIntX4 x = bigint_x4_pack(a);
+    for (int i = 0; i < cost; i += 4) {
+        x = optimised_pow_x4(&x, p, n0);
+    }
+    BigInt out[4];
+    bigint_x4_unpack(&x, out);
+    return black_box(out[0].v[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    char* p_hex = BN254_SCALAR_HEX;
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+    uint64_t mu = BN254_SCALAR_BM17_MU_4x64;
+
+    BigInt a[4], p;
+
+    int result;
+
+    result = bigint_from_hex(p_hex, &p);
+    assert(result == 0);
+    for (int k = 0; k < 4; k ++) {
+        result = bigint_from_hex(data[k].a_hex, &a[k]);
+        assert(result == 0);
+    }
+
+    // All three methods must agree before they are timed.
+    BigInt x1 = mont_pow_addchain(&a[0], &BN254_SCALAR_INV_CHAIN, &p, mu);
+    BigIntX2 ax2 = {{a[0], a[1]}};
+    BigIntX2 x2 = mont_pow_addchain_x2(&ax2, &BN254_SCALAR_INV_CHAIN, &p, mu);
+    BigIntX4 ax4 = bigint_x4_pack(a);
+    BigIntX4 vx4 = mont_pow_addchain_x4(&ax4, &BN254_SCALAR_INV_CHAIN, &p, n0);
+    BigInt x4[4];
+    bigint_x4_unpack(&vx4, x4);
+    assert(bigint_eq(&x1, &x2.v[0]));
+    assert(bigint_eq(&x1, &x4[0]));
+
+    int num_runs = 5;
+    int cost = NUM_POWS;
+
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_x1(a, &p, mu, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d Fermat inversions, 1 at a time (BM17) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_x2(a, &p, mu, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d Fermat inversions, 2 at a time (interleaved BM17) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_x4(a, &p, n0, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d Fermat inversions, 4 at a time (lane-parallel CIOS) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+}
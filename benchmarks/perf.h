@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Hardware performance counters around a benchmark region, through Linux's
+// perf_event_open. Wall-clock time says which kernel is faster; the counters
+// say why: the instructions it executes per product, how many of them retire
+// per cycle (IPC), and, on ARM, how many are Advanced SIMD (ASE) or
+// floating-point (VFP) operations.
+//
+// Each counter is opened on its own, so that the ones the CPU or the kernel
+// lacks are skipped instead of failing the others. Under an emulator, in a
+// container without access to the PMU, or with a high
+// /proc/sys/kernel/perf_event_paranoid, none may open: perf_counters_open
+// then returns 0 and every counter reads as unavailable. Only user-space
+// events of the calling thread are counted.
+//
+//     PerfCounters pc;
+//     if (perf_counters_open(&pc) > 0) {
+//         perf_counters_start(&pc);
+//         ... region ...
+//         perf_counters_stop(&pc);
+//         if (pc.valid[PERF_INSTRUCTIONS]) ... pc.value[PERF_INSTRUCTIONS] ...
+//     }
+//     perf_counters_close(&pc);
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES, // L1 data cache read misses
+    PERF_ASE_SPEC,   // Advanced SIMD operations speculatively executed (ARM only)
+    PERF_VFP_SPEC,   // Floating-point operations speculatively executed (ARM only)
+    PERF_COUNTERS,
+} PerfCounter;
+
+static const char *const perf_counter_names[PERF_COUNTERS] = {
+    "cycles", "instructions", "branch-misses", "L1D-misses", "ASE-spec", "VFP-spec",
+};
+
+typedef struct {
+    int fd[PERF_COUNTERS];        // -1 if the counter could not be opened
+    uint64_t value[PERF_COUNTERS]; // Counts over the last region
+    int valid[PERF_COUNTERS];      // Whether value is meaningful
+} PerfCounters;
+
+#if defined(__linux__)
+static inline int perf_event_fd(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // If there are more counters than the PMU has, the kernel time-slices
+    // them, and these let the counts be scaled up to the whole region.
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/*
+ * Opens every counter the system provides. Returns how many could be
+ * opened, which may be 0.
+ */
+static inline int perf_counters_open(PerfCounters *pc) {
+    int opened = 0;
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        pc->fd[i] = -1;
+        pc->value[i] = 0;
+        pc->valid[i] = 0;
+    }
+#if defined(__linux__)
+    pc->fd[PERF_CYCLES] = perf_event_fd(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    pc->fd[PERF_INSTRUCTIONS] = perf_event_fd(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    pc->fd[PERF_BRANCH_MISSES] = perf_event_fd(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    pc->fd[PERF_L1D_MISSES] = perf_event_fd(PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#if defined(__aarch64__) || defined(__arm__)
+    // The common architectural event numbers of the ARMv8 PMU
+    pc->fd[PERF_ASE_SPEC] = perf_event_fd(PERF_TYPE_RAW, 0x74);
+    pc->fd[PERF_VFP_SPEC] = perf_event_fd(PERF_TYPE_RAW, 0x75);
+#endif
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        opened += pc->fd[i] >= 0;
+    }
+#endif
+    return opened;
+}
+
+static inline void perf_counters_start(PerfCounters *pc) {
+#if defined(__linux__)
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        if (pc->fd[i] >= 0) {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)pc;
+#endif
+}
+
+static inline void perf_counters_stop(PerfCounters *pc) {
+#if defined(__linux__)
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        if (pc->fd[i] >= 0) {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        uint64_t buf[3]; // value, time enabled, time running
+        pc->valid[i] = 0;
+        if (pc->fd[i] < 0 || read(pc->fd[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+            continue;
+        }
+        // A counter that never got onto the PMU has nothing to scale
+        if (buf[2] == 0) {
+            continue;
+        }
+        pc->value[i] = buf[2] < buf[1] ? (uint64_t)((double)buf[0] * buf[1] / buf[2]) : buf[0];
+        pc->valid[i] = 1;
+    }
+#else
+    (void)pc;
+#endif
+}
+
+static inline void perf_counters_close(PerfCounters *pc) {
+#if defined(__linux__)
+    for (int i = 0; i < PERF_COUNTERS; i ++) {
+        if (pc->fd[i] >= 0) {
+            close(pc->fd[i]);
+            pc->fd[i] = -1;
+        }
+    }
+#else
+    (void)pc;
+#endif
+}
+
+// Instructions per cycle over the last region, or a negative number if
+// either counter is unavailable
+static inline double perf_counters_ipc(const PerfCounters *pc) {
+    if (!pc->valid[PERF_CYCLES] || !pc->valid[PERF_INSTRUCTIONS] || pc->value[PERF_CYCLES] == 0) {
+        return -1;
+    }
+    return (double)pc->value[PERF_INSTRUCTIONS] / pc->value[PERF_CYCLES];
+}
+
+// Counter i over the last region per one of n operations, or a negative
+// number if it is unavailable
+static inline double perf_counters_per(const PerfCounters *pc, PerfCounter i, uint64_t n) {
+    return pc->valid[i] ? (double)pc->value[i] / n : -1;
+}
@@ -0,0 +1,122 @@
+// Shared body of the thread pool benchmarks. Each benchmark_<kernel>.c
+// includes a bigint layout and a Montgomery multiplication kernel, defines
+// KERNEL_NAME and KERNEL_N0, and then includes this file.
+//
+// Each batch operation is timed with 1, 2 and 4 threads on a vector that fits
+// in L2 and on one that does not. Parallel efficiency is the speedup divided
+// by the number of threads: if it drops for the large vectors but not the
+// small ones, the memory system saturates before the multipliers do.
+
+#include <stdlib.h>
+#include "../../c/field.h"
+#include "../../c/pool/pool.h"
+#include "../../c/pool/batch.h"
+
+#define SMALL_N (1 << 12)
+#define LARGE_N (1 << 18)
+
+static MontField f;
+static BigInt *va, *vb, *vout;
+
+typedef enum { OP_MUL, OP_SQR, OP_TO_MONT, OP_ADD } BatchOp;
+static const char *op_names[] = { "mont_mul", "mont_sqr", "to_mont", "add" };
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_op(ThreadPool *pool, BatchOp op, size_t n) {
+    switch (op) {
+        case OP_MUL: batch_mul(pool, vout, va, vb, n, &f); break;
+        case OP_SQR: batch_sqr(pool, vout, va, n, &f); break;
+        case OP_TO_MONT: batch_to_mont(pool, vout, va, n, &f); break;
+        case OP_ADD: batch_add(pool, vout, va, vb, n, &f); break;
+    }
+}
+
+// Unoptimised function to run the operation `cost` times
+NO_OPT
+uint64_t reference_func(ThreadPool *pool, BatchOp op, size_t n, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        run_op(pool, op, n);
+    }
+    return black_box(vout[n - 1].v[0]);
+}
+
+double time_op(ThreadPool *pool, BatchOp op, size_t n, int num_runs) {
+    // Roughly the same number of elements per measurement for both sizes
+    int cost = (1 << 20) / n;
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(pool, op, n, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+
+    va = aligned_alloc(64, LARGE_N * sizeof(BigInt));
+    vb = aligned_alloc(64, LARGE_N * sizeof(BigInt));
+    vout = aligned_alloc(64, LARGE_N * sizeof(BigInt));
+    assert(va != NULL && vb != NULL && vout != NULL);
+    result = bigint_from_hex(data[0].a_hex, &va[0]);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &vb[0]);
+    assert(result == 0);
+    for (size_t i = 1; i < LARGE_N; i ++) {
+        va[i] = field_mul(&va[i - 1], &vb[0], &f);
+        vb[i] = field_mul(&vb[i - 1], &va[0], &f);
+    }
+
+    int num_runs = 3;
+    int thread_counts[] = {1, 2, 4};
+    size_t sizes[] = {SMALL_N, LARGE_N};
+
+    printf("Thread pool batch operations with %s:\n", KERNEL_NAME);
+    for (int op = OP_MUL; op <= OP_ADD; op ++) {
+        for (int s = 0; s < 2; s ++) {
+            double single = 0;
+            for (int k = 0; k < 3; k ++) {
+                ThreadPool pool;
+                result = pool_init(&pool, thread_counts[k]);
+                assert(result == 0);
+                double avg = time_op(&pool, op, sizes[s], num_runs);
+                if (k == 0) {
+                    single = avg;
+                }
+                printf("%s on 2^20 elements in vectors of %zu, %d thread(s) took: %f ms (avg over %d runs), efficiency %.2f\n",
+                    op_names[op], sizes[s], pool.num_threads, avg, num_runs,
+                    single / avg / pool.num_threads);
+                pool_destroy(&pool);
+            }
+        }
+    }
+
+    // Grain size sweep for mont_mul with 4 threads
+    ThreadPool pool;
+    result = pool_init(&pool, 4);
+    assert(result == 0);
+    size_t grains[] = {16, 64, 256, 1024, 4096, 0};
+    for (int g = 0; g < sizeof(grains) / sizeof(grains[0]); g ++) {
+        pool.grain = grains[g];
+        double avg = time_op(&pool, OP_MUL, LARGE_N, num_runs);
+        if (grains[g] == 0) {
+            printf("mont_mul with 4 threads and automatic grain size (%zu) took: %f ms (avg over %d runs)\n",
+                pool_auto_grain(&pool, LARGE_N), avg, num_runs);
+        } else {
+            printf("mont_mul with 4 threads and grain size %zu took: %f ms (avg over %d runs)\n",
+                grains[g], avg, num_runs);
+        }
+    }
+    pool_destroy(&pool);
+
+    free(va);
+    free(vb);
+    free(vout);
+}
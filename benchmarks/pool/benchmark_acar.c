@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../data/benchmark_mont_data.h"
+
+#define KERNEL_NAME "Acar (32-bit limbs)"
+#define KERNEL_N0 BN254_SCALAR_N0_8x32
+
+#include "bench_pool.h"
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/domb/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/pool/pool.h"
+#include "../data/benchmark_mont_data.h"
+
+// Simulates a big.LITTLE CPU on a homogeneous one: threads 2 and 3 do every
+// multiplication SLOWDOWN times, like little cores at 1/SLOWDOWN of the
+// speed of the big ones. Compares a static split, plain work stealing, and
+// the adaptive pool, which sizes each thread's ranges by its measured speed.
+
+#define NUM_THREADS 4
+#define N (1 << 16)
+#define SLOWDOWN 3
+
+static MontField f;
+static BigInt *va, *vb, *vout;
+static bool throttle = false;
+
+static void throttled_mul_range(size_t start, size_t end, void *ctx) {
+    int id = pool_current_worker();
+    int reps = throttle && id >= 2 ? SLOWDOWN : 1;
+    for (size_t i = start; i < end; i ++) {
+        for (int r = 0; r < reps; r ++) {
+            vout[i] = field_mul(&va[i], &vb[i], &f);
+        }
+    }
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_mul(ThreadPool *pool, size_t grain) {
+    parallel_for(pool, N, grain, throttled_mul_range, NULL);
+}
+
+// Unoptimised function to run the multiplications `cost` times
+NO_OPT
+uint64_t reference_func(ThreadPool *pool, size_t grain, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        run_mul(pool, grain);
+    }
+    return black_box(vout[N - 1].v[0]);
+}
+
+double time_mul(ThreadPool *pool, size_t grain, int num_runs) {
+    int cost = 16;
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(pool, grain, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    assert(result == 0);
+
+    va = aligned_alloc(64, N * sizeof(BigInt));
+    vb = aligned_alloc(64, N * sizeof(BigInt));
+    vout = aligned_alloc(64, N * sizeof(BigInt));
+    assert(va != NULL && vb != NULL && vout != NULL);
+    result = bigint_from_hex(data[0].a_hex, &va[0]);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &vb[0]);
+    assert(result == 0);
+    for (size_t i = 1; i < N; i ++) {
+        va[i] = field_mul(&va[i - 1], &vb[0], &f);
+        vb[i] = field_mul(&vb[i - 1], &va[0], &f);
+    }
+
+    // What this device looks like
+    int cpus[POOL_MAX_CPUS];
+    unsigned capacity[POOL_MAX_CPUS];
+    int num_cpus = pool_cpu_capacities(cpus, capacity, POOL_MAX_CPUS);
+    printf("CPU capacities:");
+    for (int i = 0; i < num_cpus; i ++) {
+        printf(" cpu%d=%u", cpus[i], capacity[i]);
+    }
+    ThreadPool pool;
+    result = pool_init_hetero(&pool, NUM_THREADS);
+    assert(result == 0);
+    printf("\npool_init_hetero: %s\n", pool.adaptive ? "heterogeneous, adaptive and pinned" : "homogeneous, plain work stealing");
+    pool_destroy(&pool);
+
+    int num_runs = 3;
+    printf("2^20 multiplications with %d threads, 2 of them %dx slower:\n", NUM_THREADS, SLOWDOWN);
+    for (int t = 0; t < 2; t ++) {
+        throttle = t == 1;
+        const char *label = throttle ? "throttled" : "unthrottled";
+
+        result = pool_init(&pool, NUM_THREADS);
+        assert(result == 0);
+        double avg = time_mul(&pool, N / NUM_THREADS, num_runs);
+        printf("%s, static split took: %f ms (avg over %d runs)\n", label, avg, num_runs);
+        avg = time_mul(&pool, 0, num_runs);
+        printf("%s, work stealing took: %f ms (avg over %d runs)\n", label, avg, num_runs);
+        pool_destroy(&pool);
+
+        result = pool_init_adaptive(&pool, NUM_THREADS, NULL, NULL);
+        assert(result == 0);
+        avg = time_mul(&pool, 0, num_runs);
+        printf("%s, adaptive work stealing took: %f ms (avg over %d runs)\n", label, avg, num_runs);
+        pool_destroy(&pool);
+    }
+
+    free(va);
+    free(vb);
+    free(vout);
+}
@@ -0,0 +1,82 @@
+// Shared body of the Poseidon benchmarks. Each benchmark_<kernel>.c includes
+// a bigint layout and a Montgomery multiplication kernel, defines KERNEL_NAME
+// and KERNEL_N0, and then includes this file.
+
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+
+#define NUM_HASHES (1 << 10)
+
+static PoseidonParams params;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void optimised_permute(BigInt *state, bool reference, MontField *f) {
+    if (reference) {
+        poseidon_permute_reference(state, &params, f);
+    } else {
+        poseidon_permute(state, &params, f);
+    }
+}
+
+// Unoptimised function to hash `cost` times, feeding each output back in
+NO_OPT
+uint64_t reference_func(BigInt *a, bool reference, MontField *f, int cost) {
+    BigInt state[POSEIDON_MAX_T];
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        state[0] = bigint_new();
+        for (int j = 1; j < params.t; j ++) {
+            state[j] = x;
+        }
+        optimised_permute(state, reference, f);
+        x = state[0];
+    }
+    return black_box(x.v[0]);
+}
+
+double time_hashes(BigInt *a, bool reference, MontField *f, int num_runs) {
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(a, reference, f, NUM_HASHES);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    MontField f;
+    BigInt a;
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+
+    int num_runs = 5;
+    int widths[] = {2, 3, 5, 9, 17};
+
+    printf("Poseidon with %s:\n", KERNEL_NAME);
+    for (int i = 0; i < sizeof(widths) / sizeof(widths[0]); i ++) {
+        result = poseidon_init(&params, widths[i], &f);
+        assert(result == 0);
+
+        double avg = time_hashes(&a, false, &f, num_runs);
+        printf("%d hashes with t = %d took: %f ms (avg over %d runs), %.0f hashes/s\n",
+            NUM_HASHES, widths[i], avg, num_runs, NUM_HASHES / avg * 1000);
+
+        // The unoptimised round structure, for comparison
+        if (widths[i] == 3) {
+            avg = time_hashes(&a, true, &f, num_runs);
+            printf("%d hashes with t = %d (unoptimised rounds) took: %f ms (avg over %d runs), %.0f hashes/s\n",
+                NUM_HASHES, widths[i], avg, num_runs, NUM_HASHES / avg * 1000);
+        }
+    }
+}
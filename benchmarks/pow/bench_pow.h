@@ -0,0 +1,101 @@
+// Shared body of the exponentiation benchmarks. Each benchmark_<kernel>.c
+// includes a bigint layout and a Montgomery multiplication kernel, defines
+// KERNEL_NAME and KERNEL_N0, and then includes this file.
+
+#include "../../c/field.h"
+#include "../../c/pow/pow.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+
+// This benchmarking approach needs to change. It's a little hacky, and ideally
+// we should use something like the Rust Criterion library.
+
+#define NUM_EXPS (1 << 10)
+#define MAX_BENCH_WINDOW 7
+
+// p - 2
+#define EXP_HEX "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593efffffff"
+
+enum { POW_SLIDING, POW_FIXED, POW_FIXED_CT, POW_ADDCHAIN };
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_pow(
+    BigInt *base,
+    BigInt *exp,
+    int method,
+    int w,
+    MontField *f
+) {
+    switch (method) {
+        case POW_SLIDING:
+            return mont_pow_sliding(base, exp, w, f);
+        case POW_FIXED:
+            return mont_pow_fixed(base, exp, w, false, f);
+        case POW_FIXED_CT:
+            return mont_pow_fixed(base, exp, w, true, f);
+        default:
+            return mont_pow_addchain(base, &BN254_SCALAR_INV_CHAIN, &f->p, f->n0);
+    }
+}
+
+// Unoptimised function to run the exponentiation `cost` times
+NO_OPT
+uint64_t reference_func(
+    BigInt *a,
+    BigInt *exp,
+    int method,
+    int w,
+    MontField *f,
+    int cost
+) {
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        x = optimised_pow(&x, exp, method, w, f);
+    }
+    return black_box(x.v[0]);
+}
+
+double time_pow(BigInt *a, BigInt *exp, int method, int w, MontField *f, int num_runs) {
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(a, exp, method, w, f, NUM_EXPS);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    MontField f;
+    BigInt a, exp;
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(EXP_HEX, &exp);
+    assert(result == 0);
+
+    int num_runs = 5;
+    double avg;
+
+    for (int w = 1; w <= MAX_BENCH_WINDOW; w++) {
+        avg = time_pow(&a, &exp, POW_SLIDING, w, &f, num_runs);
+        printf("%d exps by p - 2 with a sliding window (w = %d) using %s took: %f ms (avg over %d runs)\n", NUM_EXPS, w, KERNEL_NAME, avg, num_runs);
+    }
+    for (int w = 1; w <= MAX_BENCH_WINDOW; w++) {
+        avg = time_pow(&a, &exp, POW_FIXED, w, &f, num_runs);
+        printf("%d exps by p - 2 with a fixed window (w = %d) using %s took: %f ms (avg over %d runs)\n", NUM_EXPS, w, KERNEL_NAME, avg, num_runs);
+    }
+    for (int w = 1; w <= MAX_BENCH_WINDOW; w++) {
+        avg = time_pow(&a, &exp, POW_FIXED_CT, w, &f, num_runs);
+        printf("%d exps by p - 2 with a constant-time fixed window (w = %d) using %s took: %f ms (avg over %d runs)\n", NUM_EXPS, w, KERNEL_NAME, avg, num_runs);
+    }
+    avg = time_pow(&a, &exp, POW_ADDCHAIN, 0, &f, num_runs);
+    printf("%d exps by p - 2 with an addition chain using %s took: %f ms (avg over %d runs)\n", NUM_EXPS, KERNEL_NAME, avg, num_runs);
+}
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Machine-readable benchmark results, for benchmarks/compare_results.js to
+// compare runs and regenerate the README table from.
+//
+// A result file holds the device (from /proc/cpuinfo), the compiler, and one
+// record per kernel, limb layout and mode, with the raw samples and their
+// summary statistics. It is written as JSON:
+//
+//     {
+//       "device": {"model": ..., "hardware": ..., "cpu_part": ..., "arch": ..., "cores": ...},
+//       "compiler": ..., "date": ..., "unit": ...,
+//       "results": [
+//         {"kernel": ..., "limbs": ..., "mode": ..., "size": ...,
+//          "median": ..., "min": ..., "max": ..., "mean": ..., "stddev": ...,
+//          "samples": [...]},
+//         ...
+//       ]
+//     }
+//
+// or as CSV, one row per record, with the samples separated by spaces in the
+// last column, and the device and compiler repeated on every row.
+
+typedef struct {
+    char model[128];    // "model name", or the board's "Model" on ARM
+    char hardware[128]; // "Hardware", set on some ARM SoCs
+    char cpu_part[32];  // "CPU implementer" and "CPU part" on ARM
+    char arch[32];
+    int cores;
+} BenchDevice;
+
+typedef struct {
+    double median;
+    double min;
+    double max;
+    double mean;
+    double stddev; // Sample standard deviation
+} BenchStats;
+
+typedef struct {
+    const char *kernel;
+    const char *limbs;
+    const char *mode;
+    size_t size;           // Products per sample
+    const double *samples; // In the file's unit
+    size_t num_samples;
+} BenchRecord;
+
+// The value of a "key : value" line of /proc/cpuinfo, if the line has that
+// key.
+static inline int bench_cpuinfo_value(const char *line, const char *key, char *out, size_t len) {
+    size_t n = strlen(key);
+    if (strncmp(line, key, n) != 0 || (line[n] != ' ' && line[n] != '\t' && line[n] != ':')) {
+        return 0;
+    }
+    const char *v = strchr(line, ':');
+    if (v == NULL) {
+        return 0;
+    }
+    v ++;
+    while (*v == ' ') {
+        v ++;
+    }
+    snprintf(out, len, "%s", v);
+    out[strcspn(out, "\n")] = '\0';
+    return 1;
+}
+
+static inline void bench_device_detect(BenchDevice *d) {
+    memset(d, 0, sizeof(*d));
+#if defined(__aarch64__)
+    strcpy(d->arch, "aarch64");
+#elif defined(__x86_64__)
+    strcpy(d->arch, "x86_64");
+#else
+    strcpy(d->arch, "unknown");
+#endif
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f == NULL) {
+        return;
+    }
+    char line[256];
+    char implementer[16] = "", part[16] = "";
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char value[128];
+        if (bench_cpuinfo_value(line, "processor", value, sizeof(value))) {
+            d->cores ++;
+        } else if (d->model[0] == '\0' && bench_cpuinfo_value(line, "model name", value, sizeof(value))) {
+            snprintf(d->model, sizeof(d->model), "%s", value);
+        } else if (bench_cpuinfo_value(line, "Model", value, sizeof(value))) {
+            // The board, which says more than the core's model name
+            snprintf(d->model, sizeof(d->model), "%s", value);
+        } else if (bench_cpuinfo_value(line, "Hardware", value, sizeof(value))) {
+            snprintf(d->hardware, sizeof(d->hardware), "%s", value);
+        } else if (implementer[0] == '\0' && bench_cpuinfo_value(line, "CPU implementer", value, sizeof(value))) {
+            snprintf(implementer, sizeof(implementer), "%.15s", value);
+        } else if (part[0] == '\0' && bench_cpuinfo_value(line, "CPU part", value, sizeof(value))) {
+            snprintf(part, sizeof(part), "%.15s", value);
+        }
+    }
+    fclose(f);
+    if (part[0] != '\0') {
+        snprintf(d->cpu_part, sizeof(d->cpu_part), "%.15s:%.15s", implementer, part);
+    }
+}
+
+// The compiler that built the benchmark
+static inline const char *bench_compiler(void) {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+static inline int bench_compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static inline BenchStats bench_stats(const double *samples, size_t n) {
+    BenchStats s = {0, 0, 0, 0, 0};
+    if (n == 0) {
+        return s;
+    }
+    double *sorted = (double *)malloc(n * sizeof(double));
+    memcpy(sorted, samples, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), bench_compare_doubles);
+    s.median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    s.min = sorted[0];
+    s.max = sorted[n - 1];
+    for (size_t i = 0; i < n; i ++) {
+        s.mean += sorted[i] / n;
+    }
+    for (size_t i = 0; n > 1 && i < n; i ++) {
+        s.stddev += (sorted[i] - s.mean) * (sorted[i] - s.mean) / (n - 1);
+    }
+    s.stddev = sqrt(s.stddev);
+    free(sorted);
+    return s;
+}
+
+// Writes s as a JSON string.
+static inline void bench_json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s != '\0'; s ++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(f, "\\%c", *s);
+        } else if ((unsigned char)*s < 0x20) {
+            fprintf(f, "\\u%04x", *s);
+        } else {
+            fputc(*s, f);
+        }
+    }
+    fputc('"', f);
+}
+
+// Writes s as a CSV field.
+static inline void bench_csv_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s != '\0'; s ++) {
+        if (*s == '"') {
+            fputc('"', f);
+        }
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static inline void bench_date(char *out, size_t len) {
+    time_t now = time(NULL);
+    strftime(out, len, "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+}
+
+/*
+ * Writes n records to path as JSON. unit says what the samples measure, such
+ * as "ms per 1048576 products". Returns 0 on success and -1 if the file
+ * can't be written.
+ */
+static inline int bench_write_json(const char *path, const BenchDevice *d, const char *unit, const BenchRecord *r, size_t n) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return -1;
+    }
+    char date[32];
+    bench_date(date, sizeof(date));
+    fprintf(f, "{\n  \"device\": {\"model\": ");
+    bench_json_string(f, d->model);
+    fprintf(f, ", \"hardware\": ");
+    bench_json_string(f, d->hardware);
+    fprintf(f, ", \"cpu_part\": ");
+    bench_json_string(f, d->cpu_part);
+    fprintf(f, ", \"arch\": ");
+    bench_json_string(f, d->arch);
+    fprintf(f, ", \"cores\": %d},\n  \"compiler\": ", d->cores);
+    bench_json_string(f, bench_compiler());
+    fprintf(f, ",\n  \"date\": \"%s\",\n  \"unit\": ", date);
+    bench_json_string(f, unit);
+    fprintf(f, ",\n  \"results\": [\n");
+    for (size_t i = 0; i < n; i ++) {
+        BenchStats s = bench_stats(r[i].samples, r[i].num_samples);
+        fprintf(f, "    {\"kernel\": ");
+        bench_json_string(f, r[i].kernel);
+        fprintf(f, ", \"limbs\": ");
+        bench_json_string(f, r[i].limbs);
+        fprintf(f, ", \"mode\": ");
+        bench_json_string(f, r[i].mode);
+        fprintf(f, ", \"size\": %zu,\n     \"median\": %.6g, \"min\": %.6g, \"max\": %.6g, \"mean\": %.6g, \"stddev\": %.6g,\n     \"samples\": [",
+            r[i].size, s.median, s.min, s.max, s.mean, s.stddev);
+        for (size_t j = 0; j < r[i].num_samples; j ++) {
+            fprintf(f, "%s%.6g", j ? ", " : "", r[i].samples[j]);
+        }
+        fprintf(f, "]}%s\n", i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+// The same as CSV.
+static inline int bench_write_csv(const char *path, const BenchDevice *d, const char *unit, const BenchRecord *r, size_t n) {
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return -1;
+    }
+    char date[32];
+    bench_date(date, sizeof(date));
+    fprintf(f, "kernel,limbs,mode,size,unit,median,min,max,mean,stddev,model,hardware,cpu_part,arch,cores,compiler,date,samples\n");
+    for (size_t i = 0; i < n; i ++) {
+        BenchStats s = bench_stats(r[i].samples, r[i].num_samples);
+        bench_csv_string(f, r[i].kernel);
+        fputc(',', f);
+        bench_csv_string(f, r[i].limbs);
+        fputc(',', f);
+        bench_csv_string(f, r[i].mode);
+        fprintf(f, ",%zu,", r[i].size);
+        bench_csv_string(f, unit);
+        fprintf(f, ",%.6g,%.6g,%.6g,%.6g,%.6g,", s.median, s.min, s.max, s.mean, s.stddev);
+        bench_csv_string(f, d->model);
+        fputc(',', f);
+        bench_csv_string(f, d->hardware);
+        fputc(',', f);
+        bench_csv_string(f, d->cpu_part);
+        fprintf(f, ",%s,%d,", d->arch, d->cores);
+        bench_csv_string(f, bench_compiler());
+        fprintf(f, ",%s,\"", date);
+        for (size_t j = 0; j < r[i].num_samples; j ++) {
+            fprintf(f, "%s%.6g", j ? " " : "", r[i].samples[j]);
+        }
+        fprintf(f, "\"\n");
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/domb/mont_4x64.h"
+#include "../../c/safegcd/inv_4x64.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares safegcd inversion against Fermat inversion (x^(p - 2) via an
+// addition chain), using Domb's CIOS as the fastest 64-bit mont_mul.
+
+#define NUM_INVERSIONS (1 << 14)
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_mont_inv(
+    BigInt *ar,
+    BigInt *p,
+    BigInt *r2,
+    uint64_t n0
+) {
+    return mont_inv(ar, p, r2, n0);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_mont_inv_fermat(
+    BigInt *ar,
+    BigInt *p,
+    uint64_t n0
+) {
+    return mont_pow_addchain(ar, &BN254_SCALAR_INV_CHAIN, p, n0);
+}
+
+// Unoptimised function to run the safegcd inversion `cost` times
+NO_OPT
+uint64_t reference_func_safegcd(
+    BigInt *a,
+    BigInt *p,
+    BigInt *r2,
+    uint64_t n0,
+    int cost
+) {
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        x = optimised_mont_inv(&x, p, r2, n0);
+    }
+    return black_box(x.v[0]);
+}
+
+// Unoptimised function to run the Fermat inversion `cost` times
+NO_OPT
+uint64_t reference_func_fermat(
+    BigInt *a,
+    BigInt *p,
+    uint64_t n0,
+    int cost
+) {
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        x = optimised_mont_inv_fermat(&x, p, n0);
+    }
+    return black_box(x.v[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    char* p_hex = BN254_SCALAR_HEX;
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+
+    BigInt a, p, r2;
+
+    int result;
+
+    result = bigint_from_hex(p_hex, &p);
+    assert(result == 0);
+    result = bigint_from_hex(BN254_SCALAR_R2_HEX, &r2);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+
+    // Both methods must agree before they are timed.
+    BigInt x = mont_inv(&a, &p, &r2, n0);
+    BigInt y = mont_pow_addchain(&a, &BN254_SCALAR_INV_CHAIN, &p, n0);
+    assert(bigint_eq(&x, &y));
+
+    int num_runs = 5;
+    int cost = NUM_INVERSIONS;
+
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_safegcd(&a, &p, &r2, n0, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d inversions with safegcd (62-bit divsteps) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_fermat(&a, &p, n0, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d inversions with Fermat's little theorem (Domb, 64-bit limbs) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+}
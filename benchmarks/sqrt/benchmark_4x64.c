@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <assert.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/domb/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/sqrt/legendre.h"
+#include "../../c/sqrt/sqrt.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares the table-driven square root against classic Tonelli-Shanks, and
+// the binary Jacobi Legendre symbol against Euler's criterion, using Domb as
+// the 64-bit mont_mul.
+
+#define NUM_OPS (1 << 12)
+
+// Classic Tonelli-Shanks, which finds the discrete log of x^t one bit at a
+// time. g is the 2^28-th root of unity in Montgomery form.
+int classic_sqrt(BigInt *xr, BigInt *out, BigInt *g, MontField *f) {
+    BigInt w = mont_pow_addchain(xr, &BN254_SCALAR_SQRT_CHAIN, &f->p, f->n0);
+    BigInt z = field_mul(xr, &w, f);
+    BigInt b = field_mul(&z, &w, f);
+    BigInt c = *g;
+    int m = BN254_SCALAR_TWO_ADICITY;
+
+    while (!bigint_eq(&b, &f->one)) {
+        // The least i such that b^(2^i) = 1
+        int i = 0;
+        BigInt b2 = b;
+        while (!bigint_eq(&b2, &f->one)) {
+            b2 = field_sqr(&b2, f);
+            i ++;
+            if (i == m) {
+                return -1;
+            }
+        }
+        for (int j = 0; j < m - i - 1; j ++) {
+            c = field_sqr(&c, f);
+        }
+        z = field_mul(&z, &c, f);
+        c = field_sqr(&c, f);
+        b = field_mul(&b, &c, f);
+        m = i;
+    }
+    *out = z;
+    return 0;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_sqrt(BigInt *xr, SqrtTables *tables, MontField *f) {
+    BigInt r;
+    mont_sqrt(xr, &r, tables, f);
+    return r;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+BigInt optimised_classic_sqrt(BigInt *xr, BigInt *g, MontField *f) {
+    BigInt r;
+    classic_sqrt(xr, &r, g, f);
+    return r;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+int optimised_legendre_jacobi(BigInt *xr, MontField *f) {
+    return legendre_jacobi(xr, &f->p);
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+int optimised_legendre_euler(BigInt *xr, MontField *f) {
+    return mont_legendre(xr, f);
+}
+
+// Unoptimised function to take `cost` square roots of a chain of squares
+NO_OPT
+uint64_t reference_func_sqrt(BigInt *a, SqrtTables *tables, MontField *f, int cost) {
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        BigInt x2 = field_sqr(&x, f);
+        BigInt r = optimised_sqrt(&x2, tables, f);
+        x = field_mul(&r, a, f);
+    }
+    return black_box(x.v[0]);
+}
+
+// Unoptimised function to take `cost` square roots with classic Tonelli-Shanks
+NO_OPT
+uint64_t reference_func_classic_sqrt(BigInt *a, BigInt *g, MontField *f, int cost) {
+    BigInt x = *a;
+    for (int i = 0; i < cost; i ++) {
+        BigInt x2 = field_sqr(&x, f);
+        BigInt r = optimised_classic_sqrt(&x2, g, f);
+        x = field_mul(&r, a, f);
+    }
+    return black_box(x.v[0]);
+}
+
+// Unoptimised function to compute `cost` Legendre symbols with either method
+NO_OPT
+uint64_t reference_func_legendre(BigInt *a, MontField *f, int cost, bool jacobi) {
+    BigInt x = *a;
+    int acc = 0;
+    for (int i = 0; i < cost; i ++) {
+        acc += jacobi ? optimised_legendre_jacobi(&x, f) : optimised_legendre_euler(&x, f);
+        x = field_mul(&x, a, f);
+    }
+    return black_box(x.v[0] + acc);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    MontField f;
+    SqrtTables tables;
+    BigInt a, g;
+
+    int result;
+
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    assert(result == 0);
+    result = sqrt_init(&tables, &f);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(BN254_SCALAR_ROOT_OF_UNITY_HEX, &g);
+    assert(result == 0);
+    g = field_to_mont(&g, &f);
+
+    // Both square roots must square back to the input before they are timed.
+    BigInt a2 = field_sqr(&a, &f);
+    BigInt r1, r2;
+    assert(mont_sqrt(&a2, &r1, &tables, &f) == 0);
+    assert(classic_sqrt(&a2, &r2, &g, &f) == 0);
+    r1 = field_sqr(&r1, &f);
+    r2 = field_sqr(&r2, &f);
+    assert(bigint_eq(&r1, &a2));
+    assert(bigint_eq(&r2, &a2));
+    assert(legendre_jacobi(&a, &f.p) == mont_legendre(&a, &f));
+
+    int num_runs = 5;
+    int cost = NUM_OPS;
+
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_sqrt(&a, &tables, &f, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d square roots (table-driven Tonelli-Shanks) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_classic_sqrt(&a, &g, &f, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d square roots (classic Tonelli-Shanks) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_legendre(&a, &f, cost, true);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d Legendre symbols (binary Jacobi) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+
+    avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func_legendre(&a, &f, cost, false);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    avg /= num_runs;
+
+    printf("%d Legendre symbols (Euler's criterion) took: %f ms (avg over %d runs)\n", cost, avg, num_runs);
+}
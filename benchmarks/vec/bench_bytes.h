@@ -0,0 +1,126 @@
+// The body of the byte import benchmarks. Include the BigInt header, a
+// Montgomery kernel, c/field.h, c/vec/frvec.h and c/vec/bytes.h first, and
+// define KERNEL_NAME and KERNEL_N0.
+//
+// Compares getting N encoded elements into Montgomery form by parsing hex,
+// by importing and then converting in a second pass, and by the fused
+// import, for both byte orders and both layouts, and times the export.
+
+#define N (1 << 14)
+
+static MontField f;
+static char **hex_strs;
+static uint8_t *le, *be, *bytes_out;
+static BigInt *out;
+static FrVec soa;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_case(int which) {
+    switch (which) {
+        case 0:
+            for (size_t i = 0; i < N; i ++) {
+                bigint_from_hex(hex_strs[i], &out[i]);
+                out[i] = field_to_mont(&out[i], &f);
+            }
+            break;
+        case 1:
+            fr_import(out, be, N, FR_BIG_ENDIAN, false, &f);
+            for (size_t i = 0; i < N; i ++) {
+                out[i] = field_to_mont(&out[i], &f);
+            }
+            break;
+        case 2:
+            fr_import(out, be, N, FR_BIG_ENDIAN, true, &f);
+            break;
+        case 3:
+            fr_import(out, le, N, FR_LITTLE_ENDIAN, true, &f);
+            break;
+        case 4:
+            fr_import_vec(&soa, be, FR_BIG_ENDIAN, true, &f);
+            break;
+        case 5:
+            fr_import(out, le, N, FR_LITTLE_ENDIAN, false, &f);
+            break;
+        case 6: {
+            const BigInt *view = fr_import_view(le, N, &f);
+            out[0].v[0] = view == NULL;
+            break;
+        }
+        default:
+            fr_export(bytes_out, out, N, FR_BIG_ENDIAN, true, &f);
+    }
+}
+
+// Unoptimised function to run a case `cost` times
+NO_OPT
+uint64_t reference_func(int which, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        run_case(which);
+    }
+    return black_box(out[N - 1].v[0] ^ ((FrLimb *)soa.data)[0] ^ bytes_out[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+
+    hex_strs = malloc(N * sizeof(char *));
+    le = aligned_alloc(64, N * FR_BYTES);
+    be = aligned_alloc(64, N * FR_BYTES);
+    bytes_out = aligned_alloc(64, N * FR_BYTES);
+    out = aligned_alloc(64, N * sizeof(BigInt));
+    assert(hex_strs != NULL && le != NULL && be != NULL && bytes_out != NULL && out != NULL);
+    result = frvec_init(&soa, N, FRVEC_SOA);
+    assert(result == 0);
+    BigInt a, b;
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 0; i < N; i ++) {
+        hex_strs[i] = strdup(bigint_to_hex(&a));
+        out[i] = a;
+        a = field_mul(&a, &b, &f);
+    }
+    fr_export(le, out, N, FR_LITTLE_ENDIAN, false, &f);
+    fr_export(be, out, N, FR_BIG_ENDIAN, false, &f);
+
+    const char *labels[] = {
+        "bigint_from_hex, then to Montgomery form",
+        "big-endian fr_import, then to Montgomery form in a second pass",
+        "big-endian fr_import, fused Montgomery conversion",
+        "little-endian fr_import, fused Montgomery conversion",
+        "big-endian fr_import_vec into SoA, fused Montgomery conversion",
+        "little-endian fr_import, no conversion",
+        "little-endian fr_import_view (validation only)",
+        "big-endian fr_export from Montgomery form",
+    };
+    int cost = 8;
+    int num_runs = 10;
+    printf("%s, %d elements:\n", KERNEL_NAME, N);
+    for (int c = 0; c < 8; c ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(c, cost);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%s x %d took: %f ms (avg over %d runs)\n", labels[c], cost, avg, num_runs);
+    }
+
+    for (size_t i = 0; i < N; i ++) {
+        free(hex_strs[i]);
+    }
+    free(hex_strs);
+    free(le);
+    free(be);
+    free(bytes_out);
+    free(out);
+    frvec_free(&soa);
+}
@@ -0,0 +1,123 @@
+// The body of the hex codec benchmarks. Include the BigInt header and its
+// hex.h, a Montgomery kernel, c/field.h, c/vec/frvec.h, c/vec/bytes.h and
+// c/vec/hexvec.h first, and define KERNEL_NAME and KERNEL_N0.
+//
+// Compares writing and parsing N elements as hex one at a time, as
+// bigint_to_hex did with sprintf and bigint_from_hex does, against the bulk
+// SIMD codec, and reports elements per second.
+
+#include <inttypes.h>
+
+#define N (1 << 14)
+#define STRIDE (FR_HEX_DIGITS + 1)
+
+static MontField f;
+static BigInt *elems, *out;
+static char *text;
+
+// What bigint_to_hex used to do: one sprintf per limb into a static buffer.
+char *sprintf_to_hex(const BigInt *val) {
+    static char hex_str[65];
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+#if BITS_PER_LIMB == 32
+        sprintf(hex_str + i * 8, "%08x", (uint32_t)val->v[NUM_LIMBS - 1 - i]);
+#else
+        sprintf(hex_str + i * 16, "%016" PRIx64, val->v[NUM_LIMBS - 1 - i]);
+#endif
+    }
+    return hex_str;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_case(int which) {
+    char buf[65];
+    switch (which) {
+        case 0:
+            for (size_t i = 0; i < N; i ++) {
+                memcpy(text + i * STRIDE, sprintf_to_hex(&elems[i]), FR_HEX_DIGITS);
+            }
+            break;
+        case 1:
+            for (size_t i = 0; i < N; i ++) {
+                memcpy(text + i * STRIDE, bigint_to_hex_r(&elems[i], buf), FR_HEX_DIGITS);
+            }
+            break;
+        case 2:
+            fr_export_hex(text, STRIDE, elems, N, false, &f);
+            break;
+        case 3:
+            for (size_t i = 0; i < N; i ++) {
+                memcpy(buf, text + i * STRIDE, FR_HEX_DIGITS);
+                buf[FR_HEX_DIGITS] = '\0';
+                bigint_from_hex(buf, &out[i]);
+            }
+            break;
+        case 4:
+            fr_import_hex(out, text, STRIDE, N, false, &f);
+            break;
+        default:
+            fr_import_hex(out, text, STRIDE, N, true, &f);
+    }
+}
+
+// Unoptimised function to run a case `cost` times
+NO_OPT
+uint64_t reference_func(int which, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        run_case(which);
+    }
+    return black_box(out[N - 1].v[0] ^ text[0]);
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+
+    elems = aligned_alloc(64, N * sizeof(BigInt));
+    out = aligned_alloc(64, N * sizeof(BigInt));
+    text = malloc(N * STRIDE);
+    assert(elems != NULL && out != NULL && text != NULL);
+    BigInt a, b;
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 0; i < N; i ++) {
+        elems[i] = a;
+        a = field_mul(&a, &b, &f);
+        text[i * STRIDE + FR_HEX_DIGITS] = '\n';
+    }
+    fr_export_hex(text, STRIDE, elems, N, false, &f);
+
+    const char *labels[] = {
+        "sprintf per limb (the old bigint_to_hex)",
+        "bigint_to_hex_r",
+        "fr_export_hex",
+        "bigint_from_hex",
+        "fr_import_hex",
+        "fr_import_hex, fused Montgomery conversion",
+    };
+    int cost = 8;
+    int num_runs = 10;
+    printf("%s, %d elements:\n", KERNEL_NAME, N);
+    for (int c = 0; c < 6; c ++) {
+        double avg = 0;
+        for (int i = 0; i < num_runs; i++) {
+            double start = get_now_ms();
+            reference_func(c, cost);
+            double end = get_now_ms();
+            avg += end - start;
+        }
+        avg /= num_runs;
+        printf("%s x %d took: %f ms (avg over %d runs), %.2f M elements/s\n",
+            labels[c], cost, avg, num_runs, (double)N * cost / avg / 1000);
+    }
+
+    free(elems);
+    free(out);
+    free(text);
+}
@@ -0,0 +1,102 @@
+// The body of the layout conversion benchmarks. Include the BigInt header,
+// a Montgomery kernel, c/field.h and c/vec/frvec.h first, and define
+// KERNEL_NAME and KERNEL_N0.
+//
+// Reports the time to convert a vector between the AoS and SoA layouts, with
+// the plain loops and with the block kernels, next to one multiplication
+// pass over the same vector, so that the cost of converting around a
+// vertical-SIMD stage can be read off directly.
+
+#define N (1 << 12)
+
+static MontField f;
+static FrVec aos, soa, prod;
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_case(int which) {
+    switch (which) {
+        case 0:
+            transpose_aos_to_soa_scalar(frvec_aos(&aos), N, soa.data, soa.stride);
+            break;
+        case 1:
+            transpose_aos_to_soa(frvec_aos(&aos), N, soa.data, soa.stride);
+            break;
+        case 2:
+            transpose_soa_to_aos_scalar(soa.data, soa.stride, N, frvec_aos(&aos));
+            break;
+        case 3:
+            transpose_soa_to_aos(soa.data, soa.stride, N, frvec_aos(&aos));
+            break;
+        default:
+            frvec_mul(&prod, &aos, &aos, &f);
+    }
+}
+
+// Unoptimised function to run a case `cost` times
+NO_OPT
+uint64_t reference_func(int which, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        run_case(which);
+    }
+    return black_box(((FrLimb *)soa.data)[N - 1] ^ frvec_aos(&prod)[0].v[0]);
+}
+
+double time_case(int which, int cost, int num_runs) {
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(which, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, KERNEL_N0);
+    assert(result == 0);
+    result = frvec_init(&aos, N, FRVEC_AOS) | frvec_init(&soa, N, FRVEC_SOA) | frvec_init(&prod, N, FRVEC_AOS);
+    assert(result == 0);
+    BigInt a, b;
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 0; i < N; i ++) {
+        frvec_aos(&aos)[i] = a;
+        a = field_mul(&a, &b, &f);
+    }
+
+    const char *labels[] = {
+        "AoS to SoA, plain loop",
+        "AoS to SoA, block kernel",
+        "SoA to AoS, plain loop",
+        "SoA to AoS, block kernel",
+        "mont_mul pass (for scale)",
+    };
+    int cost = 256;
+    int num_runs = 10;
+#if defined(TRANSPOSE_NEON)
+    const char *kernels = "NEON";
+#elif defined(TRANSPOSE_SSE2)
+    const char *kernels = "SSE2";
+#else
+    const char *kernels = "plain loop";
+#endif
+    printf("%s, %d x %d elements, %s block kernels:\n", KERNEL_NAME, cost, N, kernels);
+    for (int c = 0; c < 5; c ++) {
+        double avg = time_case(c, c == 4 ? cost / 16 : cost, num_runs);
+        if (c == 4) {
+            avg *= 16;
+        }
+        printf("%s took: %f ms (avg over %d runs)\n", labels[c], avg, num_runs);
+    }
+
+    frvec_free(&aos);
+    frvec_free(&soa);
+    frvec_free(&prod);
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/batch_inv.h"
+#include "../data/benchmark_mont_data.h"
+
+// Compares the arena-backed routines with the same work done the naive way,
+// with a malloc and free for the scratch space of every call. Small batches
+// are where the allocation matters, so the batch sizes are those of typical
+// per-call scratch: a handful of Poseidon states or one NTT butterfly block.
+// Also compares vector multiplication in the AoS and SoA layouts.
+
+#define BATCH 64
+#define NUM_CALLS 256
+#define MUL_LEN (1 << 12)
+
+static MontField f;
+static FrVec in, out, va, vb, vab;
+static Arena arena;
+
+// frvec_batch_inv, but with the prefix products on the heap.
+int batch_inv_malloc(FrVec *out, FrVec *in, MontField *f) {
+    Arena scratch;
+    if (arena_init(&scratch, in->len * sizeof(BigInt)) != 0) {
+        return -2;
+    }
+    int result = frvec_batch_inv(out, in, &scratch, &BN254_SCALAR_INV_CHAIN, f);
+    arena_free(&scratch);
+    return result;
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_inv(bool use_arena) {
+    for (int c = 0; c < NUM_CALLS; c ++) {
+        if (use_arena) {
+            frvec_batch_inv(&out, &in, &arena, &BN254_SCALAR_INV_CHAIN, &f);
+        } else {
+            batch_inv_malloc(&out, &in, &f);
+        }
+    }
+}
+
+// out = a * b * a, with a temporary vector for a * b.
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_temp(bool use_arena, size_t len) {
+    for (int c = 0; c < NUM_CALLS; c ++) {
+        FrVec a = va, b = vb, o = vab, t;
+        a.len = b.len = o.len = len;
+        size_t mark = arena_mark(&arena);
+        if (use_arena) {
+            frvec_init_arena(&t, len, FRVEC_AOS, &arena);
+        } else {
+            frvec_init(&t, len, FRVEC_AOS);
+        }
+        frvec_mul(&t, &a, &b, &f);
+        frvec_mul(&o, &t, &a, &f);
+        frvec_free(&t);
+        arena_release(&arena, mark);
+    }
+}
+
+DO_OPT // Allow optimisations for this function
+__attribute__((noinline))
+void run_mul(FrVec *o, FrVec *a, FrVec *b) {
+    frvec_mul(o, a, b, &f);
+}
+
+// Unoptimised function to run each case `cost` times
+NO_OPT
+uint64_t reference_func(int which, bool use_arena, size_t len, int cost) {
+    for (int i = 0; i < cost; i ++) {
+        if (which == 0) {
+            run_inv(use_arena);
+        } else if (which == 1) {
+            run_temp(use_arena, len);
+        } else {
+            run_mul(&vab, &va, &vb);
+        }
+    }
+    return black_box(frvec_aos(&out)[0].v[0] ^ ((uint32_t *)vab.data)[0]);
+}
+
+double time_case(int which, bool use_arena, size_t len, int cost, int num_runs) {
+    double avg = 0;
+    for (int i = 0; i < num_runs; i++) {
+        double start = get_now_ms();
+        reference_func(which, use_arena, len, cost);
+        double end = get_now_ms();
+        avg += end - start;
+    }
+    return avg / num_runs;
+}
+
+int main(int argc, char *argv[]) {
+    const BenchmarkData* data = get_benchmark_data();
+
+    int result;
+    result = mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_8x32);
+    assert(result == 0);
+    result = arena_init(&arena, 1 << 20);
+    assert(result == 0);
+
+    result = frvec_init(&in, BATCH, FRVEC_AOS) | frvec_init(&out, BATCH, FRVEC_AOS)
+        | frvec_init(&va, MUL_LEN, FRVEC_AOS) | frvec_init(&vb, MUL_LEN, FRVEC_AOS)
+        | frvec_init(&vab, MUL_LEN, FRVEC_AOS);
+    assert(result == 0);
+    BigInt a, b;
+    result = bigint_from_hex(data[0].a_hex, &a);
+    assert(result == 0);
+    result = bigint_from_hex(data[0].b_hex, &b);
+    assert(result == 0);
+    for (size_t i = 0; i < MUL_LEN; i ++) {
+        frvec_set(&va, i, &a);
+        frvec_set(&vb, i, &b);
+        if (i < BATCH) {
+            frvec_set(&in, i, &a);
+        }
+        a = field_mul(&a, &b, &f);
+        b = field_mul(&b, &a, &f);
+    }
+
+    int num_runs = 10;
+    double avg;
+    printf("Acar (32-bit limbs), %d calls each:\n", NUM_CALLS);
+    avg = time_case(0, false, 0, 1, num_runs);
+    printf("Batch inversion of %d, scratch from malloc took: %f ms (avg over %d runs)\n", BATCH, avg, num_runs);
+    avg = time_case(0, true, 0, 1, num_runs);
+    printf("Batch inversion of %d, scratch from an arena took: %f ms (avg over %d runs)\n", BATCH, avg, num_runs);
+
+    size_t lens[] = {4, 16, 64, 1024};
+    for (int l = 0; l < sizeof(lens) / sizeof(lens[0]); l ++) {
+        avg = time_case(1, false, lens[l], 1, num_runs);
+        printf("a * b * a for %zu elements, temporary from malloc took: %f ms (avg over %d runs)\n", lens[l], avg, num_runs);
+        avg = time_case(1, true, lens[l], 1, num_runs);
+        printf("a * b * a for %zu elements, temporary from an arena took: %f ms (avg over %d runs)\n", lens[l], avg, num_runs);
+    }
+
+    int cost = 64;
+    avg = time_case(2, false, 0, cost, num_runs);
+    printf("%d x %d multiplications, AoS layout took: %f ms (avg over %d runs)\n", cost, MUL_LEN, avg, num_runs);
+    FrVec soa_a, soa_b;
+    result = frvec_init(&soa_a, MUL_LEN, FRVEC_SOA) | frvec_init(&soa_b, MUL_LEN, FRVEC_SOA);
+    assert(result == 0);
+    frvec_copy(&soa_a, &va);
+    frvec_copy(&soa_b, &vb);
+    FrVec aos_a = va, aos_b = vb;
+    frvec_free(&vab);
+    result = frvec_init(&vab, MUL_LEN, FRVEC_SOA);
+    assert(result == 0);
+    va = soa_a;
+    vb = soa_b;
+    avg = time_case(2, false, 0, cost, num_runs);
+    printf("%d x %d multiplications, SoA layout (4 lanes) took: %f ms (avg over %d runs)\n", cost, MUL_LEN, avg, num_runs);
+
+    frvec_free(&aos_a);
+    frvec_free(&aos_b);
+    frvec_free(&soa_a);
+    frvec_free(&soa_b);
+    frvec_free(&vab);
+    frvec_free(&in);
+    frvec_free(&out);
+    arena_free(&arena);
+}
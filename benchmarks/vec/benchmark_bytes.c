@@ -0,0 +1,21 @@
+#define _XOPEN_SOURCE 700 // For strdup
+
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include "../time.h"
+#include "../black_box.h"
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/field.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/bytes.h"
+#include "../data/benchmark_mont_data.h"
+
+#define KERNEL_NAME "Acar (32-bit limbs)"
+#define KERNEL_N0 BN254_SCALAR_N0_8x32
+
+#include "bench_bytes.h"
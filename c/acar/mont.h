@@ -118,3 +118,99 @@ BigInt mont_mul(
     return res;
 }
 
+
+#define MONT_SUM_OF_PRODUCTS_AVAILABLE
+
+/// Returns the sum of a[i] * b[i] for i < k, in the Montgomery domain, with
+/// one Montgomery reduction instead of k. Each 512-bit product is added into
+/// a 512-bit accumulator of 32-bit limbs, plus a full 64-bit word for the
+/// carries out of the top, and the sum is reduced once at the end. The
+/// reduction leaves a value less than (1 + k * p / R) * p, which is brought
+/// below p by subtracting p. For BN254, p < R / 5, so that is at most four
+/// subtractions for k = 16.
+/// Inputs may be anywhere in [0, p]; the result is in [0, p).
+/// Does not use SIMD instructions.
+BigInt mont_sum_of_products(
+    BigInt *a,
+    BigInt *b,
+    int k,
+    BigInt *p,
+    uint64_t n0
+) {
+    // t[2 * NUM_LIMBS] is not masked to BITS_PER_LIMB.
+    uint64_t t[2 * NUM_LIMBS + 1] = {0};
+    uint64_t c;
+    uint64_t cs;
+
+    for (int s = 0; s < k; s ++) {
+        // The 512-bit product a[s] * b[s]
+        uint64_t prod[2 * NUM_LIMBS];
+        for (int i = 0; i < NUM_LIMBS; i ++) {
+            c = 0;
+            for (int j = 0; j < NUM_LIMBS; j ++) {
+                cs = (i == 0 ? 0 : prod[i + j]) + a[s].v[i] * b[s].v[j] + c;
+                c = hi(cs);
+                prod[i + j] = lo(cs);
+            }
+            prod[i + NUM_LIMBS] = c;
+        }
+
+        // Accumulate it
+        c = 0;
+        for (int i = 0; i < 2 * NUM_LIMBS; i ++) {
+            cs = t[i] + prod[i] + c;
+            c = hi(cs);
+            t[i] = lo(cs);
+        }
+        t[2 * NUM_LIMBS] += c;
+    }
+
+    // Montgomery reduction
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t m = (t[i] * n0) & LIMB_MASK;
+        c = 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            cs = t[i + j] + m * p->v[j] + c;
+            c = hi(cs);
+            t[i + j] = lo(cs);
+        }
+        for (int j = i + NUM_LIMBS; j < 2 * NUM_LIMBS && c != 0; j ++) {
+            cs = t[j] + c;
+            c = hi(cs);
+            t[j] = lo(cs);
+        }
+        t[2 * NUM_LIMBS] += c;
+    }
+
+    // The result is t[NUM_LIMBS..2 * NUM_LIMBS]. Subtract p until it is less
+    // than p.
+    uint64_t *u = &t[NUM_LIMBS];
+    for (;;) {
+        bool u_ge_p = u[NUM_LIMBS] != 0;
+        if (!u_ge_p) {
+            u_ge_p = true;
+            for (int i = NUM_LIMBS - 1; i >= 0; i --) {
+                if (u[i] != p->v[i]) {
+                    u_ge_p = u[i] > p->v[i];
+                    break;
+                }
+            }
+        }
+        if (!u_ge_p) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (int i = 0; i < NUM_LIMBS; i ++) {
+            uint64_t diff = u[i] - p->v[i] - borrow;
+            u[i] = diff & LIMB_MASK;
+            borrow = (diff >> BITS_PER_LIMB) & 1;
+        }
+        u[NUM_LIMBS] -= borrow;
+    }
+
+    BigInt res = bigint_new();
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        res.v[i] = u[i];
+    }
+    return res;
+}
@@ -51,25 +51,9 @@ void mont_mul_no_reduce(
     }
 }
 
-/// Amine Mrabet, Nadia El-Mrabet, Ronan Lashermes, Jean-Baptiste Rigaud, Belgacem Bouallegue, et
-/// al.. High-performance Elliptic Curve Cryptography by Using the CIOS Method for Modular
-/// Multiplication. CRiSIS 2016, Sep 2016, Roscoff, France. hal-01383162
-/// https://inria.hal.science/hal-01383162/document , page 4
-/// Also see Acar, 1996.
-/// This is the "classic" CIOS algorithm.
-/// Does not implement the gnark optimisation (https://hackmd.io/@gnark/modular_multiplication),
-/// but that should be useful.
-/// Does not use SIMD instructions.
-BigInt mont_mul(
-    BigInt *ar,
-    BigInt *br,
-    BigInt *p,
-    uint64_t n0
-) {
-    uint64_t t[NUM_LIMBS + 2] = {0};
-
-    mont_mul_no_reduce(ar, br, p, n0, t);
-
+/// Returns t if t <= p, or t - p otherwise, where t has NUM_LIMBS + 1 limbs
+/// and is less than 2p.
+static inline BigInt mont_reduce_final(uint64_t *t, BigInt *p) {
     bool t_gt_p = false;
     for (int idx = 0; idx < NUM_LIMBS + 1; idx ++) {
         int i = NUM_LIMBS - idx;
@@ -116,3 +100,367 @@ BigInt mont_mul(
     }
     return res;
 }
+
+/// Amine Mrabet, Nadia El-Mrabet, Ronan Lashermes, Jean-Baptiste Rigaud, Belgacem Bouallegue, et
+/// al.. High-performance Elliptic Curve Cryptography by Using the CIOS Method for Modular
+/// Multiplication. CRiSIS 2016, Sep 2016, Roscoff, France. hal-01383162
+/// https://inria.hal.science/hal-01383162/document , page 4
+/// Also see Acar, 1996.
+/// This is the "classic" CIOS algorithm.
+/// Does not implement the gnark optimisation (https://hackmd.io/@gnark/modular_multiplication),
+/// but that should be useful.
+/// Does not use SIMD instructions.
+BigInt mont_mul(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *p,
+    uint64_t n0
+) {
+    uint64_t t[NUM_LIMBS + 2] = {0};
+
+    mont_mul_no_reduce(ar, br, p, n0, t);
+
+    return mont_reduce_final(t, p);
+}
+
+#define MONT_MUL2_AVAILABLE
+
+/// Computes a * b and a * c together with the CIOS method. Each limb of a is
+/// loaded once for both products, and the two carry chains, which don't
+/// depend on each other, are interleaved so that the multiplier can start
+/// one product's next step while the other's waits on its carry.
+/// Each result is reduced as in mont_mul.
+/// Does not use SIMD instructions.
+void mont_mul2(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *cr,
+    BigInt *p,
+    uint64_t n0,
+    BigInt *abr,
+    BigInt *acr
+) {
+    uint64_t t[NUM_LIMBS + 2] = {0};
+    uint64_t u[NUM_LIMBS + 2] = {0};
+    uint128_t r, s;
+    uint64_t c, d;
+
+    // Unrolled so that t and u stay in registers; with twice the work of
+    // mont_mul in the loop body, GCC stops unrolling it by itself.
+    #pragma GCC unroll 4
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t ai = ar->v[i];
+        c = 0;
+        d = 0;
+
+        #pragma GCC unroll 4
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            r = abcd(t[j], ai, br->v[j], c);
+            s = abcd(u[j], ai, cr->v[j], d);
+            c = hi(r);
+            d = hi(s);
+            t[j] = lo(r);
+            u[j] = lo(s);
+        }
+
+        r = add(t[NUM_LIMBS], c);
+        s = add(u[NUM_LIMBS], d);
+        t[NUM_LIMBS] = lo(r);
+        u[NUM_LIMBS] = lo(s);
+        t[NUM_LIMBS + 1] = hi(r);
+        u[NUM_LIMBS + 1] = hi(s);
+
+        uint64_t m = t[0] * n0;
+        uint64_t k = u[0] * n0;
+
+        r = abc(m, p->v[0], t[0]);
+        s = abc(k, p->v[0], u[0]);
+        c = hi(r);
+        d = hi(s);
+
+        #pragma GCC unroll 4
+        for (int j = 1; j < NUM_LIMBS; j ++) {
+            uint64_t pj = p->v[j];
+            r = abcd(t[j], m, pj, c);
+            s = abcd(u[j], k, pj, d);
+            c = hi(r);
+            d = hi(s);
+            t[j - 1] = lo(r);
+            u[j - 1] = lo(s);
+        }
+
+        r = add(t[NUM_LIMBS], c);
+        s = add(u[NUM_LIMBS], d);
+        t[NUM_LIMBS - 1] = lo(r);
+        u[NUM_LIMBS - 1] = lo(s);
+        t[NUM_LIMBS] = t[NUM_LIMBS + 1] + hi(r);
+        u[NUM_LIMBS] = u[NUM_LIMBS + 1] + hi(s);
+    }
+
+    *abr = mont_reduce_final(t, p);
+    *acr = mont_reduce_final(u, p);
+}
+
+#define MONT_MUL_INTERLEAVED_AVAILABLE
+
+/// Computes ways (up to 4) independent products a[k] * b[k] with the CIOS
+/// method of mont_mul, stepping through them in lockstep: each limb step is
+/// issued for every product before the next one, so that while one product
+/// waits on its carry the multiplier works on the others. A single product
+/// is one serial chain of multiply-adds and leaves the multiplier idle for
+/// most of its latency.
+/// ways must be a constant so that the loops over it unroll.
+static inline void mont_mul_interleaved(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *p,
+    uint64_t n0,
+    BigInt *out,
+    const int ways
+) {
+    uint64_t t[4][NUM_LIMBS + 2] = {{0}};
+    uint64_t c[4], m[4];
+    uint128_t r;
+
+    // Unrolled so that every t stays in registers.
+    #pragma GCC unroll 4
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        #pragma GCC unroll 4
+        for (int k = 0; k < ways; k ++) {
+            c[k] = 0;
+        }
+
+        #pragma GCC unroll 4
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            #pragma GCC unroll 4
+            for (int k = 0; k < ways; k ++) {
+                r = abcd(t[k][j], ar[k].v[i], br[k].v[j], c[k]);
+                c[k] = hi(r);
+                t[k][j] = lo(r);
+            }
+        }
+
+        #pragma GCC unroll 4
+        for (int k = 0; k < ways; k ++) {
+            r = add(t[k][NUM_LIMBS], c[k]);
+            t[k][NUM_LIMBS] = lo(r);
+            t[k][NUM_LIMBS + 1] = hi(r);
+
+            m[k] = t[k][0] * n0;
+            r = abc(m[k], p->v[0], t[k][0]);
+            c[k] = hi(r);
+        }
+
+        #pragma GCC unroll 4
+        for (int j = 1; j < NUM_LIMBS; j ++) {
+            #pragma GCC unroll 4
+            for (int k = 0; k < ways; k ++) {
+                r = abcd(t[k][j], m[k], p->v[j], c[k]);
+                c[k] = hi(r);
+                t[k][j - 1] = lo(r);
+            }
+        }
+
+        #pragma GCC unroll 4
+        for (int k = 0; k < ways; k ++) {
+            r = add(t[k][NUM_LIMBS], c[k]);
+            t[k][NUM_LIMBS - 1] = lo(r);
+            t[k][NUM_LIMBS] = t[k][NUM_LIMBS + 1] + hi(r);
+        }
+    }
+
+    for (int k = 0; k < ways; k ++) {
+        out[k] = mont_reduce_final(t[k], p);
+    }
+}
+
+/// out[k] = a[k] * b[k] for k = 0, 1, with the two products interleaved.
+void mont_mul_2way(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0, BigInt *out) {
+    mont_mul_interleaved(ar, br, p, n0, out, 2);
+}
+
+/// out[k] = a[k] * b[k] for k = 0..3, with the four products interleaved.
+void mont_mul_4way(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0, BigInt *out) {
+    mont_mul_interleaved(ar, br, p, n0, out, 4);
+}
+
+#define MONT_SQR_AVAILABLE
+
+/// Montgomery squaring with separated operand scanning (SOS). The off-diagonal
+/// products a[i] * a[j] (i < j) are computed once and doubled, so the
+/// 512-bit square costs 10 multiplications instead of 16, followed by the
+/// usual 16-multiplication Montgomery reduction.
+/// Does not use SIMD instructions.
+BigInt mont_sqr(
+    BigInt *ar,
+    BigInt *p,
+    uint64_t n0
+) {
+    uint64_t t[2 * NUM_LIMBS + 1] = {0};
+    uint128_t r;
+    uint64_t c;
+
+    // Off-diagonal products
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        c = 0;
+        for (int j = i + 1; j < NUM_LIMBS; j ++) {
+            r = abcd(t[i + j], ar->v[i], ar->v[j], c);
+            c = hi(r);
+            t[i + j] = lo(r);
+        }
+        t[i + NUM_LIMBS] = c;
+    }
+
+    // Double them
+    t[2 * NUM_LIMBS] = t[2 * NUM_LIMBS - 1] >> 63;
+    for (int i = 2 * NUM_LIMBS - 1; i > 0; i --) {
+        t[i] = (t[i] << 1) | (t[i - 1] >> 63);
+    }
+    t[0] <<= 1;
+
+    // Add the diagonal products
+    c = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint128_t sq = (uint128_t)ar->v[i] * ar->v[i];
+        r = (uint128_t)t[2 * i] + lo(sq) + c;
+        t[2 * i] = lo(r);
+        r = (uint128_t)t[2 * i + 1] + hi(sq) + hi(r);
+        t[2 * i + 1] = lo(r);
+        c = hi(r);
+    }
+    t[2 * NUM_LIMBS] += c;
+
+    // Montgomery reduction
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t m = t[i] * n0;
+        c = 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            r = abcd(t[i + j], m, p->v[j], c);
+            c = hi(r);
+            t[i + j] = lo(r);
+        }
+        for (int j = i + NUM_LIMBS; j < 2 * NUM_LIMBS + 1 && c != 0; j ++) {
+            r = add(t[j], c);
+            t[j] = lo(r);
+            c = hi(r);
+        }
+    }
+
+    // The result is t[NUM_LIMBS..2 * NUM_LIMBS], which is less than 2p.
+    uint64_t *u = &t[NUM_LIMBS];
+    bool u_ge_p = u[NUM_LIMBS] != 0;
+    if (!u_ge_p) {
+        u_ge_p = true;
+        for (int i = NUM_LIMBS - 1; i >= 0; i --) {
+            if (u[i] != p->v[i]) {
+                u_ge_p = u[i] > p->v[i];
+                break;
+            }
+        }
+    }
+
+    BigInt res = bigint_new();
+    uint64_t borrow = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        if (u_ge_p) {
+            res.v[i] = u[i] - p->v[i] - borrow;
+            borrow = (u[i] < (p->v[i] + borrow)) || (p->v[i] + borrow < borrow) ? 1 : 0;
+        } else {
+            res.v[i] = u[i];
+        }
+    }
+    return res;
+}
+
+#define MONT_SUM_OF_PRODUCTS_AVAILABLE
+
+/// Returns the sum of a[i] * b[i] for i < k, in the Montgomery domain, with
+/// one Montgomery reduction instead of k. Each 512-bit product is added into
+/// a 512-bit accumulator with an extra word for the carries out of the top,
+/// and the sum is reduced once at the end. The reduction leaves a value less
+/// than (1 + k * p / R) * p, which is brought below p by subtracting p. For
+/// BN254, p < R / 5, so that is at most four subtractions for k = 16.
+/// Inputs may be anywhere in [0, p]; the result is in [0, p).
+/// Does not use SIMD instructions.
+BigInt mont_sum_of_products(
+    BigInt *a,
+    BigInt *b,
+    int k,
+    BigInt *p,
+    uint64_t n0
+) {
+    uint64_t t[2 * NUM_LIMBS + 1] = {0};
+    uint128_t r;
+    uint64_t c;
+
+    for (int s = 0; s < k; s ++) {
+        // The 512-bit product a[s] * b[s]
+        uint64_t prod[2 * NUM_LIMBS];
+        for (int i = 0; i < NUM_LIMBS; i ++) {
+            c = 0;
+            for (int j = 0; j < NUM_LIMBS; j ++) {
+                r = abcd(i == 0 ? 0 : prod[i + j], a[s].v[i], b[s].v[j], c);
+                c = hi(r);
+                prod[i + j] = lo(r);
+            }
+            prod[i + NUM_LIMBS] = c;
+        }
+
+        // Accumulate it
+        c = 0;
+        for (int i = 0; i < 2 * NUM_LIMBS; i ++) {
+            r = (uint128_t)t[i] + prod[i] + c;
+            t[i] = lo(r);
+            c = hi(r);
+        }
+        t[2 * NUM_LIMBS] += c;
+    }
+
+    // Montgomery reduction
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t m = t[i] * n0;
+        c = 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            r = abcd(t[i + j], m, p->v[j], c);
+            c = hi(r);
+            t[i + j] = lo(r);
+        }
+        for (int j = i + NUM_LIMBS; j < 2 * NUM_LIMBS + 1 && c != 0; j ++) {
+            r = add(t[j], c);
+            t[j] = lo(r);
+            c = hi(r);
+        }
+    }
+
+    // The result is t[NUM_LIMBS..2 * NUM_LIMBS]. Subtract p until it is less
+    // than p.
+    uint64_t *u = &t[NUM_LIMBS];
+    for (;;) {
+        bool u_ge_p = u[NUM_LIMBS] != 0;
+        if (!u_ge_p) {
+            u_ge_p = true;
+            for (int i = NUM_LIMBS - 1; i >= 0; i --) {
+                if (u[i] != p->v[i]) {
+                    u_ge_p = u[i] > p->v[i];
+                    break;
+                }
+            }
+        }
+        if (!u_ge_p) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (int i = 0; i < NUM_LIMBS; i ++) {
+            uint64_t ui = u[i];
+            u[i] = ui - p->v[i] - borrow;
+            borrow = (ui < p->v[i]) | ((ui == p->v[i]) & borrow);
+        }
+        u[NUM_LIMBS] -= borrow;
+    }
+
+    BigInt res = bigint_new();
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        res.v[i] = u[i];
+    }
+    return res;
+}
@@ -0,0 +1,45 @@
+#include <stdint.h>
+#include "chain.h"
+
+// Fixed-exponent exponentiation with precomputed addition chains.
+// The chains themselves are generated by c/addchain/gen_addchain.js.
+//
+// Works with any kernel that provides
+// BigInt mont_mul(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0).
+// Squarings use the kernel's dedicated mont_sqr if it defines
+// MONT_SQR_AVAILABLE.
+
+/// Computes xr^e, where xr is in Montgomery form and e is the exponent that
+/// the chain was generated for. The result is also in Montgomery form.
+BigInt mont_pow_addchain(
+    BigInt *xr,
+    const AddChain *chain,
+    BigInt *p,
+    uint64_t n0
+) {
+    BigInt table[ADDCHAIN_MAX_TABLE_SIZE];
+
+    // Odd powers x, x^3, x^5, ...
+    table[0] = *xr;
+    if (chain->table_size > 1) {
+        BigInt x2 = mont_mul(xr, xr, p, n0);
+        for (int i = 1; i < chain->table_size; i ++) {
+            table[i] = mont_mul(&table[i - 1], &x2, p, n0);
+        }
+    }
+
+    BigInt z = table[chain->steps[0].idx];
+    for (int s = 1; s < chain->num_steps; s ++) {
+        for (int i = 0; i < chain->steps[s].num_sqr; i ++) {
+#ifdef MONT_SQR_AVAILABLE
+            z = mont_sqr(&z, p, n0);
+#else
+            z = mont_mul(&z, &z, p, n0);
+#endif
+        }
+        if (chain->steps[s].idx != ADDCHAIN_NO_MUL) {
+            z = mont_mul(&z, &table[chain->steps[s].idx], p, n0);
+        }
+    }
+    return z;
+}
@@ -0,0 +1,56 @@
+// Generated using c/addchain/gen_addchain.js. Do not edit.
+//
+// Include c/addchain/addchain.h before this file.
+
+// e = p - 2, for inversion by Fermat's little theorem.
+// Window size 4: 253 squarings and 56 multiplications.
+static const AddChainStep BN254_SCALAR_INV_CHAIN_STEPS[] = {
+    {0, 1}, {7, 1}, {3, 0}, {7, 4}, {2, 1}, {5, 3}, {6, 5}, {1, 0},
+    {8, 4}, {1, 0}, {7, 6}, {10, 2}, {6, 6}, {2, 1}, {7, 2}, {6, 0},
+    {7, 5}, {5, 6}, {3, 2}, {8, 1}, {9, 2}, {3, 1}, {8, 5}, {3, 2},
+    {5, 2}, {7, 1}, {6, 7}, {3, 2}, {8, 4}, {8, 7}, {6, 6}, {2, 1},
+    {6, 5}, {1, 0}, {8, 4}, {6, 2}, {8, 7}, {1, 0}, {8, 7}, {3, 2},
+    {3, 1}, {6, 4}, {4, 7}, {5, 7}, {4, 7}, {4, 7}, {4, 7}, {4, 7},
+    {4, 7}, {4, 7},
+};
+
+static const AddChain BN254_SCALAR_INV_CHAIN = {
+    8,
+    50,
+    BN254_SCALAR_INV_CHAIN_STEPS
+};
+
+// e = (p - 1) / 2, for Euler's criterion: x^e is 1 for non-zero squares, -1 otherwise.
+// Window size 4: 252 squarings and 50 multiplications.
+static const AddChainStep BN254_SCALAR_LEGENDRE_CHAIN_STEPS[] = {
+    {0, 1}, {7, 1}, {3, 0}, {7, 4}, {2, 1}, {5, 3}, {6, 5}, {1, 0},
+    {8, 4}, {1, 0}, {7, 6}, {10, 2}, {6, 6}, {2, 1}, {7, 2}, {6, 0},
+    {7, 5}, {5, 6}, {3, 2}, {8, 1}, {9, 2}, {3, 1}, {8, 5}, {3, 2},
+    {5, 2}, {7, 1}, {6, 7}, {3, 2}, {8, 4}, {8, 7}, {6, 6}, {2, 1},
+    {6, 5}, {1, 0}, {8, 4}, {6, 2}, {8, 7}, {1, 0}, {8, 7}, {3, 2},
+    {3, 1}, {6, 4}, {4, 7}, {1, 0}, {27, ADDCHAIN_NO_MUL},
+};
+
+static const AddChain BN254_SCALAR_LEGENDRE_CHAIN = {
+    8,
+    45,
+    BN254_SCALAR_LEGENDRE_CHAIN_STEPS
+};
+
+// e = (t - 1) / 2, where p - 1 = 2^28 * t, for Tonelli-Shanks square roots.
+// Window size 4: 224 squarings and 49 multiplications.
+static const AddChainStep BN254_SCALAR_SQRT_CHAIN_STEPS[] = {
+    {0, 1}, {7, 1}, {3, 0}, {7, 4}, {2, 1}, {5, 3}, {6, 5}, {1, 0},
+    {8, 4}, {1, 0}, {7, 6}, {10, 2}, {6, 6}, {2, 1}, {7, 2}, {6, 0},
+    {7, 5}, {5, 6}, {3, 2}, {8, 1}, {9, 2}, {3, 1}, {8, 5}, {3, 2},
+    {5, 2}, {7, 1}, {6, 7}, {3, 2}, {8, 4}, {8, 7}, {6, 6}, {2, 1},
+    {6, 5}, {1, 0}, {8, 4}, {6, 2}, {8, 7}, {1, 0}, {8, 7}, {3, 2},
+    {3, 1}, {6, 4}, {4, 7},
+};
+
+static const AddChain BN254_SCALAR_SQRT_CHAIN = {
+    8,
+    43,
+    BN254_SCALAR_SQRT_CHAIN_STEPS
+};
+
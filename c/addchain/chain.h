@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+
+// The addition chain format shared by c/addchain/addchain.h and the
+// multi-buffer kernels in c/multibuf. Chains for fixed exponents are
+// generated ahead of time by c/addchain/gen_addchain.js; addchain_sliding
+// builds the same kind of chain at runtime.
+
+#define ADDCHAIN_NO_MUL 0xff
+#define ADDCHAIN_MAX_TABLE_SIZE 64
+
+// Square num_sqr times, then multiply by the odd power x^(2 * idx + 1), unless
+// idx is ADDCHAIN_NO_MUL.
+typedef struct {
+    uint16_t num_sqr;
+    uint8_t idx;
+} AddChainStep;
+
+// table_size is the number of odd powers x, x^3, ... the steps refer to.
+// The first step only selects the starting value from the table.
+typedef struct {
+    int table_size;
+    int num_steps;
+    const AddChainStep *steps;
+} AddChain;
+
+// An upper bound on the number of steps addchain_sliding emits for any
+// exponent that fits in a BigInt: one per window plus a trailing squaring step.
+#define ADDCHAIN_MAX_STEPS (NUM_LIMBS * BITS_PER_LIMB + 1)
+
+static inline uint32_t addchain_bit(const BigInt *e, int i) {
+    if (i < 0) {
+        return 0;
+    }
+    return (e->v[i / BITS_PER_LIMB] >> (i % BITS_PER_LIMB)) & 1;
+}
+
+/// Builds a sliding-window chain for e with windows of at most w bits, and
+/// writes its steps to steps, which must hold ADDCHAIN_MAX_STEPS entries.
+/// This is the runtime equivalent of slidingWindow() in gen_addchain.js.
+///
+/// Returns 0 on success, or -1 if e is zero (which has no chain) or w is out of
+/// range.
+int addchain_sliding(
+    const BigInt *e,
+    int w,
+    AddChainStep *steps,
+    AddChain *chain
+) {
+    if (w < 1 || (1 << (w - 1)) > ADDCHAIN_MAX_TABLE_SIZE) {
+        return -1;
+    }
+
+    int i = NUM_LIMBS * BITS_PER_LIMB - 1;
+    while (i >= 0 && addchain_bit(e, i) == 0) {
+        i --;
+    }
+    if (i < 0) {
+        return -1;
+    }
+
+    int num_steps = 0;
+    int pending_sqr = 0;
+    int max_idx = 0;
+    while (i >= 0) {
+        if (addchain_bit(e, i) == 0) {
+            pending_sqr ++;
+            i --;
+            continue;
+        }
+
+        // The longest window of at most w bits that ends with a 1
+        int l = i + 1 < w ? i + 1 : w;
+        while (addchain_bit(e, i - l + 1) == 0) {
+            l --;
+        }
+        uint32_t window = 0;
+        for (int j = i; j > i - l; j --) {
+            window = (window << 1) | addchain_bit(e, j);
+        }
+
+        steps[num_steps].num_sqr = num_steps == 0 ? 0 : pending_sqr + l;
+        steps[num_steps].idx = window >> 1;
+        if ((int)(window >> 1) > max_idx) {
+            max_idx = window >> 1;
+        }
+        num_steps ++;
+        pending_sqr = 0;
+        i -= l;
+    }
+    if (pending_sqr > 0) {
+        steps[num_steps].num_sqr = pending_sqr;
+        steps[num_steps].idx = ADDCHAIN_NO_MUL;
+        num_steps ++;
+    }
+
+    chain->table_size = max_idx + 1;
+    chain->num_steps = num_steps;
+    chain->steps = steps;
+    return 0;
+}
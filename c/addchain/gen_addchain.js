@@ -0,0 +1,130 @@
+// Generates addition chains for fixed exponents over the BN254 scalar field.
+//
+// Usage: node c/addchain/gen_addchain.js > c/addchain/bn254_scalar.h
+//
+// Each chain is a sliding-window chain: a table of odd powers x, x^3, x^5, ...
+// followed by steps of (number of squarings, table index). The window size is
+// chosen per exponent to minimise the total number of multiplications, and
+// the table only holds the odd powers that the chain actually uses.
+
+const p = BigInt('0x30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000001');
+
+const NO_MUL = 0xff;
+
+// p - 1 = 2^s * t, with t odd
+const s = 28n;
+const t = (p - 1n) >> s;
+
+const chains = [
+    {
+        name: 'BN254_SCALAR_INV_CHAIN',
+        description: 'e = p - 2, for inversion by Fermat\'s little theorem',
+        exponent: p - 2n,
+    },
+    {
+        name: 'BN254_SCALAR_LEGENDRE_CHAIN',
+        description: 'e = (p - 1) / 2, for Euler\'s criterion: x^e is 1 for non-zero squares, -1 otherwise',
+        exponent: (p - 1n) / 2n,
+    },
+    {
+        name: 'BN254_SCALAR_SQRT_CHAIN',
+        description: 'e = (t - 1) / 2, where p - 1 = 2^28 * t, for Tonelli-Shanks square roots',
+        exponent: (t - 1n) / 2n,
+    },
+];
+
+function bitAt(e, i) {
+    return (e >> BigInt(i)) & 1n;
+}
+
+// Returns the steps of a sliding-window chain for e with window size k.
+function slidingWindow(e, k) {
+    const steps = [];
+    let i = e.toString(2).length - 1;
+    let pendingSqr = 0;
+    let first = true;
+
+    while (i >= 0) {
+        if (bitAt(e, i) === 0n) {
+            pendingSqr ++;
+            i --;
+            continue;
+        }
+        let l = Math.min(k, i + 1);
+        while (bitAt(e, i - l + 1) === 0n) {
+            l --;
+        }
+        const window = Number((e >> BigInt(i - l + 1)) & ((1n << BigInt(l)) - 1n));
+        const idx = (window - 1) / 2;
+        if (first) {
+            steps.push([0, idx]);
+            first = false;
+        } else {
+            steps.push([pendingSqr + l, idx]);
+        }
+        pendingSqr = 0;
+        i -= l;
+    }
+    if (pendingSqr > 0) {
+        steps.push([pendingSqr, NO_MUL]);
+    }
+    return steps;
+}
+
+// Returns the number of squarings and multiplications used by a chain,
+// including the odd-power table.
+function cost(steps) {
+    const tableSize = 1 + Math.max(...steps.filter(s => s[1] !== NO_MUL).map(s => s[1]));
+    let sqr = tableSize > 1 ? 1 : 0;
+    let mul = tableSize - 1;
+    for (let s = 1; s < steps.length; s ++) {
+        sqr += steps[s][0];
+        if (steps[s][1] !== NO_MUL) {
+            mul ++;
+        }
+    }
+    return { tableSize, sqr, mul };
+}
+
+function best(e) {
+    let result = null;
+    for (let k = 1; k <= 7; k ++) {
+        const steps = slidingWindow(e, k);
+        const c = cost(steps);
+        if (result === null || c.sqr + c.mul < result.cost.sqr + result.cost.mul) {
+            result = { k, steps, cost: c };
+        }
+    }
+    return result;
+}
+
+function main() {
+    console.log(`// Generated using c/addchain/gen_addchain.js. Do not edit.
+//
+// Include c/addchain/addchain.h before this file.
+`);
+
+    for (const chain of chains) {
+        const { k, steps, cost } = best(chain.exponent);
+        const body = steps.map(s => `{${s[0]}, ${s[1] === NO_MUL ? 'ADDCHAIN_NO_MUL' : s[1]}}`);
+        const lines = [];
+        for (let i = 0; i < body.length; i += 8) {
+            lines.push('    ' + body.slice(i, i + 8).join(', ') + ',');
+        }
+
+        console.log(`// ${chain.description}.
+// Window size ${k}: ${cost.sqr} squarings and ${cost.mul} multiplications.
+static const AddChainStep ${chain.name}_STEPS[] = {
+${lines.join('\n')}
+};
+
+static const AddChain ${chain.name} = {
+    ${cost.tableSize},
+    ${steps.length},
+    ${chain.name}_STEPS
+};
+`);
+    }
+}
+
+main();
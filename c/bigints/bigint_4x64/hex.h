@@ -5,20 +5,31 @@
 #include <string.h>
 
 /*
- * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * Write a BigInt to out as a 64-character big-endian hexadecimal string, with
+ * a null terminator, and return out. out must have room for 65 characters.
+ * Reentrant, unlike bigint_to_hex.
  */
-char* bigint_to_hex(const BigInt *val) {
-    static char hex_str[65];  // static buffer
-
-    hex_str[64] = '\0';
-    char *ptr = hex_str;
+char* bigint_to_hex_r(const BigInt *val, char *out) {
+    static const char digits[] = "0123456789abcdef";
     // Process limbs in reverse order (most significant first)
-    for (int i = NUM_LIMBS - 1; i >= 0; i--) {
-        sprintf(ptr, "%016" PRIx64, val->v[i]); // Uppercase hex with padding
-        ptr += 16;
+    for (int i = 0; i < NUM_LIMBS; i++) {
+        uint64_t limb = val->v[NUM_LIMBS - 1 - i];
+        for (int j = 0; j < 16; j++) {
+            out[i * 16 + j] = digits[(limb >> (60 - 4 * j)) & 0xf];
+        }
     }
+    out[64] = '\0';
+    return out;
+}
 
-    return hex_str;
+/*
+ * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * The string lives in a static buffer, so this is not thread-safe; use bigint_to_hex_r from
+ * worker threads.
+ */
+char* bigint_to_hex(const BigInt *val) {
+    static char hex_str[65];  // static buffer
+    return bigint_to_hex_r(val, hex_str);
 }
 
 /*
@@ -2,9 +2,11 @@
 #include <inttypes.h>
 
 /*
- * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * Write a BigInt to out as a 64-character big-endian hexadecimal string, with
+ * a null terminator, and return out. out must have room for 65 characters.
+ * Reentrant, unlike bigint_to_hex.
  */
-char *bigint_to_hex(BigInt *bigint) {
+char *bigint_to_hex_r(const BigInt *bigint, char *out) {
     // We’ll build a 256-bit number in four 64-bit words.
     // words[0] is the least-significant 64 bits.
     uint64_t words[4] = {0, 0, 0, 0};
@@ -27,15 +29,27 @@ char *bigint_to_hex(BigInt *bigint) {
     }
     
     // Now convert the 256-bit integer (in little-endian words) into a 64-digit hexadecimal string.
-    // The hex string is in big-endian order, so we print the most significant word first.
-    // We use a static buffer (not thread-safe) of 65 bytes (64 hex digits plus null terminator).
-    static char hex_str[65];
-    sprintf(hex_str, "%016" PRIx64 "%016" PRIx64 "%016" PRIx64 "%016" PRIx64,
-            words[3], words[2], words[1], words[0]);
+    // The hex string is in big-endian order, so we write the most significant word first.
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 0; i < 4; i++) {
+        uint64_t word = words[3 - i];
+        for (int j = 0; j < 16; j++) {
+            out[i * 16 + j] = digits[(word >> (60 - 4 * j)) & 0xf];
+        }
+    }
     // Make sure the string is null terminated.
-    hex_str[64] = '\0';
+    out[64] = '\0';
     
-    return hex_str;
+    return out;
+}
+
+/*
+ * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * We use a static buffer (not thread-safe); use bigint_to_hex_r from worker threads.
+ */
+char *bigint_to_hex(BigInt *bigint) {
+    static char hex_str[65];
+    return bigint_to_hex_r(bigint, hex_str);
 }
 
 /*
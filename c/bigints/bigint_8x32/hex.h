@@ -1,19 +1,30 @@
 #include <string.h>
 
 /*
- * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * Write a BigInt to out as a 64-character big-endian hexadecimal string, with
+ * a null terminator, and return out. out must have room for 65 characters.
+ * Reentrant, unlike bigint_to_hex.
  */
-char* bigint_to_hex(const BigInt *val) {
-    static char hex_str[65];  // static buffer
-
-    long long mask = 0xFFFFFFFFULL;
+char* bigint_to_hex_r(const BigInt *val, char *out) {
+    static const char digits[] = "0123456789abcdef";
     for (int i = 0; i < NUM_LIMBS; i++) {
-        uint32_t limb = (uint32_t)(val->v[NUM_LIMBS - 1 - i] & mask);
-        sprintf(hex_str + i * NUM_LIMBS, "%08x", limb);
+        uint32_t limb = (uint32_t)val->v[NUM_LIMBS - 1 - i];
+        for (int j = 0; j < 8; j++) {
+            out[i * 8 + j] = digits[(limb >> (28 - 4 * j)) & 0xf];
+        }
     }
+    out[64] = '\0';
+    return out;
+}
 
-    hex_str[64] = '\0';
-    return hex_str;
+/*
+ * Convert a BigInt to a 65-character big-endian hexadecimal string, with a null terminator.
+ * The string lives in a static buffer, so this is not thread-safe; use bigint_to_hex_r from
+ * worker threads.
+ */
+char* bigint_to_hex(const BigInt *val) {
+    static char hex_str[65];  // static buffer
+    return bigint_to_hex_r(val, hex_str);
 }
 
 // Helper function to convert 8 hex characters to a uint32_t
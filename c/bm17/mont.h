@@ -1,25 +1,24 @@
+#include <stddef.h>
 #include "../simd/simd.h"
 
-void mont_mul_no_reduce(
+// The inner loops of mont_mul_no_reduce, given the multiplicand's (b[i], p[i])
+// lane pairs and mu * b[0].
+static inline void mont_mul_no_reduce_bp(
     BigInt *ar,
-    BigInt *br,
-    BigInt *p,
-    uint64_t mu,
+    i64 bp[NUM_LIMBS],
+    uint32_t mu_b0,
+    uint32_t mu_32,
     BigInt *d,
     BigInt *e
-) { 
+) {
     uint32_t q;
-    uint32_t mu_32 = (uint32_t) mu;
-    uint32_t mu_b0 = mu_32 * (uint32_t) br->v[0];
     i64 aq;
-    i64 bp[NUM_LIMBS];
     i128 de[NUM_LIMBS];
     i128 t01, p01, t01de;
     i128 mask = i64x2_make(LIMB_MASK, LIMB_MASK);
 
     for (int i = 0; i < NUM_LIMBS; i ++) {
         de[i] = i128_zero();
-        bp[i] = i32x2_make(br->v[i], p->v[i]);
     }
 
     for (int j = 0; j < NUM_LIMBS; j ++) {
@@ -44,6 +43,38 @@ void mont_mul_no_reduce(
     }
 }
 
+void mont_mul_no_reduce(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *p,
+    uint64_t mu,
+    BigInt *d,
+    BigInt *e
+) { 
+    uint32_t mu_32 = (uint32_t) mu;
+    uint32_t mu_b0 = mu_32 * (uint32_t) br->v[0];
+    i64 bp[NUM_LIMBS];
+
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        bp[i] = i32x2_make(br->v[i], p->v[i]);
+    }
+
+    mont_mul_no_reduce_bp(ar, bp, mu_b0, mu_32, d, e);
+}
+
+// C = D - E, plus p if it is negative.
+static inline BigInt mont_mul_final(BigInt *d, BigInt *e, BigInt *p) {
+    BigInt result = bigint_new();
+    if (bigint_gt(e, d)) {
+        BigInt e_minus_d = bigint_sub(e, d);
+        result = bigint_sub(p, &e_minus_d);
+    } else {
+        result = bigint_sub(d, e);
+    }
+
+    return result;
+}
+
 /// Algorithm 4 of "Montgomery Arithmetic from a Software Perspective" by Bos and Montgomery
 /// Uses SIMD opcodes.
 /// Also see:
@@ -85,13 +116,107 @@ BigInt mont_mul(
     BigInt e = bigint_new();
     mont_mul_no_reduce(ar, br, p, mu, &d, &e);
 
-    BigInt result = bigint_new();
-    if (bigint_gt(&e, &d)) {
-        BigInt e_minus_d = bigint_sub(&e, &d);
-        result = bigint_sub(p, &e_minus_d);
-    } else {
-        result = bigint_sub(&d, &e);
+    return mont_mul_final(&d, &e, p);
+}
+
+#define MONT_MUL_PREPARED_AVAILABLE
+
+// A multiplicand prepared by mont_prepare for repeated multiplication, for
+// NTT twiddles, MDS constants or scaling a vector by a challenge. It holds
+// the (b[i], p[i]) lane pairs that mont_mul otherwise builds on every call,
+// and the quotient term mu * b[0].
+typedef struct {
+    i64 bp[NUM_LIMBS];
+    uint32_t mu_b0;
+    uint32_t mu;
+    BigInt p;
+} MontPrepared;
+
+void mont_prepare(MontPrepared *prep, BigInt *br, BigInt *p, uint64_t mu) {
+    prep->mu = (uint32_t) mu;
+    prep->mu_b0 = prep->mu * (uint32_t) br->v[0];
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        prep->bp[i] = i32x2_make(br->v[i], p->v[i]);
+    }
+    prep->p = *p;
+}
+
+// mont_mul(ar, br, p, mu) for the br and p that prep was prepared with.
+static inline BigInt mont_mul_prepared(BigInt *ar, MontPrepared *prep) {
+    BigInt d, e;
+    mont_mul_no_reduce_bp(ar, prep->bp, prep->mu_b0, prep->mu, &d, &e);
+    return mont_mul_final(&d, &e, &prep->p);
+}
+
+// Sets out[i] = in[i] * b for i < n, where prep holds b. out may be in.
+void mont_scale_vector(BigInt *out, BigInt *in, MontPrepared *prep, size_t n) {
+    for (size_t i = 0; i < n; i ++) {
+        out[i] = mont_mul_prepared(&in[i], prep);
     }
+}
 
-    return result;
+#define MONT_MUL2_AVAILABLE
+
+/// Computes a * b and a * c together. BM17 spends the two lanes of each
+/// vmlal_u32 on a[j] * b[i] and q * p[i]; here one vmlal_u32 multiplies a[j]
+/// by (b[i], c[i]) and another multiplies (q_b, q_c) by p[i]. The D and E
+/// accumulators of both products are thus each one vector, and the two
+/// vmlal_u32 chains are independent, so they can issue back to back. Each
+/// product goes through exactly the same steps as in mont_mul.
+void mont_mul2(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *cr,
+    BigInt *p,
+    uint64_t mu,
+    BigInt *abr,
+    BigInt *acr
+) {
+    uint32_t mu_32 = (uint32_t) mu;
+    uint32_t mu_b0 = mu_32 * (uint32_t) br->v[0];
+    uint32_t mu_c0 = mu_32 * (uint32_t) cr->v[0];
+    i64 bc[NUM_LIMBS];
+    i64 pp[NUM_LIMBS];
+    // Lane 0 belongs to a * b and lane 1 to a * c.
+    i128 d[NUM_LIMBS], e[NUM_LIMBS];
+    i128 td, te, pd, pe;
+    i128 mask = i64x2_make(LIMB_MASK, LIMB_MASK);
+
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        d[i] = i128_zero();
+        e[i] = i128_zero();
+        bc[i] = i32x2_make(br->v[i], cr->v[i]);
+        pp[i] = i32x2_splat(p->v[i]);
+    }
+
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        uint32_t a_j = (uint32_t) ar->v[j];
+        uint32_t q_b = mu_b0 * a_j + mu_32 * (uint32_t) (i64x2_extract_h(d[0]) - i64x2_extract_h(e[0]));
+        uint32_t q_c = mu_c0 * a_j + mu_32 * (uint32_t) (i64x2_extract_l(d[0]) - i64x2_extract_l(e[0]));
+        i64 aa = i32x2_splat(a_j);
+        i64 qq = i32x2_make(q_b, q_c);
+        td = u64x2_shr(madd(d[0], aa, bc[0]), 32);
+        te = u64x2_shr(madd(e[0], qq, pp[0]), 32);
+
+        for (int i = 1; i < NUM_LIMBS; i ++) {
+            pd = madd(i64x2_add(td, d[i]), aa, bc[i]);
+            pe = madd(i64x2_add(te, e[i]), qq, pp[i]);
+            td = u64x2_shr(pd, 32);
+            te = u64x2_shr(pe, 32);
+            d[i - 1] = i128_and(pd, mask);
+            e[i - 1] = i128_and(pe, mask);
+        }
+        d[NUM_LIMBS - 1] = td;
+        e[NUM_LIMBS - 1] = te;
+    }
+
+    BigInt d_b, e_b, d_c, e_c;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        d_b.v[i] = i64x2_extract_h(d[i]);
+        e_b.v[i] = i64x2_extract_h(e[i]);
+        d_c.v[i] = i64x2_extract_l(d[i]);
+        e_c.v[i] = i64x2_extract_l(e[i]);
+    }
+    *abr = mont_mul_final(&d_b, &e_b, p);
+    *acr = mont_mul_final(&d_c, &e_c, p);
 }
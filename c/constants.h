@@ -3,3 +3,11 @@
 #define BN254_SCALAR_N0_8x32 4026531839
 #define BN254_SCALAR_N0_4x64 0xc2e1f593efffffff
 #define BN254_SCALAR_BM17_MU_4x64 268435457
+
+// R mod p and R^2 mod p, where R = 2^256. R mod p is 1 in Montgomery form.
+#define BN254_SCALAR_R_HEX "0e0a77c19a07df2f666ea36f7879462e36fc76959f60cd29ac96341c4ffffffb"
+#define BN254_SCALAR_R2_HEX "0216d0b17f4e44a58c49833d53bb808553fe3ab1e35c59e31bb8e645ae216da7"
+
+// p - 1 = 2^28 * t with t odd, and 5^t, a primitive 2^28-th root of unity.
+#define BN254_SCALAR_TWO_ADICITY 28
+#define BN254_SCALAR_ROOT_OF_UNITY_HEX "2a3c09f0a58a7e8500e0a7eb8ef62abc402d111e41112ed49bd61b6e725b19f0"
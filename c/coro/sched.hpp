@@ -0,0 +1,228 @@
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+
+// Software pipelining of many small, independent field computations with
+// C++20 coroutines. Each computation (one leaf hash, one point formula) is
+// written as straight-line code in a FieldTask coroutine, and every
+// multiplication is a co_await on the scheduler:
+//
+//     FieldTask sbox(FieldScheduler &s, BigInt *x) {
+//         BigInt x2 = co_await s.sqr(*x);
+//         BigInt x4 = co_await s.sqr(x2);
+//         *x = co_await s.mul(x4, *x);
+//     }
+//
+// A task suspends at each multiplication. Once every task has run up to its
+// next one, the scheduler issues all of the pending multiplications together,
+// FIELD_SCHED_LANES at a time, through the widest kernel available: the
+// vertical NEON kernel if c/multibuf/mont_x4.h has been included (8x32 limbs
+// only), or the interleaved scalar kernels of the 64-bit Acar, BH23 and Domb
+// kernels. It then resumes the tasks with their results. N tasks thus fill
+// the lanes that one dependency chain alone would leave idle.
+//
+// Additions and subtractions are cheap enough to call directly (field_add,
+// field_sub). A task may co_await another FieldTask, which runs as part of
+// it. Results are passed back through pointers, as in the C code.
+//
+// Everything runs on the calling thread. Include c/field.h and a Montgomery
+// multiplication kernel before this file. All field elements are in
+// Montgomery form. Compile with -std=c++20.
+
+#define FIELD_SCHED_LANES 4
+
+class FieldScheduler;
+
+// A coroutine that computes over a FieldScheduler. It starts suspended and
+// runs when spawned on a scheduler, or when another task awaits it.
+class FieldTask {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+
+        FieldTask get_return_object() {
+            return FieldTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Resumes the awaiting task, if any, without growing the stack.
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit FieldTask(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    FieldTask(FieldTask &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    FieldTask &operator=(FieldTask &&other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    FieldTask(const FieldTask &) = delete;
+    FieldTask &operator=(const FieldTask &) = delete;
+    ~FieldTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+    // Awaiting a task runs it until it finishes, then resumes the awaiter.
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    friend class FieldScheduler;
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// A multiplication waiting in the scheduler. It lives in the suspended
+// task's frame, so the scheduler keeps only a pointer to it.
+struct FieldMulOp {
+    FieldScheduler *sched;
+    BigInt a;
+    BigInt b;
+    BigInt out;
+    std::coroutine_handle<> waiter;
+
+    bool await_ready() const noexcept { return false; }
+    inline void await_suspend(std::coroutine_handle<> h);
+    BigInt await_resume() const noexcept { return out; }
+};
+
+class FieldScheduler {
+public:
+    explicit FieldScheduler(MontField *f) : f_(f) {
+#ifdef MONT_MUL_X4_AVAILABLE
+        p_x4_ = bigint_x4_splat(&f->p);
+        n0_x4_ = field_redc_n0(f);
+#endif
+    }
+
+    MontField *field() const { return f_; }
+
+    // The product a * b, to be awaited in a task.
+    FieldMulOp mul(const BigInt &a, const BigInt &b) {
+        return FieldMulOp{this, a, b, BigInt(), nullptr};
+    }
+
+    FieldMulOp sqr(const BigInt &a) {
+        return mul(a, a);
+    }
+
+    // Adds a task, which starts at the next call to run.
+    void spawn(FieldTask task) {
+        ready_.push_back(task.handle_);
+        tasks_.push_back(std::move(task));
+    }
+
+    // Runs every spawned task to completion, then destroys them.
+    void run() {
+        while (!ready_.empty()) {
+            resuming_.swap(ready_);
+            for (std::coroutine_handle<> h : resuming_) {
+                h.resume();
+            }
+            resuming_.clear();
+            flush();
+        }
+        tasks_.clear();
+    }
+
+    /*
+     * out[i] = a[i] * b[i] for i < n, FIELD_SCHED_LANES products at a time
+     * with the widest kernel available. This is what the scheduler issues
+     * for each round of pending multiplications, and is also the kernel to
+     * batch by hand with.
+     */
+    void mul_batch(const BigInt *a, const BigInt *b, BigInt *out, size_t n) {
+        size_t i = 0;
+#if defined(MONT_MUL_X4_AVAILABLE)
+        for (; i < n / 4 * 4; i += 4) {
+            BigIntX4 ar = bigint_x4_pack((BigInt *)&a[i]);
+            BigIntX4 br = bigint_x4_pack((BigInt *)&b[i]);
+            BigIntX4 res = mont_mul_x4(&ar, &br, &p_x4_, n0_x4_);
+            bigint_x4_unpack(&res, &out[i]);
+        }
+#elif defined(MONT_MUL_INTERLEAVED_AVAILABLE)
+        for (; i < n / 4 * 4; i += 4) {
+            mont_mul_4way((BigInt *)&a[i], (BigInt *)&b[i], &f_->p, f_->n0, &out[i]);
+        }
+        for (; i < n / 2 * 2; i += 2) {
+            mont_mul_2way((BigInt *)&a[i], (BigInt *)&b[i], &f_->p, f_->n0, &out[i]);
+        }
+#endif
+        for (; i < n; i ++) {
+            out[i] = field_mul((BigInt *)&a[i], (BigInt *)&b[i], f_);
+        }
+    }
+
+    // Statistics
+    uint64_t rounds = 0; // Times the pending multiplications were issued
+    uint64_t muls = 0;   // Multiplications issued
+
+private:
+    friend struct FieldMulOp;
+
+    // Issues every pending multiplication and queues its task to resume.
+    void flush() {
+        size_t n = pending_.size();
+        if (n == 0) {
+            return;
+        }
+        rounds ++;
+        muls += n;
+        a_.resize(n);
+        b_.resize(n);
+        out_.resize(n);
+        for (size_t i = 0; i < n; i ++) {
+            a_[i] = pending_[i]->a;
+            b_[i] = pending_[i]->b;
+        }
+        mul_batch(a_.data(), b_.data(), out_.data(), n);
+        for (size_t i = 0; i < n; i ++) {
+            pending_[i]->out = out_[i];
+            ready_.push_back(pending_[i]->waiter);
+        }
+        pending_.clear();
+    }
+
+    MontField *f_;
+#ifdef MONT_MUL_X4_AVAILABLE
+    BigIntX4 p_x4_;
+    uint64_t n0_x4_;
+#endif
+    std::vector<FieldTask> tasks_;
+    std::vector<std::coroutine_handle<>> ready_;
+    std::vector<std::coroutine_handle<>> resuming_;
+    std::vector<FieldMulOp *> pending_;
+    // Operands and results of the pending multiplications, gathered so that
+    // they can be issued together
+    std::vector<BigInt> a_;
+    std::vector<BigInt> b_;
+    std::vector<BigInt> out_;
+};
+
+inline void FieldMulOp::await_suspend(std::coroutine_handle<> h) {
+    waiter = h;
+    sched->pending_.push_back(this);
+}
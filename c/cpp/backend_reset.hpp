@@ -0,0 +1,13 @@
+// Undefines the macros of a bigint layout and the capability flags of a
+// kernel, once c/cpp/backends.hpp has defined a backend from them. Included
+// once per backend, so it has no include guard.
+
+#undef NUM_LIMBS
+#undef BITS_PER_LIMB
+#undef LIMB_MASK
+#undef MONT_SQR_AVAILABLE
+#undef MONT_SUM_OF_PRODUCTS_AVAILABLE
+#undef MONT_MUL2_AVAILABLE
+#undef MONT_MUL_INTERLEAVED_AVAILABLE
+#undef MONT_MUL_PREPARED_AVAILABLE
+#undef MONT_MUL_X4_AVAILABLE
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#ifdef __ARM_NEON
+#include "../simd/simd.h"
+#endif
+
+// The Montgomery multiplication kernels as backends for Field<Backend,
+// Modulus> in c/cpp/field.hpp.
+//
+// Each kernel is a C header written against the NUM_LIMBS, BITS_PER_LIMB
+// and LIMB_MASK macros of one bigint layout, so a C translation unit can only
+// use one layout. Here each kernel is included, together with its bigint
+// layout, into a namespace of its own, and the macros are undefined again
+// afterwards (c/cpp/backend_reset.hpp), so that one binary can hold every
+// kernel and layout. The backend structs capture what the macros said while
+// they were defined.
+//
+// A backend has:
+//   BigInt                  the kernel's bigint type
+//   num_limbs, bits_per_limb
+//   n0_is_mu                n0 is p^-1 mod 2^32 (BM17) rather than -p^-1
+//   needs_spare_bit         the kernel relies on the top limb of p being less
+//                           than (2^bits_per_limb - 1) / 2 - 1
+//   mul(a, b, p, n0) and sqr(a, p, n0), which call the kernel
+//   has_sum_of_products     sum_of_products(a, b, k, p, n0) calls the fused
+//                           mont_sum_of_products
+//   has_mul4                mul4(a, b, p, n0, out) calls mont_mul_4way, or,
+//                           for Acar8x32 on NEON, mont_mul_x4 with the four
+//                           products in the vector lanes
+//
+// The kernels' functions have external linkage, so include this file in only
+// one translation unit per binary, as with the C headers. BM17 and SLGCK14
+// are only available when compiling for NEON.
+
+// Acar, 32-bit limbs
+namespace acar_8x32 {
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../acar/mont.h"
+}
+
+struct Acar8x32 {
+    using BigInt = acar_8x32::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = false;
+    static constexpr bool has_sum_of_products = true;
+#ifdef __ARM_NEON
+    static constexpr bool has_mul4 = true; // Defined below, with mont_mul_x4
+#else
+    static constexpr bool has_mul4 = false;
+#endif
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return acar_8x32::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return acar_8x32::mont_mul(a, a, p, n0);
+    }
+    static inline BigInt sum_of_products(BigInt *a, BigInt *b, int k, BigInt *p, uint64_t n0) {
+        return acar_8x32::mont_sum_of_products(a, b, k, p, n0);
+    }
+#ifdef __ARM_NEON
+    static inline void mul4(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, BigInt *out);
+#endif
+};
+
+#include "backend_reset.hpp"
+
+// Acar, 64-bit limbs
+namespace acar_4x64 {
+#include "../bigints/bigint_4x64/bigint.h"
+#include "../acar/mont_4x64.h"
+}
+
+struct Acar4x64 {
+    using BigInt = acar_4x64::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = true; // For mont_sqr
+    static constexpr bool has_sum_of_products = true;
+    static constexpr bool has_mul4 = true;
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return acar_4x64::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return acar_4x64::mont_sqr(a, p, n0);
+    }
+    static inline BigInt sum_of_products(BigInt *a, BigInt *b, int k, BigInt *p, uint64_t n0) {
+        return acar_4x64::mont_sum_of_products(a, b, k, p, n0);
+    }
+    static inline void mul4(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, BigInt *out) {
+        acar_4x64::mont_mul_4way(a, b, p, n0, out);
+    }
+};
+
+#include "backend_reset.hpp"
+
+// BH23, 32-bit limbs
+namespace bh23_8x32 {
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../bh23/mont.h"
+}
+
+struct BH23_8x32 {
+    using BigInt = bh23_8x32::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = true;
+    static constexpr bool has_sum_of_products = false;
+    static constexpr bool has_mul4 = false;
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return bh23_8x32::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return bh23_8x32::mont_mul(a, a, p, n0);
+    }
+};
+
+#include "backend_reset.hpp"
+
+// BH23, 64-bit limbs
+namespace bh23_4x64 {
+#include "../bigints/bigint_4x64/bigint.h"
+#include "../bh23/mont_4x64.h"
+}
+
+struct BH23_4x64 {
+    using BigInt = bh23_4x64::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = true;
+    static constexpr bool has_sum_of_products = false;
+    static constexpr bool has_mul4 = true;
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return bh23_4x64::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return bh23_4x64::mont_sqr(a, p, n0);
+    }
+    static inline void mul4(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, BigInt *out) {
+        bh23_4x64::mont_mul_4way(a, b, p, n0, out);
+    }
+};
+
+#include "backend_reset.hpp"
+
+// Yuval Domb's CIOS, 64-bit limbs
+namespace domb_4x64 {
+#include "../bigints/bigint_4x64/bigint.h"
+#include "../domb/mont_4x64.h"
+}
+
+struct Domb4x64 {
+    using BigInt = domb_4x64::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = true;
+    static constexpr bool has_sum_of_products = false;
+    static constexpr bool has_mul4 = true;
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return domb_4x64::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return domb_4x64::mont_mul(a, a, p, n0);
+    }
+    static inline void mul4(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, BigInt *out) {
+        domb_4x64::mont_mul_4way(a, b, p, n0, out);
+    }
+};
+
+#include "backend_reset.hpp"
+
+#ifdef __ARM_NEON
+// BM17, 32-bit limbs in NEON lanes
+namespace bm17_8x32 {
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../bm17/mont.h"
+}
+
+struct BM17 {
+    using BigInt = bm17_8x32::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = true;
+    static constexpr bool needs_spare_bit = false;
+    static constexpr bool has_sum_of_products = false;
+    static constexpr bool has_mul4 = false;
+
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        return bm17_8x32::mont_mul(a, b, p, n0);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return bm17_8x32::mont_mul(a, a, p, n0);
+    }
+};
+
+#include "backend_reset.hpp"
+
+// SLGCK14, 32-bit limbs in NEON lanes
+namespace slgck14_8x32 {
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../slgck14/mont.h"
+}
+
+struct SLGCK14 {
+    using BigInt = slgck14_8x32::BigInt;
+    static constexpr int num_limbs = NUM_LIMBS;
+    static constexpr int bits_per_limb = BITS_PER_LIMB;
+    static constexpr bool n0_is_mu = false;
+    static constexpr bool needs_spare_bit = false;
+    static constexpr bool has_sum_of_products = false;
+    static constexpr bool has_mul4 = false;
+
+    // The kernel takes b and p transposed into lane pairs.
+    static inline BigInt mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+        slgck14_8x32::MontPrepared prep;
+        slgck14_8x32::mont_prepare(&prep, b, p, n0);
+        return slgck14_8x32::mont_mul_prepared(a, &prep);
+    }
+    static inline BigInt sqr(BigInt *a, BigInt *p, uint64_t n0) {
+        return mul(a, a, p, n0);
+    }
+};
+
+#include "backend_reset.hpp"
+
+// Four products at once, one per NEON lane (c/multibuf/mont_x4.h). This is
+// not a backend, since it only multiplies in fours, but having it here lets
+// it share a binary with the others.
+namespace multibuf_8x32 {
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../multibuf/mont_x4.h"
+}
+
+// Acar8x32::mul4 transposes the four products into the lanes of
+// mont_mul_x4, which takes the same n0, -p^-1 mod 2^32, as Acar.
+inline void Acar8x32::mul4(BigInt *a, BigInt *b, BigInt *p, uint64_t n0, BigInt *out) {
+    multibuf_8x32::BigIntX4 va, vb, vp;
+    for (int i = 0; i < num_limbs; i ++) {
+        uint32_t la[4] = {(uint32_t)a[0].v[i], (uint32_t)a[1].v[i], (uint32_t)a[2].v[i], (uint32_t)a[3].v[i]};
+        uint32_t lb[4] = {(uint32_t)b[0].v[i], (uint32_t)b[1].v[i], (uint32_t)b[2].v[i], (uint32_t)b[3].v[i]};
+        va.v[i] = vld1q_u32(la);
+        vb.v[i] = vld1q_u32(lb);
+        vp.v[i] = vdupq_n_u32((uint32_t)p->v[i]);
+    }
+    multibuf_8x32::BigIntX4 r = multibuf_8x32::mont_mul_x4(&va, &vb, &vp, n0);
+    for (int i = 0; i < num_limbs; i ++) {
+        uint32_t lr[4];
+        vst1q_u32(lr, r.v[i]);
+        for (int j = 0; j < 4; j ++) {
+            out[j].v[i] = lr[j];
+        }
+    }
+}
+
+#include "backend_reset.hpp"
+#endif
@@ -0,0 +1,477 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include "field.hpp"
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Runtime selection of the Montgomery multiplication kernel, for shipping one
+// binary to many devices. The README table shows that the fastest kernel
+// depends on the limb size and the core, so rather than fixing one at build
+// time, FieldDispatch<Modulus>:
+//   - detects the CPU's features (HWCAP on AArch64 Linux and Android, CPUID
+//     on x86) and leaves out the kernels it can't run,
+//   - the first time an operation is used at a given batch size, times every
+//     candidate kernel on a batch of that size and keeps the fastest,
+//   - records its choices in a small profile file, keyed by the CPU and the
+//     modulus, so that later runs on the same device skip the tuning,
+//   - and calls the chosen kernel through a function pointer.
+//
+// The candidates are every backend of c/cpp/backends.hpp, and the 4-way
+// interleaved versions of the 64-bit ones. On x86 there are also copies of
+// the 64-bit ones compiled for BMI2, with the kernel inlined so that the
+// compiler can use mulx, which are only candidates if CPUID reports BMI2.
+// (The kernels' carry chains are plain C, which compilers don't turn into
+// adcx and adox, so ADX is not required.) GNU ifunc resolvers run while the program
+// is being relocated, which is too early to time anything, so the choice is
+// made at first use instead.
+//
+// Elements are passed as the four little-endian 64-bit words of their
+// Montgomery form. Every layout has R = 2^256, so this is the same value for
+// every kernel; the 8x32 kernels split and join the words around each call.
+// Elements must be in [0, p], and results are in [0, p]. Since the BH23 and
+// Domb kernels are candidates, the modulus must leave them the spare bit in
+// its top limb (BN254's does).
+//
+// Batch sizes are grouped into FIELD_DISPATCH_BUCKETS classes (below 4, below
+// 32, below 256, and larger), each tuned on its own. Tuning is not
+// thread-safe; to share a FieldDispatch between threads, call tune_all()
+// first. On big.LITTLE devices the tuning runs on whichever core the thread
+// is on, and the profile is keyed by the first core's ID.
+
+#define FIELD_DISPATCH_BUCKETS 4
+#define FIELD_DISPATCH_TUNE_ELEMENTS 4096 // Elements timed per trial
+#define FIELD_DISPATCH_TUNE_TRIALS 5
+
+// CPU features that kernels may require
+#define CPU_NEON 1 // AArch64 Advanced SIMD
+#define CPU_BMI2 2 // x86 mulx
+#define CPU_ADX 4  // x86 adcx and adox. Part of the profile key only; no kernel needs it.
+#define CPU_AVX2 8
+
+struct CpuFeatures {
+    unsigned flags;
+    // The x86 brand string or the AArch64 MIDR_EL1 of the first core
+    char model[64];
+};
+
+static inline CpuFeatures cpu_features_detect() {
+    CpuFeatures c;
+    c.flags = 0;
+    strcpy(c.model, "unknown");
+#if defined(__aarch64__) && defined(__linux__)
+    if (getauxval(AT_HWCAP) & HWCAP_ASIMD) {
+        c.flags |= CPU_NEON;
+    }
+    FILE *f = fopen("/sys/devices/system/cpu/cpu0/regs/identification/midr_el1", "r");
+    if (f != NULL) {
+        if (fgets(c.model, sizeof(c.model), f) != NULL) {
+            c.model[strcspn(c.model, "\n")] = '\0';
+        }
+        fclose(f);
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned a, b, cx, d;
+    if (__get_cpuid_count(7, 0, &a, &b, &cx, &d)) {
+        c.flags |= (b & bit_BMI2) ? CPU_BMI2 : 0;
+        c.flags |= (b & bit_ADX) ? CPU_ADX : 0;
+        c.flags |= (b & bit_AVX2) ? CPU_AVX2 : 0;
+    }
+    unsigned brand[12];
+    if (__get_cpuid(0x80000004, &a, &b, &cx, &d)) {
+        for (unsigned i = 0; i < 3; i ++) {
+            __get_cpuid(0x80000002 + i, &brand[4 * i], &brand[4 * i + 1], &brand[4 * i + 2], &brand[4 * i + 3]);
+        }
+        memcpy(c.model, brand, sizeof(brand));
+        c.model[sizeof(brand)] = '\0';
+    }
+#endif
+    return c;
+}
+
+// The features and model on one line, as recorded in profiles
+static inline void cpu_features_string(const CpuFeatures *c, char *out, size_t len) {
+    snprintf(out, len, "neon=%d bmi2=%d adx=%d avx2=%d model=%s",
+        (c->flags & CPU_NEON) != 0, (c->flags & CPU_BMI2) != 0,
+        (c->flags & CPU_ADX) != 0, (c->flags & CPU_AVX2) != 0, c->model);
+}
+
+namespace field_detail {
+
+// The words of a number in a layout of n limbs of b bits, the inverse of
+// to_limbs.
+template <class BigInt, int n, int b>
+inline Words from_limbs(const BigInt &a) {
+    Words w = {{0, 0, 0, 0}};
+    for (int i = 0; i < n; i ++) {
+        int bit = i * b;
+        w.w[bit / 64] |= a.v[i] << (bit % 64);
+        if (bit % 64 + b > 64 && bit / 64 + 1 < 4) {
+            w.w[bit / 64 + 1] |= a.v[i] >> (64 - bit % 64);
+        }
+    }
+    return w;
+}
+
+// The batch entry points of one backend. MUL4 uses the 4-way interleaved
+// kernel for blocks of four.
+template <class F, bool MUL4>
+struct Batch {
+    using Backend = typename F::backend;
+    using BigInt = typename F::BigInt;
+
+    static inline __attribute__((always_inline)) void mul(const Words *a, const Words *b, Words *out, size_t n) {
+        BigInt *p = const_cast<BigInt *>(&F::P);
+        size_t i = 0;
+        if constexpr (MUL4) {
+            for (; i < n / 4 * 4; i += 4) {
+                BigInt x[4], y[4], r[4];
+                for (int j = 0; j < 4; j ++) {
+                    x[j] = to_limbs<BigInt, F::N, F::B>(a[i + j]);
+                    y[j] = to_limbs<BigInt, F::N, F::B>(b[i + j]);
+                }
+                Backend::mul4(x, y, p, F::N0, r);
+                for (int j = 0; j < 4; j ++) {
+                    out[i + j] = from_limbs<BigInt, F::N, F::B>(r[j]);
+                }
+            }
+        }
+        for (; i < n; i ++) {
+            BigInt x = to_limbs<BigInt, F::N, F::B>(a[i]);
+            BigInt y = to_limbs<BigInt, F::N, F::B>(b[i]);
+            out[i] = from_limbs<BigInt, F::N, F::B>(Backend::mul(&x, &y, p, F::N0));
+        }
+    }
+
+    static inline __attribute__((always_inline)) void sqr(const Words *a, Words *out, size_t n) {
+        BigInt *p = const_cast<BigInt *>(&F::P);
+        size_t i = 0;
+        if constexpr (MUL4) {
+            for (; i < n / 4 * 4; i += 4) {
+                BigInt x[4], r[4];
+                for (int j = 0; j < 4; j ++) {
+                    x[j] = to_limbs<BigInt, F::N, F::B>(a[i + j]);
+                }
+                Backend::mul4(x, x, p, F::N0, r);
+                for (int j = 0; j < 4; j ++) {
+                    out[i + j] = from_limbs<BigInt, F::N, F::B>(r[j]);
+                }
+            }
+        }
+        for (; i < n; i ++) {
+            BigInt x = to_limbs<BigInt, F::N, F::B>(a[i]);
+            out[i] = from_limbs<BigInt, F::N, F::B>(Backend::sqr(&x, p, F::N0));
+        }
+    }
+};
+
+template <class F, bool MUL4>
+void batch_mul(const Words *a, const Words *b, Words *out, size_t n) {
+    Batch<F, MUL4>::mul(a, b, out, n);
+}
+
+template <class F, bool MUL4>
+void batch_sqr(const Words *a, Words *out, size_t n) {
+    Batch<F, MUL4>::sqr(a, out, n);
+}
+
+#if defined(__x86_64__)
+// The same, compiled for BMI2, with everything inlined so that the kernel is
+// compiled for it too.
+template <class F, bool MUL4>
+__attribute__((target("bmi2"), flatten))
+void batch_mul_bmi2(const Words *a, const Words *b, Words *out, size_t n) {
+    Batch<F, MUL4>::mul(a, b, out, n);
+}
+
+template <class F, bool MUL4>
+__attribute__((target("bmi2"), flatten))
+void batch_sqr_bmi2(const Words *a, Words *out, size_t n) {
+    Batch<F, MUL4>::sqr(a, out, n);
+}
+#endif
+
+}
+
+enum FieldDispatchOp {
+    FIELD_DISPATCH_MUL,
+    FIELD_DISPATCH_SQR,
+    FIELD_DISPATCH_OPS
+};
+
+template <class Modulus>
+struct FieldKernel {
+    const char *name;
+    unsigned needs; // CPU_* flags
+    void (*mul)(const field_detail::Words *a, const field_detail::Words *b, field_detail::Words *out, size_t n);
+    void (*sqr)(const field_detail::Words *a, field_detail::Words *out, size_t n);
+};
+
+template <class Modulus>
+class FieldDispatch {
+public:
+    using Words = field_detail::Words;
+    using Kernel = FieldKernel<Modulus>;
+
+    /*
+     * Detects the CPU and reads the choices in the profile at profile_path,
+     * if it exists and was written for the same CPU and modulus. Choices made
+     * later are written back to it. With no path, nothing is read or
+     * written.
+     */
+    explicit FieldDispatch(const char *profile_path = NULL) : cpu_(cpu_features_detect()), path_(profile_path) {
+        for (int op = 0; op < FIELD_DISPATCH_OPS; op ++) {
+            for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k ++) {
+                choice_[op][k] = NULL;
+            }
+        }
+        cpu_features_string(&cpu_, fingerprint_, sizeof(fingerprint_));
+        load();
+    }
+
+    // out[i] = a[i] * b[i] for i < n
+    void mul(const Words *a, const Words *b, Words *out, size_t n) {
+        kernel(FIELD_DISPATCH_MUL, n)->mul(a, b, out, n);
+    }
+
+    // out[i] = a[i]^2 for i < n
+    void sqr(const Words *a, Words *out, size_t n) {
+        kernel(FIELD_DISPATCH_SQR, n)->sqr(a, out, n);
+    }
+
+    // The kernel used for op at batch size n, tuning first if need be
+    const Kernel *kernel(FieldDispatchOp op, size_t n) {
+        const Kernel **c = &choice_[op][bucket(n)];
+        if (*c == NULL) {
+            *c = tune(op, bucket(n));
+            save();
+        }
+        return *c;
+    }
+
+    // Tunes every operation and batch size that has no choice yet.
+    void tune_all() {
+        for (int op = 0; op < FIELD_DISPATCH_OPS; op ++) {
+            for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k ++) {
+                kernel((FieldDispatchOp)op, bucket_size(k));
+            }
+        }
+    }
+
+    /*
+     * Uses the kernel called name for every operation and batch size, and
+     * forgets the tuned choices (the profile is left as it is). Returns false
+     * if there is no such kernel or the CPU can't run it.
+     */
+    bool force(const char *name) {
+        const Kernel *k = find(name);
+        if (k == NULL) {
+            return false;
+        }
+        for (int op = 0; op < FIELD_DISPATCH_OPS; op ++) {
+            for (int b = 0; b < FIELD_DISPATCH_BUCKETS; b ++) {
+                choice_[op][b] = k;
+            }
+        }
+        forced_ = true;
+        return true;
+    }
+
+    const CpuFeatures &cpu() const {
+        return cpu_;
+    }
+
+    // Every candidate kernel, whether or not this CPU can run it
+    static const Kernel *kernels(size_t *count) {
+        using namespace field_detail;
+        static const Kernel list[] = {
+            {"acar_8x32", 0, batch_mul<Field<Acar8x32, Modulus>, false>, batch_sqr<Field<Acar8x32, Modulus>, false>},
+            {"bh23_8x32", 0, batch_mul<Field<BH23_8x32, Modulus>, false>, batch_sqr<Field<BH23_8x32, Modulus>, false>},
+            {"acar_4x64", 0, batch_mul<Field<Acar4x64, Modulus>, false>, batch_sqr<Field<Acar4x64, Modulus>, false>},
+            {"acar_4x64_4way", 0, batch_mul<Field<Acar4x64, Modulus>, true>, batch_sqr<Field<Acar4x64, Modulus>, true>},
+            {"bh23_4x64", 0, batch_mul<Field<BH23_4x64, Modulus>, false>, batch_sqr<Field<BH23_4x64, Modulus>, false>},
+            {"bh23_4x64_4way", 0, batch_mul<Field<BH23_4x64, Modulus>, true>, batch_sqr<Field<BH23_4x64, Modulus>, true>},
+            {"domb_4x64", 0, batch_mul<Field<Domb4x64, Modulus>, false>, batch_sqr<Field<Domb4x64, Modulus>, false>},
+            {"domb_4x64_4way", 0, batch_mul<Field<Domb4x64, Modulus>, true>, batch_sqr<Field<Domb4x64, Modulus>, true>},
+#ifdef __ARM_NEON
+            {"bm17", CPU_NEON, batch_mul<Field<BM17, Modulus>, false>, batch_sqr<Field<BM17, Modulus>, false>},
+            {"slgck14", CPU_NEON, batch_mul<Field<SLGCK14, Modulus>, false>, batch_sqr<Field<SLGCK14, Modulus>, false>},
+#endif
+#if defined(__x86_64__)
+            {"acar_4x64_bmi2", CPU_BMI2, batch_mul_bmi2<Field<Acar4x64, Modulus>, false>, batch_sqr_bmi2<Field<Acar4x64, Modulus>, false>},
+            {"acar_4x64_4way_bmi2", CPU_BMI2, batch_mul_bmi2<Field<Acar4x64, Modulus>, true>, batch_sqr_bmi2<Field<Acar4x64, Modulus>, true>},
+            {"bh23_4x64_bmi2", CPU_BMI2, batch_mul_bmi2<Field<BH23_4x64, Modulus>, false>, batch_sqr_bmi2<Field<BH23_4x64, Modulus>, false>},
+            {"domb_4x64_bmi2", CPU_BMI2, batch_mul_bmi2<Field<Domb4x64, Modulus>, false>, batch_sqr_bmi2<Field<Domb4x64, Modulus>, false>},
+#endif
+        };
+        *count = sizeof(list) / sizeof(list[0]);
+        return list;
+    }
+
+    bool supported(const Kernel *k) const {
+        return (k->needs & ~cpu_.flags) == 0;
+    }
+
+    // The supported kernel called name, or NULL
+    const Kernel *find(const char *name) const {
+        size_t count;
+        const Kernel *list = kernels(&count);
+        for (size_t i = 0; i < count; i ++) {
+            if (strcmp(list[i].name, name) == 0 && supported(&list[i])) {
+                return &list[i];
+            }
+        }
+        return NULL;
+    }
+
+    static int bucket(size_t n) {
+        return n < 4 ? 0 : n < 32 ? 1 : n < 256 ? 2 : 3;
+    }
+
+    // The batch size that a bucket is tuned with
+    static size_t bucket_size(int k) {
+        static const size_t sizes[FIELD_DISPATCH_BUCKETS] = {1, 8, 64, 512};
+        return sizes[k];
+    }
+
+    // Statistics
+    uint64_t tunings = 0;        // Operations and batch sizes tuned
+    uint64_t profile_loaded = 0; // Choices read from the profile
+
+private:
+    static constexpr const char *op_names[FIELD_DISPATCH_OPS] = {"mul", "sqr"};
+
+    static double now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    // Times every supported kernel on a batch of the bucket's size, and
+    // returns the fastest. The trials go round the kernels in turn, so that
+    // any drift in the clock speed affects them all alike, and each kernel
+    // is judged by its fastest trial.
+    const Kernel *tune(FieldDispatchOp op, int k) {
+        tunings ++;
+        size_t n = bucket_size(k);
+        Words *a = new Words[n], *b = new Words[n], *out = new Words[n];
+        // Elements 2^(256 + i) mod p, the Montgomery forms of 2^i
+        field_detail::Words p = field_detail::parse_hex(Modulus::hex);
+        Words x = field_detail::pow2_mod(256, p);
+        for (size_t i = 0; i < n; i ++) {
+            a[i] = x;
+            x = field_detail::double_mod(x, p);
+            b[i] = x;
+        }
+        size_t count;
+        const Kernel *list = kernels(&count);
+        double *best_ns = new double[count];
+        for (int t = 0; t < FIELD_DISPATCH_TUNE_TRIALS; t ++) {
+            for (size_t c = 0; c < count; c ++) {
+                if (!supported(&list[c])) {
+                    continue;
+                }
+                size_t done = 0;
+                double start = now_ns();
+                while (done < FIELD_DISPATCH_TUNE_ELEMENTS) {
+                    if (op == FIELD_DISPATCH_MUL) {
+                        list[c].mul(a, b, out, n);
+                    } else {
+                        list[c].sqr(a, out, n);
+                    }
+                    done += n;
+                }
+                double ns = (now_ns() - start) / done;
+                if (t == 0 || ns < best_ns[c]) {
+                    best_ns[c] = ns;
+                }
+            }
+        }
+        const Kernel *best = NULL;
+        for (size_t c = 0; c < count; c ++) {
+            if (supported(&list[c]) && (best == NULL || best_ns[c] < best_ns[best - list])) {
+                best = &list[c];
+            }
+        }
+        delete[] a;
+        delete[] b;
+        delete[] out;
+        delete[] best_ns;
+        return best;
+    }
+
+    /*
+     * The profile is a text file:
+     *     cpu <cpu_features_string>
+     *     modulus <hex>
+     *     <op> <bucket> <kernel>
+     *     ...
+     * It is ignored if the first two lines don't match, and lines naming a
+     * kernel that isn't supported are skipped.
+     */
+    void load() {
+        if (path_ == NULL) {
+            return;
+        }
+        FILE *f = fopen(path_, "r");
+        if (f == NULL) {
+            return;
+        }
+        char line[256];
+        char expected[256];
+        bool ok = true;
+        snprintf(expected, sizeof(expected), "cpu %s\n", fingerprint_);
+        ok = ok && fgets(line, sizeof(line), f) != NULL && strcmp(line, expected) == 0;
+        snprintf(expected, sizeof(expected), "modulus %s\n", Modulus::hex);
+        ok = ok && fgets(line, sizeof(line), f) != NULL && strcmp(line, expected) == 0;
+        while (ok && fgets(line, sizeof(line), f) != NULL) {
+            char op[16], name[64];
+            int k;
+            if (sscanf(line, "%15s %d %63s", op, &k, name) != 3 || k < 0 || k >= FIELD_DISPATCH_BUCKETS) {
+                continue;
+            }
+            const Kernel *kernel = find(name);
+            for (int o = 0; o < FIELD_DISPATCH_OPS; o ++) {
+                if (kernel != NULL && strcmp(op, op_names[o]) == 0) {
+                    choice_[o][k] = kernel;
+                    profile_loaded ++;
+                }
+            }
+        }
+        fclose(f);
+    }
+
+    void save() {
+        if (path_ == NULL || forced_) {
+            return;
+        }
+        FILE *f = fopen(path_, "w");
+        if (f == NULL) {
+            return;
+        }
+        fprintf(f, "cpu %s\n", fingerprint_);
+        fprintf(f, "modulus %s\n", Modulus::hex);
+        for (int op = 0; op < FIELD_DISPATCH_OPS; op ++) {
+            for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k ++) {
+                if (choice_[op][k] != NULL) {
+                    fprintf(f, "%s %d %s\n", op_names[op], k, choice_[op][k]->name);
+                }
+            }
+        }
+        fclose(f);
+    }
+
+    CpuFeatures cpu_;
+    const char *path_;
+    char fingerprint_[160];
+    bool forced_ = false;
+    const Kernel *choice_[FIELD_DISPATCH_OPS][FIELD_DISPATCH_BUCKETS];
+};
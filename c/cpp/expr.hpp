@@ -0,0 +1,441 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+// Expression templates for Field<Backend, Modulus>. Sums, differences and
+// negations of field elements and of products of them are not evaluated
+// where they are written; they build a small tree whose type records its
+// shape, and the tree is evaluated once, when it is converted to a Field:
+//
+//     Fr r = a * b + c * d - e;
+//
+// collects the two products and the one linear term, and then
+//   - computes a * b + c * d with one call to the backend's fused
+//     sum_of_products (one Montgomery reduction instead of two), or with one
+//     mul per product if the backend has none,
+//   - adds the products and the linear terms, each in [0, p], into an
+//     accumulator one limb wider than the field, without reducing, so that
+//     the sum of k terms stays in the redundant range [0, kp),
+//   - and reduces the sum into [0, p) once at the end.
+// A negated term x is added as p - x, and a negated product a * b as
+// a * (p - b). A product of two elements on its own is a plain call to mul.
+//
+// Only elements can be multiplied: the operands of * are evaluated first if
+// they are sums, so (a + b) * c costs one reduction for the sum and one
+// multiplication.
+//
+// The same trees work over FieldSpan<F>, a view of an array of elements in
+// Montgomery form (the layout of an AOS FrVec, or any BigInt array). Assigning
+// an expression with spans in it to a span evaluates it element by element in
+// one pass, with no temporaries:
+//
+//     FieldSpan<Fr> out(o, n), x(xs, n), y(ys, n), z(zs, n);
+//     out = x * y + z;
+//
+// Elements, rather than spans, in a vector expression are broadcast. On
+// backends with mul4 (the 4-way interleaved kernels, and mont_mul_x4 for
+// Acar8x32 on NEON), the products are issued four elements at a time; on
+// backends with sum_of_products, expressions with several products use it
+// for each element instead. Every span must be at least as long as the one
+// assigned to, which may also appear in the expression.
+
+template <class Backend, class Modulus>
+class Field;
+
+template <class F>
+class FieldSpan;
+
+namespace field_detail {
+
+// Leaves are elements and spans; everything else is a node with a
+// field_type.
+template <class E, class = void>
+struct is_node : std::false_type {};
+
+template <class E>
+struct is_node<E, std::void_t<typename E::field_type>> : std::true_type {};
+
+template <class E>
+struct is_leaf : std::false_type {};
+
+template <class Backend, class Modulus>
+struct is_leaf<Field<Backend, Modulus>> : std::true_type {};
+
+template <class F>
+struct is_leaf<FieldSpan<F>> : std::true_type {};
+
+template <class E>
+struct is_expr : std::integral_constant<bool, is_leaf<E>::value || is_node<E>::value> {};
+
+// The shape of an expression: its field, the number of products and of
+// linear terms in it, and whether it has a span in it. Only for expressions.
+template <class E>
+struct traits {
+    using field = typename E::field_type;
+    static constexpr int products = E::products;
+    static constexpr int linears = E::linears;
+    static constexpr bool vector = E::vector;
+};
+
+template <class Backend, class Modulus>
+struct traits<Field<Backend, Modulus>> {
+    using field = Field<Backend, Modulus>;
+    static constexpr int products = 0;
+    static constexpr int linears = 1;
+    static constexpr bool vector = false;
+};
+
+template <class F>
+struct traits<FieldSpan<F>> {
+    using field = F;
+    static constexpr int products = 0;
+    static constexpr int linears = 1;
+    static constexpr bool vector = true;
+};
+
+// Whether L and R are expressions over the same field
+template <class L, class R, class = void>
+struct same_field : std::false_type {};
+
+template <class L, class R>
+struct same_field<L, R, std::enable_if_t<is_expr<L>::value && is_expr<R>::value>>
+    : std::is_same<typename traits<L>::field, typename traits<R>::field> {};
+
+// Whether a Field can be constructed from E: a scalar node over F
+template <class E, class F, class = void>
+struct evaluates_to : std::false_type {};
+
+template <class E, class F>
+struct evaluates_to<E, F, std::enable_if_t<is_node<E>::value>>
+    : std::integral_constant<bool, std::is_same<typename E::field_type, F>::value && !E::vector> {};
+
+template <class E>
+typename E::field_type eval(const E &e);
+
+// Adds the terms of an expression, as element i if it is a vector one, to a
+// Terms sink, negated if neg is set.
+template <class E, class T>
+inline void collect(const E &e, T &t, bool neg, size_t i) {
+    e.collect(t, neg, i);
+}
+
+template <class Backend, class Modulus, class T>
+inline void collect(const Field<Backend, Modulus> &x, T &t, bool neg, size_t) {
+    t.add_linear(x.mont(), neg);
+}
+
+template <class F, class T>
+inline void collect(const FieldSpan<F> &x, T &t, bool neg, size_t i) {
+    t.add_linear(x.data()[i], neg);
+}
+
+// The Montgomery form of a leaf, as element i if it is a span
+template <class Backend, class Modulus>
+inline const typename Backend::BigInt &leaf_at(const Field<Backend, Modulus> &x, size_t) {
+    return x.mont();
+}
+
+template <class F>
+inline const typename F::BigInt &leaf_at(const FieldSpan<F> &x, size_t i) {
+    return x.data()[i];
+}
+
+// An operand of *: leaves as they are, and scalar nodes evaluated.
+template <class E>
+inline std::enable_if_t<is_leaf<E>::value, const E &> as_leaf(const E &e) {
+    return e;
+}
+
+template <class E>
+inline std::enable_if_t<is_node<E>::value, typename E::field_type> as_leaf(const E &e) {
+    static_assert(!E::vector, "only elements and spans can be multiplied in a vector expression");
+    return eval(e);
+}
+
+template <class E>
+using leaf_t = std::remove_cv_t<std::remove_reference_t<decltype(as_leaf(std::declval<const E &>()))>>;
+
+// p - a, for a in [0, p], which is in [0, p]
+template <class F>
+inline typename F::BigInt negate(const typename F::BigInt &a) {
+    typename F::BigInt r;
+    uint64_t borrow = 0;
+    unroll<F::N>([&](auto i) {
+        r.v[i] = (F::P.v[i] - a.v[i] - borrow) & F::MASK;
+        borrow = F::B == 64
+            ? (F::P.v[i] < a.v[i]) | (F::P.v[i] - a.v[i] < borrow)
+            : (F::P.v[i] - a.v[i] - borrow) >> 63;
+    });
+    return r;
+}
+
+// The terms of an expression with P products and L linear terms, with the
+// negations already applied. Products that have been computed elsewhere
+// (mul4) are added as linear terms, hence the room for P + L of them.
+template <class F, int P, int L>
+struct Terms {
+    using BigInt = typename F::BigInt;
+
+    BigInt a[P > 0 ? P : 1];
+    BigInt b[P > 0 ? P : 1];
+    BigInt lin[P + L > 0 ? P + L : 1];
+    int np = 0;
+    int nl = 0;
+
+    void add_product(const BigInt &x, const BigInt &y, bool neg) {
+        a[np] = x;
+        b[np] = neg ? negate<F>(y) : y;
+        np ++;
+    }
+
+    void add_linear(const BigInt &x, bool neg) {
+        lin[nl ++] = neg ? negate<F>(x) : x;
+    }
+
+    // The sum of the terms, reduced once into [0, p).
+    BigInt sum() {
+        using Backend = typename F::backend;
+        BigInt *p = const_cast<BigInt *>(&F::P);
+        if (P == 1 && L == 0 && np == 1) {
+            return Backend::mul(&a[0], &b[0], p, F::N0);
+        }
+
+        // The sum in N limbs of B bits and a top word. With B < 64 each limb
+        // is a 64-bit word, so limbs are added without carrying, and the
+        // carries are propagated once before the reduction.
+        uint64_t acc[F::N + 1] = {};
+        if constexpr (P > 1 && Backend::has_sum_of_products) {
+            BigInt s = Backend::sum_of_products(a, b, np, p, F::N0);
+            accumulate(acc, s);
+        } else {
+            for (int k = 0; k < np; k ++) {
+                BigInt s = Backend::mul(&a[k], &b[k], p, F::N0);
+                accumulate(acc, s);
+            }
+        }
+        for (int k = 0; k < nl; k ++) {
+            accumulate(acc, lin[k]);
+        }
+        return reduce(acc);
+    }
+
+    static void accumulate(uint64_t *acc, const BigInt &x) {
+        if constexpr (F::B == 64) {
+            uint64_t carry = 0;
+            unroll<F::N>([&](auto i) {
+                uint64_t s = acc[i] + x.v[i];
+                uint64_t c1 = s < acc[i];
+                acc[i] = s + carry;
+                carry = c1 | (acc[i] < carry);
+            });
+            acc[F::N] += carry;
+        } else {
+            unroll<F::N>([&](auto i) {
+                acc[i] += x.v[i];
+            });
+        }
+    }
+
+    static BigInt reduce(uint64_t *acc) {
+        if constexpr (F::B < 64) {
+            uint64_t carry = 0;
+            unroll<F::N>([&](auto i) {
+                uint64_t x = acc[i] + carry;
+                acc[i] = x & F::MASK;
+                carry = x >> F::B;
+            });
+            acc[F::N] += carry;
+        }
+        // The sum of k terms is less than kp, so this runs at most k - 1
+        // times, and usually once or not at all.
+        while (acc[F::N] != 0 || !less_than_p(acc)) {
+            uint64_t borrow = 0;
+            unroll<F::N>([&](auto i) {
+                uint64_t d = acc[i] - F::P.v[i] - borrow;
+                borrow = F::B == 64
+                    ? (acc[i] < F::P.v[i]) | (acc[i] - F::P.v[i] < borrow)
+                    : d >> 63;
+                acc[i] = d & F::MASK;
+            });
+            acc[F::N] -= borrow;
+        }
+        BigInt r;
+        unroll<F::N>([&](auto i) {
+            r.v[i] = acc[i];
+        });
+        return r;
+    }
+
+    static bool less_than_p(const uint64_t *acc) {
+        for (int i = F::N - 1; i >= 0; i --) {
+            if (acc[i] != F::P.v[i]) {
+                return acc[i] < F::P.v[i];
+            }
+        }
+        return false;
+    }
+};
+
+template <class E>
+typename E::field_type eval(const E &e) {
+    using F = typename E::field_type;
+    Terms<F, E::products, E::linears> t;
+    e.collect(t, false, 0);
+    return F::from_mont(t.sum());
+}
+
+// out[i] = e[i] for i < n
+template <class F, class E>
+void assign(typename F::BigInt *out, size_t n, const E &e) {
+    using Backend = typename F::backend;
+    constexpr int P = traits<E>::products;
+    constexpr int L = traits<E>::linears;
+    size_t i = 0;
+    if constexpr (P > 0 && Backend::has_mul4 && !(P > 1 && Backend::has_sum_of_products)) {
+        using BigInt = typename F::BigInt;
+        BigInt *p = const_cast<BigInt *>(&F::P);
+        for (; i < n / 4 * 4; i += 4) {
+            Terms<F, P, L> t[4];
+            for (int j = 0; j < 4; j ++) {
+                collect(e, t[j], false, i + j);
+            }
+            // Each product for the four elements at once
+            for (int k = 0; k < P; k ++) {
+                BigInt a[4], b[4], prod[4];
+                for (int j = 0; j < 4; j ++) {
+                    a[j] = t[j].a[k];
+                    b[j] = t[j].b[k];
+                }
+                Backend::mul4(a, b, p, F::N0, prod);
+                for (int j = 0; j < 4; j ++) {
+                    t[j].add_linear(prod[j], false);
+                }
+            }
+            BigInt r[4];
+            for (int j = 0; j < 4; j ++) {
+                t[j].np = 0;
+                r[j] = P == 1 && L == 0 ? t[j].lin[0] : t[j].sum();
+            }
+            for (int j = 0; j < 4; j ++) {
+                out[i + j] = r[j];
+            }
+        }
+    }
+    for (; i < n; i ++) {
+        Terms<F, P, L> t;
+        collect(e, t, false, i);
+        out[i] = t.sum();
+    }
+}
+
+}
+
+// The product of two leaves
+template <class L, class R>
+struct FieldMul {
+    using field_type = typename field_detail::traits<L>::field;
+    static constexpr int products = 1;
+    static constexpr int linears = 0;
+    static constexpr bool vector = field_detail::traits<L>::vector || field_detail::traits<R>::vector;
+
+    L l;
+    R r;
+
+    template <class T>
+    void collect(T &t, bool neg, size_t i) const {
+        t.add_product(field_detail::leaf_at(l, i), field_detail::leaf_at(r, i), neg);
+    }
+};
+
+// l + r, or l - r if SUB is set
+template <class L, class R, bool SUB>
+struct FieldSum {
+    using field_type = typename field_detail::traits<L>::field;
+    static constexpr int products = field_detail::traits<L>::products + field_detail::traits<R>::products;
+    static constexpr int linears = field_detail::traits<L>::linears + field_detail::traits<R>::linears;
+    static constexpr bool vector = field_detail::traits<L>::vector || field_detail::traits<R>::vector;
+
+    L l;
+    R r;
+
+    template <class T>
+    void collect(T &t, bool neg, size_t i) const {
+        field_detail::collect(l, t, neg, i);
+        field_detail::collect(r, t, SUB ? !neg : neg, i);
+    }
+};
+
+// -e
+template <class E>
+struct FieldNeg {
+    using field_type = typename field_detail::traits<E>::field;
+    static constexpr int products = field_detail::traits<E>::products;
+    static constexpr int linears = field_detail::traits<E>::linears;
+    static constexpr bool vector = field_detail::traits<E>::vector;
+
+    E e;
+
+    template <class T>
+    void collect(T &t, bool neg, size_t i) const {
+        field_detail::collect(e, t, !neg, i);
+    }
+};
+
+template <class L, class R, class = std::enable_if_t<field_detail::same_field<L, R>::value>>
+inline FieldSum<L, R, false> operator+(const L &l, const R &r) {
+    return {l, r};
+}
+
+template <class L, class R, class = std::enable_if_t<field_detail::same_field<L, R>::value>>
+inline FieldSum<L, R, true> operator-(const L &l, const R &r) {
+    return {l, r};
+}
+
+template <class E, class = std::enable_if_t<field_detail::is_expr<E>::value>>
+inline FieldNeg<E> operator-(const E &e) {
+    return {e};
+}
+
+template <class L, class R, class = std::enable_if_t<field_detail::same_field<L, R>::value>>
+inline FieldMul<field_detail::leaf_t<L>, field_detail::leaf_t<R>> operator*(const L &l, const R &r) {
+    return {field_detail::as_leaf(l), field_detail::as_leaf(r)};
+}
+
+// A view of n elements of F in Montgomery form, in [0, p], stored one after
+// another. It does not own them. Assigning to it writes the elements:
+// out = x * y + z evaluates the expression for each element, and out = x
+// copies x's elements.
+template <class F>
+class FieldSpan {
+public:
+    using BigInt = typename F::BigInt;
+
+    FieldSpan(BigInt *data, size_t len) : data_(data), len_(len) {}
+    FieldSpan(const FieldSpan &other) = default;
+
+    BigInt *data() const { return data_; }
+    size_t size() const { return len_; }
+
+    F operator[](size_t i) const {
+        return F::from_mont(data_[i]);
+    }
+
+    template <class E, class = std::enable_if_t<field_detail::same_field<FieldSpan, E>::value>>
+    FieldSpan &operator=(const E &e) {
+        field_detail::assign<F>(data_, len_, e);
+        return *this;
+    }
+
+    FieldSpan &operator=(const FieldSpan &other) {
+        for (size_t i = 0; i < len_; i ++) {
+            data_[i] = other.data_[i];
+        }
+        return *this;
+    }
+
+private:
+    BigInt *data_;
+    size_t len_;
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <utility>
+#include "backends.hpp"
+
+// A header-only C++17 prime field type, Field<Backend, Modulus>, over the
+// kernels of c/cpp/backends.hpp. The modulus is a type with a hex string:
+//
+//     struct Bn254Scalar { static constexpr const char *hex = BN254_SCALAR_HEX; };
+//     using Fr = Field<Acar4x64, Bn254Scalar>;
+//     Fr x = Fr::from_words(w);
+//     Fr y = x * x + Fr::one();
+//
+// Everything the C code takes from constants.h is computed at compile time
+// from the hex string: p in the backend's limbs, n0 (or mu for BM17), R mod p
+// and R^2 mod p, and whether the top limb of p leaves the spare bit that the
+// BH23 and Domb kernels rely on, which is checked with a static_assert.
+//
+// Squaring calls the backend's kernel directly, with the operand in place.
+// +, - and * build expression templates (c/cpp/expr.hpp), which are
+// evaluated when converted to a Field: a product of two elements is one call
+// to the kernel, and a sum of products and elements is computed with one
+// reduction at the end. The limb arithmetic runs with a pack expansion over
+// std::index_sequence, so it is fully unrolled whatever the optimisation
+// level. Elements are kept in Montgomery form, in [0, p], since some kernels
+// return p rather than 0 for a zero product.
+
+namespace field_detail {
+
+// A 256-bit number as little-endian 64-bit words.
+struct Words {
+    uint64_t w[4];
+};
+
+constexpr int hex_value(char c) {
+    return c >= '0' && c <= '9' ? c - '0'
+        : c >= 'a' && c <= 'f' ? c - 'a' + 10
+        : c >= 'A' && c <= 'F' ? c - 'A' + 10
+        : -1;
+}
+
+// Parses up to 64 big-endian hex digits.
+constexpr Words parse_hex(const char *hex) {
+    Words r = {{0, 0, 0, 0}};
+    int n = 0;
+    while (hex[n] != '\0') {
+        n ++;
+    }
+    for (int i = 0; i < n; i ++) {
+        int digit = n - 1 - i; // Counted from the least significant
+        r.w[digit / 16] |= (uint64_t)hex_value(hex[i]) << (4 * (digit % 16));
+    }
+    return r;
+}
+
+constexpr bool words_lt(const Words &a, const Words &b) {
+    for (int i = 3; i >= 0; i --) {
+        if (a.w[i] != b.w[i]) {
+            return a.w[i] < b.w[i];
+        }
+    }
+    return false;
+}
+
+// 2a mod p, for a < p
+constexpr Words double_mod(const Words &a, const Words &p) {
+    Words r = {{0, 0, 0, 0}};
+    uint64_t carry = 0;
+    for (int i = 0; i < 4; i ++) {
+        r.w[i] = a.w[i] << 1 | carry;
+        carry = a.w[i] >> 63;
+    }
+    if (carry != 0 || !words_lt(r, p)) {
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; i ++) {
+            uint64_t d = r.w[i] - p.w[i] - borrow;
+            borrow = (r.w[i] < p.w[i]) || (r.w[i] - p.w[i] < borrow);
+            r.w[i] = d;
+        }
+    }
+    return r;
+}
+
+// 2^k mod p
+constexpr Words pow2_mod(int k, const Words &p) {
+    Words r = {{1, 0, 0, 0}};
+    for (int i = 0; i < k; i ++) {
+        r = double_mod(r, p);
+    }
+    return r;
+}
+
+// p0^-1 mod 2^bits, for odd p0, by Newton's iteration, which doubles the
+// number of correct bits each time.
+constexpr uint64_t inv_mod_pow2(uint64_t p0, int bits) {
+    uint64_t inv = 1;
+    for (int i = 0; i < 6; i ++) {
+        inv *= 2 - p0 * inv;
+    }
+    return bits == 64 ? inv : inv & ((1ULL << bits) - 1);
+}
+
+// The limbs of a 256-bit number in a layout of n limbs of b bits.
+template <class BigInt, int n, int b>
+constexpr BigInt to_limbs(const Words &w) {
+    BigInt r = {};
+    for (int i = 0; i < n; i ++) {
+        int bit = i * b;
+        uint64_t limb = w.w[bit / 64] >> (bit % 64);
+        if (bit % 64 + b > 64 && bit / 64 + 1 < 4) {
+            limb |= w.w[bit / 64 + 1] << (64 - bit % 64);
+        }
+        r.v[i] = b == 64 ? limb : limb & ((1ULL << b) - 1);
+    }
+    return r;
+}
+
+// Calls f(std::integral_constant<size_t, I>()) for I = 0..N-1, in order.
+template <size_t... I, class F>
+constexpr void unroll_impl(std::index_sequence<I...>, F &&f) {
+    (f(std::integral_constant<size_t, I>()), ...);
+}
+
+template <size_t N, class F>
+constexpr void unroll(F &&f) {
+    unroll_impl(std::make_index_sequence<N>(), std::forward<F>(f));
+}
+
+}
+
+#include "expr.hpp"
+
+template <class Backend, class Modulus>
+class Field {
+public:
+    using backend = Backend;
+    using BigInt = typename Backend::BigInt;
+    static constexpr int N = Backend::num_limbs;
+    static constexpr int B = Backend::bits_per_limb;
+    static constexpr uint64_t MASK = B == 64 ? ~0ULL : (1ULL << B) - 1;
+
+private:
+    static constexpr field_detail::Words P_WORDS = field_detail::parse_hex(Modulus::hex);
+
+public:
+    static constexpr BigInt P = field_detail::to_limbs<BigInt, N, B>(P_WORDS);
+    // -p^-1 mod 2^B, or p^-1 mod 2^32 (mu) for BM17
+    static constexpr uint64_t N0 = Backend::n0_is_mu
+        ? field_detail::inv_mod_pow2(P_WORDS.w[0], 32)
+        : (0 - field_detail::inv_mod_pow2(P_WORDS.w[0], B)) & MASK;
+    // R mod p and R^2 mod p, where R = 2^(N * B)
+    static constexpr BigInt R = field_detail::to_limbs<BigInt, N, B>(field_detail::pow2_mod(N * B, P_WORDS));
+    static constexpr BigInt R2 = field_detail::to_limbs<BigInt, N, B>(field_detail::pow2_mod(2 * N * B, P_WORDS));
+    // Whether the top limb of p is less than (2^B - 1) / 2 - 1, which the
+    // BH23 and Domb kernels and the 64-bit Acar squaring need
+    static constexpr bool SPARE_BIT = P.v[N - 1] < MASK / 2 - 1;
+
+    static_assert((P_WORDS.w[0] & 1) == 1, "the modulus must be odd");
+    static_assert(N * B >= 256 || P_WORDS.w[3] == 0, "the modulus is too large for the backend");
+    static_assert(!Backend::needs_spare_bit || SPARE_BIT,
+        "the backend needs the top limb of the modulus to leave a spare bit");
+
+    // Zero
+    constexpr Field() : v() {}
+
+    // The value of an expression of c/cpp/expr.hpp, such as a * b + c
+    template <class E, class = std::enable_if_t<field_detail::evaluates_to<E, Field>::value>>
+    Field(const E &e) : Field(field_detail::eval(e)) {}
+
+    // An element from its Montgomery form, which must be in [0, p].
+    static constexpr Field from_mont(const BigInt &a) {
+        Field r;
+        r.v = a;
+        return r;
+    }
+
+    static constexpr Field zero() {
+        return Field();
+    }
+
+    static constexpr Field one() {
+        return from_mont(R);
+    }
+
+    // An element from the little-endian 64-bit words of a canonical value
+    // less than p.
+    static Field from_words(const uint64_t w[4]) {
+        field_detail::Words x = {{w[0], w[1], w[2], w[3]}};
+        BigInt a = field_detail::to_limbs<BigInt, N, B>(x);
+        return from_mont(Backend::mul(&a, const_cast<BigInt *>(&R2), const_cast<BigInt *>(&P), N0));
+    }
+
+    static Field from_u64(uint64_t x) {
+        uint64_t w[4] = {x, 0, 0, 0};
+        return from_words(w);
+    }
+
+    // The Montgomery form, as passed to the C kernels
+    constexpr const BigInt &mont() const {
+        return v;
+    }
+
+    // The canonical value, as little-endian 64-bit words.
+    void to_words(uint64_t w[4]) const {
+        BigInt one = {};
+        one.v[0] = 1;
+        BigInt a = Backend::mul(const_cast<BigInt *>(&v), &one, const_cast<BigInt *>(&P), N0);
+        a = canonical(a);
+        for (int i = 0; i < 4; i ++) {
+            w[i] = 0;
+        }
+        for (int i = 0; i < N; i ++) {
+            int bit = i * B;
+            w[bit / 64] |= a.v[i] << (bit % 64);
+            if (bit % 64 + B > 64 && bit / 64 + 1 < 4) {
+                w[bit / 64 + 1] |= a.v[i] >> (64 - bit % 64);
+            }
+        }
+    }
+
+    Field sqr() const {
+        return from_mont(Backend::sqr(const_cast<BigInt *>(&v), const_cast<BigInt *>(&P), N0));
+    }
+
+    Field &operator*=(const Field &b) {
+        return *this = *this * b;
+    }
+
+    Field &operator+=(const Field &b) {
+        return *this = *this + b;
+    }
+
+    Field &operator-=(const Field &b) {
+        return *this = *this - b;
+    }
+
+    friend bool operator==(const Field &a, const Field &b) {
+        BigInt x = canonical(a.v);
+        BigInt y = canonical(b.v);
+        uint64_t diff = 0;
+        field_detail::unroll<N>([&](auto i) {
+            diff |= x.v[i] ^ y.v[i];
+        });
+        return diff == 0;
+    }
+
+    friend bool operator!=(const Field &a, const Field &b) {
+        return !(a == b);
+    }
+
+private:
+    // p as 0, and anything else as it is
+    static BigInt canonical(const BigInt &a) {
+        uint64_t diff = 0;
+        field_detail::unroll<N>([&](auto i) {
+            diff |= a.v[i] ^ P.v[i];
+        });
+        return diff == 0 ? BigInt() : a;
+    }
+
+    BigInt v;
+};
@@ -67,16 +67,9 @@ void mont_mul_no_reduce(
     }
 }
 
-BigInt mont_mul(
-    BigInt *ar,
-    BigInt *br,
-    BigInt *p,
-    uint64_t n0
-) {
-    uint64_t t[NUM_LIMBS + 1] = {0};
-
-    mont_mul_no_reduce(ar, br, p, n0, t);
-
+/// Returns t if t <= p, or t - p otherwise, where t has NUM_LIMBS + 1 limbs
+/// and is less than 2p.
+static inline BigInt mont_reduce_final(uint64_t *t, BigInt *p) {
     bool t_gt_p = false;
     for (int idx = 0; idx < NUM_LIMBS; idx ++) {
         int i = NUM_LIMBS - idx;
@@ -122,3 +115,98 @@ BigInt mont_mul(
     }
     return res;
 }
+
+BigInt mont_mul(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *p,
+    uint64_t n0
+) {
+    uint64_t t[NUM_LIMBS + 1] = {0};
+
+    mont_mul_no_reduce(ar, br, p, n0, t);
+
+    return mont_reduce_final(t, p);
+}
+
+#define MONT_MUL_INTERLEAVED_AVAILABLE
+
+/// Computes ways (up to 4) independent products a[k] * b[k] as mont_mul
+/// does, with each limb step issued for every product before the next one,
+/// so that the products' carry chains overlap in the multiplier instead of
+/// running one after another.
+/// ways must be a constant so that the loops over it unroll.
+static inline void mont_mul_interleaved(
+    BigInt *ar,
+    BigInt *br,
+    BigInt *p,
+    uint64_t n0,
+    BigInt *out,
+    const int ways
+) {
+    uint64_t res[4][NUM_LIMBS + 1] = {{0}};
+    uint64_t car1[4], car2[4], m[4];
+    unsigned __int128 r;
+
+    // Unrolled so that every res stays in registers, and so that the i == 0
+    // special cases fold away.
+    #pragma GCC unroll 4
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        #pragma GCC unroll 4
+        for (int k = 0; k < ways; k ++) {
+            if (i == 0) {
+                r = carrying_mul_add_slim(ar[k].v[0], br[k].v[i], res[k][0]);
+            } else {
+                r = carrying_mul_add(ar[k].v[0], br[k].v[i], res[k][0], 0);
+            }
+            res[k][0] = r & LIMB_MASK;
+            car2[k] = r >> BITS_PER_LIMB;
+
+            m[k] = res[k][0] * n0;
+
+            r = carrying_mul_add(m[k], p->v[0], res[k][0], 0);
+            car1[k] = r >> BITS_PER_LIMB;
+        }
+
+        #pragma GCC unroll 4
+        for (int j = 1; j < NUM_LIMBS; j ++) {
+            #pragma GCC unroll 4
+            for (int k = 0; k < ways; k ++) {
+                unsigned __int128 temp_mult = (unsigned __int128)ar[k].v[j] * (unsigned __int128)br[k].v[i];
+                unsigned __int128 temp_res;
+                if (i == 0) {
+                    uint64_t temp_add = res[k][j] + car2[k];
+                    temp_res = temp_mult + (unsigned __int128) temp_add;
+                } else {
+                    temp_res = temp_mult + (unsigned __int128) res[k][j] + (unsigned __int128) car2[k];
+                }
+                res[k][j] = temp_res & LIMB_MASK;
+                car2[k] = temp_res >> BITS_PER_LIMB;
+
+                r = carrying_mul_add(m[k], p->v[j], res[k][j], car1[k]);
+                res[k][j - 1] = r & LIMB_MASK;
+                car1[k] = r >> BITS_PER_LIMB;
+            }
+        }
+
+        #pragma GCC unroll 4
+        for (int k = 0; k < ways; k ++) {
+            r = (unsigned __int128)car1[k] + (unsigned __int128)car2[k];
+            res[k][NUM_LIMBS - 1] = r & LIMB_MASK;
+        }
+    }
+
+    for (int k = 0; k < ways; k ++) {
+        out[k] = mont_reduce_final(res[k], p);
+    }
+}
+
+/// out[k] = a[k] * b[k] for k = 0, 1, with the two products interleaved.
+void mont_mul_2way(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0, BigInt *out) {
+    mont_mul_interleaved(ar, br, p, n0, out, 2);
+}
+
+/// out[k] = a[k] * b[k] for k = 0..3, with the four products interleaved.
+void mont_mul_4way(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0, BigInt *out) {
+    mont_mul_interleaved(ar, br, p, n0, out, 4);
+}
@@ -0,0 +1,146 @@
+#include <stdint.h>
+
+// The Montgomery-domain constants of a prime field, so that higher-level
+// routines (exponentiation, square roots, hashing) can take one argument
+// instead of four.
+//
+// Works with any kernel that provides
+// BigInt mont_mul(BigInt *ar, BigInt *br, BigInt *p, uint64_t n0).
+// For BM17, n0 holds mu instead.
+typedef struct {
+    BigInt p;
+    BigInt one; // R mod p, i.e. 1 in Montgomery form
+    BigInt r2;  // R^2 mod p
+    uint64_t n0;
+} MontField;
+
+/*
+ * Initialises a MontField from big-endian hexadecimal strings.
+ * Returns 0 on success, or the error code of bigint_from_hex.
+ */
+int mont_field_init(
+    MontField *f,
+    const char *p_hex,
+    const char *one_hex,
+    const char *r2_hex,
+    uint64_t n0
+) {
+    int result = bigint_from_hex(p_hex, &f->p);
+    if (result != 0) return result;
+    result = bigint_from_hex(one_hex, &f->one);
+    if (result != 0) return result;
+    result = bigint_from_hex(r2_hex, &f->r2);
+    if (result != 0) return result;
+    f->n0 = n0;
+    return 0;
+}
+
+// -p^-1 mod 2^BITS_PER_LIMB, the n0 of a limb-by-limb Montgomery reduction
+// (the CIOS kernels, mont_mul_x4), by Newton's iteration, which doubles the
+// number of correct bits each time. This is f->n0 for every kernel but BM17,
+// whose MontField holds mu = p^-1 instead, so code that reduces by limbs
+// itself should call this rather than read f->n0.
+static inline uint64_t field_redc_n0(const MontField *f) {
+    uint64_t inv = 1;
+    for (int i = 0; i < 6; i ++) {
+        inv *= 2 - f->p.v[0] * inv;
+    }
+    return (0 - inv) & LIMB_MASK;
+}
+
+static inline BigInt field_mul(BigInt *ar, BigInt *br, MontField *f) {
+    return mont_mul(ar, br, &f->p, f->n0);
+}
+
+// Sets *abr = a * b and *acr = a * c. Uses the kernel's dual product, which
+// shares the work on a between the two, if it has one.
+static inline void field_mul2(BigInt *ar, BigInt *br, BigInt *cr, BigInt *abr, BigInt *acr, MontField *f) {
+#ifdef MONT_MUL2_AVAILABLE
+    mont_mul2(ar, br, cr, &f->p, f->n0, abr, acr);
+#else
+    *abr = mont_mul(ar, br, &f->p, f->n0);
+    *acr = mont_mul(ar, cr, &f->p, f->n0);
+#endif
+}
+
+// Uses the kernel's dedicated squaring if it has one.
+static inline BigInt field_sqr(BigInt *ar, MontField *f) {
+#ifdef MONT_SQR_AVAILABLE
+    return mont_sqr(ar, &f->p, f->n0);
+#else
+    return mont_mul(ar, ar, &f->p, f->n0);
+#endif
+}
+
+// Converts a into Montgomery form.
+static inline BigInt field_to_mont(BigInt *a, MontField *f) {
+    return mont_mul(a, &f->r2, &f->p, f->n0);
+}
+
+// Converts ar out of Montgomery form.
+static inline BigInt field_from_mont(BigInt *ar, MontField *f) {
+    BigInt one = bigint_new();
+    one.v[0] = 1;
+    return mont_mul(ar, &one, &f->p, f->n0);
+}
+
+// Returns a + b mod p. Inputs may be anywhere in [0, p], since some kernels
+// return p rather than 0 for a zero product.
+static inline BigInt field_add(BigInt *a, BigInt *b, MontField *f) {
+    BigInt r, d;
+    uint64_t carry = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t ai = a->v[i];
+        uint64_t s = (ai + b->v[i]) & LIMB_MASK;
+        uint64_t c1 = s < ai;
+        r.v[i] = (s + carry) & LIMB_MASK;
+        carry = c1 | (r.v[i] < s);
+    }
+    // Subtract p if a + b >= p.
+    uint64_t borrow = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t ri = r.v[i];
+        uint64_t pi = f->p.v[i];
+        d.v[i] = (ri - pi - borrow) & LIMB_MASK;
+        borrow = (ri < pi) | ((ri == pi) & borrow);
+    }
+    return (carry || !borrow) ? d : r;
+}
+
+// Returns a - b mod p, for a, b in [0, p].
+static inline BigInt field_sub(BigInt *a, BigInt *b, MontField *f) {
+    BigInt r;
+    uint64_t borrow = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t ai = a->v[i];
+        uint64_t bi = b->v[i];
+        r.v[i] = (ai - bi - borrow) & LIMB_MASK;
+        borrow = (ai < bi) | ((ai == bi) & borrow);
+    }
+    if (borrow) {
+        uint64_t carry = 0;
+        for (int i = 0; i < NUM_LIMBS; i ++) {
+            uint64_t s = (r.v[i] + f->p.v[i]) & LIMB_MASK;
+            uint64_t c1 = s < r.v[i];
+            r.v[i] = (s + carry) & LIMB_MASK;
+            carry = c1 | (r.v[i] < s);
+        }
+    }
+    return r;
+}
+
+// Returns the sum of a[i] * b[i] for i < k in the Montgomery domain. Uses
+// the kernel's fused version, which reduces once instead of k times, if it
+// has one.
+static inline BigInt field_sum_of_products(BigInt *a, BigInt *b, int k, MontField *f) {
+#ifdef MONT_SUM_OF_PRODUCTS_AVAILABLE
+    return mont_sum_of_products(a, b, k, &f->p, f->n0);
+#else
+    BigInt acc = bigint_new();
+    for (int i = 0; i < k; i ++) {
+        BigInt prod = mont_mul(&a[i], &b[i], &f->p, f->n0);
+        acc = field_add(&acc, &prod, f);
+    }
+    return acc;
+#endif
+}
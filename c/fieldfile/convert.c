@@ -0,0 +1,328 @@
+#define _XOPEN_SOURCE 700 // For pread
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+// Converts vectors of field elements to and from the binary format of
+// c/fieldfile/fieldfile.h. The input is either a field file of either limb
+// layout, or text with one 64-digit big-endian hexadecimal number per line.
+// In text, lines that don't hold such a number are skipped and quotes and
+// commas are ignored, so the C data headers (tests/data/test_mont_data.h)
+// can be converted as they are. Both are read in chunks, so inputs may be
+// larger than memory.
+//
+// Usage: convert [--mont | --canonical] [--p <hex>] [--hex] <input> <output>
+//
+// --mont, --canonical  Convert the elements into or out of Montgomery form.
+//                      Text input is taken to be canonical.
+// --p <hex>            The modulus (default: the BN254 scalar field).
+// --hex                Write text instead of a field file.
+//
+// Every element must be less than p; the first one that isn't stops the
+// conversion with an error naming its line or index.
+//
+// The output uses this build's limb layout: 4x64 by default, or 8x32 if
+// compiled with -DCONVERT_8x32. With -DCONVERT_NO_MAIN, this file can be
+// included to call convert_run directly, as tests/fieldfile/convert.c does.
+
+#ifdef CONVERT_8x32
+#include "../bigints/bigint_8x32/bigint.h"
+#include "../bigints/bigint_8x32/hex.h"
+#include "../acar/mont.h"
+#else
+#include "../bigints/bigint_4x64/bigint.h"
+#include "../bigints/bigint_4x64/hex.h"
+#include "../acar/mont_4x64.h"
+#endif
+#include "../constants.h"
+#include "../field.h"
+#include "fieldfile.h"
+
+#define CONVERT_CHUNK 4096
+
+// Derives R mod p, R^2 mod p and -p^-1 mod 2^BITS_PER_LIMB from p alone,
+// so that any odd modulus can be given on the command line.
+static int convert_field_init(MontField *f, const char *p_hex) {
+    int result = bigint_from_hex(p_hex, &f->p);
+    if (result != 0 || (f->p.v[0] & 1) == 0) {
+        return -1;
+    }
+    // 2^(k + 1) mod p from 2^k mod p, NUM_LIMBS * BITS_PER_LIMB times.
+    BigInt x = bigint_new();
+    x.v[0] = 1;
+    for (int i = 0; i < 2 * NUM_LIMBS * BITS_PER_LIMB; i ++) {
+        x = field_add(&x, &x, f);
+        if (i == NUM_LIMBS * BITS_PER_LIMB - 1) {
+            f->one = x;
+        }
+    }
+    f->r2 = x;
+    f->n0 = field_redc_n0(f);
+    return 0;
+}
+
+// The four 64-bit words of a number back into this build's limbs.
+static BigInt convert_bigint_from_words(const uint64_t words[4]) {
+    BigInt r = bigint_new();
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        int bit = i * BITS_PER_LIMB;
+        uint64_t limb = words[bit / 64] >> (bit % 64);
+        if (bit % 64 + BITS_PER_LIMB > 64 && bit / 64 + 1 < 4) {
+            limb |= words[bit / 64 + 1] << (64 - bit % 64);
+        }
+        r.v[i] = limb & LIMB_MASK;
+    }
+    return r;
+}
+
+// Whether a header from another build describes a limb layout that
+// convert_decode can read: 1 to 64 bits per limb, in 8-byte limbs that fit in
+// the element.
+static bool convert_header_valid(const FieldFileHeader *h) {
+    return h->num_limbs >= 1 && h->bits_per_limb >= 1 && h->bits_per_limb <= 64
+        && (uint64_t)h->num_limbs * 8 <= h->element_size;
+}
+
+/*
+ * Decodes one element of a field file written with any limb layout, given a
+ * header that convert_header_valid accepts. Returns 0 on success, or -1 if a
+ * limb has bits set above bits_per_limb or above bit 255.
+ */
+static int convert_decode(const uint8_t *elem, const FieldFileHeader *h, BigInt *out) {
+    uint64_t words[4] = {0, 0, 0, 0};
+    uint64_t mask = h->bits_per_limb == 64 ? ~(uint64_t)0 : ((uint64_t)1 << h->bits_per_limb) - 1;
+    for (uint32_t i = 0; i < h->num_limbs; i ++) {
+        uint64_t limb;
+        memcpy(&limb, elem + 8 * i, sizeof(limb));
+        uint64_t bit = (uint64_t)i * h->bits_per_limb;
+        if ((limb & ~mask) != 0 || (bit >= 256 && limb != 0)) {
+            return -1;
+        }
+        if (bit >= 256) {
+            continue;
+        }
+        words[bit / 64] |= limb << (bit % 64);
+        if (bit % 64 + h->bits_per_limb > 64) {
+            uint64_t high = limb >> (64 - bit % 64);
+            if (bit / 64 + 1 < 4) {
+                words[bit / 64 + 1] |= high;
+            } else if (high != 0) {
+                return -1;
+            }
+        }
+    }
+    *out = convert_bigint_from_words(words);
+    return 0;
+}
+
+/*
+ * Finds a 64-digit hex number in line. Returns 1 if there is one, 0 if the
+ * line doesn't hold one, or -1 if it does but the number is not less than p.
+ */
+static int convert_parse_line(char *line, BigInt *out, MontField *f) {
+    char digits[65];
+    int n = 0;
+    for (char *c = line; *c != '\0'; c ++) {
+        if (c[0] == '0' && (c[1] == 'x' || c[1] == 'X') && n == 0) {
+            c ++;
+        } else if (isxdigit((unsigned char)*c)) {
+            if (n == 64) {
+                return 0;
+            }
+            digits[n ++] = *c;
+        } else if (!isspace((unsigned char)*c) && *c != '"' && *c != ',') {
+            return 0;
+        }
+    }
+    if (n != 64) {
+        return 0;
+    }
+    digits[64] = '\0';
+    if (bigint_from_hex(digits, out) != 0) {
+        return 0;
+    }
+    // bigint_gt(a, b) is a >= b
+    return bigint_gt(out, &f->p) ? -1 : 1;
+}
+
+typedef struct {
+    FILE *text;
+    FieldFileWriter writer;
+    bool hex;
+} ConvertOutput;
+
+static int convert_emit(ConvertOutput *out, BigInt *elems, size_t n) {
+    if (!out->hex) {
+        return fieldfile_append(&out->writer, elems, n);
+    }
+    for (size_t i = 0; i < n; i ++) {
+        if (fprintf(out->text, "%s\n", bigint_to_hex(&elems[i])) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Converts the file at in_path into out_path (see the usage above). to_mont
+ * is 1 to convert into Montgomery form, -1 out of it, and 0 to keep the
+ * input's form. Returns 0 on success, or 1 after printing an error.
+ */
+static int convert_run(const char *in_path, const char *out_path, int to_mont, bool hex, const char *p_hex) {
+    MontField f;
+    if (convert_field_init(&f, p_hex) != 0) {
+        fprintf(stderr, "invalid modulus: %s\n", p_hex);
+        return 1;
+    }
+
+    // Work out whether the input is a field file from its first bytes.
+    FILE *in = fopen(in_path, "rb");
+    if (in == NULL) {
+        perror(in_path);
+        return 1;
+    }
+    FieldFileHeader h;
+    bool binary = fread(&h, 1, sizeof(h), in) == sizeof(h)
+        && memcmp(h.magic, FIELDFILE_MAGIC, sizeof(FIELDFILE_MAGIC)) == 0;
+    bool in_mont = false;
+    if (binary) {
+        fseek(in, 0, SEEK_END);
+        int result = fieldfile_check_header(&h, ftell(in), NULL);
+        if ((result != 0 && result != -3) || !convert_header_valid(&h)) {
+            fprintf(stderr, "%s: invalid field file header\n", in_path);
+            fclose(in);
+            return 1;
+        }
+        uint64_t words[4];
+        fieldfile_words_from_bigint(&f.p, words);
+        if (memcmp(words, h.modulus, sizeof(words)) != 0) {
+            fprintf(stderr, "%s: the file's modulus is not %s\n", in_path, p_hex);
+            fclose(in);
+            return 1;
+        }
+        in_mont = (h.flags & FIELDFILE_MONTGOMERY) != 0;
+    }
+    rewind(in);
+    bool out_mont = to_mont == 0 ? in_mont : to_mont > 0;
+
+    ConvertOutput out = {NULL, {0}, hex};
+    if (hex) {
+        out.text = fopen(out_path, "w");
+        if (out.text == NULL) {
+            perror(out_path);
+            fclose(in);
+            return 1;
+        }
+    } else if (fieldfile_create(&out.writer, out_path, out_mont, &f.p) != 0) {
+        perror(out_path);
+        fclose(in);
+        return 1;
+    }
+
+    static BigInt chunk[CONVERT_CHUNK];
+    uint8_t *raw = binary ? malloc((size_t)CONVERT_CHUNK * h.element_size) : NULL;
+    uint64_t total = 0;
+    uint64_t line_number = 0;
+    int result = 0;
+    bool invalid = false;
+    char line[1024];
+    for (;;) {
+        size_t n = 0;
+        if (binary) {
+            uint64_t remaining = h.count - total;
+            n = remaining < CONVERT_CHUNK ? remaining : CONVERT_CHUNK;
+            if (n > 0 && pread(fileno(in), raw, n * h.element_size,
+                    h.data_offset + total * h.element_size) != (ssize_t)(n * h.element_size)) {
+                result = -1;
+                break;
+            }
+            for (size_t i = 0; i < n && !invalid; i ++) {
+                // bigint_gt(a, b) is a >= b
+                if (convert_decode(raw + i * h.element_size, &h, &chunk[i]) != 0
+                    || bigint_gt(&chunk[i], &f.p)) {
+                    fprintf(stderr, "%s: element %llu is not a field element less than p\n",
+                        in_path, (unsigned long long)(total + i));
+                    invalid = true;
+                }
+            }
+        } else {
+            while (n < CONVERT_CHUNK && !invalid && fgets(line, sizeof(line), in) != NULL) {
+                line_number ++;
+                int parsed = convert_parse_line(line, &chunk[n], &f);
+                if (parsed < 0) {
+                    fprintf(stderr, "%s: line %llu: the value is not less than p\n",
+                        in_path, (unsigned long long)line_number);
+                    invalid = true;
+                }
+                n += parsed > 0;
+            }
+        }
+        if (invalid) {
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (out_mont != in_mont) {
+            for (size_t i = 0; i < n; i ++) {
+                chunk[i] = out_mont ? field_to_mont(&chunk[i], &f) : field_from_mont(&chunk[i], &f);
+            }
+        }
+        if (convert_emit(&out, chunk, n) != 0) {
+            result = -1;
+            break;
+        }
+        total += n;
+    }
+    free(raw);
+    fclose(in);
+    if (hex) {
+        result |= fclose(out.text) != 0 ? -1 : 0;
+    } else {
+        result |= fieldfile_close(&out.writer);
+    }
+    if (invalid) {
+        return 1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "I/O error\n");
+        return 1;
+    }
+    fprintf(stderr, "%llu elements, %s form, %d x %d-bit limbs\n",
+        (unsigned long long)total, out_mont ? "Montgomery" : "canonical", NUM_LIMBS, BITS_PER_LIMB);
+    return 0;
+}
+
+#ifndef CONVERT_NO_MAIN
+int main(int argc, char *argv[]) {
+    int to_mont = 0; // 1 into Montgomery form, -1 out of it
+    bool hex = false;
+    const char *p_hex = BN254_SCALAR_HEX;
+    const char *paths[2];
+    int num_paths = 0;
+    for (int i = 1; i < argc; i ++) {
+        if (strcmp(argv[i], "--mont") == 0) {
+            to_mont = 1;
+        } else if (strcmp(argv[i], "--canonical") == 0) {
+            to_mont = -1;
+        } else if (strcmp(argv[i], "--hex") == 0) {
+            hex = true;
+        } else if (strcmp(argv[i], "--p") == 0 && i + 1 < argc) {
+            p_hex = argv[++ i];
+        } else if (num_paths < 2 && argv[i][0] != '-') {
+            paths[num_paths ++] = argv[i];
+        } else {
+            num_paths = 0;
+            break;
+        }
+    }
+    if (num_paths != 2) {
+        fprintf(stderr, "usage: %s [--mont | --canonical] [--p <hex>] [--hex] <input> <output>\n", argv[0]);
+        return 2;
+    }
+    return convert_run(paths[0], paths[1], to_mont, hex, p_hex);
+}
+#endif
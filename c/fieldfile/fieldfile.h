@@ -0,0 +1,335 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// A binary file format for vectors of field elements, laid out so that the
+// element data can be mapped with mmap and handed to the kernels as a BigInt
+// array, with no parse step.
+//
+// A file is a 128-byte header followed, at data_offset, by count elements in
+// the in-memory BigInt layout of the build that wrote them (NUM_LIMBS limbs
+// of BITS_PER_LIMB bits, each in a little-endian uint64_t). data_offset is a
+// multiple of the alignment recorded in the header, FIELDFILE_ALIGN by
+// default, so the elements start on a page boundary and every BigInt is
+// naturally aligned. The header records the limb layout, and a file written
+// by an 8x32 build can't be mapped by a 4x64 build or the other way round;
+// convert it with c/fieldfile/convert.c instead.
+//
+// The streaming reader uses pread, so define _XOPEN_SOURCE 700 first if
+// anything restricts the POSIX feature level. Only little-endian hosts are
+// supported.
+//
+// Include a BigInt header before this file.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "fieldfile.h assumes a little-endian host"
+#endif
+
+#define FIELDFILE_MAGIC "MMFIELD"
+#define FIELDFILE_VERSION 1
+#define FIELDFILE_ALIGN 4096
+
+// Header flags
+#define FIELDFILE_MONTGOMERY 1 // The elements are in Montgomery form
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t num_limbs;
+    uint32_t bits_per_limb;
+    uint32_t element_size;  // Bytes per element
+    uint32_t alignment;     // data_offset is a multiple of this
+    uint64_t count;
+    uint64_t data_offset;
+    uint64_t modulus[4];    // Little-endian 64-bit words
+    uint8_t reserved[48];
+} FieldFileHeader;
+
+_Static_assert(sizeof(FieldFileHeader) == 128, "FieldFileHeader must be 128 bytes");
+
+// The modulus as four 64-bit words, whatever the limb layout.
+static inline void fieldfile_words_from_bigint(const BigInt *a, uint64_t words[4]) {
+    memset(words, 0, 4 * sizeof(uint64_t));
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        int bit = i * BITS_PER_LIMB;
+        words[bit / 64] |= a->v[i] << (bit % 64);
+        if (bit % 64 + BITS_PER_LIMB > 64 && bit / 64 + 1 < 4) {
+            words[bit / 64 + 1] |= a->v[i] >> (64 - bit % 64);
+        }
+    }
+}
+
+void fieldfile_header_init(FieldFileHeader *h, uint64_t count, bool montgomery, const BigInt *p) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, FIELDFILE_MAGIC, sizeof(FIELDFILE_MAGIC));
+    h->version = FIELDFILE_VERSION;
+    h->flags = montgomery ? FIELDFILE_MONTGOMERY : 0;
+    h->num_limbs = NUM_LIMBS;
+    h->bits_per_limb = BITS_PER_LIMB;
+    h->element_size = sizeof(BigInt);
+    h->alignment = FIELDFILE_ALIGN;
+    h->count = count;
+    h->data_offset = FIELDFILE_ALIGN;
+    fieldfile_words_from_bigint(p, h->modulus);
+}
+
+/*
+ * Checks a header read from a file of file_size bytes against this build.
+ * Returns 0 if it is usable, -2 if it isn't a valid header or the file is
+ * too short for the data it describes, -3 if the limb layout differs from
+ * this build's, or -4 if p is not NULL and differs from the file's modulus.
+ */
+int fieldfile_check_header(const FieldFileHeader *h, uint64_t file_size, const BigInt *p) {
+    if (memcmp(h->magic, FIELDFILE_MAGIC, sizeof(FIELDFILE_MAGIC)) != 0
+        || h->version != FIELDFILE_VERSION
+        || h->alignment == 0 || h->data_offset % h->alignment != 0
+        || h->data_offset < sizeof(FieldFileHeader)
+        || h->element_size == 0) {
+        return -2;
+    }
+    if (h->data_offset > file_size || h->count > (file_size - h->data_offset) / h->element_size) {
+        return -2;
+    }
+    if (h->num_limbs != NUM_LIMBS || h->bits_per_limb != BITS_PER_LIMB
+        || h->element_size != sizeof(BigInt)) {
+        return -3;
+    }
+    if (p != NULL) {
+        uint64_t words[4];
+        fieldfile_words_from_bigint(p, words);
+        if (memcmp(words, h->modulus, sizeof(words)) != 0) {
+            return -4;
+        }
+    }
+    return 0;
+}
+
+static int fieldfile_write_all(int fd, const void *buf, size_t bytes) {
+    const uint8_t *ptr = buf;
+    while (bytes > 0) {
+        ssize_t n = write(fd, ptr, bytes);
+        if (n <= 0) {
+            return -1;
+        }
+        ptr += n;
+        bytes -= n;
+    }
+    return 0;
+}
+
+// Writes elements to a new file one batch at a time, so that a file can be
+// larger than memory.
+typedef struct {
+    int fd;
+    FieldFileHeader header;
+} FieldFileWriter;
+
+/*
+ * Creates or truncates the file at path and writes an empty header. p is the
+ * modulus to record. Returns 0 on success, or -1 on an I/O error.
+ */
+int fieldfile_create(FieldFileWriter *w, const char *path, bool montgomery, const BigInt *p) {
+    fieldfile_header_init(&w->header, 0, montgomery, p);
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) {
+        return -1;
+    }
+    uint8_t *first_page = calloc(1, w->header.data_offset);
+    if (first_page == NULL) {
+        close(w->fd);
+        return -1;
+    }
+    int result = fieldfile_write_all(w->fd, first_page, w->header.data_offset);
+    free(first_page);
+    if (result != 0) {
+        close(w->fd);
+    }
+    return result;
+}
+
+// Appends count elements. Returns 0 on success, or -1 on an I/O error.
+int fieldfile_append(FieldFileWriter *w, const BigInt *elems, size_t count) {
+    if (fieldfile_write_all(w->fd, elems, count * sizeof(BigInt)) != 0) {
+        return -1;
+    }
+    w->header.count += count;
+    return 0;
+}
+
+// Writes the final header and closes the file. Returns 0 on success, or -1
+// on an I/O error.
+int fieldfile_close(FieldFileWriter *w) {
+    int result = 0;
+    if (lseek(w->fd, 0, SEEK_SET) != 0
+        || fieldfile_write_all(w->fd, &w->header, sizeof(w->header)) != 0) {
+        result = -1;
+    }
+    if (close(w->fd) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+/*
+ * Writes count elements to the file at path in one go. Returns 0 on success,
+ * or -1 on an I/O error.
+ */
+int fieldfile_write(const char *path, const BigInt *elems, size_t count, bool montgomery, const BigInt *p) {
+    FieldFileWriter w;
+    if (fieldfile_create(&w, path, montgomery, p) != 0) {
+        return -1;
+    }
+    int result = fieldfile_append(&w, elems, count);
+    if (fieldfile_close(&w) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+// A file mapped into memory. elems points straight into the mapping.
+typedef struct {
+    FieldFileHeader header;
+    const BigInt *elems;
+    void *base;
+    size_t length;
+} FieldFileMap;
+
+/*
+ * Maps the file at path read-only. If p is not NULL, the file's modulus
+ * must match it. Returns 0 on success, -1 if the file could not be opened
+ * or mapped, or an error code of fieldfile_check_header.
+ */
+int fieldfile_map(FieldFileMap *m, const char *path, const BigInt *p) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if ((uint64_t)st.st_size < sizeof(FieldFileHeader)) {
+        close(fd);
+        return -2;
+    }
+    m->length = st.st_size;
+    m->base = mmap(NULL, m->length, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file open.
+    close(fd);
+    if (m->base == MAP_FAILED) {
+        m->base = NULL;
+        return -1;
+    }
+    memcpy(&m->header, m->base, sizeof(m->header));
+    int result = fieldfile_check_header(&m->header, m->length, p);
+    if (result != 0) {
+        munmap(m->base, m->length);
+        m->base = NULL;
+        return result;
+    }
+    m->elems = (const BigInt *)((uint8_t *)m->base + m->header.data_offset);
+    return 0;
+}
+
+void fieldfile_unmap(FieldFileMap *m) {
+    if (m->base != NULL) {
+        munmap(m->base, m->length);
+    }
+    m->base = NULL;
+    m->elems = NULL;
+}
+
+// Reads a file sequentially in chunks through one aligned buffer, for files
+// too large to map in full on a 32-bit host or to keep in the page cache.
+// Pages that have been read are dropped from the cache as it goes.
+typedef struct {
+    int fd;
+    FieldFileHeader header;
+    BigInt *buf;
+    size_t chunk;  // Elements per read
+    uint64_t next; // Index of the next element to read
+} FieldFileReader;
+
+/*
+ * Opens the file at path for reading chunk elements at a time. If p is not
+ * NULL, the file's modulus must match it. Returns 0 on success, -1 if the
+ * file could not be opened or read or the buffer could not be allocated, or
+ * an error code of fieldfile_check_header.
+ */
+int fieldfile_reader_open(FieldFileReader *r, const char *path, size_t chunk, const BigInt *p) {
+    if (chunk == 0) {
+        return -1;
+    }
+    r->fd = open(path, O_RDONLY);
+    if (r->fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    int result = 0;
+    if (fstat(r->fd, &st) != 0
+        || pread(r->fd, &r->header, sizeof(r->header), 0) != sizeof(r->header)) {
+        result = -1;
+    } else {
+        result = fieldfile_check_header(&r->header, st.st_size, p);
+    }
+    if (result == 0) {
+        r->chunk = chunk;
+        r->next = 0;
+        r->buf = aligned_alloc(64, (chunk * sizeof(BigInt) + 63) / 64 * 64);
+        if (r->buf == NULL) {
+            result = -1;
+        }
+    }
+    if (result != 0) {
+        close(r->fd);
+        return result;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(r->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return 0;
+}
+
+/*
+ * Reads the next chunk and points *elems at it. Returns the number of
+ * elements read, which is less than the chunk size only at the end of the
+ * file, and 0 once there are none left. *elems is valid until the next call.
+ * Returns -1 on an I/O error.
+ */
+long fieldfile_reader_next(FieldFileReader *r, const BigInt **elems) {
+    uint64_t remaining = r->header.count - r->next;
+    size_t n = remaining < r->chunk ? remaining : r->chunk;
+    if (n == 0) {
+        return 0;
+    }
+    uint64_t offset = r->header.data_offset + r->next * sizeof(BigInt);
+    size_t bytes = n * sizeof(BigInt);
+    uint8_t *dst = (uint8_t *)r->buf;
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t got = pread(r->fd, dst + done, bytes - done, offset + done);
+        if (got <= 0) {
+            return -1;
+        }
+        done += got;
+    }
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise(r->fd, offset, bytes, POSIX_FADV_DONTNEED);
+#endif
+    r->next += n;
+    *elems = r->buf;
+    return (long)n;
+}
+
+void fieldfile_reader_close(FieldFileReader *r) {
+    close(r->fd);
+    free(r->buf);
+    r->buf = NULL;
+}
@@ -0,0 +1,471 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "mpmc.h"
+
+// An asynchronous job queue for Montgomery batch work. Application threads
+// submit multiplication or hashing jobs without blocking, and a few worker
+// threads run them. Link with -pthread.
+//
+// Include c/field.h and a Montgomery multiplication kernel before this file.
+// Hash jobs are available if c/poseidon/poseidon.h has been included, and
+// multiplications use the four-lane kernel if c/multibuf/mont_x4.h has been
+// included (8x32 limbs only).
+//
+// Submission goes through a lock-free MPMC queue (mpmc.h). Workers take a
+// batch of jobs at a time and regroup their elements into groups of
+// JOB_LANES, so that many small jobs still fill every lane of the vertical
+// SIMD kernels. If the jobs in the queue don't fill a whole number of groups,
+// a worker waits up to batch_delay_ns for more to arrive: a longer delay
+// means fuller groups but higher latency, and the latency histogram shows
+// the cost.
+//
+// Locks are only taken to put idle workers to sleep and to wake threads
+// blocked in job_wait.
+//
+// All field elements are in Montgomery form.
+
+#define JOB_LANES 4
+#define JOB_MAX_BATCH 32
+#define JOB_MAX_WORKERS 16
+
+// Latency histogram bucket 0 counts jobs under 1 us, and bucket k > 0 counts
+// jobs that took [2^(k - 1), 2^k) us.
+#define JOB_HIST_BUCKETS 32
+
+// Polls before job_wait goes to sleep
+#define JOB_WAIT_SPINS 1000
+
+typedef enum {
+    JOB_MUL,  // out[i] = a[i] * b[i] for i < count
+    JOB_HASH, // out[i] = poseidon(a[i * (t - 1)], ..., a[i * (t - 1) + t - 2])
+} JobType;
+
+typedef struct Job Job;
+
+// Called on a worker thread when the job's outputs are ready, before
+// job_done returns true. Must not free the job.
+typedef void (*JobCallback)(Job *job, void *arg);
+
+struct Job {
+    JobType type;
+    size_t count;
+    BigInt *a;
+    BigInt *b;
+    BigInt *out;
+    JobCallback callback;
+    void *callback_arg;
+
+    uint64_t submit_ns;
+    _Atomic bool done;
+};
+
+typedef struct {
+    MpmcQueue queue;
+    MontField *f;
+#ifdef POSEIDON_MAX_T
+    PoseidonParams *params;
+#endif
+#ifdef MONT_MUL_X4_AVAILABLE
+    BigIntX4 p_x4;
+    uint64_t n0_x4; // field_redc_n0(f), which is not f->n0 for BM17
+#endif
+    uint64_t batch_delay_ns;
+
+    int num_workers;
+    pthread_t threads[JOB_MAX_WORKERS];
+    pthread_mutex_t lock;
+    pthread_cond_t wake; // a job was submitted
+    pthread_cond_t done; // a job finished
+    _Atomic int sleepers; // workers waiting on wake
+    _Atomic int waiters;  // threads waiting on done
+    _Atomic bool stop;
+
+    // Statistics
+    _Atomic uint64_t latency_hist[JOB_HIST_BUCKETS];
+    _Atomic uint64_t jobs_done;
+    _Atomic uint64_t batches;
+    _Atomic uint64_t lane_groups;
+    _Atomic uint64_t lanes_used;
+} JobQueue;
+
+static inline uint64_t job_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void job_mul_init(Job *job, BigInt *out, BigInt *a, BigInt *b, size_t count, JobCallback callback, void *arg) {
+    job->type = JOB_MUL;
+    job->count = count;
+    job->a = a;
+    job->b = b;
+    job->out = out;
+    job->callback = callback;
+    job->callback_arg = arg;
+    atomic_init(&job->done, false);
+}
+
+#ifdef POSEIDON_MAX_T
+/// Hashes count groups of t - 1 inputs, where t is the width of the queue's
+/// Poseidon instance.
+void job_hash_init(Job *job, BigInt *out, BigInt *inputs, size_t count, JobCallback callback, void *arg) {
+    job->type = JOB_HASH;
+    job->count = count;
+    job->a = inputs;
+    job->b = NULL;
+    job->out = out;
+    job->callback = callback;
+    job->callback_arg = arg;
+    atomic_init(&job->done, false);
+}
+#endif
+
+// One element of a job, placed in a lane group
+typedef struct {
+    Job *job;
+    size_t i;
+} JobLane;
+
+static void job_mul_lanes(JobQueue *q, JobLane *lanes, int k) {
+    atomic_fetch_add_explicit(&q->lane_groups, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->lanes_used, k, memory_order_relaxed);
+#ifdef MONT_MUL_X4_AVAILABLE
+    if (k == 4) {
+        BigInt a[4], b[4], out[4];
+        for (int j = 0; j < 4; j ++) {
+            a[j] = lanes[j].job->a[lanes[j].i];
+            b[j] = lanes[j].job->b[lanes[j].i];
+        }
+        BigIntX4 ar = bigint_x4_pack(a);
+        BigIntX4 br = bigint_x4_pack(b);
+        BigIntX4 res = mont_mul_x4(&ar, &br, &q->p_x4, q->n0_x4);
+        bigint_x4_unpack(&res, out);
+        for (int j = 0; j < 4; j ++) {
+            lanes[j].job->out[lanes[j].i] = out[j];
+        }
+        return;
+    }
+#endif
+    for (int j = 0; j < k; j ++) {
+        Job *job = lanes[j].job;
+        size_t i = lanes[j].i;
+        job->out[i] = field_mul(&job->a[i], &job->b[i], q->f);
+    }
+}
+
+#ifdef POSEIDON_MAX_T
+static void job_hash_lanes(JobQueue *q, JobLane *lanes, int k) {
+    atomic_fetch_add_explicit(&q->lane_groups, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->lanes_used, k, memory_order_relaxed);
+    int t = q->params->t;
+    BigInt states[JOB_LANES * POSEIDON_MAX_T];
+    for (int j = 0; j < k; j ++) {
+        BigInt *inputs = &lanes[j].job->a[lanes[j].i * (t - 1)];
+        states[j * t] = bigint_new();
+        for (int s = 1; s < t; s ++) {
+            states[j * t + s] = inputs[s - 1];
+        }
+    }
+    poseidon_permute_batch(states, k, q->params, q->f);
+    for (int j = 0; j < k; j ++) {
+        lanes[j].job->out[lanes[j].i] = states[j * t];
+    }
+}
+#endif
+
+static void job_record_latency(JobQueue *q, uint64_t ns) {
+    uint64_t us = ns / 1000;
+    int bucket = us == 0 ? 0 : 64 - __builtin_clzll(us);
+    if (bucket >= JOB_HIST_BUCKETS) {
+        bucket = JOB_HIST_BUCKETS - 1;
+    }
+    atomic_fetch_add_explicit(&q->latency_hist[bucket], 1, memory_order_relaxed);
+}
+
+/*
+ * Runs a batch of jobs: first every multiplication, in groups of JOB_LANES
+ * elements across job boundaries, then every hash, then the completions.
+ */
+static void job_run_batch(JobQueue *q, Job **jobs, int n) {
+    JobLane lanes[JOB_LANES];
+    int k = 0;
+    for (int j = 0; j < n; j ++) {
+        if (jobs[j]->type != JOB_MUL) continue;
+        for (size_t i = 0; i < jobs[j]->count; i ++) {
+            lanes[k].job = jobs[j];
+            lanes[k].i = i;
+            if (++ k == JOB_LANES) {
+                job_mul_lanes(q, lanes, k);
+                k = 0;
+            }
+        }
+    }
+    if (k > 0) {
+        job_mul_lanes(q, lanes, k);
+        k = 0;
+    }
+
+#ifdef POSEIDON_MAX_T
+    for (int j = 0; j < n; j ++) {
+        if (jobs[j]->type != JOB_HASH) continue;
+        for (size_t i = 0; i < jobs[j]->count; i ++) {
+            lanes[k].job = jobs[j];
+            lanes[k].i = i;
+            if (++ k == JOB_LANES) {
+                job_hash_lanes(q, lanes, k);
+                k = 0;
+            }
+        }
+    }
+    if (k > 0) {
+        job_hash_lanes(q, lanes, k);
+    }
+#endif
+
+    uint64_t now = job_now_ns();
+    for (int j = 0; j < n; j ++) {
+        job_record_latency(q, now - jobs[j]->submit_ns);
+        if (jobs[j]->callback != NULL) {
+            jobs[j]->callback(jobs[j], jobs[j]->callback_arg);
+        }
+        atomic_store_explicit(&jobs[j]->done, true, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&q->jobs_done, n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&q->batches, 1, memory_order_relaxed);
+
+    // Pairs with the fence in job_wait: either the waiter sees done, or
+    // this sees the waiter.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&q->waiters, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&q->lock);
+        pthread_cond_broadcast(&q->done);
+        pthread_mutex_unlock(&q->lock);
+    }
+}
+
+/*
+ * Returns the next job, sleeping while the queue is empty, or NULL once the
+ * queue has been stopped and drained.
+ */
+static Job *job_next(JobQueue *q) {
+    void *data;
+    for (;;) {
+        if (mpmc_dequeue(&q->queue, &data)) {
+            return data;
+        }
+        if (atomic_load(&q->stop)) {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&q->lock);
+        atomic_fetch_add(&q->sleepers, 1);
+        // Pairs with the fence in job_submit: either this sees the job, or
+        // the submitter sees a sleeper and signals once we are waiting.
+        atomic_thread_fence(memory_order_seq_cst);
+        bool found = mpmc_dequeue(&q->queue, &data);
+        if (!found && !atomic_load(&q->stop)) {
+            pthread_cond_wait(&q->wake, &q->lock);
+        }
+        atomic_fetch_sub(&q->sleepers, 1);
+        pthread_mutex_unlock(&q->lock);
+        if (found) {
+            return data;
+        }
+    }
+}
+
+static void *job_worker(void *arg) {
+    JobQueue *q = arg;
+    Job *batch[JOB_MAX_BATCH];
+    for (;;) {
+        Job *first = job_next(q);
+        if (first == NULL) {
+            return NULL;
+        }
+        batch[0] = first;
+        int n = 1;
+        // Elements per job type, which are grouped separately
+        size_t units[2] = {0, 0};
+        units[first->type] += first->count;
+
+        // Top up the batch with whatever is already queued, and wait up to
+        // the batching delay while the lane groups are only partly full.
+        uint64_t deadline = q->batch_delay_ns == 0 ? 0 : job_now_ns() + q->batch_delay_ns;
+        while (n < JOB_MAX_BATCH) {
+            void *data;
+            if (mpmc_dequeue(&q->queue, &data)) {
+                Job *job = data;
+                batch[n ++] = job;
+                units[job->type] += job->count;
+                continue;
+            }
+            bool full = units[JOB_MUL] % JOB_LANES == 0 && units[JOB_HASH] % JOB_LANES == 0;
+            if (full || deadline == 0 || job_now_ns() >= deadline) {
+                break;
+            }
+            sched_yield();
+        }
+        job_run_batch(q, batch, n);
+    }
+}
+
+/*
+ * Starts num_workers worker threads. queue_size (a power of two) is the most
+ * jobs that can be waiting at once. Returns 0 on success, -1 on bad
+ * arguments, -2 if the allocation failed, or -3 if no worker thread could be
+ * started. If only some threads can't be started, the queue runs with fewer
+ * workers.
+ */
+int job_queue_init(
+    JobQueue *q,
+    int num_workers,
+    size_t queue_size,
+    uint64_t batch_delay_ns,
+    MontField *f
+#ifdef POSEIDON_MAX_T
+    , PoseidonParams *params
+#endif
+) {
+    if (num_workers < 1 || num_workers > JOB_MAX_WORKERS) {
+        return -1;
+    }
+    int result = mpmc_init(&q->queue, queue_size);
+    if (result != 0) {
+        return result;
+    }
+    q->f = f;
+#ifdef POSEIDON_MAX_T
+    q->params = params;
+#endif
+#ifdef MONT_MUL_X4_AVAILABLE
+    q->p_x4 = bigint_x4_splat(&f->p);
+    q->n0_x4 = field_redc_n0(f);
+#endif
+    q->batch_delay_ns = batch_delay_ns;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->wake, NULL);
+    pthread_cond_init(&q->done, NULL);
+    atomic_init(&q->sleepers, 0);
+    atomic_init(&q->waiters, 0);
+    atomic_init(&q->stop, false);
+    for (int i = 0; i < JOB_HIST_BUCKETS; i ++) {
+        atomic_init(&q->latency_hist[i], 0);
+    }
+    atomic_init(&q->jobs_done, 0);
+    atomic_init(&q->batches, 0);
+    atomic_init(&q->lane_groups, 0);
+    atomic_init(&q->lanes_used, 0);
+
+    q->num_workers = 0;
+    for (int i = 0; i < num_workers; i ++) {
+        if (pthread_create(&q->threads[i], NULL, job_worker, q) != 0) {
+            break;
+        }
+        q->num_workers ++;
+    }
+    if (q->num_workers == 0) {
+        pthread_cond_destroy(&q->done);
+        pthread_cond_destroy(&q->wake);
+        pthread_mutex_destroy(&q->lock);
+        mpmc_free(&q->queue);
+        return -3;
+    }
+    return 0;
+}
+
+/*
+ * Finishes every queued job, then stops the workers and frees the queue.
+ */
+void job_queue_destroy(JobQueue *q) {
+    pthread_mutex_lock(&q->lock);
+    atomic_store(&q->stop, true);
+    pthread_cond_broadcast(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+    for (int i = 0; i < q->num_workers; i ++) {
+        pthread_join(q->threads[i], NULL);
+    }
+    pthread_cond_destroy(&q->done);
+    pthread_cond_destroy(&q->wake);
+    pthread_mutex_destroy(&q->lock);
+    mpmc_free(&q->queue);
+}
+
+/*
+ * Queues a job without blocking. The job, its inputs and its outputs must
+ * stay valid until job_done returns true. Returns 0 on success, or -1 if
+ * the queue is full.
+ */
+int job_submit(JobQueue *q, Job *job) {
+    job->submit_ns = job_now_ns();
+    atomic_store_explicit(&job->done, false, memory_order_relaxed);
+    if (!mpmc_enqueue(&q->queue, job)) {
+        return -1;
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&q->sleepers, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&q->lock);
+        pthread_cond_signal(&q->wake);
+        pthread_mutex_unlock(&q->lock);
+    }
+    return 0;
+}
+
+/// Returns whether the job has finished (and its callback has returned),
+/// without blocking.
+static inline bool job_done(Job *job) {
+    return atomic_load_explicit(&job->done, memory_order_acquire);
+}
+
+/// Blocks until the job has finished.
+void job_wait(JobQueue *q, Job *job) {
+    for (int i = 0; i < JOB_WAIT_SPINS; i ++) {
+        if (job_done(job)) {
+            return;
+        }
+    }
+    pthread_mutex_lock(&q->lock);
+    atomic_fetch_add(&q->waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (!job_done(job)) {
+        pthread_cond_wait(&q->done, &q->lock);
+    }
+    atomic_fetch_sub(&q->waiters, 1);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/*
+ * Returns the upper bound, in microseconds, of the latency histogram bucket
+ * that contains the given percentile (0 to 100) of jobs finished so far.
+ */
+uint64_t job_latency_percentile(JobQueue *q, double percentile) {
+    uint64_t total = 0;
+    uint64_t counts[JOB_HIST_BUCKETS];
+    for (int i = 0; i < JOB_HIST_BUCKETS; i ++) {
+        counts[i] = atomic_load_explicit(&q->latency_hist[i], memory_order_relaxed);
+        total += counts[i];
+    }
+    uint64_t target = (uint64_t)(total * percentile / 100);
+    uint64_t seen = 0;
+    for (int i = 0; i < JOB_HIST_BUCKETS; i ++) {
+        seen += counts[i];
+        if (seen > target || seen == total) {
+            return (uint64_t)1 << i;
+        }
+    }
+    return (uint64_t)1 << (JOB_HIST_BUCKETS - 1);
+}
+
+void job_queue_reset_stats(JobQueue *q) {
+    for (int i = 0; i < JOB_HIST_BUCKETS; i ++) {
+        atomic_store(&q->latency_hist[i], 0);
+    }
+    atomic_store(&q->jobs_done, 0);
+    atomic_store(&q->batches, 0);
+    atomic_store(&q->lane_groups, 0);
+    atomic_store(&q->lanes_used, 0);
+}
@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+// A bounded lock-free multi-producer, multi-consumer queue of pointers.
+//
+// Dmitry Vyukov. Bounded MPMC queue.
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// Each cell carries a sequence number that says whether it is ready to be
+// written (seq == pos) or read (seq == pos + 1) on the current lap, so
+// producers and consumers only contend on their own position counter and
+// the cell they claim.
+
+typedef struct {
+    _Atomic size_t seq;
+    void *data;
+} MpmcCell;
+
+typedef struct {
+    MpmcCell *cells;
+    size_t mask;
+    _Alignas(64) _Atomic size_t enqueue_pos;
+    _Alignas(64) _Atomic size_t dequeue_pos;
+} MpmcQueue;
+
+/*
+ * Allocates a queue with room for capacity pointers, which must be a power
+ * of two. Returns 0 on success, -1 if capacity is not a power of two, or -2
+ * if the allocation failed.
+ */
+int mpmc_init(MpmcQueue *q, size_t capacity) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    q->cells = aligned_alloc(64, (capacity * sizeof(MpmcCell) + 63) / 64 * 64);
+    if (q->cells == NULL) {
+        return -2;
+    }
+    q->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i ++) {
+        atomic_init(&q->cells[i].seq, i);
+        q->cells[i].data = NULL;
+    }
+    atomic_init(&q->enqueue_pos, 0);
+    atomic_init(&q->dequeue_pos, 0);
+    return 0;
+}
+
+void mpmc_free(MpmcQueue *q) {
+    free(q->cells);
+    q->cells = NULL;
+}
+
+/*
+ * Adds data to the queue. Returns false if the queue is full.
+ */
+bool mpmc_enqueue(MpmcQueue *q, void *data) {
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell *cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                &q->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                cell->data = data;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return true;
+            }
+            // pos now holds the current value; try again.
+        } else if (diff < 0) {
+            // The cell still holds an element from the previous lap.
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/*
+ * Removes the oldest element into *data. Returns false if the queue is
+ * empty.
+ */
+bool mpmc_dequeue(MpmcQueue *q, void **data) {
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell *cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                &q->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *data = cell->data;
+                atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
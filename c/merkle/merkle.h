@@ -0,0 +1,345 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Binary Poseidon Merkle trees over the BN254 scalar field, built level by
+// level with a pool of POSIX threads. Each node is poseidon([left, right])
+// with the circomlib t = 3 instance, so roots match circomlib's.
+// Include c/poseidon/poseidon.h and its prerequisites before this file, and
+// link with -pthread. The streaming builder uses pwrite, so define
+// _XOPEN_SOURCE 700 first if anything restricts the POSIX feature level.
+//
+// All levels live in one 64-byte-aligned buffer, leaves first and the root
+// last. Each level starts on a cache line, and threads claim nodes in chunks
+// that are a whole number of cache lines, so no two threads write to the
+// same line.
+//
+// The levels near the root have too few nodes to split between threads, so
+// once a level has fewer than MERKLE_PARALLEL_MIN nodes per thread, thread 0
+// finishes the tree on its own and the others exit instead of waiting on a
+// barrier at every level.
+//
+// All field elements are in Montgomery form.
+
+#define MERKLE_MAX_DEPTH 40
+#define MERKLE_MAX_THREADS 64
+#define MERKLE_ALIGN 64
+
+// The number of nodes hashed side by side by poseidon_permute_batch.
+#ifndef MERKLE_BATCH
+#define MERKLE_BATCH 4
+#endif
+
+// The most nodes a thread claims at a time. Smaller levels are split into
+// smaller chunks so that every thread gets some.
+#ifndef MERKLE_CHUNK
+#define MERKLE_CHUNK 64
+#endif
+
+// The fewest nodes per thread worth hashing in parallel.
+#ifndef MERKLE_PARALLEL_MIN
+#define MERKLE_PARALLEL_MIN 8
+#endif
+
+typedef struct {
+    int depth;
+    size_t num_leaves;
+    // Level l (0 = leaves) starts at nodes[offsets[l]] and has
+    // num_leaves >> l nodes.
+    size_t offsets[MERKLE_MAX_DEPTH + 1];
+    size_t num_nodes; // including the padding between levels
+    BigInt *nodes;
+} MerkleTree;
+
+static inline size_t merkle_nodes_per_line(void) {
+    return sizeof(BigInt) >= MERKLE_ALIGN ? 1 : MERKLE_ALIGN / sizeof(BigInt);
+}
+
+/*
+ * Computes the level offsets of a tree of the given depth. Each level is
+ * padded to a whole number of cache lines. Returns the total number of
+ * nodes, including padding.
+ */
+static size_t merkle_layout(int depth, size_t *offsets) {
+    size_t per_line = merkle_nodes_per_line();
+    size_t offset = 0;
+    for (int l = 0; l <= depth; l ++) {
+        offsets[l] = offset;
+        size_t n = ((size_t)1 << depth) >> l;
+        offset += (n + per_line - 1) / per_line * per_line;
+    }
+    return offset;
+}
+
+/*
+ * Allocates a tree with 2^depth leaves. Returns 0 on success, -1 if depth is
+ * out of range, or -2 if the allocation failed.
+ */
+int merkle_tree_init(MerkleTree *tree, int depth) {
+    if (depth < 0 || depth > MERKLE_MAX_DEPTH) {
+        return -1;
+    }
+    tree->depth = depth;
+    tree->num_leaves = (size_t)1 << depth;
+    tree->num_nodes = merkle_layout(depth, tree->offsets);
+
+    size_t bytes = tree->num_nodes * sizeof(BigInt);
+    bytes = (bytes + MERKLE_ALIGN - 1) / MERKLE_ALIGN * MERKLE_ALIGN;
+    tree->nodes = aligned_alloc(MERKLE_ALIGN, bytes);
+    if (tree->nodes == NULL) {
+        return -2;
+    }
+    return 0;
+}
+
+void merkle_tree_free(MerkleTree *tree) {
+    free(tree->nodes);
+    tree->nodes = NULL;
+}
+
+static inline BigInt *merkle_level(MerkleTree *tree, int level) {
+    return &tree->nodes[tree->offsets[level]];
+}
+
+static inline BigInt *merkle_leaves(MerkleTree *tree) {
+    return merkle_level(tree, 0);
+}
+
+static inline BigInt merkle_root(MerkleTree *tree) {
+    return *merkle_level(tree, tree->depth);
+}
+
+/*
+ * Hashes the children of nodes [start, end) of the level above `children`.
+ */
+static void merkle_hash_range(
+    BigInt *children,
+    BigInt *parents,
+    size_t start,
+    size_t end,
+    PoseidonParams *params,
+    MontField *f
+) {
+    BigInt states[MERKLE_BATCH * 3];
+    size_t i = start;
+    while (i < end) {
+        int count = end - i < MERKLE_BATCH ? (int)(end - i) : MERKLE_BATCH;
+        for (int j = 0; j < count; j ++) {
+            states[j * 3] = bigint_new();
+            states[j * 3 + 1] = children[2 * (i + j)];
+            states[j * 3 + 2] = children[2 * (i + j) + 1];
+        }
+        poseidon_permute_batch(states, count, params, f);
+        for (int j = 0; j < count; j ++) {
+            parents[i + j] = states[j * 3];
+        }
+        i += count;
+    }
+}
+
+typedef struct {
+    MerkleTree *tree;
+    PoseidonParams *params;
+    MontField *f;
+    int num_threads;
+    int parallel_levels; // levels 1..parallel_levels are built in parallel
+    pthread_mutex_t start; // held until all threads have been started
+    pthread_barrier_t barrier;
+    atomic_size_t next[MERKLE_MAX_DEPTH + 1];
+} MerkleJob;
+
+typedef struct {
+    MerkleJob *job;
+    int id;
+} MerkleWorker;
+
+static void *merkle_worker(void *arg) {
+    MerkleWorker *worker = arg;
+    MerkleJob *job = worker->job;
+    MerkleTree *tree = job->tree;
+
+    pthread_mutex_lock(&job->start);
+    pthread_mutex_unlock(&job->start);
+
+    for (int l = 1; l <= job->parallel_levels; l ++) {
+        BigInt *children = merkle_level(tree, l - 1);
+        BigInt *parents = merkle_level(tree, l);
+        size_t n = tree->num_leaves >> l;
+        size_t per_line = merkle_nodes_per_line();
+        size_t chunk = n / job->num_threads / per_line * per_line;
+        chunk = chunk < per_line ? per_line : chunk > MERKLE_CHUNK ? MERKLE_CHUNK : chunk;
+        for (;;) {
+            size_t start = atomic_fetch_add(&job->next[l], chunk);
+            if (start >= n) {
+                break;
+            }
+            size_t end = start + chunk < n ? start + chunk : n;
+            merkle_hash_range(children, parents, start, end, job->params, job->f);
+        }
+        pthread_barrier_wait(&job->barrier);
+    }
+
+    if (worker->id == 0) {
+        for (int l = job->parallel_levels + 1; l <= tree->depth; l ++) {
+            size_t n = tree->num_leaves >> l;
+            merkle_hash_range(merkle_level(tree, l - 1), merkle_level(tree, l), 0, n, job->params, job->f);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Computes every internal node of a tree whose leaves have been filled in,
+ * with num_threads threads (including the calling thread). params must be
+ * the t = 3 instance. Returns 0 on success, or -1 on bad arguments.
+ */
+int merkle_build(MerkleTree *tree, int num_threads, PoseidonParams *params, MontField *f) {
+    if (params->t != 3 || num_threads < 1 || num_threads > MERKLE_MAX_THREADS) {
+        return -1;
+    }
+
+    MerkleJob job;
+    job.tree = tree;
+    job.params = params;
+    job.f = f;
+    job.parallel_levels = 0;
+    while (
+        job.parallel_levels < tree->depth &&
+        (tree->num_leaves >> (job.parallel_levels + 1)) >= (size_t)num_threads * MERKLE_PARALLEL_MIN
+    ) {
+        job.parallel_levels ++;
+    }
+    // No point starting threads that would have nothing to do
+    if (job.parallel_levels == 0) {
+        num_threads = 1;
+    }
+    for (int l = 0; l <= MERKLE_MAX_DEPTH; l ++) {
+        atomic_init(&job.next[l], 0);
+    }
+
+    // If a thread can't be started, carry on with the ones that were: nodes
+    // are claimed dynamically, so the work still gets done.
+    pthread_t threads[MERKLE_MAX_THREADS];
+    MerkleWorker workers[MERKLE_MAX_THREADS];
+    pthread_mutex_init(&job.start, NULL);
+    pthread_mutex_lock(&job.start);
+    int started = 1;
+    for (int i = 0; i < num_threads; i ++) {
+        workers[i].job = &job;
+        workers[i].id = i;
+    }
+    for (int i = 1; i < num_threads; i ++) {
+        if (pthread_create(&threads[i], NULL, merkle_worker, &workers[i]) != 0) {
+            break;
+        }
+        started ++;
+    }
+    job.num_threads = started;
+    pthread_barrier_init(&job.barrier, NULL, started);
+    pthread_mutex_unlock(&job.start);
+
+    merkle_worker(&workers[0]);
+    for (int i = 1; i < started; i ++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_barrier_destroy(&job.barrier);
+    pthread_mutex_destroy(&job.start);
+    return 0;
+}
+
+// Fills leaves[0..count - 1] with leaves first..first + count - 1. Returns 0
+// on success, or non-zero to abort the build.
+typedef int (*MerkleLeafSource)(BigInt *leaves, size_t first, size_t count, void *ctx);
+
+/*
+ * Builds a tree of the given depth that may not fit in memory, by building
+ * 2^(depth - chunk_depth) subtrees of depth chunk_depth one after another and
+ * then the tree above their roots. Only one subtree is held in memory at a
+ * time.
+ *
+ * If fd is not -1, every node is written to it with the same layout as a
+ * MerkleTree of the full depth, so that the file can be mapped and read with
+ * the offsets from merkle_layout.
+ *
+ * Returns 0 on success, -1 on bad arguments, -2 if an allocation failed, -3
+ * if a write failed, or -4 if the leaf source failed.
+ */
+int merkle_build_streaming(
+    BigInt *root,
+    int depth,
+    int chunk_depth,
+    MerkleLeafSource source,
+    void *ctx,
+    int fd,
+    int num_threads,
+    PoseidonParams *params,
+    MontField *f
+) {
+    if (depth < 0 || depth > MERKLE_MAX_DEPTH || chunk_depth < 0 || chunk_depth > depth) {
+        return -1;
+    }
+
+    size_t offsets[MERKLE_MAX_DEPTH + 1];
+    merkle_layout(depth, offsets);
+    int top_depth = depth - chunk_depth;
+    size_t num_chunks = (size_t)1 << top_depth;
+
+    MerkleTree chunk, top;
+    int result = merkle_tree_init(&chunk, chunk_depth);
+    if (result != 0) {
+        return result;
+    }
+    result = merkle_tree_init(&top, top_depth);
+    if (result != 0) {
+        merkle_tree_free(&chunk);
+        return result;
+    }
+
+    for (size_t c = 0; c < num_chunks && result == 0; c ++) {
+        if (source(merkle_leaves(&chunk), c * chunk.num_leaves, chunk.num_leaves, ctx) != 0) {
+            result = -4;
+            break;
+        }
+        result = merkle_build(&chunk, num_threads, params, f);
+        if (result != 0) {
+            break;
+        }
+        merkle_leaves(&top)[c] = merkle_root(&chunk);
+
+        // The subtree's nodes on level l are contiguous in the full tree,
+        // starting at node c * 2^(chunk_depth - l) of that level.
+        for (int l = 0; l <= chunk_depth && fd != -1; l ++) {
+            size_t n = chunk.num_leaves >> l;
+            size_t bytes = n * sizeof(BigInt);
+            off_t pos = (offsets[l] + c * n) * sizeof(BigInt);
+            if (pwrite(fd, merkle_level(&chunk, l), bytes, pos) != (ssize_t)bytes) {
+                result = -3;
+                break;
+            }
+        }
+    }
+
+    if (result == 0) {
+        result = merkle_build(&top, num_threads, params, f);
+    }
+    // Level 0 of the top tree holds the subtree roots, which were written
+    // with the subtrees.
+    for (int l = 1; l <= top_depth && fd != -1 && result == 0; l ++) {
+        size_t bytes = (top.num_leaves >> l) * sizeof(BigInt);
+        off_t pos = offsets[chunk_depth + l] * sizeof(BigInt);
+        if (pwrite(fd, merkle_level(&top, l), bytes, pos) != (ssize_t)bytes) {
+            result = -3;
+        }
+    }
+    if (result == 0) {
+        *root = merkle_root(&top);
+    }
+
+    merkle_tree_free(&chunk);
+    merkle_tree_free(&top);
+    return result;
+}
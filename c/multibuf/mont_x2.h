@@ -0,0 +1,157 @@
+#include "../simd/simd.h"
+#include "../addchain/chain.h"
+
+// Two independent BM17 Montgomery multiplications, interleaved. Each product
+// occupies both lanes of its own 32x2 vectors ("horizontal" SIMD: one lane
+// accumulates a * b, the other q * p), exactly as in c/bm17/mont.h. A single
+// BM17 product leaves the multiply pipeline idle while each vmlal_u32 waits on
+// the one before it; running two products side by side fills those gaps.
+//
+// Uses the 8x32 limb layout. mu is p^-1 mod 2^32, as for c/bm17.
+
+typedef struct {
+    BigInt v[2];
+} BigIntX2;
+
+void mont_mul_x2_no_reduce(
+    BigIntX2 *ar,
+    BigIntX2 *br,
+    BigInt *p,
+    uint64_t mu,
+    BigIntX2 *d,
+    BigIntX2 *e
+) {
+    uint32_t mu_32 = (uint32_t) mu;
+    uint32_t mu_b0_0 = mu_32 * (uint32_t) br->v[0].v[0];
+    uint32_t mu_b0_1 = mu_32 * (uint32_t) br->v[1].v[0];
+    uint32_t q0, q1;
+    i64 aq0, aq1;
+    i64 bp0[NUM_LIMBS], bp1[NUM_LIMBS];
+    i128 de0[NUM_LIMBS], de1[NUM_LIMBS];
+    i128 t0, t1, p0, p1;
+    i128 mask = i64x2_make(LIMB_MASK, LIMB_MASK);
+
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        de0[i] = i128_zero();
+        de1[i] = i128_zero();
+        bp0[i] = i32x2_make(br->v[0].v[i], p->v[i]);
+        bp1[i] = i32x2_make(br->v[1].v[i], p->v[i]);
+    }
+
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        q0 = mu_b0_0 * (uint32_t) ar->v[0].v[j]
+            + mu_32 * (uint32_t) (i64x2_extract_h(de0[0]) - i64x2_extract_l(de0[0]));
+        q1 = mu_b0_1 * (uint32_t) ar->v[1].v[j]
+            + mu_32 * (uint32_t) (i64x2_extract_h(de1[0]) - i64x2_extract_l(de1[0]));
+        aq0 = i32x2_make(ar->v[0].v[j], q0);
+        aq1 = i32x2_make(ar->v[1].v[j], q1);
+        t0 = u64x2_shr(madd(de0[0], aq0, bp0[0]), 32);
+        t1 = u64x2_shr(madd(de1[0], aq1, bp1[0]), 32);
+
+        for (int i = 1; i < NUM_LIMBS; i ++) {
+            p0 = madd(i64x2_add(t0, de0[i]), aq0, bp0[i]);
+            p1 = madd(i64x2_add(t1, de1[i]), aq1, bp1[i]);
+            t0 = u64x2_shr(p0, 32);
+            t1 = u64x2_shr(p1, 32);
+            de0[i - 1] = i128_and(p0, mask);
+            de1[i - 1] = i128_and(p1, mask);
+        }
+        de0[NUM_LIMBS - 1] = t0;
+        de1[NUM_LIMBS - 1] = t1;
+    }
+
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        d->v[0].v[i] = i64x2_extract_h(de0[i]);
+        e->v[0].v[i] = i64x2_extract_l(de0[i]);
+        d->v[1].v[i] = i64x2_extract_h(de1[i]);
+        e->v[1].v[i] = i64x2_extract_l(de1[i]);
+    }
+}
+
+/*
+ * Returns d - e mod p for d, e in [0, p), adding p back without branching so
+ * that both products take the same path.
+ */
+static inline BigInt sub_mod_x2(BigInt *d, BigInt *e, BigInt *p) {
+    BigInt r;
+    uint64_t borrow = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t diff = d->v[i] - e->v[i] - borrow;
+        r.v[i] = diff & LIMB_MASK;
+        borrow = (diff >> BITS_PER_LIMB) & 1;
+    }
+    uint64_t mask = 0 - borrow;
+    uint64_t carry = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t sum = r.v[i] + (p->v[i] & mask) + carry;
+        r.v[i] = sum & LIMB_MASK;
+        carry = sum >> BITS_PER_LIMB;
+    }
+    return r;
+}
+
+BigIntX2 mont_mul_x2(
+    BigIntX2 *ar,
+    BigIntX2 *br,
+    BigInt *p,
+    uint64_t mu
+) {
+    BigIntX2 d, e, r;
+    mont_mul_x2_no_reduce(ar, br, p, mu, &d, &e);
+    r.v[0] = sub_mod_x2(&d.v[0], &e.v[0], p);
+    r.v[1] = sub_mod_x2(&d.v[1], &e.v[1], p);
+    return r;
+}
+
+/// Raises both elements of xr to the exponent that chain was generated for,
+/// in lock-step.
+BigIntX2 mont_pow_addchain_x2(
+    BigIntX2 *xr,
+    const AddChain *chain,
+    BigInt *p,
+    uint64_t mu
+) {
+    BigIntX2 table[ADDCHAIN_MAX_TABLE_SIZE];
+
+    // Odd powers x, x^3, x^5, ...
+    table[0] = *xr;
+    if (chain->table_size > 1) {
+        BigIntX2 x2 = mont_mul_x2(xr, xr, p, mu);
+        for (int i = 1; i < chain->table_size; i ++) {
+            table[i] = mont_mul_x2(&table[i - 1], &x2, p, mu);
+        }
+    }
+
+    BigIntX2 z = table[chain->steps[0].idx];
+    for (int s = 1; s < chain->num_steps; s ++) {
+        for (int i = 0; i < chain->steps[s].num_sqr; i ++) {
+            z = mont_mul_x2(&z, &z, p, mu);
+        }
+        if (chain->steps[s].idx != ADDCHAIN_NO_MUL) {
+            z = mont_mul_x2(&z, &table[chain->steps[s].idx], p, mu);
+        }
+    }
+    return z;
+}
+
+#ifndef MONT_POW_WINDOW
+#define MONT_POW_WINDOW 4
+#endif
+
+/// Raises both elements of xr to the same public exponent exp, which is in
+/// canonical form. one is R mod p, returned for a zero exponent.
+BigIntX2 mont_pow_x2(
+    BigIntX2 *xr,
+    BigInt *exp,
+    BigInt *p,
+    BigInt *one,
+    uint64_t mu
+) {
+    AddChainStep steps[ADDCHAIN_MAX_STEPS];
+    AddChain chain;
+    if (addchain_sliding(exp, MONT_POW_WINDOW, steps, &chain) != 0) {
+        BigIntX2 r = {{*one, *one}};
+        return r;
+    }
+    return mont_pow_addchain_x2(xr, &chain, p, mu);
+}
@@ -0,0 +1,176 @@
+#include <assert.h>
+#include "../simd/simd.h"
+#include "../addchain/chain.h"
+
+// Four independent Montgomery multiplications at once, one per 32-bit NEON
+// lane ("vertical" SIMD). Limb i of all four operands lives in one uint32x4_t,
+// so every instruction does the same work in every lane and no lane has to
+// wait for another. This is the shape that batch workloads with a shared,
+// public exponent (Legendre symbols, Fermat inversions) can use at full width.
+//
+// Uses the 8x32 limb layout. n0 is -p^-1 mod 2^32, as for the Acar and BH23
+// 32-bit kernels.
+
+#define MONT_MUL_X4_AVAILABLE
+
+// Four BigInts, transposed so that v[i] holds limb i of each of them.
+typedef struct {
+    uint32x4_t v[NUM_LIMBS];
+} BigIntX4;
+
+BigIntX4 bigint_x4_pack(BigInt a[4]) {
+    BigIntX4 r;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint32_t limbs[4] = {
+            (uint32_t)a[0].v[i], (uint32_t)a[1].v[i],
+            (uint32_t)a[2].v[i], (uint32_t)a[3].v[i]
+        };
+        r.v[i] = vld1q_u32(limbs);
+    }
+    return r;
+}
+
+void bigint_x4_unpack(BigIntX4 *a, BigInt out[4]) {
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint32_t limbs[4];
+        vst1q_u32(limbs, a->v[i]);
+        for (int k = 0; k < 4; k ++) {
+            out[k].v[i] = limbs[k];
+        }
+    }
+}
+
+// Puts a in all four lanes.
+BigIntX4 bigint_x4_splat(BigInt *a) {
+    BigIntX4 r;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        r.v[i] = vdupq_n_u32((uint32_t)a->v[i]);
+    }
+    return r;
+}
+
+/*
+ * Computes t + a * b + c in each lane, which always fits in 64 bits, and
+ * returns the low 32 bits in *lo and the high 32 bits in *hi.
+ */
+static inline void mac_x4(
+    uint32x4_t t,
+    uint32x4_t a,
+    uint32x4_t b,
+    uint32x4_t c,
+    uint32x4_t *lo,
+    uint32x4_t *hi
+) {
+    // Lanes 0 and 1, then lanes 2 and 3.
+    uint64x2_t r01 = vmlal_u32(vaddl_u32(vget_low_u32(t), vget_low_u32(c)), vget_low_u32(a), vget_low_u32(b));
+    uint64x2_t r23 = vmlal_high_u32(vaddl_high_u32(t, c), a, b);
+    *lo = vuzp1q_u32(vreinterpretq_u32_u64(r01), vreinterpretq_u32_u64(r23));
+    *hi = vuzp2q_u32(vreinterpretq_u32_u64(r01), vreinterpretq_u32_u64(r23));
+}
+
+/// The CIOS method of Acar (1996), in each of the four lanes.
+/// p is the modulus in all four lanes; see bigint_x4_splat.
+BigIntX4 mont_mul_x4(
+    BigIntX4 *ar,
+    BigIntX4 *br,
+    BigIntX4 *p,
+    uint64_t n0
+) {
+    uint32x4_t zero = vdupq_n_u32(0);
+    uint32x4_t vn0 = vdupq_n_u32((uint32_t)n0);
+    uint32x4_t t[NUM_LIMBS + 2];
+    uint32x4_t c, s, m;
+
+    for (int i = 0; i < NUM_LIMBS + 2; i ++) {
+        t[i] = zero;
+    }
+
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        c = zero;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            mac_x4(t[j], ar->v[j], br->v[i], c, &t[j], &c);
+        }
+        s = vaddq_u32(t[NUM_LIMBS], c);
+        t[NUM_LIMBS + 1] = vshrq_n_u32(vcltq_u32(s, c), 31);
+        t[NUM_LIMBS] = s;
+
+        m = vmulq_u32(t[0], vn0);
+        mac_x4(t[0], m, p->v[0], zero, &s, &c);
+        for (int j = 1; j < NUM_LIMBS; j ++) {
+            mac_x4(t[j], m, p->v[j], c, &t[j - 1], &c);
+        }
+        s = vaddq_u32(t[NUM_LIMBS], c);
+        t[NUM_LIMBS] = vaddq_u32(t[NUM_LIMBS + 1], vshrq_n_u32(vcltq_u32(s, c), 31));
+        t[NUM_LIMBS - 1] = s;
+    }
+
+    // t < 2p. Compute t - p with a borrow mask per lane, and keep it in the
+    // lanes where it did not underflow.
+    BigIntX4 d;
+    uint32x4_t borrow = zero;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        d.v[i] = vaddq_u32(vsubq_u32(t[i], p->v[i]), borrow);
+        borrow = vorrq_u32(
+            vcltq_u32(t[i], p->v[i]),
+            vandq_u32(vceqq_u32(t[i], p->v[i]), borrow)
+        );
+    }
+    uint32x4_t keep_t = vandq_u32(borrow, vceqq_u32(t[NUM_LIMBS], zero));
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        d.v[i] = vbslq_u32(keep_t, t[i], d.v[i]);
+    }
+    return d;
+}
+
+/// Raises each lane of xr to the exponent that chain was generated for. The
+/// chain is shared by all four lanes, so they stay in lock-step throughout.
+BigIntX4 mont_pow_addchain_x4(
+    BigIntX4 *xr,
+    const AddChain *chain,
+    BigInt *p,
+    uint64_t n0
+) {
+    BigIntX4 vp = bigint_x4_splat(p);
+    BigIntX4 table[ADDCHAIN_MAX_TABLE_SIZE];
+
+    // Odd powers x, x^3, x^5, ...
+    table[0] = *xr;
+    if (chain->table_size > 1) {
+        BigIntX4 x2 = mont_mul_x4(xr, xr, &vp, n0);
+        for (int i = 1; i < chain->table_size; i ++) {
+            table[i] = mont_mul_x4(&table[i - 1], &x2, &vp, n0);
+        }
+    }
+
+    BigIntX4 z = table[chain->steps[0].idx];
+    for (int s = 1; s < chain->num_steps; s ++) {
+        for (int i = 0; i < chain->steps[s].num_sqr; i ++) {
+            z = mont_mul_x4(&z, &z, &vp, n0);
+        }
+        if (chain->steps[s].idx != ADDCHAIN_NO_MUL) {
+            z = mont_mul_x4(&z, &table[chain->steps[s].idx], &vp, n0);
+        }
+    }
+    return z;
+}
+
+#ifndef MONT_POW_WINDOW
+#define MONT_POW_WINDOW 4
+#endif
+
+/// Raises each lane of xr to the same public exponent exp, which is in
+/// canonical form. one is R mod p, returned for a zero exponent.
+BigIntX4 mont_pow_x4(
+    BigIntX4 *xr,
+    BigInt *exp,
+    BigInt *p,
+    BigInt *one,
+    uint64_t n0
+) {
+    AddChainStep steps[ADDCHAIN_MAX_STEPS];
+    AddChain chain;
+    if (addchain_sliding(exp, MONT_POW_WINDOW, steps, &chain) != 0) {
+        return bigint_x4_splat(one);
+    }
+    return mont_pow_addchain_x4(xr, &chain, p, n0);
+}
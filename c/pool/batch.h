@@ -0,0 +1,107 @@
+#include <stddef.h>
+
+// Element-wise field-vector operations, split across a ThreadPool with
+// parallel_for. Include c/field.h, a Montgomery multiplication kernel and
+// c/pool/pool.h before this file.
+//
+// Output vectors may alias input vectors. All ranges use the pool's grain
+// size (pool->grain, or automatic if it is 0).
+
+typedef struct {
+    BigInt *out;
+    BigInt *a;
+    BigInt *b;
+    BigInt *scalar;
+    MontField *f;
+} BatchArgs;
+
+static void batch_mul_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_mul(&args->a[i], &args->b[i], args->f);
+    }
+}
+
+static void batch_scale_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_mul(&args->a[i], args->scalar, args->f);
+    }
+}
+
+static void batch_sqr_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_sqr(&args->a[i], args->f);
+    }
+}
+
+static void batch_to_mont_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_to_mont(&args->a[i], args->f);
+    }
+}
+
+static void batch_from_mont_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_from_mont(&args->a[i], args->f);
+    }
+}
+
+static void batch_add_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_add(&args->a[i], &args->b[i], args->f);
+    }
+}
+
+static void batch_sub_range(size_t start, size_t end, void *ctx) {
+    BatchArgs *args = ctx;
+    for (size_t i = start; i < end; i ++) {
+        args->out[i] = field_sub(&args->a[i], &args->b[i], args->f);
+    }
+}
+
+/// out[i] = a[i] * b[i]
+void batch_mul(ThreadPool *pool, BigInt *out, BigInt *a, BigInt *b, size_t n, MontField *f) {
+    BatchArgs args = { out, a, b, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_mul_range, &args);
+}
+
+/// out[i] = a[i] * scalar
+void batch_scale(ThreadPool *pool, BigInt *out, BigInt *a, BigInt *scalar, size_t n, MontField *f) {
+    BatchArgs args = { out, a, NULL, scalar, f };
+    parallel_for(pool, n, pool->grain, batch_scale_range, &args);
+}
+
+/// out[i] = a[i]^2
+void batch_sqr(ThreadPool *pool, BigInt *out, BigInt *a, size_t n, MontField *f) {
+    BatchArgs args = { out, a, NULL, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_sqr_range, &args);
+}
+
+/// Converts a[i] into Montgomery form.
+void batch_to_mont(ThreadPool *pool, BigInt *out, BigInt *a, size_t n, MontField *f) {
+    BatchArgs args = { out, a, NULL, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_to_mont_range, &args);
+}
+
+/// Converts a[i] out of Montgomery form.
+void batch_from_mont(ThreadPool *pool, BigInt *out, BigInt *a, size_t n, MontField *f) {
+    BatchArgs args = { out, a, NULL, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_from_mont_range, &args);
+}
+
+/// out[i] = a[i] + b[i]
+void batch_add(ThreadPool *pool, BigInt *out, BigInt *a, BigInt *b, size_t n, MontField *f) {
+    BatchArgs args = { out, a, b, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_add_range, &args);
+}
+
+/// out[i] = a[i] - b[i]
+void batch_sub(ThreadPool *pool, BigInt *out, BigInt *a, BigInt *b, size_t n, MontField *f) {
+    BatchArgs args = { out, a, b, NULL, f };
+    parallel_for(pool, n, pool->grain, batch_sub_range, &args);
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <sched.h>
+#include <unistd.h>
+
+// CPU topology helpers for the thread pool: per-core capacity and thread
+// pinning.
+//
+// Pinning needs sched_setaffinity and the CPU_SET macros, which glibc only
+// declares if _GNU_SOURCE is defined before the first system header, so the
+// Makefile's CFLAGS_THREADS passes -D_GNU_SOURCE. Without them (or off
+// Linux), pool_pin_thread does nothing.
+
+#define POOL_MAX_CPUS 64
+
+// The capacity that Linux gives the fastest core
+#define POOL_FULL_CAPACITY 1024
+
+/*
+ * Reads one unsigned integer from a sysfs file. Returns false if the file
+ * doesn't exist or doesn't start with a number.
+ */
+static bool pool_read_sysfs(const char *path, unsigned long *value) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    bool ok = fscanf(fp, "%lu", value) == 1;
+    fclose(fp);
+    return ok;
+}
+
+/*
+ * Fills cpus with the IDs of the online CPUs, in increasing order, and
+ * returns how many there are (at most max_cpus).
+ *
+ * The IDs need not be contiguous, as phones take cores offline to save
+ * power. They are read from /sys/devices/system/cpu/online, a list such as
+ * "0-3,6". If that is missing, they are the CPUs in the calling thread's
+ * affinity mask, and if that isn't available either, 0 up to
+ * _SC_NPROCESSORS_ONLN - 1.
+ */
+int pool_online_cpus(int *cpus, int max_cpus) {
+    int n = 0;
+    FILE *fp = fopen("/sys/devices/system/cpu/online", "r");
+    if (fp != NULL) {
+        int first, last;
+        char sep;
+        while (n < max_cpus && fscanf(fp, "%d", &first) == 1) {
+            last = first;
+            sep = '\0';
+            if (fscanf(fp, "%c", &sep) == 1 && sep == '-' && fscanf(fp, "%d", &last) == 1) {
+                fscanf(fp, "%c", &sep);
+            }
+            for (int cpu = first; cpu <= last && n < max_cpus; cpu ++) {
+                cpus[n ++] = cpu;
+            }
+            if (sep != ',') {
+                break;
+            }
+        }
+        fclose(fp);
+        if (n > 0) {
+            return n;
+        }
+    }
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE && n < max_cpus; cpu ++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus[n ++] = cpu;
+            }
+        }
+        if (n > 0) {
+            return n;
+        }
+    }
+#endif
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    n = online < 1 ? 1 : online > max_cpus ? max_cpus : (int)online;
+    for (int i = 0; i < n; i ++) {
+        cpus[i] = i;
+    }
+    return n;
+}
+
+/*
+ * Fills cpus with the IDs of the online CPUs (see pool_online_cpus) and
+ * capacity[i] with the relative capacity of CPU cpus[i], scaled so that the
+ * fastest CPU has POOL_FULL_CAPACITY, and returns the number of CPUs.
+ *
+ * The capacities come from /sys/devices/system/cpu/cpu<id>/cpu_capacity,
+ * which the kernel derives from the device tree on big.LITTLE systems. If
+ * that is missing, the maximum cpufreq frequency is used instead, and if
+ * that is missing too, every CPU gets POOL_FULL_CAPACITY.
+ */
+int pool_cpu_capacities(int *cpus, unsigned *capacity, int max_cpus) {
+    int num_cpus = pool_online_cpus(cpus, max_cpus);
+
+    const char *sources[] = {
+        "/sys/devices/system/cpu/cpu%d/cpu_capacity",
+        "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq",
+    };
+    for (int s = 0; s < 2; s ++) {
+        unsigned long values[POOL_MAX_CPUS];
+        unsigned long max_value = 0;
+        bool found = true;
+        for (int i = 0; i < num_cpus && found; i ++) {
+            char path[128];
+            snprintf(path, sizeof(path), sources[s], cpus[i]);
+            found = pool_read_sysfs(path, &values[i]) && values[i] > 0;
+            if (found && values[i] > max_value) {
+                max_value = values[i];
+            }
+        }
+        if (found) {
+            for (int i = 0; i < num_cpus; i ++) {
+                capacity[i] = values[i] * POOL_FULL_CAPACITY / max_value;
+            }
+            return num_cpus;
+        }
+    }
+
+    for (int i = 0; i < num_cpus; i ++) {
+        capacity[i] = POOL_FULL_CAPACITY;
+    }
+    return num_cpus;
+}
+
+/*
+ * Pins the calling thread to one CPU. Returns 0 on success, or -1 if pinning
+ * failed or isn't available.
+ */
+int pool_pin_thread(int cpu) {
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : -1;
+#else
+    return -1;
+#endif
+}
+
+// A thread's CPU affinity, saved before pinning it so that it can be put
+// back
+typedef struct {
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t set;
+#endif
+    bool saved;
+} PoolAffinity;
+
+static void pool_save_affinity(PoolAffinity *a) {
+#if defined(__linux__) && defined(CPU_SET)
+    a->saved = sched_getaffinity(0, sizeof(a->set), &a->set) == 0;
+#else
+    a->saved = false;
+#endif
+}
+
+// Restores the calling thread's affinity, if it was saved.
+static void pool_restore_affinity(PoolAffinity *a) {
+#if defined(__linux__) && defined(CPU_SET)
+    if (a->saved) {
+        sched_setaffinity(0, sizeof(a->set), &a->set);
+    }
+#endif
+    a->saved = false;
+}
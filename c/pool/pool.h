@@ -0,0 +1,467 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "cpus.h"
+
+// A work-stealing thread pool with a parallel_for over index ranges. Link
+// with -pthread.
+//
+// Each thread owns a Chase-Lev deque of index ranges. A thread that takes a
+// range larger than the grain size splits it in half, pushes the upper half
+// onto the bottom of its own deque and carries on with the lower half, so
+// each deque holds at most log2(n / grain) ranges. Idle threads steal from
+// the top of other threads' deques, which takes the largest remaining range.
+// Pushing, popping and stealing are lock-free; the mutex and condition
+// variable are only used to put threads to sleep between parallel_for calls.
+//
+// David Chase and Yossi Lev. Dynamic Circular Work-Stealing Deque. SPAA 2005.
+// Nhat Minh Lê, et al. Correct and Efficient Work-Stealing for Weak Memory
+// Models. PPoPP 2013. (The memory orderings below follow this paper, except
+// that push publishes with a release store rather than a release fence.)
+//
+// Only one parallel_for may run on a pool at a time, and the function must
+// not call parallel_for on the same pool.
+//
+// On heterogeneous (big.LITTLE) CPUs, pool_init_hetero pins each thread to a
+// core and makes the pool adaptive: each thread measures its own throughput,
+// and splits ranges down to a grain size proportional to it, so that the last
+// range a little core takes finishes at about the same time as the last
+// range of a big core.
+
+#define POOL_MAX_THREADS 64
+
+// Deque capacity. Binary splitting needs one slot per halving, so this only
+// runs out if n / grain exceeds 2^POOL_DEQUE_SIZE.
+#define POOL_DEQUE_SIZE 64
+
+// With automatic grain sizes, each thread gets about this many ranges, so
+// that a thread that finishes early has something to steal.
+#ifndef POOL_SPLITS_PER_THREAD
+#define POOL_SPLITS_PER_THREAD 8
+#endif
+
+typedef void (*PoolRangeFunc)(size_t start, size_t end, void *ctx);
+
+// The fields are atomic so that a thief can read a slot while its owner
+// reuses it. The thief then loses the race on top and discards what it read.
+typedef struct {
+    _Atomic size_t start;
+    _Atomic size_t end;
+} PoolRange;
+
+typedef struct {
+    _Alignas(64) _Atomic int64_t top;
+    _Alignas(64) _Atomic int64_t bottom;
+    PoolRange buf[POOL_DEQUE_SIZE];
+} PoolDeque;
+
+typedef struct ThreadPool ThreadPool;
+
+typedef struct {
+    ThreadPool *pool;
+    int id;
+    int cpu; // the CPU the thread is pinned to, or -1
+    unsigned capacity; // relative to POOL_FULL_CAPACITY
+    // Measured throughput in indices per second, or 0 before the first
+    // measurement. Only adaptive pools measure it.
+    _Alignas(64) _Atomic uint64_t rate;
+} PoolWorker;
+
+struct ThreadPool {
+    int num_threads; // including the thread that calls parallel_for
+    pthread_t threads[POOL_MAX_THREADS];
+    PoolWorker workers[POOL_MAX_THREADS];
+    PoolDeque deques[POOL_MAX_THREADS];
+
+    // The grain size used by the batch operations in batch.h; 0 for
+    // automatic.
+    size_t grain;
+    // Whether threads size their ranges by their measured throughput
+    bool adaptive;
+    // The affinity of the thread that started the pool, if it pinned that
+    // thread, for pool_destroy to restore
+    PoolAffinity caller_affinity;
+
+    // The current parallel_for
+    PoolRangeFunc func;
+    void *ctx;
+    size_t job_grain;
+    _Alignas(64) _Atomic size_t remaining; // indices not yet processed
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    unsigned epoch; // incremented for each parallel_for, under lock
+    bool stop;
+};
+
+static void pool_deque_push(PoolDeque *q, size_t start, size_t end) {
+    int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+    assert(b - t < POOL_DEQUE_SIZE);
+    PoolRange *slot = &q->buf[b % POOL_DEQUE_SIZE];
+    atomic_store_explicit(&slot->start, start, memory_order_relaxed);
+    atomic_store_explicit(&slot->end, end, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_release);
+}
+
+static bool pool_deque_pop(PoolDeque *q, size_t *start, size_t *end) {
+    int64_t b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        return false;
+    }
+    PoolRange *slot = &q->buf[b % POOL_DEQUE_SIZE];
+    *start = atomic_load_explicit(&slot->start, memory_order_relaxed);
+    *end = atomic_load_explicit(&slot->end, memory_order_relaxed);
+    if (t < b) {
+        return true;
+    }
+    // The last range, which a thief may be taking at the same time
+    bool won = atomic_compare_exchange_strong_explicit(
+        &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    return won;
+}
+
+static bool pool_deque_steal(PoolDeque *q, size_t *start, size_t *end) {
+    int64_t t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+    if (t >= b) {
+        return false;
+    }
+    PoolRange *slot = &q->buf[t % POOL_DEQUE_SIZE];
+    *start = atomic_load_explicit(&slot->start, memory_order_relaxed);
+    *end = atomic_load_explicit(&slot->end, memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(
+        &q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+// The ID of the pool thread running on this thread, or -1 outside a pool.
+static _Thread_local int pool_worker_id = -1;
+
+/*
+ * Returns the ID (0 to num_threads - 1) of the pool thread that is calling,
+ * or -1 if it isn't a pool thread. Thread 0 is the one that called
+ * parallel_for.
+ */
+static inline int pool_current_worker(void) {
+    return pool_worker_id;
+}
+
+static inline uint64_t pool_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+ * In an adaptive pool, returns the job's grain size scaled by this thread's
+ * throughput relative to the fastest thread. Until every thread has been
+ * measured, the core capacities are used instead.
+ */
+static size_t pool_worker_grain(ThreadPool *pool, int id) {
+    uint64_t mine = 0, max = 0;
+    bool measured = true;
+    for (int i = 0; i < pool->num_threads; i ++) {
+        uint64_t rate = atomic_load_explicit(&pool->workers[i].rate, memory_order_relaxed);
+        measured &= rate != 0;
+        if (i == id) mine = rate;
+        if (rate > max) max = rate;
+    }
+    if (!measured) {
+        mine = pool->workers[id].capacity;
+        max = POOL_FULL_CAPACITY;
+    }
+    size_t grain = (size_t)((double)pool->job_grain * mine / max);
+    return grain == 0 ? 1 : grain;
+}
+
+/*
+ * Runs [start, end), splitting off the upper half onto the worker's own
+ * deque while the range is larger than the grain size.
+ */
+static void pool_run_range(ThreadPool *pool, int id, size_t start, size_t end) {
+    size_t grain = pool->adaptive ? pool_worker_grain(pool, id) : pool->job_grain;
+    while (end - start > grain) {
+        size_t mid = start + (end - start) / 2;
+        pool_deque_push(&pool->deques[id], mid, end);
+        end = mid;
+    }
+
+    if (pool->adaptive) {
+        uint64_t t0 = pool_now_ns();
+        pool->func(start, end, pool->ctx);
+        uint64_t ns = pool_now_ns() - t0;
+        if (ns > 0) {
+            // An exponential moving average, so that a one-off preemption
+            // doesn't shrink the thread's ranges for long
+            _Atomic uint64_t *rate = &pool->workers[id].rate;
+            uint64_t sample = (uint64_t)((end - start) * 1e9 / ns);
+            uint64_t old = atomic_load_explicit(rate, memory_order_relaxed);
+            atomic_store_explicit(rate, old == 0 ? sample : (3 * old + sample) / 4, memory_order_relaxed);
+        }
+    } else {
+        pool->func(start, end, pool->ctx);
+    }
+    atomic_fetch_sub_explicit(&pool->remaining, end - start, memory_order_acq_rel);
+}
+
+/*
+ * Works on the current parallel_for until every index has been processed.
+ */
+static void pool_work(ThreadPool *pool, int id) {
+    uint32_t rng = 0x9e3779b9u * (id + 1);
+    size_t start, end;
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) > 0) {
+        if (pool_deque_pop(&pool->deques[id], &start, &end)) {
+            pool_run_range(pool, id, start, end);
+            continue;
+        }
+
+        // Try each other thread once, starting from a random victim.
+        bool stolen = false;
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        for (int k = 0; k < pool->num_threads && !stolen; k ++) {
+            int victim = (rng + k) % pool->num_threads;
+            if (victim != id) {
+                stolen = pool_deque_steal(&pool->deques[victim], &start, &end);
+            }
+        }
+        if (stolen) {
+            pool_run_range(pool, id, start, end);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static void *pool_thread(void *arg) {
+    PoolWorker *worker = arg;
+    ThreadPool *pool = worker->pool;
+    unsigned seen = 0;
+    pool_worker_id = worker->id;
+    if (worker->cpu >= 0) {
+        pool_pin_thread(worker->cpu);
+    }
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->epoch == seen && !pool->stop) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        seen = pool->epoch;
+        bool stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) {
+            return NULL;
+        }
+        pool_work(pool, worker->id);
+    }
+}
+
+/*
+ * Starts the worker threads once pool->workers[i].cpu and .capacity have
+ * been set.
+ */
+static void pool_start(ThreadPool *pool, int num_threads) {
+    pool->grain = 0;
+    pool->func = NULL;
+    pool->ctx = NULL;
+    pool->job_grain = 1;
+    atomic_init(&pool->remaining, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pool->epoch = 0;
+    pool->stop = false;
+    for (int i = 0; i < num_threads; i ++) {
+        atomic_init(&pool->deques[i].top, 0);
+        atomic_init(&pool->deques[i].bottom, 0);
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        atomic_init(&pool->workers[i].rate, 0);
+    }
+
+    pool->num_threads = 1;
+    for (int i = 1; i < num_threads; i ++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_thread, &pool->workers[i]) != 0) {
+            break;
+        }
+        pool->num_threads ++;
+    }
+}
+
+/*
+ * Starts num_threads - 1 worker threads; the thread that calls parallel_for
+ * is the last one. Returns 0 on success, or -1 if num_threads is out of
+ * range. If a thread can't be started, the pool runs with fewer threads.
+ */
+int pool_init(ThreadPool *pool, int num_threads) {
+    if (num_threads < 1 || num_threads > POOL_MAX_THREADS) {
+        return -1;
+    }
+    pool->adaptive = false;
+    pool->caller_affinity.saved = false;
+    for (int i = 0; i < num_threads; i ++) {
+        pool->workers[i].cpu = -1;
+        pool->workers[i].capacity = POOL_FULL_CAPACITY;
+    }
+    pool_start(pool, num_threads);
+    return 0;
+}
+
+/*
+ * Starts an adaptive pool (see above) with thread i pinned to cpus[i] and
+ * given capacity capacities[i]; the calling thread is pinned to cpus[0]
+ * until pool_destroy, which restores its affinity and so must be called from
+ * the same thread.
+ * Either array may be NULL, for no pinning or for equal capacities until the
+ * first measurements. Returns 0 on success, or -1 if num_threads is out of
+ * range.
+ */
+int pool_init_adaptive(
+    ThreadPool *pool,
+    int num_threads,
+    const int *cpus,
+    const unsigned *capacities
+) {
+    if (num_threads < 1 || num_threads > POOL_MAX_THREADS) {
+        return -1;
+    }
+    pool->adaptive = true;
+    for (int i = 0; i < num_threads; i ++) {
+        pool->workers[i].cpu = cpus == NULL ? -1 : cpus[i];
+        pool->workers[i].capacity = capacities == NULL ? POOL_FULL_CAPACITY : capacities[i];
+    }
+    pool->caller_affinity.saved = false;
+    if (cpus != NULL) {
+        pool_save_affinity(&pool->caller_affinity);
+        pool_pin_thread(cpus[0]);
+    }
+    pool_start(pool, num_threads);
+    return 0;
+}
+
+/*
+ * Like pool_init, but for CPUs with cores of different speeds. Threads are
+ * given the fastest cores first and pinned to them with sched_setaffinity,
+ * and the pool is adaptive.
+ *
+ * On a homogeneous CPU, or if the capacities can't be read, this is the same
+ * as pool_init: no threads are pinned and the pool is not adaptive.
+ *
+ * Returns 0 on success, or -1 if num_threads is out of range.
+ */
+int pool_init_hetero(ThreadPool *pool, int num_threads) {
+    if (num_threads < 1 || num_threads > POOL_MAX_THREADS) {
+        return -1;
+    }
+    int ids[POOL_MAX_CPUS];
+    unsigned capacity[POOL_MAX_CPUS];
+    int num_cpus = pool_cpu_capacities(ids, capacity, POOL_MAX_CPUS);
+
+    // CPUs in decreasing order of capacity, as indices into ids
+    int order[POOL_MAX_CPUS];
+    for (int i = 0; i < num_cpus; i ++) {
+        int j = i;
+        while (j > 0 && capacity[order[j - 1]] < capacity[i]) {
+            order[j] = order[j - 1];
+            j --;
+        }
+        order[j] = i;
+    }
+
+    int cpus[POOL_MAX_THREADS];
+    unsigned capacities[POOL_MAX_THREADS];
+    bool heterogeneous = false;
+    for (int i = 0; i < num_threads; i ++) {
+        cpus[i] = ids[order[i % num_cpus]];
+        capacities[i] = capacity[order[i % num_cpus]];
+        heterogeneous |= capacities[i] != capacities[0];
+    }
+    if (!heterogeneous) {
+        return pool_init(pool, num_threads);
+    }
+    return pool_init_adaptive(pool, num_threads, cpus, capacities);
+}
+
+void pool_destroy(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->num_threads; i ++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pool_restore_affinity(&pool->caller_affinity);
+}
+
+/*
+ * Returns the grain size that gives each thread about POOL_SPLITS_PER_THREAD
+ * ranges of n indices.
+ */
+static inline size_t pool_auto_grain(ThreadPool *pool, size_t n) {
+    size_t grain = n / ((size_t)pool->num_threads * POOL_SPLITS_PER_THREAD);
+    return grain == 0 ? 1 : grain;
+}
+
+/*
+ * Calls func(start, end, ctx) on disjoint ranges that together cover
+ * [0, n), in parallel, and returns when they have all finished. Ranges are
+ * at most grain indices long (in an adaptive pool, threads on slower cores
+ * take shorter ranges); pass 0 for pool_auto_grain.
+ */
+void parallel_for(
+    ThreadPool *pool,
+    size_t n,
+    size_t grain,
+    PoolRangeFunc func,
+    void *ctx
+) {
+    if (n == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = pool_auto_grain(pool, n);
+    }
+    int outer_id = pool_worker_id;
+    pool_worker_id = 0;
+    if (pool->num_threads == 1 || n <= grain) {
+        for (size_t start = 0; start < n; start += grain) {
+            func(start, n - start > grain ? start + grain : n, ctx);
+        }
+        pool_worker_id = outer_id;
+        return;
+    }
+
+    // Workers still leaving the previous call may be in pool_work's steal
+    // loop, and can take the range as soon as it is pushed. So the job and
+    // remaining must be set before the push: if the range went first, such a
+    // worker could run it and subtract from a remaining of 0, and the store
+    // of n would then overwrite that, leaving remaining above 0 for good.
+    // The push's release store publishes all of these to the thief.
+    pool->func = func;
+    pool->ctx = ctx;
+    pool->job_grain = grain;
+    atomic_store_explicit(&pool->remaining, n, memory_order_release);
+    pool_deque_push(&pool->deques[0], 0, n);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->epoch ++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_work(pool, 0);
+    pool_worker_id = outer_id;
+}
@@ -0,0 +1,86 @@
+#include <stdint.h>
+
+// The Grain LFSR that generates Poseidon round constants and MDS matrices,
+// as in generate_parameters_grain.sage from the Poseidon reference
+// implementation: https://extgit.iaik.tugraz.at/krypto/hadeshash
+//
+// circomlib's BN254 constants come from this generator with field = 1
+// (prime field), sbox = 0 (x^alpha), n = 254, R_F = 8 and R_P per width.
+
+#define GRAIN_STATE_BITS 80
+
+typedef struct {
+    uint8_t bits[GRAIN_STATE_BITS];
+    int head; // index of the oldest bit
+} GrainLfsr;
+
+/*
+ * Appends the lowest num_bits of x to the state, most significant bit first.
+ */
+static inline void grain_push_bits(GrainLfsr *g, int *pos, uint64_t x, int num_bits) {
+    for (int i = num_bits - 1; i >= 0; i --) {
+        g->bits[(*pos) ++] = (x >> i) & 1;
+    }
+}
+
+/*
+ * Clocks the LFSR once and returns the new bit:
+ * b[i + 80] = b[i + 62] ^ b[i + 51] ^ b[i + 38] ^ b[i + 23] ^ b[i + 13] ^ b[i].
+ */
+static inline uint8_t grain_clock(GrainLfsr *g) {
+    int h = g->head;
+    uint8_t b = g->bits[(h + 62) % GRAIN_STATE_BITS]
+        ^ g->bits[(h + 51) % GRAIN_STATE_BITS]
+        ^ g->bits[(h + 38) % GRAIN_STATE_BITS]
+        ^ g->bits[(h + 23) % GRAIN_STATE_BITS]
+        ^ g->bits[(h + 13) % GRAIN_STATE_BITS]
+        ^ g->bits[h];
+    g->bits[h] = b;
+    g->head = (h + 1) % GRAIN_STATE_BITS;
+    return b;
+}
+
+void grain_init(
+    GrainLfsr *g,
+    int field,
+    int sbox,
+    int n,
+    int t,
+    int r_f,
+    int r_p
+) {
+    int pos = 0;
+    grain_push_bits(g, &pos, field, 2);
+    grain_push_bits(g, &pos, sbox, 4);
+    grain_push_bits(g, &pos, n, 12);
+    grain_push_bits(g, &pos, t, 12);
+    grain_push_bits(g, &pos, r_f, 10);
+    grain_push_bits(g, &pos, r_p, 10);
+    grain_push_bits(g, &pos, (1 << 30) - 1, 30);
+    g->head = 0;
+
+    // Discard the first 160 bits.
+    for (int i = 0; i < 160; i ++) {
+        grain_clock(g);
+    }
+}
+
+/*
+ * Returns the next output bit. Bits are produced in pairs: if the first bit of
+ * a pair is 1, the second is output, otherwise the pair is discarded.
+ */
+static inline uint8_t grain_next_bit(GrainLfsr *g) {
+    while (grain_clock(g) == 0) {
+        grain_clock(g);
+    }
+    return grain_clock(g);
+}
+
+/// Reads num_bits output bits as a big-endian integer.
+BigInt grain_random_bits(GrainLfsr *g, int num_bits) {
+    BigInt r = bigint_new();
+    for (int i = num_bits - 1; i >= 0; i --) {
+        r.v[i / BITS_PER_LIMB] |= (uint64_t)grain_next_bit(g) << (i % BITS_PER_LIMB);
+    }
+    return r;
+}
@@ -0,0 +1,541 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "grain.h"
+
+// The Poseidon permutation and sponge over the BN254 scalar field, with
+// circomlib's parameters: x^5 S-boxes, 8 full rounds, and widths t = 2..17.
+// Include c/field.h, a Montgomery multiplication kernel,
+// c/addchain/addchain.h and c/addchain/bn254_scalar.h before this file.
+//
+// Lorenzo Grassi, et al. Poseidon: A New Hash Function for Zero-Knowledge
+// Proof Systems. https://eprint.iacr.org/2019/458
+//
+// The round constants and MDS matrix are generated at startup with the Grain
+// LFSR (see grain.h) rather than shipped as tables, and then transformed as in
+// Appendix B of the paper:
+//
+// - In partial rounds, the constants added to state[1..] pass straight
+//   through the S-box, so they are pushed forward through the MDS matrix until
+//   the next full round. Each partial round then adds one constant.
+// - The MDS matrix of each partial round is factored as M = S * D, where
+//   D = diag(1, D') commutes with the partial S-box and is pushed back into
+//   the previous round, and S = [[a, w^T], [v, I]] is sparse. A partial round
+//   then costs 2t - 1 multiplications instead of t^2. The last D is absorbed
+//   by the dense matrix of the last full round before the partial rounds.
+//
+// Dense matrix-vector products use lazy reduction: each output is a sum of t
+// double-width products followed by a single Montgomery reduction.
+//
+// All field elements are in Montgomery form.
+
+#define POSEIDON_MIN_T 2
+#define POSEIDON_MAX_T 17
+#define POSEIDON_FULL_ROUNDS 8
+#define POSEIDON_MAX_PARTIAL_ROUNDS 70
+#define POSEIDON_MAX_ROUNDS (POSEIDON_FULL_ROUNDS + POSEIDON_MAX_PARTIAL_ROUNDS)
+
+// The number of partial rounds for t = 2..17, from circomlib.
+static const int POSEIDON_PARTIAL_ROUNDS[] = {
+    56, 57, 56, 60, 60, 63, 64, 63, 60, 66, 60, 65, 70, 60, 64, 68
+};
+
+typedef struct {
+    int t;
+    int r_f;
+    int r_p;
+
+    // -p^-1 mod 2^BITS_PER_LIMB, for the lazy reductions. This is not always
+    // the kernel's n0: BM17 takes p^-1 instead.
+    uint64_t redc_n0;
+
+    // The constants and MDS matrix as generated, used by
+    // poseidon_permute_reference.
+    BigInt c[POSEIDON_MAX_ROUNDS * POSEIDON_MAX_T];
+    BigInt m[POSEIDON_MAX_T][POSEIDON_MAX_T];
+
+    // Full-round constants, with the partial-round leftovers folded into the
+    // first full round after the partial rounds.
+    BigInt c_full[POSEIDON_FULL_ROUNDS][POSEIDON_MAX_T];
+    // D * M, for the last full round before the partial rounds.
+    BigInt m_pre[POSEIDON_MAX_T][POSEIDON_MAX_T];
+    // One constant per partial round, added to state[0].
+    BigInt c_partial[POSEIDON_MAX_PARTIAL_ROUNDS];
+    // The sparse matrices: the first row (a, w) and the first column below
+    // the diagonal (v).
+    BigInt sparse_row[POSEIDON_MAX_PARTIAL_ROUNDS][POSEIDON_MAX_T];
+    BigInt sparse_col[POSEIDON_MAX_PARTIAL_ROUNDS][POSEIDON_MAX_T];
+} PoseidonParams;
+
+#if BITS_PER_LIMB == 64
+typedef unsigned __int128 poseidon_dlimb;
+#else
+typedef uint64_t poseidon_dlimb;
+#endif
+
+// A double-width accumulator with two spare limbs, enough for a sum of up to
+// POSEIDON_MAX_T products of values below p.
+#define POSEIDON_ACC_LIMBS (2 * NUM_LIMBS + 2)
+
+/*
+ * Adds the double-width product a * b to acc.
+ */
+static inline void poseidon_mac_wide(uint64_t *acc, BigInt *a, BigInt *b) {
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            poseidon_dlimb uv = (poseidon_dlimb)a->v[i] * b->v[j] + acc[i + j] + carry;
+            acc[i + j] = (uint64_t)uv & LIMB_MASK;
+            carry = (uint64_t)(uv >> BITS_PER_LIMB);
+        }
+        for (int k = i + NUM_LIMBS; k < POSEIDON_ACC_LIMBS && carry != 0; k ++) {
+            poseidon_dlimb uv = (poseidon_dlimb)acc[k] + carry;
+            acc[k] = (uint64_t)uv & LIMB_MASK;
+            carry = (uint64_t)(uv >> BITS_PER_LIMB);
+        }
+    }
+}
+
+/*
+ * Returns acc * R^-1 mod p. acc is overwritten.
+ */
+static inline BigInt poseidon_redc(uint64_t *acc, BigInt *p, uint64_t n0) {
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t m = (acc[i] * n0) & LIMB_MASK;
+        uint64_t carry = 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            poseidon_dlimb uv = (poseidon_dlimb)m * p->v[j] + acc[i + j] + carry;
+            acc[i + j] = (uint64_t)uv & LIMB_MASK;
+            carry = (uint64_t)(uv >> BITS_PER_LIMB);
+        }
+        for (int k = i + NUM_LIMBS; k < POSEIDON_ACC_LIMBS && carry != 0; k ++) {
+            poseidon_dlimb uv = (poseidon_dlimb)acc[k] + carry;
+            acc[k] = (uint64_t)uv & LIMB_MASK;
+            carry = (uint64_t)(uv >> BITS_PER_LIMB);
+        }
+    }
+
+    // r = acc[NUM_LIMBS..] is below (t + 1) * p, so subtract p until r < p.
+    uint64_t *r = acc + NUM_LIMBS;
+    const int len = POSEIDON_ACC_LIMBS - NUM_LIMBS;
+    for (;;) {
+        bool lt = false;
+        for (int i = len - 1; i >= 0; i --) {
+            uint64_t pi = i < NUM_LIMBS ? p->v[i] : 0;
+            if (r[i] != pi) {
+                lt = r[i] < pi;
+                break;
+            }
+        }
+        if (lt) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (int i = 0; i < len; i ++) {
+            uint64_t ri = r[i];
+            uint64_t pi = i < NUM_LIMBS ? p->v[i] : 0;
+            r[i] = (ri - pi - borrow) & LIMB_MASK;
+            borrow = (ri < pi) | ((ri == pi) & borrow);
+        }
+    }
+
+    BigInt res;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        res.v[i] = r[i];
+    }
+    return res;
+}
+
+/// Returns sum(a[i] * x[i]) * R^-1 mod p, with a single reduction.
+BigInt poseidon_dot(BigInt *a, BigInt *x, int n, PoseidonParams *params, MontField *f) {
+    uint64_t acc[POSEIDON_ACC_LIMBS] = {0};
+    for (int i = 0; i < n; i ++) {
+        poseidon_mac_wide(acc, &a[i], &x[i]);
+    }
+    return poseidon_redc(acc, &f->p, params->redc_n0);
+}
+
+static inline BigInt poseidon_sbox(BigInt *x, MontField *f) {
+    BigInt x2 = field_sqr(x, f);
+    BigInt x4 = field_sqr(&x2, f);
+    return field_mul(&x4, x, f);
+}
+
+/*
+ * Returns x^-1 in Montgomery form, by Fermat's little theorem.
+ */
+static inline BigInt poseidon_inv(BigInt *x, MontField *f) {
+    return mont_pow_addchain(x, &BN254_SCALAR_INV_CHAIN, &f->p, f->n0);
+}
+
+static inline bool poseidon_is_zero(BigInt *x, MontField *f) {
+    BigInt zero = bigint_new();
+    return bigint_eq(x, &zero) || bigint_eq(x, &f->p);
+}
+
+/*
+ * Solves a * x = b for x in place, where a is an n x n matrix stored row by
+ * row. a is destroyed and x is written to b. Returns -1 if a is singular.
+ */
+static int poseidon_solve(BigInt *a, BigInt *b, int n, MontField *f) {
+    for (int col = 0; col < n; col ++) {
+        int pivot = col;
+        while (pivot < n && poseidon_is_zero(&a[pivot * n + col], f)) {
+            pivot ++;
+        }
+        if (pivot == n) {
+            return -1;
+        }
+        if (pivot != col) {
+            for (int j = 0; j < n; j ++) {
+                BigInt tmp = a[col * n + j];
+                a[col * n + j] = a[pivot * n + j];
+                a[pivot * n + j] = tmp;
+            }
+            BigInt tmp = b[col];
+            b[col] = b[pivot];
+            b[pivot] = tmp;
+        }
+
+        BigInt inv = poseidon_inv(&a[col * n + col], f);
+        for (int j = 0; j < n; j ++) {
+            a[col * n + j] = field_mul(&a[col * n + j], &inv, f);
+        }
+        b[col] = field_mul(&b[col], &inv, f);
+
+        for (int i = 0; i < n; i ++) {
+            if (i == col || poseidon_is_zero(&a[i * n + col], f)) {
+                continue;
+            }
+            BigInt factor = a[i * n + col];
+            for (int j = 0; j < n; j ++) {
+                BigInt x = field_mul(&factor, &a[col * n + j], f);
+                a[i * n + j] = field_sub(&a[i * n + j], &x, f);
+            }
+            BigInt x = field_mul(&factor, &b[col], f);
+            b[i] = field_sub(&b[i], &x, f);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Generates the round constants and the Cauchy MDS matrix
+ * m[i][j] = 1 / (x_i + y_j), as generate_parameters_grain.sage does.
+ */
+static void poseidon_generate(PoseidonParams *params, MontField *f) {
+    const int n = 254;
+    int t = params->t;
+    GrainLfsr g;
+    grain_init(&g, 1, 0, n, t, params->r_f, params->r_p);
+
+    // Round constants are sampled by rejection of anything >= p. (Despite its
+    // name, bigint_gt(a, b) is a >= b.)
+    int num_constants = (params->r_f + params->r_p) * t;
+    for (int i = 0; i < num_constants; i ++) {
+        BigInt c;
+        do {
+            c = grain_random_bits(&g, n);
+        } while (bigint_gt(&c, &f->p));
+        params->c[i] = field_to_mont(&c, f);
+    }
+
+    // The MDS matrix samples are reduced mod p instead. Duplicate samples or
+    // a zero x_i + y_j would make the script resample, which does not happen
+    // for any of the widths here.
+    BigInt xy[2 * POSEIDON_MAX_T];
+    for (int i = 0; i < 2 * t; i ++) {
+        // 2^254 < 2p, so one subtraction is enough.
+        BigInt s = grain_random_bits(&g, n);
+        if (bigint_gt(&s, &f->p)) {
+            s = field_sub(&s, &f->p, f);
+        }
+        xy[i] = field_to_mont(&s, f);
+    }
+    for (int i = 0; i < t; i ++) {
+        for (int j = 0; j < t; j ++) {
+            BigInt s = field_add(&xy[i], &xy[t + j], f);
+            params->m[i][j] = poseidon_inv(&s, f);
+        }
+    }
+}
+
+/// Generates and precomputes the constants for width t, in 2..17.
+/// Returns 0 on success, or -1 if t is out of range.
+int poseidon_init(PoseidonParams *params, int t, MontField *f) {
+    if (t < POSEIDON_MIN_T || t > POSEIDON_MAX_T) {
+        return -1;
+    }
+    params->t = t;
+    params->r_f = POSEIDON_FULL_ROUNDS;
+    params->r_p = POSEIDON_PARTIAL_ROUNDS[t - POSEIDON_MIN_T];
+
+    params->redc_n0 = field_redc_n0(f);
+
+    poseidon_generate(params, f);
+
+    int half = params->r_f / 2;
+    int r_p = params->r_p;
+
+    // Fold the partial-round constants forward. d is the part of the
+    // constants still to be added to the state.
+    BigInt d[POSEIDON_MAX_T];
+    for (int i = 0; i < t; i ++) {
+        d[i] = bigint_new();
+    }
+    for (int k = 0; k < r_p; k ++) {
+        BigInt e[POSEIDON_MAX_T];
+        for (int i = 0; i < t; i ++) {
+            e[i] = field_add(&params->c[(half + k) * t + i], &d[i], f);
+        }
+        params->c_partial[k] = e[0];
+        e[0] = bigint_new();
+        for (int i = 0; i < t; i ++) {
+            d[i] = poseidon_dot(params->m[i], e, t, params, f);
+        }
+    }
+    for (int r = 0; r < params->r_f; r ++) {
+        int round = r < half ? r : r + r_p;
+        for (int i = 0; i < t; i ++) {
+            params->c_full[r][i] = params->c[round * t + i];
+        }
+    }
+    for (int i = 0; i < t; i ++) {
+        params->c_full[half][i] = field_add(&params->c_full[half][i], &d[i], f);
+    }
+
+    // Factor the partial-round matrices from the last one backwards. n holds
+    // the matrix of the current round, D_next * M.
+    BigInt n[POSEIDON_MAX_T][POSEIDON_MAX_T];
+    for (int i = 0; i < t; i ++) {
+        for (int j = 0; j < t; j ++) {
+            n[i][j] = params->m[i][j];
+        }
+    }
+    for (int k = r_p - 1; k >= 0; k --) {
+        // n = [[a, b^T], [v, C]] = S * diag(1, C), with w = C^-T b.
+        BigInt a_t[(POSEIDON_MAX_T - 1) * (POSEIDON_MAX_T - 1)];
+        BigInt w[POSEIDON_MAX_T - 1];
+        for (int i = 1; i < t; i ++) {
+            for (int j = 1; j < t; j ++) {
+                a_t[(i - 1) * (t - 1) + (j - 1)] = n[j][i];
+            }
+            w[i - 1] = n[0][i];
+        }
+        if (poseidon_solve(a_t, w, t - 1, f) != 0) {
+            return -1;
+        }
+
+        params->sparse_row[k][0] = n[0][0];
+        params->sparse_col[k][0] = bigint_new();
+        for (int i = 1; i < t; i ++) {
+            params->sparse_row[k][i] = w[i - 1];
+            params->sparse_col[k][i] = n[i][0];
+        }
+
+        // n = diag(1, C) * M for the round before.
+        BigInt next[POSEIDON_MAX_T][POSEIDON_MAX_T];
+        BigInt col[POSEIDON_MAX_T];
+        for (int j = 0; j < t; j ++) {
+            next[0][j] = params->m[0][j];
+            for (int l = 0; l < t; l ++) {
+                col[l] = params->m[l][j];
+            }
+            for (int i = 1; i < t; i ++) {
+                next[i][j] = poseidon_dot(&n[i][1], &col[1], t - 1, params, f);
+            }
+        }
+        for (int i = 0; i < t; i ++) {
+            for (int j = 0; j < t; j ++) {
+                n[i][j] = next[i][j];
+            }
+        }
+    }
+    for (int i = 0; i < t; i ++) {
+        for (int j = 0; j < t; j ++) {
+            params->m_pre[i][j] = n[i][j];
+        }
+    }
+    return 0;
+}
+
+static inline void poseidon_full_round(
+    BigInt *state,
+    BigInt *c,
+    BigInt m[POSEIDON_MAX_T][POSEIDON_MAX_T],
+    PoseidonParams *params,
+    MontField *f
+) {
+    int t = params->t;
+    BigInt s[POSEIDON_MAX_T];
+    for (int i = 0; i < t; i ++) {
+        s[i] = field_add(&state[i], &c[i], f);
+        s[i] = poseidon_sbox(&s[i], f);
+    }
+    for (int i = 0; i < t; i ++) {
+        state[i] = poseidon_dot(m[i], s, t, params, f);
+    }
+}
+
+// Partial round k of the optimised structure: one S-box and one sparse
+// matrix.
+static inline void poseidon_partial_round(
+    BigInt *state,
+    int k,
+    PoseidonParams *params,
+    MontField *f
+) {
+    int t = params->t;
+    BigInt x0 = field_add(&state[0], &params->c_partial[k], f);
+    x0 = poseidon_sbox(&x0, f);
+    state[0] = x0;
+
+    BigInt s0 = poseidon_dot(params->sparse_row[k], state, t, params, f);
+    for (int i = 1; i < t; i ++) {
+        BigInt vx = field_mul(&params->sparse_col[k][i], &x0, f);
+        state[i] = field_add(&state[i], &vx, f);
+    }
+    state[0] = s0;
+}
+
+/// Applies the Poseidon permutation to state[0..t - 1] in place, using the
+/// optimised round structure.
+void poseidon_permute(BigInt *state, PoseidonParams *params, MontField *f) {
+    int half = params->r_f / 2;
+
+    for (int r = 0; r < half - 1; r ++) {
+        poseidon_full_round(state, params->c_full[r], params->m, params, f);
+    }
+    poseidon_full_round(state, params->c_full[half - 1], params->m_pre, params, f);
+
+    for (int k = 0; k < params->r_p; k ++) {
+        poseidon_partial_round(state, k, params, f);
+    }
+
+    for (int r = half; r < params->r_f; r ++) {
+        poseidon_full_round(state, params->c_full[r], params->m, params, f);
+    }
+}
+
+/// Applies the permutation to count independent states, stored one after
+/// another with stride t, in lock-step round by round. A single permutation
+/// is one long dependency chain (especially through state[0] in the partial
+/// rounds), so running several side by side gives the core independent
+/// multiplications to overlap.
+void poseidon_permute_batch(BigInt *states, int count, PoseidonParams *params, MontField *f) {
+    int t = params->t;
+    int half = params->r_f / 2;
+
+    for (int r = 0; r < half; r ++) {
+        BigInt (*m)[POSEIDON_MAX_T] = r == half - 1 ? params->m_pre : params->m;
+        for (int j = 0; j < count; j ++) {
+            poseidon_full_round(&states[j * t], params->c_full[r], m, params, f);
+        }
+    }
+    for (int k = 0; k < params->r_p; k ++) {
+        for (int j = 0; j < count; j ++) {
+            poseidon_partial_round(&states[j * t], k, params, f);
+        }
+    }
+    for (int r = half; r < params->r_f; r ++) {
+        for (int j = 0; j < count; j ++) {
+            poseidon_full_round(&states[j * t], params->c_full[r], params->m, params, f);
+        }
+    }
+}
+
+/// Applies the Poseidon permutation round by round as specified, with t^2
+/// multiplications per round. For testing poseidon_permute.
+void poseidon_permute_reference(BigInt *state, PoseidonParams *params, MontField *f) {
+    int t = params->t;
+    int half = params->r_f / 2;
+    int num_rounds = params->r_f + params->r_p;
+
+    for (int r = 0; r < num_rounds; r ++) {
+        BigInt s[POSEIDON_MAX_T];
+        for (int i = 0; i < t; i ++) {
+            s[i] = field_add(&state[i], &params->c[r * t + i], f);
+        }
+        if (r < half || r >= half + params->r_p) {
+            for (int i = 0; i < t; i ++) {
+                s[i] = poseidon_sbox(&s[i], f);
+            }
+        } else {
+            s[0] = poseidon_sbox(&s[0], f);
+        }
+        for (int i = 0; i < t; i ++) {
+            BigInt acc = bigint_new();
+            for (int j = 0; j < t; j ++) {
+                BigInt x = field_mul(&params->m[i][j], &s[j], f);
+                acc = field_add(&acc, &x, f);
+            }
+            state[i] = acc;
+        }
+    }
+}
+
+/// Hashes exactly t - 1 inputs the way circomlib's Poseidon does: the state
+/// is [0, inputs...], and the output is state[0] after one permutation.
+BigInt poseidon_hash(BigInt *inputs, PoseidonParams *params, MontField *f) {
+    BigInt state[POSEIDON_MAX_T];
+    state[0] = bigint_new();
+    for (int i = 1; i < params->t; i ++) {
+        state[i] = inputs[i - 1];
+    }
+    poseidon_permute(state, params, f);
+    return state[0];
+}
+
+// A sponge with capacity 1 (state[0]) and rate t - 1 (state[1..t - 1]), for
+// inputs of any length.
+typedef struct {
+    PoseidonParams *params;
+    BigInt state[POSEIDON_MAX_T];
+    int pos; // the next rate element to absorb into or squeeze from
+    bool squeezing;
+} PoseidonSponge;
+
+void poseidon_sponge_init(PoseidonSponge *sponge, PoseidonParams *params) {
+    sponge->params = params;
+    for (int i = 0; i < POSEIDON_MAX_T; i ++) {
+        sponge->state[i] = bigint_new();
+    }
+    sponge->pos = 0;
+    sponge->squeezing = false;
+}
+
+/// Absorbs n field elements. Must not be called after squeezing has started.
+void poseidon_sponge_absorb(PoseidonSponge *sponge, BigInt *inputs, size_t n, MontField *f) {
+    int rate = sponge->params->t - 1;
+    for (size_t i = 0; i < n; i ++) {
+        if (sponge->pos == rate) {
+            poseidon_permute(sponge->state, sponge->params, f);
+            sponge->pos = 0;
+        }
+        BigInt *s = &sponge->state[1 + sponge->pos];
+        *s = field_add(s, &inputs[i], f);
+        sponge->pos ++;
+    }
+}
+
+/// Squeezes one field element. The first call pads the input with a single 1
+/// (so that inputs which differ only in trailing zeros hash differently) and
+/// permutes.
+BigInt poseidon_sponge_squeeze(PoseidonSponge *sponge, MontField *f) {
+    int rate = sponge->params->t - 1;
+    if (!sponge->squeezing) {
+        if (sponge->pos == rate) {
+            poseidon_permute(sponge->state, sponge->params, f);
+            sponge->pos = 0;
+        }
+        BigInt *s = &sponge->state[1 + sponge->pos];
+        *s = field_add(s, &f->one, f);
+        poseidon_permute(sponge->state, sponge->params, f);
+        sponge->pos = 0;
+        sponge->squeezing = true;
+    }
+    if (sponge->pos == rate) {
+        poseidon_permute(sponge->state, sponge->params, f);
+        sponge->pos = 0;
+    }
+    return sponge->state[1 + sponge->pos ++];
+}
@@ -0,0 +1,193 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+
+// Windowed modular exponentiation in the Montgomery domain.
+// Include c/field.h and a Montgomery multiplication kernel before this file.
+// Squarings go through field_sqr, which uses the kernel's dedicated mont_sqr
+// if it has one.
+//
+// Exponents are BigInts in canonical (non-Montgomery) form.
+
+// The window size used by mont_pow and mont_pow_ct. Override it per device
+// with -DMONT_POW_WINDOW=<w>; see benchmarks/pow.
+#ifndef MONT_POW_WINDOW
+#define MONT_POW_WINDOW 4
+#endif
+
+#define MONT_POW_MAX_WINDOW 8
+
+/*
+ * Returns the position of the highest set bit of e, plus 1.
+ */
+static inline int pow_num_bits(BigInt *e) {
+    for (int i = NUM_LIMBS - 1; i >= 0; i --) {
+        uint64_t limb = e->v[i] & LIMB_MASK;
+        if (limb != 0) {
+            return i * BITS_PER_LIMB + 64 - __builtin_clzll(limb);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Returns bit i of e, or 0 if i is out of range.
+ */
+static inline uint32_t pow_bit(BigInt *e, int i) {
+    if (i < 0 || i >= NUM_LIMBS * BITS_PER_LIMB) {
+        return 0;
+    }
+    return (e->v[i / BITS_PER_LIMB] >> (i % BITS_PER_LIMB)) & 1;
+}
+
+/*
+ * Returns the w bits of e starting at bit lo_bit, as an integer.
+ */
+static inline uint32_t pow_window(BigInt *e, int lo_bit, int w) {
+    uint32_t window = 0;
+    for (int i = w - 1; i >= 0; i --) {
+        window = (window << 1) | pow_bit(e, lo_bit + i);
+    }
+    return window;
+}
+
+/*
+ * Returns table[idx] without branching on idx or indexing memory with it.
+ */
+static inline BigInt pow_ct_select(BigInt *table, int table_size, uint32_t idx) {
+    BigInt res = bigint_new();
+    for (uint32_t i = 0; i < (uint32_t)table_size; i ++) {
+        // All ones if i == idx, otherwise zero.
+        uint64_t mask = 0 - (uint64_t)(((i ^ idx) - 1) >> 31);
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            res.v[j] |= table[i].v[j] & mask;
+        }
+    }
+    return res;
+}
+
+/// Left-to-right fixed-window exponentiation with a table of
+/// x^0, x^1, ..., x^(2^w - 1).
+///
+/// If constant_time is set, the sequence of squarings and multiplications
+/// depends only on w and the limb layout: every window of the full-width
+/// exponent is processed, zero windows included, and the table is read with a
+/// masked scan. The kernels' final conditional subtraction still branches on
+/// its data.
+BigInt mont_pow_fixed(
+    BigInt *base,
+    BigInt *exp,
+    int w,
+    bool constant_time,
+    MontField *f
+) {
+    assert(w >= 1 && w <= MONT_POW_MAX_WINDOW);
+
+    int table_size = 1 << w;
+    BigInt table[1 << MONT_POW_MAX_WINDOW];
+    table[0] = f->one;
+    table[1] = *base;
+    for (int i = 2; i < table_size; i ++) {
+        table[i] = field_mul(&table[i - 1], base, f);
+    }
+
+    int num_bits = constant_time ? NUM_LIMBS * BITS_PER_LIMB : pow_num_bits(exp);
+    if (num_bits == 0) {
+        return f->one;
+    }
+    int num_windows = (num_bits + w - 1) / w;
+
+    BigInt z;
+    int k = num_windows - 1;
+    uint32_t window = pow_window(exp, k * w, w);
+    z = constant_time ? pow_ct_select(table, table_size, window) : table[window];
+
+    for (k = num_windows - 2; k >= 0; k --) {
+        for (int i = 0; i < w; i ++) {
+            z = field_sqr(&z, f);
+        }
+        window = pow_window(exp, k * w, w);
+        if (constant_time) {
+            BigInt x = pow_ct_select(table, table_size, window);
+            z = field_mul(&z, &x, f);
+        } else if (window != 0) {
+            z = field_mul(&z, &table[window], f);
+        }
+    }
+    return z;
+}
+
+/// Left-to-right sliding-window exponentiation with a table of the odd powers
+/// x, x^3, ..., x^(2^w - 1). Zero bits cost one squaring each, and each window
+/// of up to w bits that starts and ends with a 1 costs one multiplication.
+/// Not constant-time.
+BigInt mont_pow_sliding(
+    BigInt *base,
+    BigInt *exp,
+    int w,
+    MontField *f
+) {
+    assert(w >= 1 && w <= MONT_POW_MAX_WINDOW);
+
+    int table_size = 1 << (w - 1);
+    BigInt table[1 << (MONT_POW_MAX_WINDOW - 1)];
+    table[0] = *base;
+    if (table_size > 1) {
+        BigInt x2 = field_sqr(base, f);
+        for (int i = 1; i < table_size; i ++) {
+            table[i] = field_mul(&table[i - 1], &x2, f);
+        }
+    }
+
+    BigInt z = f->one;
+    bool first = true;
+    int i = pow_num_bits(exp) - 1;
+    while (i >= 0) {
+        if (pow_bit(exp, i) == 0) {
+            if (!first) {
+                z = field_sqr(&z, f);
+            }
+            i --;
+            continue;
+        }
+
+        // The longest window of at most w bits that ends with a 1
+        int l = i + 1 < w ? i + 1 : w;
+        while (pow_bit(exp, i - l + 1) == 0) {
+            l --;
+        }
+        uint32_t window = pow_window(exp, i - l + 1, l);
+
+        if (first) {
+            z = table[window >> 1];
+            first = false;
+        } else {
+            for (int j = 0; j < l; j ++) {
+                z = field_sqr(&z, f);
+            }
+            z = field_mul(&z, &table[window >> 1], f);
+        }
+        i -= l;
+    }
+    return z;
+}
+
+/// Computes base^exp with the default window size. Not constant-time; use
+/// mont_pow_ct for secret exponents.
+BigInt mont_pow(
+    BigInt *base,
+    BigInt *exp,
+    MontField *f
+) {
+    return mont_pow_sliding(base, exp, MONT_POW_WINDOW, f);
+}
+
+/// Computes base^exp with a fixed window and a constant sequence of
+/// operations.
+BigInt mont_pow_ct(
+    BigInt *base,
+    BigInt *exp,
+    MontField *f
+) {
+    return mont_pow_fixed(base, exp, MONT_POW_WINDOW, true, f);
+}
@@ -0,0 +1,246 @@
+#include <stdint.h>
+
+// Constant-time modular inversion using the Bernstein-Yang "safegcd" divsteps
+// algorithm, with 30-bit signed limbs and 30-divstep transition matrices.
+// Every product is a 32x32 -> 64-bit multiplication, so this variant suits
+// 32-bit limb layouts and cores with narrow multipliers.
+//
+// Daniel J. Bernstein and Bo-Yin Yang. Fast constant-time gcd computation and
+// modular inversion. https://eprint.iacr.org/2019/266
+//
+// Ported from libsecp256k1's modinv32 (MIT licence):
+// https://github.com/bitcoin-core/secp256k1/blob/master/src/modinv32_impl.h
+
+#define SAFEGCD_M30 (UINT32_MAX >> 2)
+#define SAFEGCD_NUM_LIMBS_30 9
+
+// 9 signed 30-bit limbs in little-endian form. The top limb carries the sign.
+typedef struct {
+    int32_t v[SAFEGCD_NUM_LIMBS_30];
+} Signed30;
+
+// A transition matrix [[u, v], [q, r]] for 30 divsteps, scaled by 2^30.
+typedef struct {
+    int32_t u, v, q, r;
+} Trans2x2;
+
+static inline Signed30 bigint_to_signed30(const BigInt *a) {
+    Signed30 r;
+    uint64_t acc = 0;
+    int acc_bits = 0;
+    int j = 0;
+    for (int i = 0; i < SAFEGCD_NUM_LIMBS_30; i ++) {
+        if (acc_bits < 30 && j < NUM_LIMBS) {
+            acc |= (a->v[j] & LIMB_MASK) << acc_bits;
+            acc_bits += BITS_PER_LIMB;
+            j ++;
+        }
+        r.v[i] = (int32_t)(acc & SAFEGCD_M30);
+        acc >>= 30;
+        acc_bits -= 30;
+    }
+    return r;
+}
+
+// Assumes that every limb of a is in [0, 2^30), i.e. a has been normalised.
+static inline BigInt signed30_to_bigint(const Signed30 *a) {
+    BigInt r;
+    uint64_t acc = 0;
+    int acc_bits = 0;
+    int j = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        while (acc_bits < BITS_PER_LIMB && j < SAFEGCD_NUM_LIMBS_30) {
+            acc |= (uint64_t)(uint32_t)a->v[j] << acc_bits;
+            acc_bits += 30;
+            j ++;
+        }
+        r.v[i] = acc & LIMB_MASK;
+        acc >>= BITS_PER_LIMB;
+        acc_bits -= BITS_PER_LIMB;
+    }
+    return r;
+}
+
+// Performs 30 branchless divsteps on the lowest limbs of f and g, and returns
+// the new zeta = -(delta + 1/2). The transition matrix is written to t.
+static inline int32_t safegcd_divsteps_30(
+    int32_t zeta,
+    uint32_t f0,
+    uint32_t g0,
+    Trans2x2 *t
+) {
+    // u, v, q, r are signed, but kept as unsigned values so that left shifts
+    // of negative values are well-defined.
+    uint32_t u = 1, v = 0, q = 0, r = 1;
+    uint32_t f = f0, g = g0;
+    uint32_t mask1, mask2, x, y, z;
+
+    for (int i = 0; i < 30; i ++) {
+        // mask1 = (zeta < 0), mask2 = (g is odd)
+        mask1 = (uint32_t)(zeta >> 31);
+        mask2 = -(g & 1);
+
+        // Conditionally negate f, u, v and add them to g, q, r.
+        x = (f ^ mask1) - mask1;
+        y = (u ^ mask1) - mask1;
+        z = (v ^ mask1) - mask1;
+        g += x & mask2;
+        q += y & mask2;
+        r += z & mask2;
+
+        // If both conditions hold, swap: zeta -> -zeta - 2, else zeta -> zeta - 1.
+        mask1 &= mask2;
+        zeta = (zeta ^ (int32_t)mask1) - 1;
+
+        // Conditionally add g, q, r back to f, u, v.
+        f += g & mask1;
+        u += q & mask1;
+        v += r & mask1;
+
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+
+    t->u = (int32_t)u;
+    t->v = (int32_t)v;
+    t->q = (int32_t)q;
+    t->r = (int32_t)r;
+    return zeta;
+}
+
+// Computes (t * [d, e] + p * [md, me]) / 2^30, choosing md and me so that the
+// division is exact. d and e stay within (-2p, p).
+static inline void safegcd_update_de_30(
+    Signed30 *d,
+    Signed30 *e,
+    const Trans2x2 *t,
+    const Signed30 *p,
+    uint32_t p_inv30
+) {
+    const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int32_t sd = d->v[SAFEGCD_NUM_LIMBS_30 - 1] >> 31;
+    int32_t se = e->v[SAFEGCD_NUM_LIMBS_30 - 1] >> 31;
+    int32_t md = (u & sd) + (v & se);
+    int32_t me = (q & sd) + (r & se);
+    int64_t cd, ce;
+
+    cd = (int64_t)u * d->v[0] + (int64_t)v * e->v[0];
+    ce = (int64_t)q * d->v[0] + (int64_t)r * e->v[0];
+
+    // Correct md and me so that the bottom 30 bits become zero.
+    md -= (p_inv30 * (uint32_t)cd + md) & SAFEGCD_M30;
+    me -= (p_inv30 * (uint32_t)ce + me) & SAFEGCD_M30;
+
+    cd += (int64_t)p->v[0] * md;
+    ce += (int64_t)p->v[0] * me;
+    cd >>= 30;
+    ce >>= 30;
+
+    for (int i = 1; i < SAFEGCD_NUM_LIMBS_30; i ++) {
+        cd += (int64_t)u * d->v[i] + (int64_t)v * e->v[i];
+        ce += (int64_t)q * d->v[i] + (int64_t)r * e->v[i];
+        cd += (int64_t)p->v[i] * md;
+        ce += (int64_t)p->v[i] * me;
+        d->v[i - 1] = (int32_t)((uint32_t)cd & SAFEGCD_M30);
+        e->v[i - 1] = (int32_t)((uint32_t)ce & SAFEGCD_M30);
+        cd >>= 30;
+        ce >>= 30;
+    }
+    d->v[SAFEGCD_NUM_LIMBS_30 - 1] = (int32_t)cd;
+    e->v[SAFEGCD_NUM_LIMBS_30 - 1] = (int32_t)ce;
+}
+
+// Computes (t * [f, g]) / 2^30. The division is always exact.
+static inline void safegcd_update_fg_30(
+    Signed30 *f,
+    Signed30 *g,
+    const Trans2x2 *t
+) {
+    const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int64_t cf, cg;
+
+    cf = (int64_t)u * f->v[0] + (int64_t)v * g->v[0];
+    cg = (int64_t)q * f->v[0] + (int64_t)r * g->v[0];
+    cf >>= 30;
+    cg >>= 30;
+
+    for (int i = 1; i < SAFEGCD_NUM_LIMBS_30; i ++) {
+        cf += (int64_t)u * f->v[i] + (int64_t)v * g->v[i];
+        cg += (int64_t)q * f->v[i] + (int64_t)r * g->v[i];
+        f->v[i - 1] = (int32_t)((uint32_t)cf & SAFEGCD_M30);
+        g->v[i - 1] = (int32_t)((uint32_t)cg & SAFEGCD_M30);
+        cf >>= 30;
+        cg >>= 30;
+    }
+    f->v[SAFEGCD_NUM_LIMBS_30 - 1] = (int32_t)cf;
+    g->v[SAFEGCD_NUM_LIMBS_30 - 1] = (int32_t)cg;
+}
+
+// Brings r from (-2p, p) to [0, p), negating it first if sign < 0.
+static inline void safegcd_normalize_30(
+    Signed30 *r,
+    int32_t sign,
+    const Signed30 *p
+) {
+    const int32_t M30 = (int32_t)SAFEGCD_M30;
+    const int n = SAFEGCD_NUM_LIMBS_30;
+    int32_t cond_add = r->v[n - 1] >> 31;
+    int32_t cond_negate = sign >> 31;
+
+    for (int i = 0; i < n; i ++) {
+        r->v[i] += p->v[i] & cond_add;
+        r->v[i] = (r->v[i] ^ cond_negate) - cond_negate;
+    }
+    for (int i = 0; i < n - 1; i ++) {
+        r->v[i + 1] += r->v[i] >> 30;
+        r->v[i] &= M30;
+    }
+
+    cond_add = r->v[n - 1] >> 31;
+    for (int i = 0; i < n; i ++) {
+        r->v[i] += p->v[i] & cond_add;
+    }
+    for (int i = 0; i < n - 1; i ++) {
+        r->v[i + 1] += r->v[i] >> 30;
+        r->v[i] &= M30;
+    }
+}
+
+/// Computes the inverse of ar in constant time, where ar = aR mod p is in
+/// Montgomery form, and returns a^-1 R mod p (also in Montgomery form).
+/// Returns 0 if ar is 0.
+///
+/// The divsteps track d, e such that f = d * x / c and g = e * x / c. Starting
+/// with e = c = R^2 instead of 1 means that d ends up as R^2 / (aR) = a^-1 R,
+/// so no Montgomery multiplication is needed to correct the result.
+///
+/// r2 is R^2 mod p, and n0 is -p^-1 mod 2^32, from which p^-1 mod 2^30 follows.
+BigInt mont_inv(
+    BigInt *ar,
+    BigInt *p,
+    BigInt *r2,
+    uint64_t n0
+) {
+    Signed30 modulus = bigint_to_signed30(p);
+    uint32_t p_inv30 = (0 - (uint32_t)n0) & SAFEGCD_M30;
+
+    Signed30 d = {{0}};
+    Signed30 e = bigint_to_signed30(r2);
+    Signed30 f = modulus;
+    Signed30 g = bigint_to_signed30(ar);
+    int32_t zeta = -1; // delta = 1/2
+
+    // 20 x 30 = 600 divsteps, which exceeds the 590 needed for 256-bit inputs.
+    for (int i = 0; i < 20; i ++) {
+        Trans2x2 t;
+        zeta = safegcd_divsteps_30(zeta, f.v[0], g.v[0], &t);
+        safegcd_update_de_30(&d, &e, &t, &modulus, p_inv30);
+        safegcd_update_fg_30(&f, &g, &t);
+    }
+
+    // f is now +/-1, and d is +/- the inverse.
+    safegcd_normalize_30(&d, f.v[SAFEGCD_NUM_LIMBS_30 - 1], &modulus);
+
+    return signed30_to_bigint(&d);
+}
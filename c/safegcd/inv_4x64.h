@@ -0,0 +1,229 @@
+#include <stdint.h>
+
+// Constant-time modular inversion using the Bernstein-Yang "safegcd" divsteps
+// algorithm, with 62-bit signed limbs and 62-divstep transition matrices.
+//
+// Daniel J. Bernstein and Bo-Yin Yang. Fast constant-time gcd computation and
+// modular inversion. https://eprint.iacr.org/2019/266
+//
+// Ported from libsecp256k1's modinv64 (MIT licence), with the half-delta
+// bound of 590 divsteps for 256-bit moduli:
+// https://github.com/bitcoin-core/secp256k1/blob/master/doc/safegcd_implementation.md
+
+typedef __int128 int128_t;
+
+#define SAFEGCD_M62 (UINT64_MAX >> 2)
+
+// 5 signed 62-bit limbs in little-endian form. The top limb carries the sign.
+typedef struct {
+    int64_t v[5];
+} Signed62;
+
+// A transition matrix [[u, v], [q, r]] for 62 divsteps, scaled by 2^62.
+typedef struct {
+    int64_t u, v, q, r;
+} Trans2x2;
+
+static inline Signed62 bigint_to_signed62(const BigInt *a) {
+    Signed62 r;
+    r.v[0] = a->v[0] & SAFEGCD_M62;
+    r.v[1] = ((a->v[0] >> 62) | (a->v[1] << 2)) & SAFEGCD_M62;
+    r.v[2] = ((a->v[1] >> 60) | (a->v[2] << 4)) & SAFEGCD_M62;
+    r.v[3] = ((a->v[2] >> 58) | (a->v[3] << 6)) & SAFEGCD_M62;
+    r.v[4] = a->v[3] >> 56;
+    return r;
+}
+
+// Assumes that every limb of a is in [0, 2^62), i.e. a has been normalised.
+static inline BigInt signed62_to_bigint(const Signed62 *a) {
+    uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2], a3 = a->v[3], a4 = a->v[4];
+    BigInt r;
+    r.v[0] = a0 | (a1 << 62);
+    r.v[1] = (a1 >> 2) | (a2 << 60);
+    r.v[2] = (a2 >> 4) | (a3 << 58);
+    r.v[3] = (a3 >> 6) | (a4 << 56);
+    return r;
+}
+
+// Performs 62 branchless divsteps on the lowest limbs of f and g, and returns
+// the new zeta = -(delta + 1/2). The transition matrix is written to t.
+static inline int64_t safegcd_divsteps_62(
+    int64_t zeta,
+    uint64_t f0,
+    uint64_t g0,
+    Trans2x2 *t
+) {
+    // u, v, q, r are signed, but kept as unsigned values so that left shifts
+    // of negative values are well-defined.
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t f = f0, g = g0;
+    uint64_t mask1, mask2, x, y, z;
+
+    for (int i = 0; i < 62; i ++) {
+        // mask1 = (zeta < 0), mask2 = (g is odd)
+        mask1 = (uint64_t)(zeta >> 63);
+        mask2 = -(g & 1);
+
+        // Conditionally negate f, u, v and add them to g, q, r.
+        x = (f ^ mask1) - mask1;
+        y = (u ^ mask1) - mask1;
+        z = (v ^ mask1) - mask1;
+        g += x & mask2;
+        q += y & mask2;
+        r += z & mask2;
+
+        // If both conditions hold, swap: zeta -> -zeta - 2, else zeta -> zeta - 1.
+        mask1 &= mask2;
+        zeta = (zeta ^ (int64_t)mask1) - 1;
+
+        // Conditionally add g, q, r back to f, u, v.
+        f += g & mask1;
+        u += q & mask1;
+        v += r & mask1;
+
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+
+    t->u = (int64_t)u;
+    t->v = (int64_t)v;
+    t->q = (int64_t)q;
+    t->r = (int64_t)r;
+    return zeta;
+}
+
+// Computes (t * [d, e] + p * [md, me]) / 2^62, choosing md and me so that the
+// division is exact. d and e stay within (-2p, p).
+static inline void safegcd_update_de_62(
+    Signed62 *d,
+    Signed62 *e,
+    const Trans2x2 *t,
+    const Signed62 *p,
+    uint64_t p_inv62
+) {
+    const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int64_t sd = d->v[4] >> 63;
+    int64_t se = e->v[4] >> 63;
+    int64_t md = (u & sd) + (v & se);
+    int64_t me = (q & sd) + (r & se);
+    int128_t cd, ce;
+
+    cd = (int128_t)u * d->v[0] + (int128_t)v * e->v[0];
+    ce = (int128_t)q * d->v[0] + (int128_t)r * e->v[0];
+
+    // Correct md and me so that the bottom 62 bits become zero.
+    md -= (p_inv62 * (uint64_t)cd + md) & SAFEGCD_M62;
+    me -= (p_inv62 * (uint64_t)ce + me) & SAFEGCD_M62;
+
+    cd += (int128_t)p->v[0] * md;
+    ce += (int128_t)p->v[0] * me;
+    cd >>= 62;
+    ce >>= 62;
+
+    for (int i = 1; i < 5; i ++) {
+        cd += (int128_t)u * d->v[i] + (int128_t)v * e->v[i];
+        ce += (int128_t)q * d->v[i] + (int128_t)r * e->v[i];
+        cd += (int128_t)p->v[i] * md;
+        ce += (int128_t)p->v[i] * me;
+        d->v[i - 1] = (int64_t)((uint64_t)cd & SAFEGCD_M62);
+        e->v[i - 1] = (int64_t)((uint64_t)ce & SAFEGCD_M62);
+        cd >>= 62;
+        ce >>= 62;
+    }
+    d->v[4] = (int64_t)cd;
+    e->v[4] = (int64_t)ce;
+}
+
+// Computes (t * [f, g]) / 2^62. The division is always exact.
+static inline void safegcd_update_fg_62(
+    Signed62 *f,
+    Signed62 *g,
+    const Trans2x2 *t
+) {
+    const int64_t u = t->u, v = t->v, q = t->q, r = t->r;
+    int128_t cf, cg;
+
+    cf = (int128_t)u * f->v[0] + (int128_t)v * g->v[0];
+    cg = (int128_t)q * f->v[0] + (int128_t)r * g->v[0];
+    cf >>= 62;
+    cg >>= 62;
+
+    for (int i = 1; i < 5; i ++) {
+        cf += (int128_t)u * f->v[i] + (int128_t)v * g->v[i];
+        cg += (int128_t)q * f->v[i] + (int128_t)r * g->v[i];
+        f->v[i - 1] = (int64_t)((uint64_t)cf & SAFEGCD_M62);
+        g->v[i - 1] = (int64_t)((uint64_t)cg & SAFEGCD_M62);
+        cf >>= 62;
+        cg >>= 62;
+    }
+    f->v[4] = (int64_t)cf;
+    g->v[4] = (int64_t)cg;
+}
+
+// Brings r from (-2p, p) to [0, p), negating it first if sign < 0.
+static inline void safegcd_normalize_62(
+    Signed62 *r,
+    int64_t sign,
+    const Signed62 *p
+) {
+    const int64_t M62 = (int64_t)SAFEGCD_M62;
+    int64_t cond_add = r->v[4] >> 63;
+    int64_t cond_negate = sign >> 63;
+
+    for (int i = 0; i < 5; i ++) {
+        r->v[i] += p->v[i] & cond_add;
+        r->v[i] = (r->v[i] ^ cond_negate) - cond_negate;
+    }
+    for (int i = 0; i < 4; i ++) {
+        r->v[i + 1] += r->v[i] >> 62;
+        r->v[i] &= M62;
+    }
+
+    cond_add = r->v[4] >> 63;
+    for (int i = 0; i < 5; i ++) {
+        r->v[i] += p->v[i] & cond_add;
+    }
+    for (int i = 0; i < 4; i ++) {
+        r->v[i + 1] += r->v[i] >> 62;
+        r->v[i] &= M62;
+    }
+}
+
+/// Computes the inverse of ar in constant time, where ar = aR mod p is in
+/// Montgomery form, and returns a^-1 R mod p (also in Montgomery form).
+/// Returns 0 if ar is 0.
+///
+/// The divsteps track d, e such that f = d * x / c and g = e * x / c. Starting
+/// with e = c = R^2 instead of 1 means that d ends up as R^2 / (aR) = a^-1 R,
+/// so no Montgomery multiplication is needed to correct the result.
+///
+/// r2 is R^2 mod p, and n0 is -p^-1 mod 2^64, from which p^-1 mod 2^62 follows.
+BigInt mont_inv(
+    BigInt *ar,
+    BigInt *p,
+    BigInt *r2,
+    uint64_t n0
+) {
+    Signed62 modulus = bigint_to_signed62(p);
+    uint64_t p_inv62 = (0 - n0) & SAFEGCD_M62;
+
+    Signed62 d = {{0, 0, 0, 0, 0}};
+    Signed62 e = bigint_to_signed62(r2);
+    Signed62 f = modulus;
+    Signed62 g = bigint_to_signed62(ar);
+    int64_t zeta = -1; // delta = 1/2
+
+    // 10 x 62 = 620 divsteps, which exceeds the 590 needed for 256-bit inputs.
+    for (int i = 0; i < 10; i ++) {
+        Trans2x2 t;
+        zeta = safegcd_divsteps_62(zeta, f.v[0], g.v[0], &t);
+        safegcd_update_de_62(&d, &e, &t, &modulus, p_inv62);
+        safegcd_update_fg_62(&f, &g, &t);
+    }
+
+    // f is now +/-1, and d is +/- the inverse.
+    safegcd_normalize_62(&d, f.v[4], &modulus);
+
+    return signed62_to_bigint(&d);
+}
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <stddef.h>
 #include "../simd/simd.h"
 #include "../transpose.h"
 
@@ -266,6 +267,51 @@ BigInt mont_mul(
     return res;
 }
 
+#define MONT_MUL_PREPARED_AVAILABLE
+
+// Packs the limbs of x into the lane pairs (4, 0), (6, 2), (5, 1), (7, 3)
+// that mont_mul takes for b and p.
+static inline void mont_transpose_operand(BigInt *x, i64 out[4]) {
+    out[0] = i32x2_make(x->v[4], x->v[0]);
+    out[1] = i32x2_make(x->v[6], x->v[2]);
+    out[2] = i32x2_make(x->v[5], x->v[1]);
+    out[3] = i32x2_make(x->v[7], x->v[3]);
+}
+
+// A multiplicand prepared by mont_prepare for repeated multiplication, for
+// NTT twiddles, MDS constants or scaling a vector by a challenge. It holds
+// b and p already transposed into lane pairs, so that each product only
+// has to splat the limbs of a.
+typedef struct {
+    i64 transposed_b[4];
+    i64 transposed_p[4];
+    BigInt p;
+    uint64_t n0;
+} MontPrepared;
+
+void mont_prepare(MontPrepared *prep, BigInt *br, BigInt *p, uint64_t n0) {
+    mont_transpose_operand(br, prep->transposed_b);
+    mont_transpose_operand(p, prep->transposed_p);
+    prep->p = *p;
+    prep->n0 = n0;
+}
+
+// mont_mul of ar and the br that prep was prepared with.
+static inline BigInt mont_mul_prepared(BigInt *ar, MontPrepared *prep) {
+    i64 vai[NUM_LIMBS];
+    for (int i = 0; i < NUM_LIMBS; i++) {
+        vai[i] = i32x2_splat(ar->v[i]);
+    }
+    return mont_mul(vai, prep->transposed_b, &prep->p, prep->transposed_p, prep->n0);
+}
+
+// Sets out[i] = in[i] * b for i < n, where prep holds b. out may be in.
+void mont_scale_vector(BigInt *out, BigInt *in, MontPrepared *prep, size_t n) {
+    for (size_t i = 0; i < n; i ++) {
+        out[i] = mont_mul_prepared(&in[i], prep);
+    }
+}
+
 /*
     uint64_t prods[NUM_LIMBS] = {0};
     for (int i = 0; i < NUM_LIMBS; i++) {
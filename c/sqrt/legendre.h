@@ -0,0 +1,136 @@
+#include <stdint.h>
+#include <stddef.h>
+
+// The Legendre symbol over the BN254 scalar field.
+// Include c/field.h, a Montgomery multiplication kernel,
+// c/addchain/addchain.h and c/addchain/bn254_scalar.h before this file.
+//
+// Both methods take x in Montgomery form. R = 2^256 is a square mod p
+// (2 is a square because p = 1 mod 8), so (xR / p) = (x / p) and no
+// conversion out of Montgomery form is needed.
+
+/*
+ * Returns true if every limb of a is zero.
+ */
+static inline bool legendre_is_zero(const BigInt *a) {
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        if (a->v[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Returns true if a < b.
+ */
+static inline bool legendre_lt(const BigInt *a, const BigInt *b) {
+    for (int i = NUM_LIMBS - 1; i >= 0; i --) {
+        if (a->v[i] != b->v[i]) {
+            return a->v[i] < b->v[i];
+        }
+    }
+    return false;
+}
+
+/*
+ * a -= b, assuming a >= b.
+ */
+static inline void legendre_sub(BigInt *a, const BigInt *b) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        uint64_t ai = a->v[i];
+        uint64_t bi = b->v[i];
+        a->v[i] = (ai - bi - borrow) & LIMB_MASK;
+        borrow = (ai < bi) | ((ai == bi) & borrow);
+    }
+}
+
+/*
+ * a >>= k, for 0 < k < BITS_PER_LIMB.
+ */
+static inline void legendre_shr(BigInt *a, int k) {
+    for (int i = 0; i < NUM_LIMBS - 1; i ++) {
+        a->v[i] = ((a->v[i] >> k) | (a->v[i + 1] << (BITS_PER_LIMB - k))) & LIMB_MASK;
+    }
+    a->v[NUM_LIMBS - 1] >>= k;
+}
+
+/// Computes the Legendre symbol (x / p) with the binary Jacobi symbol
+/// algorithm: strip factors of 2 using (2 / n) = (-1)^((n^2 - 1) / 8), swap
+/// using quadratic reciprocity, and subtract. Needs only shifts and
+/// subtractions. Not constant-time.
+///
+/// Returns 1 if x is a non-zero square, -1 if it is not a square, and 0 if it
+/// is zero. p must be an odd prime.
+int legendre_jacobi(BigInt *xr, BigInt *p) {
+    BigInt a = *xr;
+    BigInt n = *p;
+    int t = 1;
+
+    while (!legendre_is_zero(&a)) {
+        // Whole zero limbs can be dropped without changing the sign, since
+        // BITS_PER_LIMB is even.
+        while ((a.v[0] & LIMB_MASK) == 0) {
+            for (int i = 0; i < NUM_LIMBS - 1; i ++) {
+                a.v[i] = a.v[i + 1];
+            }
+            a.v[NUM_LIMBS - 1] = 0;
+        }
+        int z = __builtin_ctzll(a.v[0]);
+        if (z > 0) {
+            legendre_shr(&a, z);
+            uint64_t n_mod_8 = n.v[0] & 7;
+            if ((z & 1) && (n_mod_8 == 3 || n_mod_8 == 5)) {
+                t = -t;
+            }
+        }
+
+        // Both a and n are odd here.
+        if (legendre_lt(&a, &n)) {
+            BigInt tmp = a;
+            a = n;
+            n = tmp;
+            if ((a.v[0] & 3) == 3 && (n.v[0] & 3) == 3) {
+                t = -t;
+            }
+        }
+        legendre_sub(&a, &n);
+    }
+
+    // n is now gcd(x, p), which is 1 unless x = 0.
+    BigInt one = bigint_new();
+    one.v[0] = 1;
+    return bigint_eq(&n, &one) ? t : 0;
+}
+
+/// Computes the Legendre symbol (x / p) by Euler's criterion,
+/// x^((p - 1) / 2), with a precomputed addition chain. This is the baseline
+/// for legendre_jacobi.
+int mont_legendre(BigInt *xr, MontField *f) {
+    // Checked up front, since some kernels return p rather than 0 for a zero
+    // product.
+    if (legendre_is_zero(xr)) {
+        return 0;
+    }
+    BigInt r = mont_pow_addchain(xr, &BN254_SCALAR_LEGENDRE_CHAIN, &f->p, f->n0);
+    return bigint_eq(&r, &f->one) ? 1 : -1;
+}
+
+/// Computes the Legendre symbols of n field elements in Montgomery form, and
+/// writes them to out.
+void legendre_batch(
+    BigInt *xr,
+    int *out,
+    size_t n,
+    MontField *f
+) {
+    for (size_t i = 0; i < n; i ++) {
+        out[i] = legendre_jacobi(&xr[i], &f->p);
+    }
+}
+
+/// Returns true if x is a square, including 0.
+static inline bool mont_is_square(BigInt *xr, MontField *f) {
+    return legendre_jacobi(xr, &f->p) >= 0;
+}
@@ -0,0 +1,159 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+// Square roots over the BN254 scalar field, with Sarkar's table-driven
+// variant of Tonelli-Shanks for 2-adicity 28.
+// Include c/field.h, a Montgomery multiplication kernel,
+// c/addchain/addchain.h and c/addchain/bn254_scalar.h before this file.
+//
+// Palash Sarkar. Computing square roots faster than the Tonelli-Shanks/
+// Bernstein algorithm. https://eprint.iacr.org/2020/1407
+//
+// Write p - 1 = 2^28 * t with t odd, and let g be a primitive 2^28-th root of
+// unity. For any x != 0, b = x^t lies in the subgroup generated by g, so
+// b = g^e for some 28-bit e, and x is a square if and only if e is even. Then
+// sqrt(x) = x^((t + 1) / 2) * g^(-e / 2).
+//
+// Classic Tonelli-Shanks finds e one bit at a time, which costs up to
+// 28 * 27 / 2 squarings. Here e is found 7 bits at a time: each window is read
+// off by looking up an element of order dividing 2^7 in a table of 128 roots
+// of unity, after cancelling the windows found so far with precomputed powers
+// of g. That costs 21 squarings and at most 10 multiplications.
+
+#define SQRT_TWO_ADICITY 28
+#define SQRT_WINDOW 7
+#define SQRT_NUM_WINDOWS (SQRT_TWO_ADICITY / SQRT_WINDOW)
+#define SQRT_TABLE_SIZE (1 << SQRT_WINDOW)
+
+// Precomputed powers of g in Montgomery form. Initialise with sqrt_init.
+typedef struct {
+    // g_inv[k][v] = g^(-v * 2^(7k))
+    BigInt g_inv[SQRT_NUM_WINDOWS][SQRT_TABLE_SIZE];
+} SqrtTables;
+
+/// Fills in the tables from BN254_SCALAR_ROOT_OF_UNITY_HEX.
+/// Returns 0 on success, or the error code of bigint_from_hex.
+int sqrt_init(SqrtTables *tables, MontField *f) {
+    BigInt g;
+    int result = bigint_from_hex(BN254_SCALAR_ROOT_OF_UNITY_HEX, &g);
+    if (result != 0) return result;
+    g = field_to_mont(&g, f);
+
+    // g^-1 = g^(2^28 - 1)
+    BigInt h = g;
+    for (int i = 1; i < SQRT_TWO_ADICITY; i ++) {
+        h = field_sqr(&h, f);
+        h = field_mul(&h, &g, f);
+    }
+
+    for (int k = 0; k < SQRT_NUM_WINDOWS; k ++) {
+        tables->g_inv[k][0] = f->one;
+        for (int v = 1; v < SQRT_TABLE_SIZE; v ++) {
+            tables->g_inv[k][v] = field_mul(&tables->g_inv[k][v - 1], &h, f);
+        }
+        // Move on to g^(-2^(7(k + 1))).
+        for (int i = 0; i < SQRT_WINDOW; i ++) {
+            h = field_sqr(&h, f);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Given y = g^(v * 2^21) for some 7-bit v, returns v.
+ * g_inv[3] holds g^(-j * 2^21) for every j, so v = -j mod 2^7, where j is the
+ * index of y in that row. Returns -1 if y is not in the row.
+ */
+static inline int sqrt_lookup(SqrtTables *tables, BigInt *y) {
+    BigInt *row = tables->g_inv[SQRT_NUM_WINDOWS - 1];
+    for (int j = 0; j < SQRT_TABLE_SIZE; j ++) {
+        // Compare the lowest limb first; it almost always differs.
+        if (row[j].v[0] == y->v[0] && bigint_eq(&row[j], y)) {
+            return (SQRT_TABLE_SIZE - j) & (SQRT_TABLE_SIZE - 1);
+        }
+    }
+    return -1;
+}
+
+/*
+ * Returns g^(-e * 2^(7 * shift)), for e < 2^(7 * (4 - shift)).
+ */
+static inline BigInt sqrt_g_pow_neg(
+    SqrtTables *tables,
+    uint32_t e,
+    int shift,
+    MontField *f
+) {
+    BigInt r = f->one;
+    bool first = true;
+    for (int k = shift; k < SQRT_NUM_WINDOWS; k ++) {
+        uint32_t v = e & (SQRT_TABLE_SIZE - 1);
+        e >>= SQRT_WINDOW;
+        if (v == 0) {
+            continue;
+        }
+        if (first) {
+            r = tables->g_inv[k][v];
+            first = false;
+        } else {
+            r = field_mul(&r, &tables->g_inv[k][v], f);
+        }
+    }
+    return r;
+}
+
+/// Computes a square root of xr, which is in Montgomery form, and writes it to
+/// *out, also in Montgomery form. Which of the two roots is returned is
+/// unspecified. Returns 0 on success, or -1 if xr is not a square, in which case
+/// *out is left unchanged. Not constant-time.
+int mont_sqrt(
+    BigInt *xr,
+    BigInt *out,
+    SqrtTables *tables,
+    MontField *f
+) {
+    BigInt zero = bigint_new();
+    if (bigint_eq(xr, &zero)) {
+        *out = zero;
+        return 0;
+    }
+
+    // w = x^((t - 1) / 2), z = x^((t + 1) / 2), b = x^t
+    BigInt w = mont_pow_addchain(xr, &BN254_SCALAR_SQRT_CHAIN, &f->p, f->n0);
+    BigInt z = field_mul(xr, &w, f);
+    BigInt b = field_mul(&z, &w, f);
+
+    // x_i = b^(2^(7i)) = g^(e * 2^(7i))
+    BigInt x[SQRT_NUM_WINDOWS];
+    x[0] = b;
+    for (int i = 1; i < SQRT_NUM_WINDOWS; i ++) {
+        x[i] = x[i - 1];
+        for (int j = 0; j < SQRT_WINDOW; j ++) {
+            x[i] = field_sqr(&x[i], f);
+        }
+    }
+
+    // Find e a window at a time, starting from the lowest. Before the i-th
+    // lookup, x[3 - i] * g^(-(e mod 2^(7i)) * 2^(7(3 - i))) = g^(e_i * 2^21).
+    uint32_t e = 0;
+    for (int i = 0; i < SQRT_NUM_WINDOWS; i ++) {
+        BigInt y = x[SQRT_NUM_WINDOWS - 1 - i];
+        if (e != 0) {
+            BigInt c = sqrt_g_pow_neg(tables, e, SQRT_NUM_WINDOWS - 1 - i, f);
+            y = field_mul(&y, &c, f);
+        }
+        int v = sqrt_lookup(tables, &y);
+        if (v < 0) {
+            return -1;
+        }
+        e |= (uint32_t)v << (SQRT_WINDOW * i);
+    }
+
+    if (e & 1) {
+        return -1;
+    }
+
+    BigInt c = sqrt_g_pow_neg(tables, e >> 1, 0, f);
+    *out = field_mul(&z, &c, f);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// A bump allocator for per-call scratch space (prefix products, transposed
+// copies, temporary vectors). One arena is allocated up front; routines take
+// what they need from it and give it back with arena_release, so hot loops
+// never call malloc. Every allocation is 64-byte aligned, so that no two
+// buffers share a cache line and SIMD loads never straddle one.
+//
+// An arena is not thread-safe. Give each thread its own.
+
+#define ARENA_ALIGN 64
+
+typedef struct {
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+    size_t high_water; // The most ever in use at once
+} Arena;
+
+static inline size_t arena_round_up(size_t bytes) {
+    return (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+/*
+ * Allocates an arena of at least capacity bytes. Returns 0 on success, or
+ * -1 if the allocation failed.
+ */
+int arena_init(Arena *a, size_t capacity) {
+    a->capacity = arena_round_up(capacity);
+    a->used = 0;
+    a->high_water = 0;
+    a->base = aligned_alloc(ARENA_ALIGN, a->capacity > 0 ? a->capacity : ARENA_ALIGN);
+    return a->base == NULL ? -1 : 0;
+}
+
+void arena_free(Arena *a) {
+    free(a->base);
+    a->base = NULL;
+    a->capacity = 0;
+    a->used = 0;
+}
+
+/*
+ * Returns a 64-byte aligned block of bytes bytes, or NULL if the arena does
+ * not have room for it. The contents are uninitialised.
+ */
+void *arena_alloc(Arena *a, size_t bytes) {
+    size_t size = arena_round_up(bytes);
+    if (size > a->capacity - a->used) {
+        return NULL;
+    }
+    void *ptr = a->base + a->used;
+    a->used += size;
+    if (a->used > a->high_water) {
+        a->high_water = a->used;
+    }
+    return ptr;
+}
+
+// Returns a mark to pass to arena_release.
+static inline size_t arena_mark(Arena *a) {
+    return a->used;
+}
+
+// Frees everything allocated since the mark was taken.
+static inline void arena_release(Arena *a, size_t mark) {
+    a->used = mark;
+}
+
+// Frees everything.
+static inline void arena_reset(Arena *a) {
+    a->used = 0;
+}
@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+// Inverts a vector of field elements with one exponentiation and 3(n - 1)
+// multiplications, using Montgomery's trick:
+//
+// Peter L. Montgomery. Speeding the Pollard and elliptic curve methods of
+// factorization. Mathematics of Computation 48 (1987).
+//
+// The running prefix products go in scratch space from an arena, so that a
+// caller which inverts many small batches does not allocate for each one.
+//
+// Include c/addchain/addchain.h and c/vec/frvec.h before this file.
+
+// Some kernels return p rather than 0 for a zero product.
+static inline bool frvec_is_zero(BigInt *a, MontField *f) {
+    bool zero = true;
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        zero &= a->v[i] == 0;
+    }
+    return zero || bigint_eq(a, &f->p);
+}
+
+/*
+ * Sets out[i] = in[i]^-1 for each i, in the Montgomery domain. Zero elements
+ * are left as zero. inv_chain is an addition chain for p - 2, such as
+ * BN254_SCALAR_INV_CHAIN. Both vectors must be FRVEC_AOS and have the same
+ * length; out may be in. Returns 0 on success, -1 if the shapes are wrong,
+ * or -2 if scratch does not have room for len BigInts.
+ */
+int frvec_batch_inv(
+    FrVec *out,
+    FrVec *in,
+    Arena *scratch,
+    const AddChain *inv_chain,
+    MontField *f
+) {
+    if (out->len != in->len || in->layout != FRVEC_AOS || out->layout != FRVEC_AOS) {
+        return -1;
+    }
+    size_t n = in->len;
+    if (n == 0) {
+        return 0;
+    }
+    size_t mark = arena_mark(scratch);
+    BigInt *prefix = arena_alloc(scratch, n * sizeof(BigInt));
+    if (prefix == NULL) {
+        return -2;
+    }
+    BigInt *x = frvec_aos(in), *r = frvec_aos(out);
+
+    // prefix[i] is the product of the nonzero elements before i.
+    BigInt acc = f->one;
+    for (size_t i = 0; i < n; i ++) {
+        prefix[i] = acc;
+        if (!frvec_is_zero(&x[i], f)) {
+            acc = field_mul(&acc, &x[i], f);
+        }
+    }
+
+    // inv is the inverse of the product of the nonzero elements up to i.
+    BigInt inv = mont_pow_addchain(&acc, inv_chain, &f->p, f->n0);
+    for (size_t i = n; i -- > 0;) {
+        BigInt xi = x[i];
+        if (frvec_is_zero(&xi, f)) {
+            r[i] = bigint_new();
+            continue;
+        }
+        r[i] = field_mul(&inv, &prefix[i], f);
+        inv = field_mul(&inv, &xi, f);
+    }
+    arena_release(scratch, mark);
+    return 0;
+}
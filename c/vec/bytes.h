@@ -0,0 +1,262 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Bulk import and export of field elements as 32-byte canonical encodings,
+// little- or big-endian, as they come from the network and other libraries.
+//
+// Each element is decoded into four 64-bit words (a plain load on a
+// little-endian host; for big-endian, rev64 on NEON or bswap elsewhere),
+// checked to be less than p, and, if asked, converted into Montgomery form
+// while it is still in registers, so the input is read only once. Export
+// does the same in reverse.
+//
+// Include c/vec/frvec.h and its prerequisites before this file. Only
+// little-endian hosts are supported.
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "bytes.h assumes a little-endian host"
+#endif
+
+#define FR_BYTES 32
+
+typedef enum {
+    FR_LITTLE_ENDIAN,
+    FR_BIG_ENDIAN,
+} FrByteOrder;
+
+// Decodes one encoding into little-endian 64-bit words.
+static inline void fr_bytes_to_words(const uint8_t *in, FrByteOrder order, uint64_t w[4]) {
+    if (order == FR_LITTLE_ENDIAN) {
+        memcpy(w, in, FR_BYTES);
+        return;
+    }
+#ifdef __ARM_NEON
+    // Bytes 0-15 hold words 3 and 2, most significant byte first. rev64
+    // reverses the bytes within each word, and ext swaps the two words.
+    uint64x2_t hi = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(in)));
+    uint64x2_t lo = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(in + 16)));
+    vst1q_u64(&w[0], vextq_u64(lo, lo, 1));
+    vst1q_u64(&w[2], vextq_u64(hi, hi, 1));
+#else
+    uint64_t be[4];
+    memcpy(be, in, FR_BYTES);
+    for (int i = 0; i < 4; i ++) {
+        w[i] = __builtin_bswap64(be[3 - i]);
+    }
+#endif
+}
+
+static inline void fr_words_to_bytes(const uint64_t w[4], FrByteOrder order, uint8_t *out) {
+    if (order == FR_LITTLE_ENDIAN) {
+        memcpy(out, w, FR_BYTES);
+        return;
+    }
+#ifdef __ARM_NEON
+    uint64x2_t lo = vld1q_u64(&w[0]);
+    uint64x2_t hi = vld1q_u64(&w[2]);
+    vst1q_u8(out, vrev64q_u8(vreinterpretq_u8_u64(vextq_u64(hi, hi, 1))));
+    vst1q_u8(out + 16, vrev64q_u8(vreinterpretq_u8_u64(vextq_u64(lo, lo, 1))));
+#else
+    uint64_t be[4];
+    for (int i = 0; i < 4; i ++) {
+        be[3 - i] = __builtin_bswap64(w[i]);
+    }
+    memcpy(out, be, FR_BYTES);
+#endif
+}
+
+static inline BigInt fr_bigint_from_words(const uint64_t w[4]) {
+    BigInt r;
+#if BITS_PER_LIMB == 64 && NUM_LIMBS == 4
+    memcpy(r.v, w, FR_BYTES);
+#elif BITS_PER_LIMB == 32 && NUM_LIMBS == 8
+    for (int i = 0; i < 4; i ++) {
+        r.v[2 * i] = w[i] & 0xFFFFFFFF;
+        r.v[2 * i + 1] = w[i] >> 32;
+    }
+#else
+    r = bigint_new();
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        int bit = i * BITS_PER_LIMB;
+        uint64_t limb = w[bit / 64] >> (bit % 64);
+        if (bit % 64 + BITS_PER_LIMB > 64 && bit / 64 + 1 < 4) {
+            limb |= w[bit / 64 + 1] << (64 - bit % 64);
+        }
+        r.v[i] = limb & LIMB_MASK;
+    }
+#endif
+    return r;
+}
+
+static inline void fr_bigint_to_words(const BigInt *a, uint64_t w[4]) {
+#if BITS_PER_LIMB == 64 && NUM_LIMBS == 4
+    memcpy(w, a->v, FR_BYTES);
+#elif BITS_PER_LIMB == 32 && NUM_LIMBS == 8
+    for (int i = 0; i < 4; i ++) {
+        w[i] = a->v[2 * i] | a->v[2 * i + 1] << 32;
+    }
+#else
+    memset(w, 0, FR_BYTES);
+    for (int i = 0; i < NUM_LIMBS; i ++) {
+        int bit = i * BITS_PER_LIMB;
+        w[bit / 64] |= a->v[i] << (bit % 64);
+        if (bit % 64 + BITS_PER_LIMB > 64 && bit / 64 + 1 < 4) {
+            w[bit / 64 + 1] |= a->v[i] >> (64 - bit % 64);
+        }
+    }
+#endif
+}
+
+// Returns whether w < p, where pw holds p as words.
+static inline bool fr_words_lt(const uint64_t w[4], const uint64_t pw[4]) {
+    uint64_t borrow = 0;
+    for (int i = 0; i < 4; i ++) {
+        uint64_t d = w[i] - pw[i];
+        borrow = (w[i] < pw[i]) | (d < borrow);
+    }
+    return borrow != 0;
+}
+
+// The words of a, with p mapped to 0, since some kernels return p rather
+// than 0 for a zero product.
+static inline void fr_canonical_words(const BigInt *a, const uint64_t pw[4], uint64_t w[4]) {
+    fr_bigint_to_words(a, w);
+    if (memcmp(w, pw, FR_BYTES) == 0) {
+        memset(w, 0, FR_BYTES);
+    }
+}
+
+/*
+ * Decodes count encodings of FR_BYTES bytes each into out, converting them
+ * into Montgomery form if to_mont is set. Stops at the first encoding that is
+ * not less than p. Returns the number of elements imported, which is less
+ * than count only if the encoding at that index is out of range.
+ */
+size_t fr_import(BigInt *out, const uint8_t *bytes, size_t count, FrByteOrder order, bool to_mont, MontField *f) {
+    uint64_t pw[4];
+    fr_bigint_to_words(&f->p, pw);
+    for (size_t i = 0; i < count; i ++) {
+        uint64_t w[4];
+        fr_bytes_to_words(bytes + i * FR_BYTES, order, w);
+        if (!fr_words_lt(w, pw)) {
+            return i;
+        }
+        BigInt a = fr_bigint_from_words(w);
+        out[i] = to_mont ? field_to_mont(&a, f) : a;
+    }
+    return count;
+}
+
+/*
+ * Encodes count elements from in into bytes, converting them out of
+ * Montgomery form first if from_mont is set. Elements must be in [0, p].
+ */
+void fr_export(uint8_t *bytes, const BigInt *in, size_t count, FrByteOrder order, bool from_mont, MontField *f) {
+    uint64_t pw[4];
+    fr_bigint_to_words(&f->p, pw);
+    for (size_t i = 0; i < count; i ++) {
+        BigInt a = from_mont ? field_from_mont((BigInt *)&in[i], f) : in[i];
+        uint64_t w[4];
+        fr_canonical_words(&a, pw, w);
+        fr_words_to_bytes(w, order, bytes + i * FR_BYTES);
+    }
+}
+
+/*
+ * Checks that count little-endian encodings are all less than p and, if the
+ * build uses 4x64 limbs, returns them as a BigInt array that aliases bytes,
+ * with no copy. Returns NULL if any encoding is out of range, if bytes is
+ * not 8-byte aligned, or if the limb layout is not 4x64; use fr_import then.
+ */
+const BigInt *fr_import_view(const uint8_t *bytes, size_t count, MontField *f) {
+#if BITS_PER_LIMB == 64 && NUM_LIMBS == 4
+    if ((uintptr_t)bytes % _Alignof(BigInt) != 0) {
+        return NULL;
+    }
+    uint64_t pw[4];
+    fr_bigint_to_words(&f->p, pw);
+    const uint64_t *w = (const uint64_t *)bytes;
+    for (size_t i = 0; i < count; i ++) {
+        if (!fr_words_lt(&w[4 * i], pw)) {
+            return NULL;
+        }
+    }
+    return (const BigInt *)bytes;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * fr_import into all out->len elements of a vector of either layout. For
+ * FRVEC_SOA, each block of four elements is decoded, transposed into the
+ * rows and, with the 8x32 limb layout and c/multibuf/mont_x4.h included,
+ * converted into Montgomery form four lanes at a time. Returns the number
+ * of elements imported, as fr_import.
+ */
+size_t fr_import_vec(FrVec *out, const uint8_t *bytes, FrByteOrder order, bool to_mont, MontField *f) {
+    if (out->layout == FRVEC_AOS) {
+        return fr_import(frvec_aos(out), bytes, out->len, order, to_mont, f);
+    }
+    size_t n = out->len;
+    size_t i = 0;
+#if defined(MONT_MUL_X4_AVAILABLE) && BITS_PER_LIMB == 32
+    bool vertical = to_mont;
+    BigIntX4 r2 = bigint_x4_splat(&f->r2);
+    BigIntX4 p = bigint_x4_splat(&f->p);
+    uint64_t n0 = field_redc_n0(f);
+#else
+    bool vertical = false;
+#endif
+    for (; i + 4 <= n; i += 4) {
+        BigInt block[4];
+        size_t got = fr_import(block, bytes + i * FR_BYTES, 4, order, to_mont && !vertical, f);
+        if (got < 4) {
+            return i + got;
+        }
+        transpose_aos_to_soa_x4(block, (FrLimb *)out->data + i, out->stride);
+#if defined(MONT_MUL_X4_AVAILABLE) && BITS_PER_LIMB == 32
+        if (vertical) {
+            BigIntX4 x;
+            for (int j = 0; j < NUM_LIMBS; j ++) {
+                x.v[j] = vld1q_u32(frvec_limbs(out, j) + i);
+            }
+            x = mont_mul_x4(&x, &r2, &p, n0);
+            for (int j = 0; j < NUM_LIMBS; j ++) {
+                vst1q_u32(frvec_limbs(out, j) + i, x.v[j]);
+            }
+        }
+#endif
+    }
+    for (; i < n; i ++) {
+        BigInt a;
+        if (fr_import(&a, bytes + i * FR_BYTES, 1, order, to_mont, f) == 0) {
+            return i;
+        }
+        frvec_set(out, i, &a);
+    }
+    return n;
+}
+
+// fr_export from a vector of either layout.
+void fr_export_vec(uint8_t *bytes, FrVec *in, FrByteOrder order, bool from_mont, MontField *f) {
+    if (in->layout == FRVEC_AOS) {
+        fr_export(bytes, frvec_aos(in), in->len, order, from_mont, f);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 4 <= in->len; i += 4) {
+        BigInt block[4];
+        transpose_soa_to_aos_x4((FrLimb *)in->data + i, in->stride, block);
+        fr_export(bytes + i * FR_BYTES, block, 4, order, from_mont, f);
+    }
+    for (; i < in->len; i ++) {
+        BigInt a = frvec_get(in, i);
+        fr_export(bytes + i * FR_BYTES, &a, 1, order, from_mont, f);
+    }
+}
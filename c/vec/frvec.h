@@ -0,0 +1,196 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+// A vector of field elements in 64-byte aligned storage, in one of two
+// layouts:
+//
+// - FRVEC_AOS (array of structs): an array of BigInts, so element i is
+//   contiguous. This is what the scalar kernels and c/pool/batch.h take.
+// - FRVEC_SOA (struct of arrays): one row per limb, so limb j of every
+//   element is contiguous. Rows hold FrLimbs (uint32_t for 8x32, uint64_t
+//   for 4x64), and each row starts on a 64-byte boundary, so the vertical
+//   SIMD kernels (c/multibuf/mont_x4.h) can load four elements' limbs with a
+//   single instruction instead of gathering them.
+//
+// The storage either comes from the heap (frvec_init) and is released with
+// frvec_free, or from an Arena (frvec_init_arena) and is released with the
+// arena.
+//
+// Include a BigInt header and c/field.h before this file.
+
+typedef enum {
+    FRVEC_AOS,
+    FRVEC_SOA,
+} FrVecLayout;
+
+#if BITS_PER_LIMB == 32
+typedef uint32_t FrLimb;
+#else
+typedef uint64_t FrLimb;
+#endif
+
+#include "transpose.h"
+
+typedef struct {
+    void *data;
+    size_t len;
+    size_t stride; // FRVEC_SOA only: FrLimbs from the start of one row to the next
+    FrVecLayout layout;
+    bool owned;    // Whether frvec_free should free data
+} FrVec;
+
+static inline size_t frvec_stride(size_t len) {
+    size_t per_line = ARENA_ALIGN / sizeof(FrLimb);
+    return (len + per_line - 1) / per_line * per_line;
+}
+
+// Returns the number of bytes of storage a vector of len elements needs.
+static inline size_t frvec_bytes(size_t len, FrVecLayout layout) {
+    if (layout == FRVEC_AOS) {
+        return arena_round_up(len * sizeof(BigInt));
+    }
+    return NUM_LIMBS * frvec_stride(len) * sizeof(FrLimb);
+}
+
+static inline void frvec_set_shape(FrVec *v, size_t len, FrVecLayout layout) {
+    v->len = len;
+    v->layout = layout;
+    v->stride = layout == FRVEC_SOA ? frvec_stride(len) : 0;
+}
+
+/*
+ * Allocates a vector of len elements on the heap. The contents are
+ * uninitialised. Returns 0 on success, or -1 if the allocation failed.
+ */
+int frvec_init(FrVec *v, size_t len, FrVecLayout layout) {
+    frvec_set_shape(v, len, layout);
+    size_t bytes = frvec_bytes(len, layout);
+    v->data = aligned_alloc(ARENA_ALIGN, bytes > 0 ? bytes : ARENA_ALIGN);
+    v->owned = true;
+    return v->data == NULL ? -1 : 0;
+}
+
+/*
+ * Takes the storage for a vector of len elements from an arena. The
+ * contents are uninitialised. Returns 0 on success, or -1 if the arena does
+ * not have room.
+ */
+int frvec_init_arena(FrVec *v, size_t len, FrVecLayout layout, Arena *arena) {
+    frvec_set_shape(v, len, layout);
+    v->data = arena_alloc(arena, frvec_bytes(len, layout));
+    v->owned = false;
+    return v->data == NULL ? -1 : 0;
+}
+
+void frvec_free(FrVec *v) {
+    if (v->owned) {
+        free(v->data);
+    }
+    v->data = NULL;
+    v->len = 0;
+}
+
+// The elements of an FRVEC_AOS vector.
+static inline BigInt *frvec_aos(FrVec *v) {
+    return (BigInt *)v->data;
+}
+
+// Row j of an FRVEC_SOA vector: limb j of every element.
+static inline FrLimb *frvec_limbs(FrVec *v, int j) {
+    return (FrLimb *)v->data + (size_t)j * v->stride;
+}
+
+static inline BigInt frvec_get(FrVec *v, size_t i) {
+    if (v->layout == FRVEC_AOS) {
+        return frvec_aos(v)[i];
+    }
+    BigInt r;
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        r.v[j] = frvec_limbs(v, j)[i];
+    }
+    return r;
+}
+
+static inline void frvec_set(FrVec *v, size_t i, BigInt *x) {
+    if (v->layout == FRVEC_AOS) {
+        frvec_aos(v)[i] = *x;
+        return;
+    }
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        frvec_limbs(v, j)[i] = (FrLimb)x->v[j];
+    }
+}
+
+// Sets every element to zero, including the padding.
+void frvec_zero(FrVec *v) {
+    memset(v->data, 0, frvec_bytes(v->len, v->layout));
+}
+
+/*
+ * Copies src into dst, converting between layouts if they differ. Returns 0
+ * on success, or -1 if the lengths differ.
+ */
+int frvec_copy(FrVec *dst, FrVec *src) {
+    if (dst->len != src->len) {
+        return -1;
+    }
+    if (dst->layout == src->layout) {
+        memcpy(dst->data, src->data, frvec_bytes(src->len, src->layout));
+        return 0;
+    }
+    if (src->layout == FRVEC_AOS) {
+        transpose_aos_to_soa(frvec_aos(src), src->len, dst->data, dst->stride);
+    } else {
+        transpose_soa_to_aos(src->data, src->stride, src->len, frvec_aos(dst));
+    }
+    return 0;
+}
+
+/*
+ * Sets out[i] = a[i] * b[i] in the Montgomery domain. out may be a or b.
+ * All three must have the same length and layout. With the 8x32 limb layout
+ * and c/multibuf/mont_x4.h included, FRVEC_SOA vectors are multiplied four
+ * at a time straight from their rows. Returns 0 on success, or -1 if the
+ * shapes differ.
+ */
+int frvec_mul(FrVec *out, FrVec *a, FrVec *b, MontField *f) {
+    if (a->len != out->len || b->len != out->len
+        || a->layout != out->layout || b->layout != out->layout) {
+        return -1;
+    }
+    size_t n = out->len;
+    size_t i = 0;
+    if (out->layout == FRVEC_AOS) {
+        BigInt *va = frvec_aos(a), *vb = frvec_aos(b), *vo = frvec_aos(out);
+        for (; i < n; i ++) {
+            vo[i] = field_mul(&va[i], &vb[i], f);
+        }
+        return 0;
+    }
+#if defined(MONT_MUL_X4_AVAILABLE) && BITS_PER_LIMB == 32
+    BigIntX4 p = bigint_x4_splat(&f->p);
+    uint64_t n0 = field_redc_n0(f);
+    for (; i + 4 <= n; i += 4) {
+        BigIntX4 x, y;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            x.v[j] = vld1q_u32(frvec_limbs(a, j) + i);
+            y.v[j] = vld1q_u32(frvec_limbs(b, j) + i);
+        }
+        BigIntX4 r = mont_mul_x4(&x, &y, &p, n0);
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            vst1q_u32(frvec_limbs(out, j) + i, r.v[j]);
+        }
+    }
+#endif
+    for (; i < n; i ++) {
+        BigInt x = frvec_get(a, i);
+        BigInt y = frvec_get(b, i);
+        BigInt r = field_mul(&x, &y, f);
+        frvec_set(out, i, &r);
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Bulk conversion of field elements to and from 64-digit big-endian
+// hexadecimal, into and out of caller-provided buffers, so that it can run
+// on several threads at once (bigint_to_hex returns a static buffer).
+//
+// Each element goes through the 32-byte big-endian encoding of
+// c/vec/bytes.h. Encoding splits each byte into its two nibbles and maps all
+// 16 of them to digits at once with a table lookup (vqtbl1q_u8 on NEON,
+// pshufb with SSSE3), then interleaves the high and low digits with
+// vzip1q/vzip2q (unpacklo/unpackhi). Decoding classifies 16 characters at a
+// time as digits or letters with two subtractions and two comparisons,
+// rejects the block if any is neither, and packs pairs of nibbles back into
+// bytes. Without NEON or SSE, both are plain table loops.
+//
+// Digits are written in lower case; either case is accepted.
+//
+// Include c/vec/frvec.h, c/vec/bytes.h and their prerequisites before this
+// file.
+
+#define FR_HEX_DIGITS 64
+
+#if defined(__ARM_NEON)
+    #define HEXVEC_NEON
+#elif defined(__SSE2__)
+    #define HEXVEC_SSE2
+    #include <emmintrin.h>
+    #ifdef __SSSE3__
+        #include <tmmintrin.h>
+    #endif
+#endif
+
+static const char fr_hex_digits[16] = "0123456789abcdef";
+
+// The value of a hex digit, or -1 if c isn't one.
+static inline int fr_hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Writes the FR_HEX_DIGITS digits of an FR_BYTES big-endian encoding.
+static inline void fr_hex_encode(const uint8_t *bytes, char *out) {
+#if defined(HEXVEC_NEON)
+    uint8x16_t table = vld1q_u8((const uint8_t *)fr_hex_digits);
+    uint8x16_t mask = vdupq_n_u8(0xf);
+    for (int h = 0; h < 2; h ++) {
+        uint8x16_t b = vld1q_u8(bytes + 16 * h);
+        uint8x16_t hi = vqtbl1q_u8(table, vshrq_n_u8(b, 4));
+        uint8x16_t lo = vqtbl1q_u8(table, vandq_u8(b, mask));
+        vst1q_u8((uint8_t *)out + 32 * h, vzip1q_u8(hi, lo));
+        vst1q_u8((uint8_t *)out + 32 * h + 16, vzip2q_u8(hi, lo));
+    }
+#elif defined(HEXVEC_SSE2) && defined(__SSSE3__)
+    __m128i table = _mm_loadu_si128((const __m128i *)fr_hex_digits);
+    __m128i mask = _mm_set1_epi8(0xf);
+    for (int h = 0; h < 2; h ++) {
+        __m128i b = _mm_loadu_si128((const __m128i *)(bytes + 16 * h));
+        __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(b, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(b, mask));
+        _mm_storeu_si128((__m128i *)(out + 32 * h), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(out + 32 * h + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#else
+    for (int i = 0; i < FR_BYTES; i ++) {
+        out[2 * i] = fr_hex_digits[bytes[i] >> 4];
+        out[2 * i + 1] = fr_hex_digits[bytes[i] & 0xf];
+    }
+#endif
+}
+
+#if defined(HEXVEC_NEON)
+// The nibble values of 16 characters. Returns false if any isn't a digit.
+static inline bool fr_hex_nibbles(const char *in, uint8x16_t *val) {
+    uint8x16_t c = vld1q_u8((const uint8_t *)in);
+    uint8x16_t d = vsubq_u8(c, vdupq_n_u8('0'));
+    uint8x16_t l = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t is_digit = vcltq_u8(d, vdupq_n_u8(10));
+    uint8x16_t is_alpha = vcltq_u8(l, vdupq_n_u8(6));
+    *val = vorrq_u8(vandq_u8(is_digit, d), vandq_u8(is_alpha, vaddq_u8(l, vdupq_n_u8(10))));
+    return vminvq_u8(vorrq_u8(is_digit, is_alpha)) == 0xff;
+}
+#elif defined(HEXVEC_SSE2)
+static inline bool fr_hex_nibbles(const char *in, __m128i *val) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i c = _mm_loadu_si128((const __m128i *)in);
+    __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    // There is no unsigned byte comparison; x <= n iff x saturating minus n is 0.
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_subs_epu8(d, _mm_set1_epi8(9)), zero);
+    __m128i is_alpha = _mm_cmpeq_epi8(_mm_subs_epu8(l, _mm_set1_epi8(5)), zero);
+    *val = _mm_or_si128(_mm_and_si128(is_digit, d),
+        _mm_and_si128(is_alpha, _mm_add_epi8(l, _mm_set1_epi8(10))));
+    return _mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) == 0xffff;
+}
+#endif
+
+// Parses FR_HEX_DIGITS digits into an FR_BYTES big-endian encoding. Returns
+// false if any character isn't a hex digit.
+static inline bool fr_hex_decode(const char *in, uint8_t *bytes) {
+#if defined(HEXVEC_NEON)
+    bool ok = true;
+    for (int h = 0; h < 2; h ++) {
+        uint8x16_t v0, v1;
+        ok &= fr_hex_nibbles(in + 32 * h, &v0);
+        ok &= fr_hex_nibbles(in + 32 * h + 16, &v1);
+        // Even characters are high nibbles and odd ones low nibbles.
+        uint8x16_t hi = vuzp1q_u8(v0, v1);
+        uint8x16_t lo = vuzp2q_u8(v0, v1);
+        vst1q_u8(bytes + 16 * h, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return ok;
+#elif defined(HEXVEC_SSE2)
+    bool ok = true;
+    __m128i low_byte = _mm_set1_epi16(0xff);
+    for (int h = 0; h < 2; h ++) {
+        __m128i v0, v1;
+        ok &= fr_hex_nibbles(in + 32 * h, &v0);
+        ok &= fr_hex_nibbles(in + 32 * h + 16, &v1);
+        // In each 16-bit lane, the low byte is a high nibble and the high
+        // byte a low nibble.
+        __m128i w0 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v0, low_byte), 4), _mm_srli_epi16(v0, 8));
+        __m128i w1 = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v1, low_byte), 4), _mm_srli_epi16(v1, 8));
+        _mm_storeu_si128((__m128i *)(bytes + 16 * h), _mm_packus_epi16(w0, w1));
+    }
+    return ok;
+#else
+    for (int i = 0; i < FR_BYTES; i ++) {
+        int hi = fr_hex_value(in[2 * i]);
+        int lo = fr_hex_value(in[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        bytes[i] = hi << 4 | lo;
+    }
+    return true;
+#endif
+}
+
+/*
+ * Parses count elements of FR_HEX_DIGITS digits each, element i starting at
+ * hex + i * stride, into out, converting them into Montgomery form if
+ * to_mont is set. stride must be at least FR_HEX_DIGITS; whatever lies
+ * between the elements (newlines, say) is skipped. Stops at the first
+ * element with a character that isn't a hex digit or a value that is not
+ * less than p. Returns the number of elements parsed, which is less than
+ * count only if the element at that index is invalid.
+ */
+size_t fr_import_hex(BigInt *out, const char *hex, size_t stride, size_t count, bool to_mont, MontField *f) {
+    uint64_t pw[4];
+    fr_bigint_to_words(&f->p, pw);
+    for (size_t i = 0; i < count; i ++) {
+        uint8_t bytes[FR_BYTES];
+        uint64_t w[4];
+        if (!fr_hex_decode(hex + i * stride, bytes)) {
+            return i;
+        }
+        fr_bytes_to_words(bytes, FR_BIG_ENDIAN, w);
+        if (!fr_words_lt(w, pw)) {
+            return i;
+        }
+        BigInt a = fr_bigint_from_words(w);
+        out[i] = to_mont ? field_to_mont(&a, f) : a;
+    }
+    return count;
+}
+
+/*
+ * Writes count elements from in as FR_HEX_DIGITS digits each, element i
+ * starting at hex + i * stride, converting them out of Montgomery form first
+ * if from_mont is set. stride must be at least FR_HEX_DIGITS; the bytes
+ * between the elements are left as they are, and no terminator is written.
+ * Elements must be in [0, p].
+ */
+void fr_export_hex(char *hex, size_t stride, const BigInt *in, size_t count, bool from_mont, MontField *f) {
+    uint64_t pw[4];
+    fr_bigint_to_words(&f->p, pw);
+    for (size_t i = 0; i < count; i ++) {
+        BigInt a = from_mont ? field_from_mont((BigInt *)&in[i], f) : in[i];
+        uint8_t bytes[FR_BYTES];
+        uint64_t w[4];
+        fr_canonical_words(&a, pw, w);
+        fr_words_to_bytes(w, FR_BIG_ENDIAN, bytes);
+        fr_hex_encode(bytes, hex + i * stride);
+    }
+}
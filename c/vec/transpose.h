@@ -0,0 +1,269 @@
+#include <stdint.h>
+#include <stddef.h>
+
+// Converts blocks of field elements between the element-major (AoS) layout
+// of BigInt arrays and the limb-major (SoA) layout of FrVec rows, in which
+// the vertical SIMD kernels work.
+//
+// A block of 4 elements is a small matrix transposition:
+//
+// - 8x32: each element's eight limbs are first narrowed from their 64-bit
+//   BigInt slots to 32 bits (vuzp1q_u32), then each half of the 8x4 matrix
+//   is transposed as a 4x4 matrix of 32-bit lanes with two rounds of
+//   vtrn1q/vtrn2q (32-bit, then 64-bit). The reverse transposes, then widens
+//   with vzip1q/vzip2q against zero.
+// - 4x64: a 4x4 matrix of 64-bit limbs is four 2x2 transpositions of
+//   uint64x2_t pairs with vtrn1q_u64/vtrn2q_u64, which is its own inverse.
+//
+// With SSE2 the same shuffles are unpacklo/unpackhi, and without either,
+// or for other limb layouts, the block functions are plain loops. A block
+// of 8 is two blocks of 4.
+//
+// Row j of the SoA side starts at rows + j * stride, where stride is in
+// FrLimbs (see frvec_stride). c/vec/frvec.h includes this file.
+
+#if defined(__ARM_NEON) && (BITS_PER_LIMB == 32 && NUM_LIMBS == 8 || BITS_PER_LIMB == 64 && NUM_LIMBS == 4)
+    #define TRANSPOSE_NEON
+    #include <arm_neon.h>
+#elif defined(__SSE2__) && (BITS_PER_LIMB == 32 && NUM_LIMBS == 8 || BITS_PER_LIMB == 64 && NUM_LIMBS == 4)
+    #define TRANSPOSE_SSE2
+    #include <emmintrin.h>
+#endif
+
+// The plain loops, which are also the reference for the tests.
+void transpose_aos_to_soa_scalar(const BigInt *src, size_t count, FrLimb *rows, size_t stride) {
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        for (size_t k = 0; k < count; k ++) {
+            rows[j * stride + k] = (FrLimb)src[k].v[j];
+        }
+    }
+}
+
+void transpose_soa_to_aos_scalar(const FrLimb *rows, size_t stride, size_t count, BigInt *dst) {
+    for (size_t k = 0; k < count; k ++) {
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            dst[k].v[j] = rows[j * stride + k];
+        }
+    }
+}
+
+#if defined(TRANSPOSE_NEON) && BITS_PER_LIMB == 32
+
+// Transposes the 4x4 matrix of 32-bit lanes in r0..r3 in place.
+static inline void transpose_4x4_u32(uint32x4_t *r0, uint32x4_t *r1, uint32x4_t *r2, uint32x4_t *r3) {
+    uint64x2_t t0 = vreinterpretq_u64_u32(vtrn1q_u32(*r0, *r1));
+    uint64x2_t t1 = vreinterpretq_u64_u32(vtrn2q_u32(*r0, *r1));
+    uint64x2_t t2 = vreinterpretq_u64_u32(vtrn1q_u32(*r2, *r3));
+    uint64x2_t t3 = vreinterpretq_u64_u32(vtrn2q_u32(*r2, *r3));
+    *r0 = vreinterpretq_u32_u64(vtrn1q_u64(t0, t2));
+    *r1 = vreinterpretq_u32_u64(vtrn1q_u64(t1, t3));
+    *r2 = vreinterpretq_u32_u64(vtrn2q_u64(t0, t2));
+    *r3 = vreinterpretq_u32_u64(vtrn2q_u64(t1, t3));
+}
+
+// Limbs 4 * half to 4 * half + 3 of a, narrowed to 32 bits.
+static inline uint32x4_t transpose_load_narrow(const BigInt *a, int half) {
+    uint32x4_t lo = vreinterpretq_u32_u64(vld1q_u64(&a->v[4 * half]));
+    uint32x4_t hi = vreinterpretq_u32_u64(vld1q_u64(&a->v[4 * half + 2]));
+    return vuzp1q_u32(lo, hi);
+}
+
+static inline void transpose_store_widen(BigInt *a, int half, uint32x4_t x) {
+    uint32x4_t zero = vdupq_n_u32(0);
+    vst1q_u64(&a->v[4 * half], vreinterpretq_u64_u32(vzip1q_u32(x, zero)));
+    vst1q_u64(&a->v[4 * half + 2], vreinterpretq_u64_u32(vzip2q_u32(x, zero)));
+}
+
+void transpose_aos_to_soa_x4(const BigInt *src, FrLimb *rows, size_t stride) {
+    for (int half = 0; half < 2; half ++) {
+        uint32x4_t r0 = transpose_load_narrow(&src[0], half);
+        uint32x4_t r1 = transpose_load_narrow(&src[1], half);
+        uint32x4_t r2 = transpose_load_narrow(&src[2], half);
+        uint32x4_t r3 = transpose_load_narrow(&src[3], half);
+        transpose_4x4_u32(&r0, &r1, &r2, &r3);
+        FrLimb *row = rows + 4 * half * stride;
+        vst1q_u32(row, r0);
+        vst1q_u32(row + stride, r1);
+        vst1q_u32(row + 2 * stride, r2);
+        vst1q_u32(row + 3 * stride, r3);
+    }
+}
+
+void transpose_soa_to_aos_x4(const FrLimb *rows, size_t stride, BigInt *dst) {
+    for (int half = 0; half < 2; half ++) {
+        const FrLimb *row = rows + 4 * half * stride;
+        uint32x4_t r0 = vld1q_u32(row);
+        uint32x4_t r1 = vld1q_u32(row + stride);
+        uint32x4_t r2 = vld1q_u32(row + 2 * stride);
+        uint32x4_t r3 = vld1q_u32(row + 3 * stride);
+        transpose_4x4_u32(&r0, &r1, &r2, &r3);
+        transpose_store_widen(&dst[0], half, r0);
+        transpose_store_widen(&dst[1], half, r1);
+        transpose_store_widen(&dst[2], half, r2);
+        transpose_store_widen(&dst[3], half, r3);
+    }
+}
+
+#elif defined(TRANSPOSE_NEON)
+
+// Limbs 2 * jp and 2 * jp + 1 of src[0] and src[1].
+static inline void transpose_2x2_aos_to_soa(const BigInt *src, int jp, FrLimb *rows, size_t stride) {
+    uint64x2_t a = vld1q_u64(&src[0].v[2 * jp]);
+    uint64x2_t b = vld1q_u64(&src[1].v[2 * jp]);
+    vst1q_u64(rows + 2 * jp * stride, vtrn1q_u64(a, b));
+    vst1q_u64(rows + (2 * jp + 1) * stride, vtrn2q_u64(a, b));
+}
+
+static inline void transpose_2x2_soa_to_aos(const FrLimb *rows, size_t stride, int jp, BigInt *dst) {
+    uint64x2_t a = vld1q_u64(rows + 2 * jp * stride);
+    uint64x2_t b = vld1q_u64(rows + (2 * jp + 1) * stride);
+    vst1q_u64(&dst[0].v[2 * jp], vtrn1q_u64(a, b));
+    vst1q_u64(&dst[1].v[2 * jp], vtrn2q_u64(a, b));
+}
+
+void transpose_aos_to_soa_x4(const BigInt *src, FrLimb *rows, size_t stride) {
+    transpose_2x2_aos_to_soa(&src[0], 0, rows, stride);
+    transpose_2x2_aos_to_soa(&src[2], 0, rows + 2, stride);
+    transpose_2x2_aos_to_soa(&src[0], 1, rows, stride);
+    transpose_2x2_aos_to_soa(&src[2], 1, rows + 2, stride);
+}
+
+void transpose_soa_to_aos_x4(const FrLimb *rows, size_t stride, BigInt *dst) {
+    transpose_2x2_soa_to_aos(rows, stride, 0, &dst[0]);
+    transpose_2x2_soa_to_aos(rows + 2, stride, 0, &dst[2]);
+    transpose_2x2_soa_to_aos(rows, stride, 1, &dst[0]);
+    transpose_2x2_soa_to_aos(rows + 2, stride, 1, &dst[2]);
+}
+
+#elif defined(TRANSPOSE_SSE2) && BITS_PER_LIMB == 32
+
+static inline void transpose_4x4_epi32(__m128i *r0, __m128i *r1, __m128i *r2, __m128i *r3) {
+    __m128i t0 = _mm_unpacklo_epi32(*r0, *r1);
+    __m128i t1 = _mm_unpackhi_epi32(*r0, *r1);
+    __m128i t2 = _mm_unpacklo_epi32(*r2, *r3);
+    __m128i t3 = _mm_unpackhi_epi32(*r2, *r3);
+    *r0 = _mm_unpacklo_epi64(t0, t2);
+    *r1 = _mm_unpackhi_epi64(t0, t2);
+    *r2 = _mm_unpacklo_epi64(t1, t3);
+    *r3 = _mm_unpackhi_epi64(t1, t3);
+}
+
+static inline __m128i transpose_load_narrow(const BigInt *a, int half) {
+    __m128i lo = _mm_loadu_si128((const __m128i *)&a->v[4 * half]);
+    __m128i hi = _mm_loadu_si128((const __m128i *)&a->v[4 * half + 2]);
+    lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 0, 2, 0));
+    hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 0, 2, 0));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+static inline void transpose_store_widen(BigInt *a, int half, __m128i x) {
+    __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i *)&a->v[4 * half], _mm_unpacklo_epi32(x, zero));
+    _mm_storeu_si128((__m128i *)&a->v[4 * half + 2], _mm_unpackhi_epi32(x, zero));
+}
+
+void transpose_aos_to_soa_x4(const BigInt *src, FrLimb *rows, size_t stride) {
+    for (int half = 0; half < 2; half ++) {
+        __m128i r0 = transpose_load_narrow(&src[0], half);
+        __m128i r1 = transpose_load_narrow(&src[1], half);
+        __m128i r2 = transpose_load_narrow(&src[2], half);
+        __m128i r3 = transpose_load_narrow(&src[3], half);
+        transpose_4x4_epi32(&r0, &r1, &r2, &r3);
+        FrLimb *row = rows + 4 * half * stride;
+        _mm_storeu_si128((__m128i *)row, r0);
+        _mm_storeu_si128((__m128i *)(row + stride), r1);
+        _mm_storeu_si128((__m128i *)(row + 2 * stride), r2);
+        _mm_storeu_si128((__m128i *)(row + 3 * stride), r3);
+    }
+}
+
+void transpose_soa_to_aos_x4(const FrLimb *rows, size_t stride, BigInt *dst) {
+    for (int half = 0; half < 2; half ++) {
+        const FrLimb *row = rows + 4 * half * stride;
+        __m128i r0 = _mm_loadu_si128((const __m128i *)row);
+        __m128i r1 = _mm_loadu_si128((const __m128i *)(row + stride));
+        __m128i r2 = _mm_loadu_si128((const __m128i *)(row + 2 * stride));
+        __m128i r3 = _mm_loadu_si128((const __m128i *)(row + 3 * stride));
+        transpose_4x4_epi32(&r0, &r1, &r2, &r3);
+        transpose_store_widen(&dst[0], half, r0);
+        transpose_store_widen(&dst[1], half, r1);
+        transpose_store_widen(&dst[2], half, r2);
+        transpose_store_widen(&dst[3], half, r3);
+    }
+}
+
+#elif defined(TRANSPOSE_SSE2)
+
+static inline void transpose_2x2_aos_to_soa(const BigInt *src, int jp, FrLimb *rows, size_t stride) {
+    __m128i a = _mm_loadu_si128((const __m128i *)&src[0].v[2 * jp]);
+    __m128i b = _mm_loadu_si128((const __m128i *)&src[1].v[2 * jp]);
+    _mm_storeu_si128((__m128i *)(rows + 2 * jp * stride), _mm_unpacklo_epi64(a, b));
+    _mm_storeu_si128((__m128i *)(rows + (2 * jp + 1) * stride), _mm_unpackhi_epi64(a, b));
+}
+
+static inline void transpose_2x2_soa_to_aos(const FrLimb *rows, size_t stride, int jp, BigInt *dst) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(rows + 2 * jp * stride));
+    __m128i b = _mm_loadu_si128((const __m128i *)(rows + (2 * jp + 1) * stride));
+    _mm_storeu_si128((__m128i *)&dst[0].v[2 * jp], _mm_unpacklo_epi64(a, b));
+    _mm_storeu_si128((__m128i *)&dst[1].v[2 * jp], _mm_unpackhi_epi64(a, b));
+}
+
+void transpose_aos_to_soa_x4(const BigInt *src, FrLimb *rows, size_t stride) {
+    transpose_2x2_aos_to_soa(&src[0], 0, rows, stride);
+    transpose_2x2_aos_to_soa(&src[2], 0, rows + 2, stride);
+    transpose_2x2_aos_to_soa(&src[0], 1, rows, stride);
+    transpose_2x2_aos_to_soa(&src[2], 1, rows + 2, stride);
+}
+
+void transpose_soa_to_aos_x4(const FrLimb *rows, size_t stride, BigInt *dst) {
+    transpose_2x2_soa_to_aos(rows, stride, 0, &dst[0]);
+    transpose_2x2_soa_to_aos(rows + 2, stride, 0, &dst[2]);
+    transpose_2x2_soa_to_aos(rows, stride, 1, &dst[0]);
+    transpose_2x2_soa_to_aos(rows + 2, stride, 1, &dst[2]);
+}
+
+#else
+
+void transpose_aos_to_soa_x4(const BigInt *src, FrLimb *rows, size_t stride) {
+    transpose_aos_to_soa_scalar(src, 4, rows, stride);
+}
+
+void transpose_soa_to_aos_x4(const FrLimb *rows, size_t stride, BigInt *dst) {
+    transpose_soa_to_aos_scalar(rows, stride, 4, dst);
+}
+
+#endif
+
+void transpose_aos_to_soa_x8(const BigInt *src, FrLimb *rows, size_t stride) {
+    transpose_aos_to_soa_x4(src, rows, stride);
+    transpose_aos_to_soa_x4(src + 4, rows + 4, stride);
+}
+
+void transpose_soa_to_aos_x8(const FrLimb *rows, size_t stride, BigInt *dst) {
+    transpose_soa_to_aos_x4(rows, stride, dst);
+    transpose_soa_to_aos_x4(rows + 4, stride, dst + 4);
+}
+
+// Converts count elements, in blocks of 8 and then 4, with the plain loop
+// for the rest.
+void transpose_aos_to_soa(const BigInt *src, size_t count, FrLimb *rows, size_t stride) {
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        transpose_aos_to_soa_x8(src + k, rows + k, stride);
+    }
+    for (; k + 4 <= count; k += 4) {
+        transpose_aos_to_soa_x4(src + k, rows + k, stride);
+    }
+    transpose_aos_to_soa_scalar(src + k, count - k, rows + k, stride);
+}
+
+void transpose_soa_to_aos(const FrLimb *rows, size_t stride, size_t count, BigInt *dst) {
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        transpose_soa_to_aos_x8(rows + k, stride, dst + k);
+    }
+    for (; k + 4 <= count; k += 4) {
+        transpose_soa_to_aos_x4(rows + k, stride, dst + k);
+    }
+    transpose_soa_to_aos_scalar(rows + k, stride, count - k, dst + k);
+}
@@ -7,6 +7,41 @@
 #include "../../c/acar/mont.h"
 #include "../data/test_mont_data.h"
 
+// (a + b) mod p for a, b in [0, p], with the result in [0, p).
+static BigInt mont_add_ref(BigInt *a, BigInt *b, BigInt *p) {
+    BigInt r = bigint_new();
+    uint64_t carry = 0;
+    for (int i = 0; i < NUM_LIMBS; i++) {
+        uint64_t s = a->v[i] + b->v[i] + carry;
+        carry = BITS_PER_LIMB == 64 ? (s < a->v[i]) | ((s == a->v[i]) & carry) : s >> BITS_PER_LIMB;
+        r.v[i] = s & LIMB_MASK;
+    }
+    for (int n = 0; n < 2; n++) {
+        // Subtract p if r >= p
+        bool ge = carry != 0;
+        if (!ge) {
+            ge = true;
+            for (int i = NUM_LIMBS - 1; i >= 0; i--) {
+                if (r.v[i] != p->v[i]) {
+                    ge = r.v[i] > p->v[i];
+                    break;
+                }
+            }
+        }
+        if (!ge) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (int i = 0; i < NUM_LIMBS; i++) {
+            uint64_t ri = r.v[i];
+            r.v[i] = (ri - p->v[i] - borrow) & LIMB_MASK;
+            borrow = (ri < p->v[i]) | ((ri == p->v[i]) & borrow);
+        }
+        carry = 0;
+    }
+    return r;
+}
+
 MU_TEST(test_mont_mul) {
     // For the BN254 scalar field.
     uint64_t n0 = BN254_SCALAR_N0_8x32;
@@ -48,8 +83,51 @@ MU_TEST(test_mont_mul) {
     }
 }
 
+MU_TEST(test_mont_sum_of_products) {
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, a[16], b[16], sop, expected;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    // The first test case uses the largest inputs, p - 1 and p
+    BigInt p_minus_1 = p;
+    p_minus_1.v[0] -= 1;
+
+    size_t NUM_TESTS = 64;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        for (int k = 0; k <= 16; k++) {
+            expected = bigint_new();
+            for (int j = 0; j < k; j++) {
+                result = bigint_from_hex(hex_strs[(i * 16 + j) % 3072], &a[j]);
+                mu_check(result == 0);
+                result = bigint_from_hex(hex_strs[(i * 16 + j + 1) % 3072], &b[j]);
+                mu_check(result == 0);
+                if (i == 0) {
+                    a[j] = j % 2 ? p : p_minus_1;
+                    b[j] = p_minus_1;
+                }
+
+                // Reduce after every product
+                BigInt prod = mont_mul(&a[j], &b[j], &p, n0);
+                expected = mont_add_ref(&expected, &prod, &p);
+            }
+
+            sop = mont_sum_of_products(a, b, k, &p, n0);
+            mu_check(bigint_eq(&sop, &expected));
+        }
+    }
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_mont_mul);
+    MU_RUN_TEST(test_mont_sum_of_products);
 }
 
 int main(int argc, char *argv[]) {
@@ -7,6 +7,41 @@
 #include "../../c/acar/mont_4x64.h"
 #include "../data/test_mont_data.h"
 
+// (a + b) mod p for a, b in [0, p], with the result in [0, p).
+static BigInt mont_add_ref(BigInt *a, BigInt *b, BigInt *p) {
+    BigInt r = bigint_new();
+    uint64_t carry = 0;
+    for (int i = 0; i < NUM_LIMBS; i++) {
+        uint64_t s = a->v[i] + b->v[i] + carry;
+        carry = BITS_PER_LIMB == 64 ? (s < a->v[i]) | ((s == a->v[i]) & carry) : s >> BITS_PER_LIMB;
+        r.v[i] = s & LIMB_MASK;
+    }
+    for (int n = 0; n < 2; n++) {
+        // Subtract p if r >= p
+        bool ge = carry != 0;
+        if (!ge) {
+            ge = true;
+            for (int i = NUM_LIMBS - 1; i >= 0; i--) {
+                if (r.v[i] != p->v[i]) {
+                    ge = r.v[i] > p->v[i];
+                    break;
+                }
+            }
+        }
+        if (!ge) {
+            break;
+        }
+        uint64_t borrow = 0;
+        for (int i = 0; i < NUM_LIMBS; i++) {
+            uint64_t ri = r.v[i];
+            r.v[i] = (ri - p->v[i] - borrow) & LIMB_MASK;
+            borrow = (ri < p->v[i]) | ((ri == p->v[i]) & borrow);
+        }
+        carry = 0;
+    }
+    return r;
+}
+
 MU_TEST(test_mont_mul) {
     // For the BN254 scalar field.
     uint64_t n0 = BN254_SCALAR_N0_4x64;
@@ -45,8 +80,179 @@ MU_TEST(test_mont_mul) {
     }
 }
 
+MU_TEST(test_mont_sqr) {
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, ar, sqr, expected;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        // Square both inputs of each test case
+        for (int j = 0; j < 2; j++) {
+            result = bigint_from_hex(hex_strs[i * 3 + j], &ar);
+            mu_check(result == 0);
+
+            sqr = mont_sqr(&ar, &p, n0);
+            expected = mont_mul(&ar, &ar, &p, n0);
+
+            mu_check(bigint_eq(&sqr, &expected));
+        }
+    }
+}
+
+MU_TEST(test_mont_sum_of_products) {
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, a[16], b[16], sop, expected;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    // The first test case uses the largest inputs, p - 1 and p
+    BigInt p_minus_1 = p;
+    p_minus_1.v[0] -= 1;
+
+    size_t NUM_TESTS = 64;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        for (int k = 0; k <= 16; k++) {
+            expected = bigint_new();
+            for (int j = 0; j < k; j++) {
+                result = bigint_from_hex(hex_strs[(i * 16 + j) % 3072], &a[j]);
+                mu_check(result == 0);
+                result = bigint_from_hex(hex_strs[(i * 16 + j + 1) % 3072], &b[j]);
+                mu_check(result == 0);
+                if (i == 0) {
+                    a[j] = j % 2 ? p : p_minus_1;
+                    b[j] = p_minus_1;
+                }
+
+                // Reduce after every product
+                BigInt prod = mont_mul(&a[j], &b[j], &p, n0);
+                expected = mont_add_ref(&expected, &prod, &p);
+            }
+
+            sop = mont_sum_of_products(a, b, k, &p, n0);
+            mu_check(bigint_eq(&sop, &expected));
+        }
+    }
+}
+
+MU_TEST(test_mont_mul2) {
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, ar, br, cr, abr, acr, expected_ab, expected_ac;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &ar);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 1], &br);
+        mu_check(result == 0);
+        // The b of the next test case
+        result = bigint_from_hex(hex_strs[(i * 3 + 4) % 3072], &cr);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 2], &expected_ab);
+        mu_check(result == 0);
+
+        mont_mul2(&ar, &br, &cr, &p, n0, &abr, &acr);
+        expected_ac = mont_mul(&ar, &cr, &p, n0);
+
+        mu_check(bigint_eq(&abr, &expected_ab));
+        mu_check(bigint_eq(&acr, &expected_ac));
+    }
+
+    // b = c, and a zero multiplicand
+    result = bigint_from_hex(hex_strs[0], &ar);
+    mu_check(result == 0);
+    br = bigint_new();
+    mont_mul2(&ar, &ar, &br, &p, n0, &abr, &acr);
+    expected_ab = mont_mul(&ar, &ar, &p, n0);
+    expected_ac = mont_mul(&ar, &br, &p, n0);
+    mu_check(bigint_eq(&abr, &expected_ab));
+    mu_check(bigint_eq(&acr, &expected_ac));
+}
+
+MU_TEST(test_mont_mul_interleaved) {
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, ar[4], br[4], out[4], expected[4];
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    // Four test cases at a time
+    for (int i = 0; i < NUM_TESTS; i += 4) {
+        for (int k = 0; k < 4; k++) {
+            result = bigint_from_hex(hex_strs[(i + k) * 3], &ar[k]);
+            mu_check(result == 0);
+            result = bigint_from_hex(hex_strs[(i + k) * 3 + 1], &br[k]);
+            mu_check(result == 0);
+            result = bigint_from_hex(hex_strs[(i + k) * 3 + 2], &expected[k]);
+            mu_check(result == 0);
+        }
+
+        mont_mul_4way(ar, br, &p, n0, out);
+        for (int k = 0; k < 4; k++) {
+            mu_check(bigint_eq(&out[k], &expected[k]));
+        }
+
+        mont_mul_2way(ar, br, &p, n0, out);
+        mont_mul_2way(&ar[2], &br[2], &p, n0, &out[2]);
+        for (int k = 0; k < 4; k++) {
+            mu_check(bigint_eq(&out[k], &expected[k]));
+        }
+    }
+
+    // The same operands in every way, a zero multiplicand, and the output
+    // in place of the first operand
+    result = bigint_from_hex(hex_strs[0], &ar[0]);
+    mu_check(result == 0);
+    ar[1] = ar[0];
+    ar[2] = ar[0];
+    ar[3] = bigint_new();
+    for (int k = 0; k < 4; k++) {
+        br[k] = ar[0];
+        expected[k] = mont_mul(&ar[k], &br[k], &p, n0);
+    }
+    mont_mul_4way(ar, br, &p, n0, ar);
+    for (int k = 0; k < 4; k++) {
+        mu_check(bigint_eq(&ar[k], &expected[k]));
+    }
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_mont_mul);
+    MU_RUN_TEST(test_mont_sqr);
+    MU_RUN_TEST(test_mont_sum_of_products);
+    MU_RUN_TEST(test_mont_mul2);
+    MU_RUN_TEST(test_mont_mul_interleaved);
 }
 
 int main(int argc, char *argv[]) {
@@ -73,9 +73,113 @@ MU_TEST(test_mont_mul_bls12_377_scalar) {
     mu_check(strcmp(abr_hex, expected_hex) == 0);
 }
 
+// The product without a prepared operand
+static BigInt reference_mul(BigInt *a, BigInt *b, BigInt *p, uint64_t mu) {
+    return mont_mul(a, b, p, mu);
+}
+
+MU_TEST(test_mont_mul_prepared) {
+    uint64_t n0 = BN254_SCALAR_BM17_MU_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, b, a[256], out[256], expected;
+    MontPrepared prep;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    // Each test case with its own prepared multiplicand
+    for (int i = 0; i < NUM_TESTS; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &a[0]);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 1], &b);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 2], &expected);
+        mu_check(result == 0);
+
+        mont_prepare(&prep, &b, &p, n0);
+        out[0] = mont_mul_prepared(&a[0], &prep);
+        mu_check(bigint_eq(&out[0], &expected));
+    }
+
+    // One multiplicand for a whole vector
+    result = bigint_from_hex(hex_strs[1], &b);
+    mu_check(result == 0);
+    for (int i = 0; i < 256; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &a[i]);
+        mu_check(result == 0);
+    }
+    mont_prepare(&prep, &b, &p, n0);
+    mont_scale_vector(out, a, &prep, 256);
+    bool ok = true;
+    for (int i = 0; i < 256; i++) {
+        expected = reference_mul(&a[i], &b, &p, n0);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    // In place
+    mont_scale_vector(a, a, &prep, 256);
+    ok = true;
+    for (int i = 0; i < 256; i++) {
+        ok &= bigint_eq(&a[i], &out[i]);
+    }
+    mu_check(ok);
+}
+
+MU_TEST(test_mont_mul2) {
+    uint64_t n0 = BN254_SCALAR_BM17_MU_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, ar, br, cr, abr, acr, expected_ab, expected_ac;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &ar);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 1], &br);
+        mu_check(result == 0);
+        // The b of the next test case
+        result = bigint_from_hex(hex_strs[(i * 3 + 4) % 3072], &cr);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 2], &expected_ab);
+        mu_check(result == 0);
+
+        mont_mul2(&ar, &br, &cr, &p, n0, &abr, &acr);
+        expected_ac = mont_mul(&ar, &cr, &p, n0);
+
+        mu_check(bigint_eq(&abr, &expected_ab));
+        mu_check(bigint_eq(&acr, &expected_ac));
+    }
+
+    // b = c, and a zero multiplicand
+    result = bigint_from_hex(hex_strs[0], &ar);
+    mu_check(result == 0);
+    br = bigint_new();
+    mont_mul2(&ar, &ar, &br, &p, n0, &abr, &acr);
+    expected_ab = mont_mul(&ar, &ar, &p, n0);
+    expected_ac = mont_mul(&ar, &br, &p, n0);
+    mu_check(bigint_eq(&abr, &expected_ab));
+    mu_check(bigint_eq(&acr, &expected_ac));
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_mont_mul_bn254_scalar);
     MU_RUN_TEST(test_mont_mul_bls12_377_scalar);
+    MU_RUN_TEST(test_mont_mul_prepared);
+    MU_RUN_TEST(test_mont_mul2);
 }
 
 int main(int argc, char *argv[]) {
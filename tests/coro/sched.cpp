@@ -0,0 +1,116 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/field.h"
+#include "../../c/coro/sched.hpp"
+#include "../data/test_mont_data.h"
+
+#define NUM_TASKS 11
+#define MAX_ROUNDS 6
+
+static MontField f;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_8x32);
+}
+
+// x^5, as a nested task
+static FieldTask sbox(FieldScheduler &s, BigInt *x) {
+    BigInt x2 = co_await s.sqr(*x);
+    BigInt x4 = co_await s.sqr(x2);
+    *x = co_await s.mul(x4, *x);
+}
+
+// rounds rounds of x = x^5 + c
+static FieldTask chain(FieldScheduler &s, BigInt *x, BigInt c, int rounds) {
+    for (int r = 0; r < rounds; r ++) {
+        co_await sbox(s, x);
+        *x = field_add(x, &c, s.field());
+    }
+}
+
+static void chain_ref(BigInt *x, BigInt *c, int rounds) {
+    for (int r = 0; r < rounds; r ++) {
+        BigInt x2 = field_mul(x, x, &f);
+        BigInt x4 = field_mul(&x2, &x2, &f);
+        *x = field_mul(&x4, x, &f);
+        *x = field_add(x, c, &f);
+    }
+}
+
+MU_TEST(test_sched_chains) {
+    char** hex_strs = get_mont_test_data();
+
+    BigInt x[NUM_TASKS], expected[NUM_TASKS], c[NUM_TASKS];
+    int total = 0;
+    FieldScheduler s(&f);
+    for (int i = 0; i < NUM_TASKS; i++) {
+        mu_check(bigint_from_hex(hex_strs[i * 3], &x[i]) == 0);
+        mu_check(bigint_from_hex(hex_strs[i * 3 + 1], &c[i]) == 0);
+        expected[i] = x[i];
+        // Chains of different lengths, so that the number of pending
+        // multiplications changes from one round to the next
+        int rounds = i % MAX_ROUNDS + 1;
+        chain_ref(&expected[i], &c[i], rounds);
+        s.spawn(chain(s, &x[i], c[i], rounds));
+        total += 3 * rounds;
+    }
+    s.run();
+
+    for (int i = 0; i < NUM_TASKS; i++) {
+        mu_check(bigint_eq(&x[i], &expected[i]));
+    }
+    mu_check(s.muls == (uint64_t)total);
+    mu_check(s.rounds == 3 * MAX_ROUNDS);
+
+    // The scheduler can be reused once it has run
+    s.spawn(chain(s, &x[0], c[0], 1));
+    s.run();
+    chain_ref(&expected[0], &c[0], 1);
+    mu_check(bigint_eq(&x[0], &expected[0]));
+}
+
+MU_TEST(test_sched_mul_batch) {
+    char** hex_strs = get_mont_test_data();
+
+    BigInt a[9], b[9], out[9], expected[9];
+    for (size_t i = 0; i < 9; i++) {
+        mu_check(bigint_from_hex(hex_strs[i * 3], &a[i]) == 0);
+        mu_check(bigint_from_hex(hex_strs[i * 3 + 1], &b[i]) == 0);
+        mu_check(bigint_from_hex(hex_strs[i * 3 + 2], &expected[i]) == 0);
+    }
+
+    // Every remainder of the four-lane groups
+    FieldScheduler s(&f);
+    for (size_t n = 0; n <= 9; n++) {
+        s.mul_batch(a, b, out, n);
+        for (size_t i = 0; i < n; i++) {
+            mu_check(bigint_eq(&out[i], &expected[i]));
+        }
+    }
+}
+
+MU_TEST(test_sched_empty) {
+    FieldScheduler s(&f);
+    s.run();
+    mu_check(s.rounds == 0);
+    mu_check(s.muls == 0);
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_SUITE_CONFIGURE(&setup, NULL);
+    MU_RUN_TEST(test_sched_chains);
+    MU_RUN_TEST(test_sched_mul_batch);
+    MU_RUN_TEST(test_sched_empty);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
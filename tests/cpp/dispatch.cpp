@@ -0,0 +1,137 @@
+#include "../minunit.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#include "../../c/constants.h"
+#include "../../c/cpp/dispatch.hpp"
+#include "../data/test_mont_data.h"
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+using Fr = Field<Acar4x64, Bn254Scalar>;
+using Dispatch = FieldDispatch<Bn254Scalar>;
+using Words = field_detail::Words;
+
+#define LEN 100
+
+static Words a[LEN], b[LEN], expected_mul[LEN], expected_sqr[LEN];
+
+static void load_data(void) {
+    char** hex_strs = get_mont_test_data();
+    for (int i = 0; i < LEN; i++) {
+        a[i] = field_detail::parse_hex(hex_strs[i * 3]);
+        b[i] = field_detail::parse_hex(hex_strs[i * 3 + 1]);
+        Fr x = Fr::from_mont(field_detail::to_limbs<Fr::BigInt, Fr::N, Fr::B>(a[i]));
+        Fr y = Fr::from_mont(field_detail::to_limbs<Fr::BigInt, Fr::N, Fr::B>(b[i]));
+        expected_mul[i] = field_detail::from_limbs<Fr::BigInt, Fr::N, Fr::B>(Fr(x * y).mont());
+        expected_sqr[i] = field_detail::from_limbs<Fr::BigInt, Fr::N, Fr::B>(x.sqr().mont());
+    }
+}
+
+// Whether two Montgomery forms in [0, p] are the same element
+static bool same_element(const Words &x, const Words &y) {
+    Fr u = Fr::from_mont(field_detail::to_limbs<Fr::BigInt, Fr::N, Fr::B>(x));
+    Fr v = Fr::from_mont(field_detail::to_limbs<Fr::BigInt, Fr::N, Fr::B>(y));
+    return u == v;
+}
+
+// Every kernel that the CPU supports gives the same results, at every batch
+// size.
+MU_TEST(test_dispatch_kernels_agree) {
+    load_data();
+    size_t count;
+    const Dispatch::Kernel *list = Dispatch::kernels(&count);
+    size_t sizes[5] = {1, 3, 7, 64, LEN};
+    for (size_t k = 0; k < count; k++) {
+        Dispatch d;
+        if (!d.supported(&list[k])) {
+            mu_check(!d.force(list[k].name));
+            continue;
+        }
+        mu_check(d.force(list[k].name));
+        for (int s = 0; s < 5; s++) {
+            Words out[LEN];
+            d.mul(a, b, out, sizes[s]);
+            for (size_t i = 0; i < sizes[s]; i++) {
+                mu_check(same_element(out[i], expected_mul[i]));
+            }
+            d.sqr(a, out, sizes[s]);
+            for (size_t i = 0; i < sizes[s]; i++) {
+                mu_check(same_element(out[i], expected_sqr[i]));
+            }
+        }
+    }
+}
+
+// Tuning picks a supported kernel for each operation and batch size, and the
+// profile saves the next run the tuning.
+MU_TEST(test_dispatch_profile) {
+    char path[] = "/tmp/dispatch_profile_XXXXXX";
+    int fd = mkstemp(path);
+    mu_check(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    Dispatch d(path);
+    d.tune_all();
+    mu_check(d.tunings == FIELD_DISPATCH_OPS * FIELD_DISPATCH_BUCKETS);
+    mu_check(d.profile_loaded == 0);
+    for (int op = 0; op < FIELD_DISPATCH_OPS; op++) {
+        for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k++) {
+            const Dispatch::Kernel *kernel = d.kernel((FieldDispatchOp)op, Dispatch::bucket_size(k));
+            mu_check(kernel != NULL && d.supported(kernel));
+        }
+    }
+    Words out[LEN];
+    d.mul(a, b, out, LEN);
+    for (int i = 0; i < LEN; i++) {
+        mu_check(same_element(out[i], expected_mul[i]));
+    }
+
+    Dispatch again(path);
+    mu_check(again.profile_loaded == FIELD_DISPATCH_OPS * FIELD_DISPATCH_BUCKETS);
+    again.tune_all();
+    mu_check(again.tunings == 0);
+    for (int op = 0; op < FIELD_DISPATCH_OPS; op++) {
+        for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k++) {
+            size_t n = Dispatch::bucket_size(k);
+            mu_check(again.kernel((FieldDispatchOp)op, n) == d.kernel((FieldDispatchOp)op, n));
+        }
+    }
+
+    // A profile from another CPU is ignored
+    FILE *f = fopen(path, "w");
+    fprintf(f, "cpu neon=0 bmi2=0 adx=0 avx2=0 model=other\nmodulus %s\nmul 0 acar_8x32\n", BN254_SCALAR_HEX);
+    fclose(f);
+    Dispatch other(path);
+    mu_check(other.profile_loaded == 0);
+    unlink(path);
+}
+
+MU_TEST(test_dispatch_buckets) {
+    mu_check(Dispatch::bucket(0) == 0);
+    mu_check(Dispatch::bucket(1) == 0);
+    mu_check(Dispatch::bucket(4) == 1);
+    mu_check(Dispatch::bucket(255) == 2);
+    mu_check(Dispatch::bucket(1 << 20) == 3);
+    for (int k = 0; k < FIELD_DISPATCH_BUCKETS; k++) {
+        mu_check(Dispatch::bucket(Dispatch::bucket_size(k)) == k);
+    }
+#if defined(__aarch64__) && defined(__linux__)
+    mu_check((cpu_features_detect().flags & CPU_NEON) != 0);
+#endif
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_dispatch_kernels_agree);
+    MU_RUN_TEST(test_dispatch_profile);
+    MU_RUN_TEST(test_dispatch_buckets);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,190 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/cpp/field.hpp"
+#include "../data/test_mont_data.h"
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+using FrAcar8x32 = Field<Acar8x32, Bn254Scalar>;
+using FrAcar4x64 = Field<Acar4x64, Bn254Scalar>;
+using FrBH23_8x32 = Field<BH23_8x32, Bn254Scalar>;
+using FrBH23_4x64 = Field<BH23_4x64, Bn254Scalar>;
+using FrDomb4x64 = Field<Domb4x64, Bn254Scalar>;
+using FrBM17 = Field<BM17, Bn254Scalar>;
+
+// The shape of a * b + c * d - e is in its type
+using Fused = decltype(FrAcar4x64() * FrAcar4x64() + FrAcar4x64() * FrAcar4x64() - FrAcar4x64());
+static_assert(Fused::products == 2 && Fused::linears == 1 && !Fused::vector, "a * b + c * d - e");
+
+// An element from the hex of its Montgomery form
+template <class F>
+static F from_mont_hex(const char *hex) {
+    field_detail::Words w = field_detail::parse_hex(hex);
+    return F::from_mont(field_detail::to_limbs<typename F::BigInt, F::N, F::B>(w));
+}
+
+// Checks scalar expressions against their step-by-step evaluation, and
+// returns the number of failed checks.
+template <class F>
+static int check_scalar(void) {
+    int failures = 0;
+    char** hex_strs = get_mont_test_data();
+
+    for (int i = 0; i + 5 < 1024 * 3; i += 5) {
+        F a = from_mont_hex<F>(hex_strs[i]);
+        F b = from_mont_hex<F>(hex_strs[i + 1]);
+        F c = from_mont_hex<F>(hex_strs[i + 2]);
+        F d = from_mont_hex<F>(hex_strs[i + 3]);
+        F e = from_mont_hex<F>(hex_strs[i + 4]);
+
+        // Every step evaluated on its own
+        F ab = a * b;
+        F cd = c * d;
+        F ab_cd = ab + cd;
+        F expected = ab_cd - e;
+        F r = a * b + c * d - e;
+        failures += r != expected;
+        failures += F(-(a * b) + e) != e - ab;
+        failures += F(a - b - c - d - e) != F(F(F(F(a - b) - c) - d) - e);
+        failures += F(e - a * b - c * d) != e - ab_cd;
+        F a_b = a + b;
+        failures += F((a + b) * c) != F(a_b * c);
+        failures += F(a * b * c) != F(ab * c);
+
+        // The fused result is in [0, p)
+        F zero = a * b - a * b;
+        failures += zero != F::zero();
+        bool below_p = false;
+        for (int j = F::N - 1; j >= 0; j --) {
+            if (r.mont().v[j] != F::P.v[j]) {
+                below_p = r.mont().v[j] < F::P.v[j];
+                break;
+            }
+        }
+        failures += !below_p;
+    }
+
+    // Terms of p, the largest allowed value, add up without overflowing
+    F p = F::from_mont(F::P);
+    F one = F::one();
+    failures += F(p + p + p + p + one) != one;
+    failures += F(p * one + p * one - one) != -one;
+    return failures;
+}
+
+MU_TEST(test_expr_scalar) {
+    mu_check(check_scalar<FrAcar8x32>() == 0);
+    mu_check(check_scalar<FrAcar4x64>() == 0);
+    mu_check(check_scalar<FrBH23_8x32>() == 0);
+    mu_check(check_scalar<FrBH23_4x64>() == 0);
+    mu_check(check_scalar<FrDomb4x64>() == 0);
+    mu_check(check_scalar<FrBM17>() == 0);
+}
+
+// Checks vector expressions element by element against scalar ones, over a
+// length that leaves a tail after the blocks of four.
+template <class F>
+static int check_vector(void) {
+    using BigInt = typename F::BigInt;
+    const size_t n = 1023;
+    int failures = 0;
+    char** hex_strs = get_mont_test_data();
+
+    BigInt *xs = new BigInt[n], *ys = new BigInt[n], *zs = new BigInt[n], *os = new BigInt[n];
+    for (size_t i = 0; i < n; i ++) {
+        xs[i] = from_mont_hex<F>(hex_strs[i * 3]).mont();
+        ys[i] = from_mont_hex<F>(hex_strs[i * 3 + 1]).mont();
+        zs[i] = from_mont_hex<F>(hex_strs[i * 3 + 2]).mont();
+    }
+    FieldSpan<F> x(xs, n), y(ys, n), z(zs, n), out(os, n);
+    F c = from_mont_hex<F>(hex_strs[0]);
+
+    out = x * y;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != x[i] * y[i];
+    }
+    out = x * y + z;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != x[i] * y[i] + z[i];
+    }
+    out = x * y - z * c + c;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != x[i] * y[i] - z[i] * c + c;
+    }
+    out = -(x * y);
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != -(x[i] * y[i]);
+    }
+    out = x - z;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != x[i] - z[i];
+    }
+    out = c;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != c;
+    }
+
+    // The span assigned to may appear in the expression
+    out = x;
+    out = out * y + out;
+    for (size_t i = 0; i < n; i ++) {
+        failures += out[i] != x[i] * y[i] + x[i];
+    }
+
+    delete[] xs;
+    delete[] ys;
+    delete[] zs;
+    delete[] os;
+    return failures;
+}
+
+MU_TEST(test_expr_vector) {
+    mu_check(check_vector<FrAcar8x32>() == 0);
+    mu_check(check_vector<FrAcar4x64>() == 0);
+    mu_check(check_vector<FrBH23_8x32>() == 0);
+    mu_check(check_vector<FrBH23_4x64>() == 0);
+    mu_check(check_vector<FrDomb4x64>() == 0);
+    mu_check(check_vector<FrBM17>() == 0);
+}
+
+// On NEON, 8x32 spans go through mont_mul_x4 four elements at a time, which
+// check_vector<FrAcar8x32> covers; this checks the kernel itself, including
+// the lanes staying apart.
+MU_TEST(test_acar8x32_mul4) {
+#ifdef __ARM_NEON
+    static_assert(Acar8x32::has_mul4, "mont_mul_x4 backs Acar8x32::mul4");
+    using BigInt = FrAcar8x32::BigInt;
+    BigInt *p = const_cast<BigInt *>(&FrAcar8x32::P);
+    char** hex_strs = get_mont_test_data();
+    int failures = 0;
+    for (int i = 0; i + 4 <= 256; i += 4) {
+        BigInt a[4], b[4], out[4];
+        for (int j = 0; j < 4; j ++) {
+            a[j] = from_mont_hex<FrAcar8x32>(hex_strs[(i + j) * 3]).mont();
+            b[j] = from_mont_hex<FrAcar8x32>(hex_strs[(i + 3 - j) * 3 + 1]).mont();
+        }
+        Acar8x32::mul4(a, b, p, FrAcar8x32::N0, out);
+        for (int j = 0; j < 4; j ++) {
+            BigInt expected = Acar8x32::mul(&a[j], &b[j], p, FrAcar8x32::N0);
+            failures += FrAcar8x32::from_mont(out[j]) != FrAcar8x32::from_mont(expected);
+        }
+    }
+    mu_check(failures == 0);
+#endif
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_expr_scalar);
+    MU_RUN_TEST(test_expr_vector);
+    MU_RUN_TEST(test_acar8x32_mul4);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
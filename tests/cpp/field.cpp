@@ -0,0 +1,133 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/cpp/field.hpp"
+#include "../data/test_mont_data.h"
+
+struct Bn254Scalar {
+    static constexpr const char *hex = BN254_SCALAR_HEX;
+};
+
+using FrAcar8x32 = Field<Acar8x32, Bn254Scalar>;
+using FrAcar4x64 = Field<Acar4x64, Bn254Scalar>;
+using FrBH23_8x32 = Field<BH23_8x32, Bn254Scalar>;
+using FrBH23_4x64 = Field<BH23_4x64, Bn254Scalar>;
+using FrDomb4x64 = Field<Domb4x64, Bn254Scalar>;
+using FrBM17 = Field<BM17, Bn254Scalar>;
+using FrSLGCK14 = Field<SLGCK14, Bn254Scalar>;
+
+// The constants computed at compile time match the ones in constants.h
+static_assert(FrAcar4x64::N0 == BN254_SCALAR_N0_4x64, "n0, 4x64");
+static_assert(FrAcar8x32::N0 == BN254_SCALAR_N0_8x32, "n0, 8x32");
+static_assert(FrBM17::N0 == BN254_SCALAR_BM17_MU_4x64, "mu");
+static_assert(FrAcar4x64::SPARE_BIT && FrAcar8x32::SPARE_BIT, "BN254 leaves a spare bit");
+
+// An element from the hex of its Montgomery form
+template <class F>
+static F from_mont_hex(const char *hex) {
+    field_detail::Words w = field_detail::parse_hex(hex);
+    return F::from_mont(field_detail::to_limbs<typename F::BigInt, F::N, F::B>(w));
+}
+
+template <class F>
+static bool bigint_equal(const typename F::BigInt &a, const typename F::BigInt &b) {
+    for (int i = 0; i < F::N; i++) {
+        if (a.v[i] != b.v[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks one backend, and returns the number of failed checks.
+template <class F>
+static int check_field(void) {
+    int failures = 0;
+    char** hex_strs = get_mont_test_data();
+
+    // R and R^2
+    failures += !bigint_equal<F>(F::R, from_mont_hex<F>(BN254_SCALAR_R_HEX).mont());
+    failures += !bigint_equal<F>(F::R2, from_mont_hex<F>(BN254_SCALAR_R2_HEX).mont());
+
+    for (int i = 0; i < 1024; i++) {
+        F a = from_mont_hex<F>(hex_strs[i * 3]);
+        F b = from_mont_hex<F>(hex_strs[i * 3 + 1]);
+        F expected = from_mont_hex<F>(hex_strs[i * 3 + 2]);
+
+        failures += a * b != expected;
+        failures += a.sqr() != a * a;
+        failures += (a + b) - b != a;
+        failures += (a - b) + b != a;
+        failures += a + (-a) != F::zero();
+
+        F c = a;
+        c *= b;
+        c += a;
+        c -= a;
+        failures += c != expected;
+    }
+
+    // p is zero
+    failures += F::from_mont(F::P) != F::zero();
+    failures += F::from_mont(F::P) + F::one() != F::one();
+
+    // Canonical values in and out
+    uint64_t w[4] = {12345, 0, 0, 0};
+    uint64_t out[4];
+    F x = F::from_words(w);
+    x.to_words(out);
+    failures += out[0] != 12345 || out[1] != 0 || out[2] != 0 || out[3] != 0;
+    failures += F::from_u64(6) * F::from_u64(7) != F::from_u64(42);
+    failures += F::from_u64(1) != F::one();
+    failures += F::from_u64(0) - F::one() + F::from_u64(2) != F::one();
+    return failures;
+}
+
+MU_TEST(test_field_backends) {
+    mu_check(check_field<FrAcar8x32>() == 0);
+    mu_check(check_field<FrAcar4x64>() == 0);
+    mu_check(check_field<FrBH23_8x32>() == 0);
+    mu_check(check_field<FrBH23_4x64>() == 0);
+    mu_check(check_field<FrDomb4x64>() == 0);
+    mu_check(check_field<FrBM17>() == 0);
+    mu_check(check_field<FrSLGCK14>() == 0);
+}
+
+// The same computation gives the same canonical result in every layout in
+// one binary.
+template <class F>
+static void canonical_result(uint64_t out[4]) {
+    char** hex_strs = get_mont_test_data();
+    F acc = F::one();
+    for (int i = 0; i < 64; i++) {
+        acc = acc * from_mont_hex<F>(hex_strs[i * 3]) + from_mont_hex<F>(hex_strs[i * 3 + 1]);
+    }
+    acc.to_words(out);
+}
+
+MU_TEST(test_field_layouts_agree) {
+    uint64_t expected[4], out[4];
+    canonical_result<FrAcar4x64>(expected);
+    canonical_result<FrAcar8x32>(out);
+    mu_check(memcmp(out, expected, sizeof(out)) == 0);
+    canonical_result<FrBH23_8x32>(out);
+    mu_check(memcmp(out, expected, sizeof(out)) == 0);
+    canonical_result<FrDomb4x64>(out);
+    mu_check(memcmp(out, expected, sizeof(out)) == 0);
+    canonical_result<FrBM17>(out);
+    mu_check(memcmp(out, expected, sizeof(out)) == 0);
+    canonical_result<FrSLGCK14>(out);
+    mu_check(memcmp(out, expected, sizeof(out)) == 0);
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_field_backends);
+    MU_RUN_TEST(test_field_layouts_agree);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -47,8 +47,63 @@ MU_TEST(test_mont_mul) {
     }
 }
 
+MU_TEST(test_mont_mul_interleaved) {
+    uint64_t n0 = BN254_SCALAR_N0_4x64;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, ar[4], br[4], out[4], expected[4];
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    // Four test cases at a time
+    for (int i = 0; i < NUM_TESTS; i += 4) {
+        for (int k = 0; k < 4; k++) {
+            result = bigint_from_hex(hex_strs[(i + k) * 3], &ar[k]);
+            mu_check(result == 0);
+            result = bigint_from_hex(hex_strs[(i + k) * 3 + 1], &br[k]);
+            mu_check(result == 0);
+            result = bigint_from_hex(hex_strs[(i + k) * 3 + 2], &expected[k]);
+            mu_check(result == 0);
+        }
+
+        mont_mul_4way(ar, br, &p, n0, out);
+        for (int k = 0; k < 4; k++) {
+            mu_check(bigint_eq(&out[k], &expected[k]));
+        }
+
+        mont_mul_2way(ar, br, &p, n0, out);
+        mont_mul_2way(&ar[2], &br[2], &p, n0, &out[2]);
+        for (int k = 0; k < 4; k++) {
+            mu_check(bigint_eq(&out[k], &expected[k]));
+        }
+    }
+
+    // The same operands in every way, a zero multiplicand, and the output
+    // in place of the first operand
+    result = bigint_from_hex(hex_strs[0], &ar[0]);
+    mu_check(result == 0);
+    ar[1] = ar[0];
+    ar[2] = ar[0];
+    ar[3] = bigint_new();
+    for (int k = 0; k < 4; k++) {
+        br[k] = ar[0];
+        expected[k] = mont_mul(&ar[k], &br[k], &p, n0);
+    }
+    mont_mul_4way(ar, br, &p, n0, ar);
+    for (int k = 0; k < 4; k++) {
+        mu_check(bigint_eq(&ar[k], &expected[k]));
+    }
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_mont_mul);
+    MU_RUN_TEST(test_mont_mul_interleaved);
 }
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,119 @@
+// The converter, without its main, in the default 4x64 layout
+#define CONVERT_NO_MAIN
+#include "../../c/fieldfile/convert.c"
+
+#include <stddef.h>
+#include "../minunit.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_ELEMS 100
+
+static MontField f;
+static char text_path[] = "/tmp/convert_text_XXXXXX";
+static char bin_path[] = "/tmp/convert_bin_XXXXXX";
+static char out_path[] = "/tmp/convert_out_XXXXXX";
+
+static void write_text(const char *path, const char *extra) {
+    char** hex_strs = get_mont_test_data();
+    FILE *fp = fopen(path, "w");
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        fprintf(fp, "\"%s\",\n", hex_strs[i]);
+    }
+    if (extra != NULL) {
+        fprintf(fp, "%s\n", extra);
+    }
+    fclose(fp);
+}
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    close(mkstemp(text_path));
+    close(mkstemp(bin_path));
+    close(mkstemp(out_path));
+}
+
+// Patches bytes of the field file at bin_path
+static void patch(uint64_t offset, const void *bytes, size_t n) {
+    FILE *fp = fopen(bin_path, "r+b");
+    fseek(fp, offset, SEEK_SET);
+    fwrite(bytes, 1, n, fp);
+    fclose(fp);
+}
+
+MU_TEST(test_round_trip) {
+    char** hex_strs = get_mont_test_data();
+    write_text(text_path, NULL);
+    mu_check(convert_run(text_path, bin_path, 1, false, BN254_SCALAR_HEX) == 0);
+
+    FieldFileMap m;
+    mu_check(fieldfile_map(&m, bin_path, &f.p) == 0);
+    mu_check(m.header.count == NUM_ELEMS);
+    mu_check((m.header.flags & FIELDFILE_MONTGOMERY) != 0);
+    bool ok = true;
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        BigInt x;
+        bigint_from_hex(hex_strs[i], &x);
+        BigInt expected = field_to_mont(&x, &f);
+        ok &= bigint_eq((BigInt *)&m.elems[i], &expected);
+    }
+    mu_check(ok);
+    fieldfile_unmap(&m);
+
+    mu_check(convert_run(bin_path, out_path, -1, true, BN254_SCALAR_HEX) == 0);
+    FILE *fp = fopen(out_path, "r");
+    char line[128];
+    ok = true;
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        ok &= fgets(line, sizeof(line), fp) != NULL && strncmp(line, hex_strs[i], 64) == 0;
+    }
+    ok &= fgets(line, sizeof(line), fp) == NULL;
+    fclose(fp);
+    mu_check(ok);
+}
+
+MU_TEST(test_rejects_values_not_less_than_p) {
+    write_text(text_path, BN254_SCALAR_HEX);
+    mu_check(convert_run(text_path, out_path, 1, true, BN254_SCALAR_HEX) == 1);
+    write_text(text_path, "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    mu_check(convert_run(text_path, out_path, 0, false, BN254_SCALAR_HEX) == 1);
+
+    // An element of a field file equal to p
+    write_text(text_path, NULL);
+    mu_check(convert_run(text_path, bin_path, 0, false, BN254_SCALAR_HEX) == 0);
+    uint64_t words[4];
+    fieldfile_words_from_bigint(&f.p, words);
+    patch(FIELDFILE_ALIGN + 5 * sizeof(BigInt), words, sizeof(words));
+    mu_check(convert_run(bin_path, out_path, 0, true, BN254_SCALAR_HEX) == 1);
+}
+
+MU_TEST(test_rejects_invalid_headers) {
+    write_text(text_path, NULL);
+    uint32_t bad[][2] = {
+        {9, 64},  // Limbs past the end of a 32-byte element
+        {4, 0},   // A shift by 64
+        {4, 65},  // Shifts by more than 64
+        {0, 64},
+    };
+    for (int i = 0; i < 4; i ++) {
+        mu_check(convert_run(text_path, bin_path, 0, false, BN254_SCALAR_HEX) == 0);
+        patch(offsetof(FieldFileHeader, num_limbs), &bad[i][0], sizeof(uint32_t));
+        patch(offsetof(FieldFileHeader, bits_per_limb), &bad[i][1], sizeof(uint32_t));
+        mu_check(convert_run(bin_path, out_path, 0, true, BN254_SCALAR_HEX) == 1);
+    }
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_round_trip);
+    MU_RUN_TEST(test_rejects_values_not_less_than_p);
+    MU_RUN_TEST(test_rejects_invalid_headers);
+    unlink(text_path);
+    unlink(bin_path);
+    unlink(out_path);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,149 @@
+#define _XOPEN_SOURCE 700 // For pread and mkstemp
+
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/fieldfile/fieldfile.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_ELEMS 3072
+
+static MontField f;
+static BigInt elems[NUM_ELEMS];
+static char path[] = "/tmp/fieldfile_test_XXXXXX";
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    char** hex_strs = get_mont_test_data();
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        bigint_from_hex(hex_strs[i], &elems[i]);
+    }
+    int fd = mkstemp(path);
+    close(fd);
+}
+
+MU_TEST(test_map) {
+    mu_check(fieldfile_write(path, elems, NUM_ELEMS, false, &f.p) == 0);
+
+    FieldFileMap m;
+    mu_check(fieldfile_map(&m, path, &f.p) == 0);
+    mu_check(m.header.count == NUM_ELEMS);
+    mu_check(m.header.num_limbs == NUM_LIMBS);
+    mu_check(m.header.bits_per_limb == BITS_PER_LIMB);
+    mu_check((m.header.flags & FIELDFILE_MONTGOMERY) == 0);
+    mu_check((uintptr_t)m.elems % FIELDFILE_ALIGN == 0);
+    mu_check(memcmp(m.elems, elems, sizeof(elems)) == 0);
+
+    // The kernels run straight on the mapped pages: the test data is
+    // triples of a, b and the Montgomery product of a and b.
+    bool ok = true;
+    for (int i = 0; i + 2 < NUM_ELEMS; i += 3) {
+        BigInt r = field_mul((BigInt *)&m.elems[i], (BigInt *)&m.elems[i + 1], &f);
+        ok &= bigint_eq(&r, &m.elems[i + 2]);
+    }
+    mu_check(ok);
+    fieldfile_unmap(&m);
+
+    // An empty file
+    mu_check(fieldfile_write(path, elems, 0, true, &f.p) == 0);
+    mu_check(fieldfile_map(&m, path, NULL) == 0);
+    mu_check(m.header.count == 0);
+    mu_check((m.header.flags & FIELDFILE_MONTGOMERY) != 0);
+    fieldfile_unmap(&m);
+}
+
+MU_TEST(test_stream) {
+    FieldFileWriter w;
+    mu_check(fieldfile_create(&w, path, false, &f.p) == 0);
+    // Appended in uneven pieces
+    for (int i = 0; i < NUM_ELEMS; i += 1000) {
+        int n = NUM_ELEMS - i < 1000 ? NUM_ELEMS - i : 1000;
+        mu_check(fieldfile_append(&w, &elems[i], n) == 0);
+    }
+    mu_check(fieldfile_close(&w) == 0);
+
+    size_t chunks[] = {1, 7, 1024, NUM_ELEMS, 5000};
+    for (int c = 0; c < 5; c ++) {
+        FieldFileReader r;
+        mu_check(fieldfile_reader_open(&r, path, chunks[c], &f.p) == 0);
+        size_t total = 0;
+        bool ok = true;
+        const BigInt *got;
+        long n;
+        while ((n = fieldfile_reader_next(&r, &got)) > 0) {
+            ok &= (size_t)n <= chunks[c];
+            ok &= memcmp(got, &elems[total], n * sizeof(BigInt)) == 0;
+            total += n;
+        }
+        mu_check(ok);
+        mu_check(n == 0);
+        mu_check(total == NUM_ELEMS);
+        fieldfile_reader_close(&r);
+    }
+}
+
+MU_TEST(test_errors) {
+    FieldFileMap m;
+    FieldFileReader r;
+    mu_check(fieldfile_map(&m, "/nonexistent/fieldfile", NULL) == -1);
+    mu_check(fieldfile_reader_open(&r, "/nonexistent/fieldfile", 16, NULL) == -1);
+
+    // Another modulus
+    BigInt q = f.p;
+    q.v[0] += 2;
+    mu_check(fieldfile_write(path, elems, 16, false, &f.p) == 0);
+    mu_check(fieldfile_map(&m, path, &q) == -4);
+    mu_check(fieldfile_reader_open(&r, path, 16, &q) == -4);
+
+    // Another limb layout
+    FieldFileHeader h;
+    fieldfile_header_init(&h, 16, false, &f.p);
+    h.num_limbs = NUM_LIMBS == 8 ? 4 : 8;
+    h.bits_per_limb = BITS_PER_LIMB == 32 ? 64 : 32;
+    h.element_size = 32;
+    int fd = open(path, O_WRONLY);
+    mu_check(pwrite(fd, &h, sizeof(h), 0) == sizeof(h));
+    close(fd);
+    mu_check(fieldfile_map(&m, path, NULL) == -3);
+
+    // Bad magic
+    fieldfile_header_init(&h, 16, false, &f.p);
+    h.magic[0] = 'X';
+    fd = open(path, O_WRONLY);
+    mu_check(pwrite(fd, &h, sizeof(h), 0) == sizeof(h));
+    close(fd);
+    mu_check(fieldfile_map(&m, path, NULL) == -2);
+
+    // More elements than the file holds
+    fieldfile_header_init(&h, 17, false, &f.p);
+    fd = open(path, O_WRONLY);
+    mu_check(pwrite(fd, &h, sizeof(h), 0) == sizeof(h));
+    close(fd);
+    mu_check(fieldfile_map(&m, path, NULL) == -2);
+    mu_check(fieldfile_reader_open(&r, path, 16, NULL) == -2);
+
+    // Too short for a header
+    fd = open(path, O_WRONLY | O_TRUNC);
+    mu_check(write(fd, "MMFIELD", 8) == 8);
+    close(fd);
+    mu_check(fieldfile_map(&m, path, NULL) == -2);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_map);
+    MU_RUN_TEST(test_stream);
+    MU_RUN_TEST(test_errors);
+    unlink(path);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,249 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/jobs/jobs.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_JOBS 200
+#define MAX_JOB_SIZE 7
+#define NUM_ITEMS 20000
+#define NUM_PRODUCERS 4
+
+static MontField f;
+static PoseidonParams params;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_8x32);
+    poseidon_init(&params, 3, &f);
+}
+
+static BigInt small_mont(uint64_t a) {
+    BigInt x = bigint_new();
+    x.v[0] = a;
+    return field_to_mont(&x, &f);
+}
+
+static void count_callback(Job *job, void *arg) {
+    atomic_fetch_add((_Atomic int *)arg, 1);
+}
+
+MU_TEST(test_mpmc_single_thread) {
+    MpmcQueue q;
+    mu_check(mpmc_init(&q, 3) == -1);
+    mu_check(mpmc_init(&q, 8) == 0);
+
+    void *data;
+    mu_check(!mpmc_dequeue(&q, &data));
+    static int items[9];
+    for (int lap = 0; lap < 3; lap ++) {
+        for (int i = 0; i < 8; i ++) {
+            mu_check(mpmc_enqueue(&q, &items[i]));
+        }
+        mu_check(!mpmc_enqueue(&q, &items[8]));
+        for (int i = 0; i < 8; i ++) {
+            mu_check(mpmc_dequeue(&q, &data) && data == &items[i]);
+        }
+        mu_check(!mpmc_dequeue(&q, &data));
+    }
+    mpmc_free(&q);
+}
+
+typedef struct {
+    MpmcQueue *q;
+    size_t first;
+    _Atomic size_t *sum;
+    _Atomic size_t *consumed;
+} MpmcThreadArgs;
+
+static void *mpmc_producer(void *arg) {
+    MpmcThreadArgs *args = arg;
+    for (size_t i = 0; i < NUM_ITEMS; i ++) {
+        // Values are offset by 1 so that none is NULL.
+        while (!mpmc_enqueue(args->q, (void *)(args->first + i + 1))) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+    MpmcThreadArgs *args = arg;
+    void *data;
+    while (atomic_load(args->consumed) < NUM_ITEMS * NUM_PRODUCERS) {
+        if (mpmc_dequeue(args->q, &data)) {
+            atomic_fetch_add(args->sum, (size_t)data - 1);
+            atomic_fetch_add(args->consumed, 1);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+MU_TEST(test_mpmc_threads) {
+    MpmcQueue q;
+    mu_check(mpmc_init(&q, 64) == 0);
+    _Atomic size_t sum, consumed;
+    atomic_init(&sum, 0);
+    atomic_init(&consumed, 0);
+
+    pthread_t threads[2 * NUM_PRODUCERS];
+    MpmcThreadArgs args[NUM_PRODUCERS];
+    for (int i = 0; i < NUM_PRODUCERS; i ++) {
+        args[i].q = &q;
+        args[i].first = (size_t)i * NUM_ITEMS;
+        args[i].sum = &sum;
+        args[i].consumed = &consumed;
+        pthread_create(&threads[i], NULL, mpmc_producer, &args[i]);
+        pthread_create(&threads[NUM_PRODUCERS + i], NULL, mpmc_consumer, &args[i]);
+    }
+    for (int i = 0; i < 2 * NUM_PRODUCERS; i ++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Every item was taken exactly once.
+    size_t n = (size_t)NUM_ITEMS * NUM_PRODUCERS;
+    mu_check(atomic_load(&consumed) == n);
+    mu_check(atomic_load(&sum) == n * (n - 1) / 2);
+    mpmc_free(&q);
+}
+
+MU_TEST(test_mul_jobs) {
+    char** hex_strs = get_mont_test_data();
+    static BigInt a[NUM_JOBS][MAX_JOB_SIZE], b[NUM_JOBS][MAX_JOB_SIZE], out[NUM_JOBS][MAX_JOB_SIZE];
+    static Job jobs[NUM_JOBS];
+    _Atomic int callbacks;
+    atomic_init(&callbacks, 0);
+
+    uint64_t delays[] = {0, 100000};
+    for (int d = 0; d < 2; d ++) {
+        JobQueue q;
+        mu_check(job_queue_init(&q, 2, 256, delays[d], &f, &params) == 0);
+
+        size_t total = 0;
+        for (int j = 0; j < NUM_JOBS; j ++) {
+            int size = 1 + j % MAX_JOB_SIZE;
+            for (int i = 0; i < size; i ++) {
+                int idx = (j * MAX_JOB_SIZE + i) % 1000;
+                bigint_from_hex(hex_strs[idx * 3], &a[j][i]);
+                bigint_from_hex(hex_strs[idx * 3 + 1], &b[j][i]);
+            }
+            job_mul_init(&jobs[j], out[j], a[j], b[j], size, count_callback, &callbacks);
+            mu_check(job_submit(&q, &jobs[j]) == 0);
+            total += size;
+        }
+
+        bool ok = true;
+        for (int j = 0; j < NUM_JOBS; j ++) {
+            job_wait(&q, &jobs[j]);
+            ok &= job_done(&jobs[j]);
+            for (size_t i = 0; i < jobs[j].count; i ++) {
+                BigInt expected = field_mul(&a[j][i], &b[j][i], &f);
+                ok &= bigint_eq(&out[j][i], &expected);
+            }
+        }
+        mu_check(ok);
+        job_queue_destroy(&q);
+
+        mu_check(atomic_load(&q.jobs_done) == NUM_JOBS);
+        mu_check(atomic_load(&q.lanes_used) == total);
+        mu_check(atomic_load(&q.lane_groups) >= (total + JOB_LANES - 1) / JOB_LANES);
+    }
+    mu_check(atomic_load(&callbacks) == 2 * NUM_JOBS);
+}
+
+MU_TEST(test_hash_jobs) {
+    static BigInt inputs[NUM_JOBS][2 * MAX_JOB_SIZE], out[NUM_JOBS][MAX_JOB_SIZE];
+    static Job jobs[NUM_JOBS];
+
+    JobQueue q;
+    mu_check(job_queue_init(&q, 3, 64, 0, &f, &params) == 0);
+
+    // More jobs than the queue holds, so that submission sometimes has to
+    // retry
+    for (int j = 0; j < NUM_JOBS; j ++) {
+        int size = 1 + j % MAX_JOB_SIZE;
+        for (int i = 0; i < 2 * size; i ++) {
+            inputs[j][i] = small_mont(j * 100 + i + 1);
+        }
+        job_hash_init(&jobs[j], out[j], inputs[j], size, NULL, NULL);
+        while (job_submit(&q, &jobs[j]) != 0) {
+            sched_yield();
+        }
+    }
+
+    bool ok = true;
+    for (int j = 0; j < NUM_JOBS; j ++) {
+        job_wait(&q, &jobs[j]);
+        for (size_t i = 0; i < jobs[j].count; i ++) {
+            BigInt expected = poseidon_hash(&inputs[j][2 * i], &params, &f);
+            ok &= bigint_eq(&out[j][i], &expected);
+        }
+    }
+    mu_check(ok);
+
+    // poseidon([1, 2]) from circomlib
+    inputs[0][0] = small_mont(1);
+    inputs[0][1] = small_mont(2);
+    job_hash_init(&jobs[0], out[0], inputs[0], 1, NULL, NULL);
+    mu_check(job_submit(&q, &jobs[0]) == 0);
+    job_wait(&q, &jobs[0]);
+    BigInt h = field_from_mont(&out[0][0], &f);
+    BigInt expected;
+    bigint_from_hex("115cc0f5e7d690413df64c6b9662e9cf2a3617f2743245519e19607a4417189a", &expected);
+    mu_check(bigint_eq(&h, &expected));
+
+    job_queue_destroy(&q);
+}
+
+MU_TEST(test_latency_histogram) {
+    JobQueue q;
+    mu_check(job_queue_init(&q, 1, 16, 0, &f, &params) == 0);
+    BigInt a = small_mont(3), out;
+    Job job;
+    for (int i = 0; i < 10; i ++) {
+        job_mul_init(&job, &out, &a, &a, 1, NULL, NULL);
+        mu_check(job_submit(&q, &job) == 0);
+        job_wait(&q, &job);
+    }
+    job_queue_destroy(&q);
+
+    uint64_t total = 0;
+    for (int i = 0; i < JOB_HIST_BUCKETS; i ++) {
+        total += atomic_load(&q.latency_hist[i]);
+    }
+    mu_check(total == 10);
+    uint64_t p50 = job_latency_percentile(&q, 50);
+    uint64_t p99 = job_latency_percentile(&q, 99);
+    mu_check(p50 >= 1 && p50 <= p99);
+
+    job_queue_reset_stats(&q);
+    mu_check(atomic_load(&q.jobs_done) == 0);
+
+    mu_check(job_queue_init(&q, 0, 16, 0, &f, &params) == -1);
+    mu_check(job_queue_init(&q, 1, 15, 0, &f, &params) == -1);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_mpmc_single_thread);
+    MU_RUN_TEST(test_mpmc_threads);
+    MU_RUN_TEST(test_mul_jobs);
+    MU_RUN_TEST(test_hash_jobs);
+    MU_RUN_TEST(test_latency_histogram);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,155 @@
+// For pread and pwrite, which minunit.h would otherwise hide
+#define _XOPEN_SOURCE 700
+
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+#include "../../c/merkle/merkle.h"
+
+#define DEPTH 7
+
+static MontField f;
+static PoseidonParams params;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_BM17_MU_4x64);
+    poseidon_init(&params, 3, &f);
+}
+
+static BigInt small_mont(uint64_t a) {
+    BigInt x = bigint_new();
+    x.v[0] = a;
+    return field_to_mont(&x, &f);
+}
+
+static int leaf_source(BigInt *leaves, size_t first, size_t count, void *ctx) {
+    for (size_t i = 0; i < count; i ++) {
+        leaves[i] = small_mont(first + i + 1);
+    }
+    return 0;
+}
+
+static int failing_source(BigInt *leaves, size_t first, size_t count, void *ctx) {
+    return first == 0 ? 0 : 1;
+}
+
+// The node at (level, index), hashed recursively from the leaves.
+static BigInt naive_node(int level, size_t index) {
+    if (level == 0) {
+        return small_mont(index + 1);
+    }
+    BigInt children[2];
+    children[0] = naive_node(level - 1, 2 * index);
+    children[1] = naive_node(level - 1, 2 * index + 1);
+    return poseidon_hash(children, &params, &f);
+}
+
+MU_TEST(test_layout) {
+    MerkleTree tree;
+    mu_check(merkle_tree_init(&tree, DEPTH) == 0);
+    mu_check(((uintptr_t)tree.nodes % MERKLE_ALIGN) == 0);
+    for (int l = 0; l <= DEPTH; l ++) {
+        mu_check((tree.offsets[l] * sizeof(BigInt)) % MERKLE_ALIGN == 0);
+        if (l > 0) {
+            mu_check(tree.offsets[l] >= tree.offsets[l - 1] + (tree.num_leaves >> (l - 1)));
+        }
+    }
+    mu_check(tree.num_nodes >= tree.offsets[DEPTH] + 1);
+    merkle_tree_free(&tree);
+
+    mu_check(merkle_tree_init(&tree, -1) == -1);
+    mu_check(merkle_tree_init(&tree, MERKLE_MAX_DEPTH + 1) == -1);
+}
+
+MU_TEST(test_circomlib_pair) {
+    // A tree with leaves 1 and 2 has root poseidon([1, 2]).
+    MerkleTree tree;
+    mu_check(merkle_tree_init(&tree, 1) == 0);
+    leaf_source(merkle_leaves(&tree), 0, 2, NULL);
+    mu_check(merkle_build(&tree, 4, &params, &f) == 0);
+    BigInt root = field_from_mont(merkle_level(&tree, 1), &f);
+    BigInt expected;
+    bigint_from_hex("115cc0f5e7d690413df64c6b9662e9cf2a3617f2743245519e19607a4417189a", &expected);
+    mu_check(bigint_eq(&root, &expected));
+    merkle_tree_free(&tree);
+}
+
+MU_TEST(test_matches_naive) {
+    MerkleTree tree;
+    mu_check(merkle_tree_init(&tree, DEPTH) == 0);
+
+    int thread_counts[] = {1, 2, 3, 4, 8};
+    for (int k = 0; k < sizeof(thread_counts) / sizeof(thread_counts[0]); k ++) {
+        memset(tree.nodes, 0, tree.num_nodes * sizeof(BigInt));
+        leaf_source(merkle_leaves(&tree), 0, tree.num_leaves, NULL);
+        mu_check(merkle_build(&tree, thread_counts[k], &params, &f) == 0);
+
+        for (int l = 1; l <= DEPTH; l ++) {
+            for (size_t i = 0; i < (tree.num_leaves >> l); i ++) {
+                BigInt expected = naive_node(l, i);
+                mu_check(bigint_eq(&merkle_level(&tree, l)[i], &expected));
+            }
+        }
+    }
+
+    mu_check(merkle_build(&tree, 0, &params, &f) == -1);
+    mu_check(merkle_build(&tree, MERKLE_MAX_THREADS + 1, &params, &f) == -1);
+    merkle_tree_free(&tree);
+}
+
+MU_TEST(test_streaming) {
+    MerkleTree tree;
+    mu_check(merkle_tree_init(&tree, DEPTH) == 0);
+    leaf_source(merkle_leaves(&tree), 0, tree.num_leaves, NULL);
+    mu_check(merkle_build(&tree, 2, &params, &f) == 0);
+    BigInt expected_root = merkle_root(&tree);
+
+    for (int chunk_depth = 0; chunk_depth <= DEPTH; chunk_depth ++) {
+        FILE *fp = tmpfile();
+        int fd = fileno(fp);
+        BigInt root;
+        mu_check(merkle_build_streaming(&root, DEPTH, chunk_depth, leaf_source, NULL, fd, 2, &params, &f) == 0);
+        mu_check(bigint_eq(&root, &expected_root));
+
+        // The file has the same layout as the in-memory tree.
+        for (int l = 0; l <= DEPTH; l ++) {
+            size_t n = tree.num_leaves >> l;
+            BigInt level[1 << DEPTH];
+            ssize_t bytes = pread(fd, level, n * sizeof(BigInt), tree.offsets[l] * sizeof(BigInt));
+            mu_check(bytes == (ssize_t)(n * sizeof(BigInt)));
+            mu_check(memcmp(level, merkle_level(&tree, l), n * sizeof(BigInt)) == 0);
+        }
+        fclose(fp);
+    }
+
+    // Without a file, only the root is computed.
+    BigInt root;
+    mu_check(merkle_build_streaming(&root, DEPTH, 3, leaf_source, NULL, -1, 4, &params, &f) == 0);
+    mu_check(bigint_eq(&root, &expected_root));
+
+    mu_check(merkle_build_streaming(&root, DEPTH, 3, failing_source, NULL, -1, 4, &params, &f) == -4);
+    mu_check(merkle_build_streaming(&root, DEPTH, DEPTH + 1, leaf_source, NULL, -1, 4, &params, &f) == -1);
+    merkle_tree_free(&tree);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_layout);
+    MU_RUN_TEST(test_circomlib_pair);
+    MU_RUN_TEST(test_matches_naive);
+    MU_RUN_TEST(test_streaming);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
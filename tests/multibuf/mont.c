@@ -0,0 +1,153 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../../c/field.h"
+#include "../../c/pow/pow.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/multibuf/mont_x2.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_TESTS 1024
+
+static void load_test_case(char **hex_strs, int i, BigInt *ar, BigInt *br, BigInt *expected) {
+    bigint_from_hex(hex_strs[i * 3], ar);
+    bigint_from_hex(hex_strs[i * 3 + 1], br);
+    bigint_from_hex(hex_strs[i * 3 + 2], expected);
+}
+
+MU_TEST(test_mont_mul_x4) {
+    BigInt p;
+    bigint_from_hex(BN254_SCALAR_HEX, &p);
+    BigIntX4 vp = bigint_x4_splat(&p);
+    char** hex_strs = get_mont_test_data();
+
+    for (int i = 0; i < NUM_TESTS; i += 4) {
+        BigInt a[4], b[4], expected[4], res[4];
+        for (int k = 0; k < 4; k ++) {
+            load_test_case(hex_strs, i + k, &a[k], &b[k], &expected[k]);
+        }
+        BigIntX4 va = bigint_x4_pack(a);
+        BigIntX4 vb = bigint_x4_pack(b);
+        BigIntX4 vr = mont_mul_x4(&va, &vb, &vp, BN254_SCALAR_N0_8x32);
+        bigint_x4_unpack(&vr, res);
+        for (int k = 0; k < 4; k ++) {
+            mu_check(bigint_eq(&res[k], &expected[k]));
+        }
+    }
+}
+
+MU_TEST(test_mont_mul_x2) {
+    BigInt p;
+    bigint_from_hex(BN254_SCALAR_HEX, &p);
+    char** hex_strs = get_mont_test_data();
+
+    for (int i = 0; i < NUM_TESTS; i += 2) {
+        BigIntX2 a, b, expected, res;
+        for (int k = 0; k < 2; k ++) {
+            load_test_case(hex_strs, i + k, &a.v[k], &b.v[k], &expected.v[k]);
+        }
+        res = mont_mul_x2(&a, &b, &p, BN254_SCALAR_BM17_MU_4x64);
+        mu_check(bigint_eq(&res.v[0], &expected.v[0]));
+        mu_check(bigint_eq(&res.v[1], &expected.v[1]));
+    }
+}
+
+MU_TEST(test_addchain_sliding_matches_generated) {
+    // addchain_sliding with the window that gen_addchain.js picked should
+    // reproduce the generated chain step for step.
+    BigInt e;
+    bigint_from_hex("30644e72e131a029b85045b68181585d2833e84879b9709143e1f593efffffff", &e);
+    AddChainStep steps[ADDCHAIN_MAX_STEPS];
+    AddChain chain;
+    mu_check(addchain_sliding(&e, 4, steps, &chain) == 0);
+    mu_check(chain.table_size == BN254_SCALAR_INV_CHAIN.table_size);
+    mu_check(chain.num_steps == BN254_SCALAR_INV_CHAIN.num_steps);
+    for (int s = 0; s < chain.num_steps; s ++) {
+        mu_check(steps[s].num_sqr == BN254_SCALAR_INV_CHAIN.steps[s].num_sqr);
+        mu_check(steps[s].idx == BN254_SCALAR_INV_CHAIN.steps[s].idx);
+    }
+
+    e = bigint_new();
+    mu_check(addchain_sliding(&e, 4, steps, &chain) == -1);
+}
+
+MU_TEST(test_mont_pow_addchain_xN) {
+    BigInt p;
+    bigint_from_hex(BN254_SCALAR_HEX, &p);
+    char** hex_strs = get_mont_test_data();
+
+    for (int i = 0; i < 32; i += 4) {
+        BigInt a[4], b, c, res[4], expected[4];
+        for (int k = 0; k < 4; k ++) {
+            load_test_case(hex_strs, i + k, &a[k], &b, &c);
+            expected[k] = mont_pow_addchain(&a[k], &BN254_SCALAR_INV_CHAIN, &p, BN254_SCALAR_BM17_MU_4x64);
+        }
+
+        BigIntX4 va = bigint_x4_pack(a);
+        BigIntX4 vr = mont_pow_addchain_x4(&va, &BN254_SCALAR_INV_CHAIN, &p, BN254_SCALAR_N0_8x32);
+        bigint_x4_unpack(&vr, res);
+        for (int k = 0; k < 4; k ++) {
+            mu_check(bigint_eq(&res[k], &expected[k]));
+        }
+
+        for (int k = 0; k < 4; k += 2) {
+            BigIntX2 x = {{a[k], a[k + 1]}};
+            BigIntX2 r = mont_pow_addchain_x2(&x, &BN254_SCALAR_INV_CHAIN, &p, BN254_SCALAR_BM17_MU_4x64);
+            mu_check(bigint_eq(&r.v[0], &expected[k]));
+            mu_check(bigint_eq(&r.v[1], &expected[k + 1]));
+        }
+    }
+}
+
+MU_TEST(test_mont_pow_xN) {
+    MontField f;
+    mu_check(mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_BM17_MU_4x64) == 0);
+    char** hex_strs = get_mont_test_data();
+
+    BigInt a[4], b, c, res[4];
+    for (int k = 0; k < 4; k ++) {
+        load_test_case(hex_strs, k, &a[k], &b, &c);
+    }
+    BigIntX4 va = bigint_x4_pack(a);
+
+    // Use the later test inputs as exponents, plus 0 and 1.
+    for (int i = 4; i < 16; i ++) {
+        BigInt exp;
+        load_test_case(hex_strs, i, &exp, &b, &c);
+        if (i == 4) exp = bigint_new();
+        if (i == 5) { exp = bigint_new(); exp.v[0] = 1; }
+
+        BigIntX4 vr = mont_pow_x4(&va, &exp, &f.p, &f.one, BN254_SCALAR_N0_8x32);
+        bigint_x4_unpack(&vr, res);
+        BigIntX2 x = {{a[0], a[1]}};
+        BigIntX2 r = mont_pow_x2(&x, &exp, &f.p, &f.one, BN254_SCALAR_BM17_MU_4x64);
+
+        for (int k = 0; k < 4; k ++) {
+            BigInt expected = mont_pow(&a[k], &exp, &f);
+            mu_check(bigint_eq(&res[k], &expected));
+            if (k < 2) {
+                mu_check(bigint_eq(&r.v[k], &expected));
+            }
+        }
+    }
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_mont_mul_x4);
+    MU_RUN_TEST(test_mont_mul_x2);
+    MU_RUN_TEST(test_addchain_sliding_matches_generated);
+    MU_RUN_TEST(test_mont_pow_addchain_xN);
+    MU_RUN_TEST(test_mont_pow_xN);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
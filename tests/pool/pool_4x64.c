@@ -0,0 +1,288 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/pool/pool.h"
+#include "../../c/pool/batch.h"
+#include "../data/test_mont_data.h"
+
+#define MAX_N 100000
+#define NUM_ELEMS 1000
+
+static MontField f;
+
+typedef struct {
+    _Atomic unsigned char *hits;
+    size_t grain;
+    _Atomic bool too_long;
+    _Atomic bool bad_worker;
+    int num_threads;
+} CoverCtx;
+
+static void cover_range(size_t start, size_t end, void *ctx) {
+    CoverCtx *c = ctx;
+    if (end - start > c->grain) {
+        atomic_store(&c->too_long, true);
+    }
+    int id = pool_current_worker();
+    if (id < 0 || id >= c->num_threads) {
+        atomic_store(&c->bad_worker, true);
+    }
+    for (size_t i = start; i < end; i ++) {
+        atomic_fetch_add(&c->hits[i], 1);
+    }
+}
+
+static void sum_range(size_t start, size_t end, void *ctx) {
+    _Atomic size_t *sum = ctx;
+    size_t s = 0;
+    for (size_t i = start; i < end; i ++) {
+        s += i;
+    }
+    atomic_fetch_add(sum, s);
+}
+
+MU_TEST(test_init) {
+    ThreadPool pool;
+    mu_check(pool_init(&pool, 0) == -1);
+    mu_check(pool_init(&pool, POOL_MAX_THREADS + 1) == -1);
+    mu_check(pool_init(&pool, 3) == 0);
+    mu_check(pool.num_threads == 3);
+    pool_destroy(&pool);
+}
+
+MU_TEST(test_parallel_for_covers_range) {
+    static _Atomic unsigned char hits[MAX_N];
+    int thread_counts[] = {1, 2, 4, 8};
+    size_t sizes[] = {0, 1, 7, 1000, MAX_N};
+    size_t grains[] = {0, 1, 3, 64};
+
+    for (int k = 0; k < 4; k ++) {
+        ThreadPool pool;
+        mu_check(pool_init(&pool, thread_counts[k]) == 0);
+        for (int s = 0; s < 5; s ++) {
+            for (int g = 0; g < 4; g ++) {
+                size_t n = sizes[s];
+                for (size_t i = 0; i < n; i ++) {
+                    atomic_init(&hits[i], 0);
+                }
+                CoverCtx c;
+                c.hits = hits;
+                c.grain = grains[g] == 0 ? pool_auto_grain(&pool, n) : grains[g];
+                c.num_threads = pool.num_threads;
+                atomic_init(&c.too_long, false);
+                atomic_init(&c.bad_worker, false);
+                parallel_for(&pool, n, grains[g], cover_range, &c);
+
+                bool all_once = true;
+                for (size_t i = 0; i < n; i ++) {
+                    all_once &= atomic_load(&hits[i]) == 1;
+                }
+                mu_check(all_once);
+                mu_check(!atomic_load(&c.too_long));
+                mu_check(!atomic_load(&c.bad_worker));
+            }
+        }
+        pool_destroy(&pool);
+    }
+    mu_check(pool_current_worker() == -1);
+}
+
+MU_TEST(test_cpu_capacities) {
+    int cpus[POOL_MAX_CPUS];
+    unsigned capacity[POOL_MAX_CPUS];
+    int num_cpus = pool_cpu_capacities(cpus, capacity, POOL_MAX_CPUS);
+    mu_check(num_cpus >= 1);
+    bool has_full = false;
+    for (int i = 0; i < num_cpus; i ++) {
+        // Online CPU IDs, in increasing order but not always contiguous
+        mu_check(cpus[i] >= 0 && (i == 0 || cpus[i] > cpus[i - 1]));
+        mu_check(capacity[i] > 0 && capacity[i] <= POOL_FULL_CAPACITY);
+        has_full |= capacity[i] == POOL_FULL_CAPACITY;
+    }
+    mu_check(has_full);
+
+    // Works whether or not this machine is heterogeneous
+    ThreadPool pool;
+    mu_check(pool_init_hetero(&pool, 4) == 0);
+    mu_check(pool.num_threads == 4);
+    if (!pool.adaptive) {
+        for (int i = 0; i < 4; i ++) {
+            mu_check(pool.workers[i].cpu == -1);
+        }
+    }
+    _Atomic size_t sum;
+    atomic_init(&sum, 0);
+    parallel_for(&pool, 1000, 10, sum_range, &sum);
+    mu_check(atomic_load(&sum) == 1000 * 999 / 2);
+    pool_destroy(&pool);
+}
+
+typedef struct {
+    size_t max_len[POOL_MAX_THREADS];
+} LengthCtx;
+
+static void length_range(size_t start, size_t end, void *ctx) {
+    LengthCtx *c = ctx;
+    int id = pool_current_worker();
+    if (end - start > c->max_len[id]) {
+        c->max_len[id] = end - start;
+    }
+}
+
+// Pinning the calling thread lasts only as long as the pool.
+MU_TEST(test_caller_affinity) {
+#if defined(__linux__) && defined(CPU_SET)
+    cpu_set_t before, during, after;
+    mu_check(sched_getaffinity(0, sizeof(before), &before) == 0);
+    int cpus[POOL_MAX_CPUS];
+    pool_online_cpus(cpus, POOL_MAX_CPUS);
+    int pinned[] = {cpus[0], cpus[0]};
+
+    ThreadPool pool;
+    mu_check(pool_init_adaptive(&pool, 2, pinned, NULL) == 0);
+    mu_check(sched_getaffinity(0, sizeof(during), &during) == 0);
+    mu_check(CPU_COUNT(&during) == 1 && CPU_ISSET(cpus[0], &during));
+    pool_destroy(&pool);
+    mu_check(sched_getaffinity(0, sizeof(after), &after) == 0);
+    mu_check(CPU_EQUAL(&before, &after));
+#endif
+}
+
+MU_TEST(test_adaptive_grain) {
+    // Two big and two little cores, without pinning
+    ThreadPool pool;
+    unsigned capacities[] = {1024, 1024, 256, 256};
+    mu_check(pool_init_adaptive(&pool, 4, NULL, capacities) == 0);
+    mu_check(pool.adaptive);
+
+    // Before any measurements, little cores use a quarter of the grain.
+    pool.job_grain = 64;
+    mu_check(pool_worker_grain(&pool, 0) == 64);
+    mu_check(pool_worker_grain(&pool, 2) == 16);
+
+    LengthCtx c;
+    for (int i = 0; i < 4; i ++) {
+        c.max_len[i] = 0;
+    }
+    parallel_for(&pool, 1 << 16, 64, length_range, &c);
+    for (int i = 0; i < 4; i ++) {
+        mu_check(c.max_len[i] <= 64);
+    }
+
+    // Once measured, rates replace capacities.
+    for (int i = 0; i < 4; i ++) {
+        atomic_store(&pool.workers[i].rate, 1000);
+    }
+    atomic_store(&pool.workers[3].rate, 500);
+    mu_check(pool_worker_grain(&pool, 2) == 64);
+    mu_check(pool_worker_grain(&pool, 3) == 32);
+    pool_destroy(&pool);
+}
+
+MU_TEST(test_many_small_jobs) {
+    // Back-to-back calls, so that workers are often still leaving one job
+    // when the next starts.
+    ThreadPool pool;
+    mu_check(pool_init(&pool, 4) == 0);
+    bool all_correct = true;
+    for (size_t n = 1; n < 2000; n ++) {
+        _Atomic size_t sum;
+        atomic_init(&sum, 0);
+        parallel_for(&pool, n, 1, sum_range, &sum);
+        all_correct &= atomic_load(&sum) == n * (n - 1) / 2;
+    }
+    mu_check(all_correct);
+    pool_destroy(&pool);
+}
+
+MU_TEST(test_batch_ops) {
+    char** hex_strs = get_mont_test_data();
+    static BigInt a[NUM_ELEMS], b[NUM_ELEMS], out[NUM_ELEMS], alias[NUM_ELEMS];
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        bigint_from_hex(hex_strs[i * 3], &a[i]);
+        bigint_from_hex(hex_strs[i * 3 + 1], &b[i]);
+    }
+    BigInt scalar = b[0];
+
+    ThreadPool pool;
+    mu_check(pool_init(&pool, 4) == 0);
+    pool.grain = 16;
+
+    BigInt expected;
+    bool ok = true;
+
+    batch_mul(&pool, out, a, b, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_mul(&a[i], &b[i], &f);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    batch_scale(&pool, out, a, &scalar, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_mul(&a[i], &scalar, &f);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    batch_sqr(&pool, out, a, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_sqr(&a[i], &f);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    batch_add(&pool, out, a, b, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_add(&a[i], &b[i], &f);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    batch_sub(&pool, out, a, b, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_sub(&a[i], &b[i], &f);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    // Round trip through Montgomery form, in place
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        alias[i] = a[i];
+    }
+    batch_to_mont(&pool, alias, alias, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        expected = field_to_mont(&a[i], &f);
+        ok &= bigint_eq(&alias[i], &expected);
+    }
+    mu_check(ok);
+    batch_from_mont(&pool, alias, alias, NUM_ELEMS, &f);
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        ok &= bigint_eq(&alias[i], &a[i]);
+    }
+    mu_check(ok);
+
+    pool_destroy(&pool);
+}
+
+MU_TEST_SUITE(test_suite) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    MU_RUN_TEST(test_init);
+    MU_RUN_TEST(test_parallel_for_covers_range);
+    MU_RUN_TEST(test_many_small_jobs);
+    MU_RUN_TEST(test_cpu_capacities);
+    MU_RUN_TEST(test_caller_affinity);
+    MU_RUN_TEST(test_adaptive_grain);
+    MU_RUN_TEST(test_batch_ops);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
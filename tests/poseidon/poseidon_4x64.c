@@ -0,0 +1,130 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/poseidon/poseidon.h"
+#include "../data/test_mont_data.h"
+
+static MontField f;
+static PoseidonParams params;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+}
+
+static BigInt small_mont(uint64_t a) {
+    BigInt x = bigint_new();
+    x.v[0] = a;
+    return field_to_mont(&x, &f);
+}
+
+static bool eq_hex(BigInt *xr, const char *expected_hex) {
+    BigInt x = field_from_mont(xr, &f);
+    BigInt expected;
+    bigint_from_hex(expected_hex, &expected);
+    return bigint_eq(&x, &expected);
+}
+
+MU_TEST(test_generated_constants) {
+    // The first round constant and MDS entry of circomlib's t = 3 instance
+    mu_check(poseidon_init(&params, 3, &f) == 0);
+    mu_check(eq_hex(&params.c[0], "0ee9a592ba9a9518d05986d656f40c2114c4993c11bb29938d21d47304cd8e6e"));
+    mu_check(eq_hex(&params.m[0][0], "109b7f411ba0e4c9b2b70caf5c36a7b194be7c11ad24378bfedb68592ba8118b"));
+
+    mu_check(poseidon_init(&params, 1, &f) == -1);
+    mu_check(poseidon_init(&params, 18, &f) == -1);
+}
+
+MU_TEST(test_circomlib_vectors) {
+    BigInt inputs[4];
+    for (int i = 0; i < 4; i ++) {
+        inputs[i] = small_mont(i + 1);
+    }
+    BigInt h;
+
+    mu_check(poseidon_init(&params, 2, &f) == 0);
+    h = poseidon_hash(inputs, &params, &f);
+    mu_check(eq_hex(&h, "29176100eaa962bdc1fe6c654d6a3c130e96a4d1168b33848b897dc502820133"));
+
+    mu_check(poseidon_init(&params, 3, &f) == 0);
+    h = poseidon_hash(inputs, &params, &f);
+    mu_check(eq_hex(&h, "115cc0f5e7d690413df64c6b9662e9cf2a3617f2743245519e19607a4417189a"));
+
+    mu_check(poseidon_init(&params, 5, &f) == 0);
+    h = poseidon_hash(inputs, &params, &f);
+    mu_check(eq_hex(&h, "299c867db6c1fdd79dcefa40e4510b9837e60ebb1ce0663dbaa525df65250465"));
+}
+
+MU_TEST(test_permute_matches_reference) {
+    char** hex_strs = get_mont_test_data();
+
+    for (int t = POSEIDON_MIN_T; t <= POSEIDON_MAX_T; t ++) {
+        mu_check(poseidon_init(&params, t, &f) == 0);
+
+        BigInt a[POSEIDON_MAX_T], b[POSEIDON_MAX_T];
+        for (int i = 0; i < t; i ++) {
+            bigint_from_hex(hex_strs[(t * POSEIDON_MAX_T + i) * 3], &a[i]);
+            b[i] = a[i];
+        }
+        poseidon_permute(a, &params, &f);
+        poseidon_permute_reference(b, &params, &f);
+        for (int i = 0; i < t; i ++) {
+            mu_check(bigint_eq(&a[i], &b[i]));
+        }
+    }
+}
+
+MU_TEST(test_sponge) {
+    mu_check(poseidon_init(&params, 3, &f) == 0);
+
+    BigInt inputs[7];
+    for (int i = 0; i < 7; i ++) {
+        inputs[i] = small_mont(i + 1);
+    }
+
+    // Absorbing in one call or in pieces gives the same output.
+    PoseidonSponge s1, s2;
+    poseidon_sponge_init(&s1, &params);
+    poseidon_sponge_absorb(&s1, inputs, 7, &f);
+    poseidon_sponge_init(&s2, &params);
+    poseidon_sponge_absorb(&s2, inputs, 3, &f);
+    poseidon_sponge_absorb(&s2, inputs + 3, 1, &f);
+    poseidon_sponge_absorb(&s2, inputs + 4, 3, &f);
+    BigInt h1 = poseidon_sponge_squeeze(&s1, &f);
+    BigInt h2 = poseidon_sponge_squeeze(&s2, &f);
+    mu_check(bigint_eq(&h1, &h2));
+
+    // Later squeezes give new outputs.
+    BigInt h3 = poseidon_sponge_squeeze(&s1, &f);
+    BigInt h4 = poseidon_sponge_squeeze(&s1, &f);
+    mu_check(!bigint_eq(&h1, &h3));
+    mu_check(!bigint_eq(&h3, &h4));
+
+    // A trailing zero changes the output.
+    BigInt zero = bigint_new();
+    poseidon_sponge_init(&s2, &params);
+    poseidon_sponge_absorb(&s2, inputs, 7, &f);
+    poseidon_sponge_absorb(&s2, &zero, 1, &f);
+    h2 = poseidon_sponge_squeeze(&s2, &f);
+    mu_check(!bigint_eq(&h1, &h2));
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_generated_constants);
+    MU_RUN_TEST(test_circomlib_vectors);
+    MU_RUN_TEST(test_permute_matches_reference);
+    MU_RUN_TEST(test_sponge);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
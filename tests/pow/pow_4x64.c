@@ -0,0 +1,130 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/pow/pow.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../data/test_mont_data.h"
+
+// p - 2 and (p - 1) / 2
+#define P_MINUS_2_HEX "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593efffffff"
+#define P_MINUS_1_OVER_2_HEX "183227397098d014dc2822db40c0ac2e9419f4243cdcb848a1f0fac9f8000000"
+
+// Plain binary square-and-multiply over every bit of the exponent.
+static BigInt reference_pow(BigInt *base, BigInt *exp, MontField *f) {
+    BigInt z = f->one;
+    for (int i = NUM_LIMBS * BITS_PER_LIMB - 1; i >= 0; i--) {
+        z = mont_mul(&z, &z, &f->p, f->n0);
+        if (pow_bit(exp, i)) {
+            z = mont_mul(&z, base, &f->p, f->n0);
+        }
+    }
+    return z;
+}
+
+MU_TEST(test_mont_pow_small_exponents) {
+    MontField f;
+    mu_check(mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64) == 0);
+
+    char** hex_strs = get_mont_test_data();
+    BigInt ar, exp, res, expected;
+    bigint_from_hex(hex_strs[0], &ar);
+
+    // x^0 = 1
+    exp = bigint_new();
+    res = mont_pow(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &f.one));
+    res = mont_pow_ct(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &f.one));
+
+    // x^1 = x
+    exp.v[0] = 1;
+    res = mont_pow(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &ar));
+    res = mont_pow_ct(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &ar));
+
+    // x^5 = x * x^2 * x^2
+    exp.v[0] = 5;
+    expected = field_sqr(&ar, &f);
+    expected = field_sqr(&expected, &f);
+    expected = field_mul(&expected, &ar, &f);
+    res = mont_pow(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &expected));
+    res = mont_pow_ct(&ar, &exp, &f);
+    mu_check(bigint_eq(&res, &expected));
+}
+
+MU_TEST(test_mont_pow_window_sizes) {
+    MontField f;
+    mu_check(mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64) == 0);
+
+    char** hex_strs = get_mont_test_data();
+    BigInt ar, exp, res, expected;
+
+    size_t NUM_TESTS = 16;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        bigint_from_hex(hex_strs[i * 3], &ar);
+        // Use the second operand as a random 254-bit exponent.
+        bigint_from_hex(hex_strs[i * 3 + 1], &exp);
+
+        expected = reference_pow(&ar, &exp, &f);
+
+        for (int w = 1; w <= MONT_POW_MAX_WINDOW; w++) {
+            res = mont_pow_sliding(&ar, &exp, w, &f);
+            mu_check(bigint_eq(&res, &expected));
+            res = mont_pow_fixed(&ar, &exp, w, false, &f);
+            mu_check(bigint_eq(&res, &expected));
+            res = mont_pow_fixed(&ar, &exp, w, true, &f);
+            mu_check(bigint_eq(&res, &expected));
+        }
+    }
+}
+
+MU_TEST(test_mont_pow_addchain) {
+    MontField f;
+    mu_check(mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64) == 0);
+
+    char** hex_strs = get_mont_test_data();
+    BigInt ar, inv_exp, legendre_exp, res, expected;
+    bigint_from_hex(P_MINUS_2_HEX, &inv_exp);
+    bigint_from_hex(P_MINUS_1_OVER_2_HEX, &legendre_exp);
+
+    size_t NUM_TESTS = 16;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        bigint_from_hex(hex_strs[i * 3], &ar);
+
+        // x^(p - 2) * x = 1
+        res = mont_pow_addchain(&ar, &BN254_SCALAR_INV_CHAIN, &f.p, f.n0);
+        expected = mont_pow(&ar, &inv_exp, &f);
+        mu_check(bigint_eq(&res, &expected));
+        res = field_mul(&res, &ar, &f);
+        mu_check(bigint_eq(&res, &f.one));
+
+        // x^((p - 1) / 2) is +1 or -1, so its square is 1
+        res = mont_pow_addchain(&ar, &BN254_SCALAR_LEGENDRE_CHAIN, &f.p, f.n0);
+        expected = mont_pow(&ar, &legendre_exp, &f);
+        mu_check(bigint_eq(&res, &expected));
+        res = field_sqr(&res, &f);
+        mu_check(bigint_eq(&res, &f.one));
+    }
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_mont_pow_small_exponents);
+    MU_RUN_TEST(test_mont_pow_window_sizes);
+    MU_RUN_TEST(test_mont_pow_addchain);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
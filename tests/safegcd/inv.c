@@ -0,0 +1,99 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/safegcd/inv.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../data/test_mont_data.h"
+
+MU_TEST(test_mont_inv) {
+    // For the BN254 scalar field.
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, r, r2, ar, inv, product;
+
+    int result;
+    result = bigint_from_hex(BN254_SCALAR_HEX, &p);
+    mu_check(result == 0);
+    result = bigint_from_hex(BN254_SCALAR_R_HEX, &r);
+    mu_check(result == 0);
+    result = bigint_from_hex(BN254_SCALAR_R2_HEX, &r2);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        char* ar_hex = hex_strs[i * 3];
+
+        result = bigint_from_hex(ar_hex, &ar);
+        mu_check(result == 0);
+
+        inv = mont_inv(&ar, &p, &r2, n0);
+
+        // (aR)(a^-1 R) / R = R, i.e. 1 in Montgomery form.
+        product = mont_mul(&ar, &inv, &p, n0);
+        mu_check(bigint_eq(&product, &r));
+    }
+}
+
+MU_TEST(test_mont_inv_matches_fermat) {
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, r2, ar, inv, expected;
+
+    int result;
+    result = bigint_from_hex(BN254_SCALAR_HEX, &p);
+    mu_check(result == 0);
+    result = bigint_from_hex(BN254_SCALAR_R2_HEX, &r2);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 64;
+
+    for (int i = 0; i < NUM_TESTS; i++) {
+        result = bigint_from_hex(hex_strs[i * 3 + 1], &ar);
+        mu_check(result == 0);
+
+        inv = mont_inv(&ar, &p, &r2, n0);
+        expected = mont_pow_addchain(&ar, &BN254_SCALAR_INV_CHAIN, &p, n0);
+
+        mu_check(bigint_eq(&inv, &expected));
+    }
+}
+
+MU_TEST(test_mont_inv_edge_cases) {
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+    BigInt p, r, r2, inv;
+
+    bigint_from_hex(BN254_SCALAR_HEX, &p);
+    bigint_from_hex(BN254_SCALAR_R_HEX, &r);
+    bigint_from_hex(BN254_SCALAR_R2_HEX, &r2);
+
+    // The inverse of 1 is 1.
+    inv = mont_inv(&r, &p, &r2, n0);
+    mu_check(bigint_eq(&inv, &r));
+
+    // 0 has no inverse, and maps to 0.
+    BigInt zero = bigint_new();
+    inv = mont_inv(&zero, &p, &r2, n0);
+    mu_check(bigint_eq(&inv, &zero));
+}
+
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_mont_inv);
+    MU_RUN_TEST(test_mont_inv_matches_fermat);
+    MU_RUN_TEST(test_mont_inv_edge_cases);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
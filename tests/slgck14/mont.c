@@ -65,8 +65,75 @@ MU_TEST(test_mont_mul) {
     }
 }
 
+// The product without a prepared operand
+static BigInt reference_mul(BigInt *a, BigInt *b, BigInt *p, uint64_t n0) {
+    i64 vai[NUM_LIMBS];
+    for (int i = 0; i < NUM_LIMBS; i++) {
+        vai[i] = i32x2_make(a->v[i], a->v[i]);
+    }
+    i64 transposed_b[4], transposed_p[4];
+    mont_transpose_operand(b, transposed_b);
+    mont_transpose_operand(p, transposed_p);
+    return mont_mul(vai, transposed_b, p, transposed_p, n0);
+}
+
+MU_TEST(test_mont_mul_prepared) {
+    uint64_t n0 = BN254_SCALAR_N0_8x32;
+    char* p_hex = BN254_SCALAR_HEX;
+
+    char** hex_strs = get_mont_test_data();
+
+    BigInt p, b, a[256], out[256], expected;
+    MontPrepared prep;
+
+    int result;
+    result = bigint_from_hex(p_hex, &p);
+    mu_check(result == 0);
+
+    size_t NUM_TESTS = 1024;
+
+    // Each test case with its own prepared multiplicand
+    for (int i = 0; i < NUM_TESTS; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &a[0]);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 1], &b);
+        mu_check(result == 0);
+        result = bigint_from_hex(hex_strs[i * 3 + 2], &expected);
+        mu_check(result == 0);
+
+        mont_prepare(&prep, &b, &p, n0);
+        out[0] = mont_mul_prepared(&a[0], &prep);
+        mu_check(bigint_eq(&out[0], &expected));
+    }
+
+    // One multiplicand for a whole vector
+    result = bigint_from_hex(hex_strs[1], &b);
+    mu_check(result == 0);
+    for (int i = 0; i < 256; i++) {
+        result = bigint_from_hex(hex_strs[i * 3], &a[i]);
+        mu_check(result == 0);
+    }
+    mont_prepare(&prep, &b, &p, n0);
+    mont_scale_vector(out, a, &prep, 256);
+    bool ok = true;
+    for (int i = 0; i < 256; i++) {
+        expected = reference_mul(&a[i], &b, &p, n0);
+        ok &= bigint_eq(&out[i], &expected);
+    }
+    mu_check(ok);
+
+    // In place
+    mont_scale_vector(a, a, &prep, 256);
+    ok = true;
+    for (int i = 0; i < 256; i++) {
+        ok &= bigint_eq(&a[i], &out[i]);
+    }
+    mu_check(ok);
+}
+
 MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_mont_mul);
+    MU_RUN_TEST(test_mont_mul_prepared);
 }
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,136 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/sqrt/legendre.h"
+#include "../../c/sqrt/sqrt.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_TESTS 256
+
+static MontField f;
+static SqrtTables tables;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    sqrt_init(&tables, &f);
+}
+
+static BigInt small_mont(uint64_t a) {
+    BigInt x = bigint_new();
+    x.v[0] = a;
+    return field_to_mont(&x, &f);
+}
+
+MU_TEST(test_root_of_unity_tables) {
+    // g^(-2^27) has order 2, so it is -1: it squares to 1 but is not 1.
+    BigInt minus_one = tables.g_inv[3][64];
+    BigInt sq = field_sqr(&minus_one, &f);
+    mu_check(bigint_eq(&sq, &f.one));
+    mu_check(!bigint_eq(&minus_one, &f.one));
+
+    // Each row starts at 1.
+    for (int k = 0; k < SQRT_NUM_WINDOWS; k ++) {
+        mu_check(bigint_eq(&tables.g_inv[k][0], &f.one));
+    }
+}
+
+MU_TEST(test_legendre) {
+    char** hex_strs = get_mont_test_data();
+    BigInt zero = bigint_new();
+
+    mu_check(legendre_jacobi(&zero, &f.p) == 0);
+    mu_check(mont_legendre(&zero, &f) == 0);
+    mu_check(legendre_jacobi(&f.one, &f.p) == 1);
+
+    // 5 and 7 are the smallest non-residues.
+    for (uint64_t a = 2; a <= 7; a ++) {
+        BigInt x = small_mont(a);
+        int expected = (a == 5 || a == 7) ? -1 : 1;
+        mu_check(legendre_jacobi(&x, &f.p) == expected);
+        mu_check(mont_legendre(&x, &f) == expected);
+    }
+
+    int num_squares = 0;
+    for (int i = 0; i < NUM_TESTS; i ++) {
+        BigInt x;
+        bigint_from_hex(hex_strs[i * 3], &x);
+        int l = legendre_jacobi(&x, &f.p);
+        mu_check(l == mont_legendre(&x, &f));
+        num_squares += l == 1;
+
+        BigInt x2 = field_sqr(&x, &f);
+        mu_check(legendre_jacobi(&x2, &f.p) == 1);
+    }
+    // About half of all elements are squares.
+    mu_check(num_squares > NUM_TESTS / 4 && num_squares < 3 * NUM_TESTS / 4);
+}
+
+MU_TEST(test_legendre_batch) {
+    char** hex_strs = get_mont_test_data();
+    BigInt x[NUM_TESTS];
+    int out[NUM_TESTS];
+    for (int i = 0; i < NUM_TESTS; i ++) {
+        bigint_from_hex(hex_strs[i * 3], &x[i]);
+    }
+    legendre_batch(x, out, NUM_TESTS, &f);
+    for (int i = 0; i < NUM_TESTS; i ++) {
+        mu_check(out[i] == mont_legendre(&x[i], &f));
+    }
+}
+
+MU_TEST(test_sqrt) {
+    char** hex_strs = get_mont_test_data();
+    BigInt zero = bigint_new();
+    BigInt r;
+
+    mu_check(mont_sqrt(&zero, &r, &tables, &f) == 0);
+    mu_check(bigint_eq(&r, &zero));
+
+    mu_check(mont_sqrt(&f.one, &r, &tables, &f) == 0);
+    r = field_sqr(&r, &f);
+    mu_check(bigint_eq(&r, &f.one));
+
+    BigInt five = small_mont(5);
+    mu_check(mont_sqrt(&five, &r, &tables, &f) == -1);
+
+    for (int i = 0; i < NUM_TESTS; i ++) {
+        BigInt x, x2;
+        bigint_from_hex(hex_strs[i * 3], &x);
+
+        // The root of a square is x or -x.
+        x2 = field_sqr(&x, &f);
+        mu_check(mont_sqrt(&x2, &r, &tables, &f) == 0);
+        BigInt r2 = field_sqr(&r, &f);
+        mu_check(bigint_eq(&r2, &x2));
+
+        // x itself has a root exactly when its Legendre symbol is 1.
+        int l = legendre_jacobi(&x, &f.p);
+        int result = mont_sqrt(&x, &r, &tables, &f);
+        mu_check((result == 0) == (l == 1));
+        if (result == 0) {
+            r2 = field_sqr(&r, &f);
+            mu_check(bigint_eq(&r2, &x));
+        }
+    }
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_root_of_unity_tables);
+    MU_RUN_TEST(test_legendre);
+    MU_RUN_TEST(test_legendre_batch);
+    MU_RUN_TEST(test_sqrt);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,146 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/acar/mont.h"
+#include "../../c/field.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/bytes.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_ELEMS 203
+
+static MontField f;
+static BigInt elems[NUM_ELEMS];
+static _Alignas(64) uint8_t be[NUM_ELEMS * FR_BYTES], le[NUM_ELEMS * FR_BYTES];
+
+static void hex_to_bytes(const char *hex, uint8_t *out) {
+    for (int i = 0; i < FR_BYTES; i ++) {
+        unsigned int byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        out[i] = byte;
+    }
+}
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_8x32);
+    char** hex_strs = get_mont_test_data();
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        bigint_from_hex(hex_strs[i], &elems[i]);
+        hex_to_bytes(hex_strs[i], &be[i * FR_BYTES]);
+        for (int j = 0; j < FR_BYTES; j ++) {
+            le[i * FR_BYTES + j] = be[i * FR_BYTES + FR_BYTES - 1 - j];
+        }
+    }
+}
+
+MU_TEST(test_import_export) {
+    static BigInt out[NUM_ELEMS];
+    static uint8_t bytes[NUM_ELEMS * FR_BYTES];
+    uint8_t *inputs[] = {le, be};
+    FrByteOrder orders[] = {FR_LITTLE_ENDIAN, FR_BIG_ENDIAN};
+    for (int o = 0; o < 2; o ++) {
+        mu_check(fr_import(out, inputs[o], NUM_ELEMS, orders[o], false, &f) == NUM_ELEMS);
+        bool ok = true;
+        for (int i = 0; i < NUM_ELEMS; i ++) {
+            ok &= bigint_eq(&out[i], &elems[i]);
+        }
+        mu_check(ok);
+        fr_export(bytes, out, NUM_ELEMS, orders[o], false, &f);
+        mu_check(memcmp(bytes, inputs[o], sizeof(bytes)) == 0);
+
+        // Fused conversion into and out of Montgomery form
+        mu_check(fr_import(out, inputs[o], NUM_ELEMS, orders[o], true, &f) == NUM_ELEMS);
+        ok = true;
+        for (int i = 0; i < NUM_ELEMS; i ++) {
+            BigInt expected = field_to_mont(&elems[i], &f);
+            ok &= bigint_eq(&out[i], &expected);
+        }
+        mu_check(ok);
+        fr_export(bytes, out, NUM_ELEMS, orders[o], true, &f);
+        mu_check(memcmp(bytes, inputs[o], sizeof(bytes)) == 0);
+    }
+}
+
+MU_TEST(test_validation) {
+    static BigInt out[NUM_ELEMS];
+    static uint8_t bytes[NUM_ELEMS * FR_BYTES];
+    uint8_t p_be[FR_BYTES];
+    hex_to_bytes(BN254_SCALAR_HEX, p_be);
+
+    // p itself is rejected, p - 1 accepted
+    memcpy(bytes, be, sizeof(bytes));
+    memcpy(&bytes[5 * FR_BYTES], p_be, FR_BYTES);
+    mu_check(fr_import(out, bytes, NUM_ELEMS, FR_BIG_ENDIAN, false, &f) == 5);
+    bytes[6 * FR_BYTES - 1] -= 1;
+    mu_check(fr_import(out, bytes, NUM_ELEMS, FR_BIG_ENDIAN, true, &f) == NUM_ELEMS);
+    memset(&bytes[100 * FR_BYTES], 0xff, FR_BYTES);
+    mu_check(fr_import(out, bytes, NUM_ELEMS, FR_BIG_ENDIAN, false, &f) == 100);
+
+    // A kernel's p for zero is exported as 0
+    uint8_t zero[FR_BYTES] = {0}, got[FR_BYTES];
+    fr_export(got, &f.p, 1, FR_LITTLE_ENDIAN, false, &f);
+    mu_check(memcmp(got, zero, FR_BYTES) == 0);
+
+    // Only 4x64 builds can alias the input
+    const BigInt *view = fr_import_view(le, NUM_ELEMS, &f);
+    if (BITS_PER_LIMB == 64) {
+        mu_check(view == (const BigInt *)le);
+        mu_check(fr_import_view(le + 1, NUM_ELEMS - 1, &f) == NULL);
+        memcpy(bytes, le, sizeof(bytes));
+        memset(&bytes[7 * FR_BYTES], 0xff, FR_BYTES);
+        mu_check(fr_import_view(bytes, NUM_ELEMS, &f) == NULL);
+    } else {
+        mu_check(view == NULL);
+    }
+}
+
+MU_TEST(test_vectors) {
+    static uint8_t bytes[NUM_ELEMS * FR_BYTES];
+    FrVec aos, soa;
+    mu_check(frvec_init(&aos, NUM_ELEMS, FRVEC_AOS) == 0);
+    mu_check(frvec_init(&soa, NUM_ELEMS, FRVEC_SOA) == 0);
+    for (int m = 0; m < 2; m ++) {
+        mu_check(fr_import_vec(&aos, be, FR_BIG_ENDIAN, m, &f) == NUM_ELEMS);
+        mu_check(fr_import_vec(&soa, be, FR_BIG_ENDIAN, m, &f) == NUM_ELEMS);
+        bool ok = true;
+        for (int i = 0; i < NUM_ELEMS; i ++) {
+            BigInt x = frvec_get(&soa, i);
+            BigInt expected = m ? field_to_mont(&elems[i], &f) : elems[i];
+            ok &= bigint_eq(&x, &expected);
+            ok &= bigint_eq(&frvec_aos(&aos)[i], &expected);
+        }
+        mu_check(ok);
+        fr_export_vec(bytes, &soa, FR_LITTLE_ENDIAN, m, &f);
+        mu_check(memcmp(bytes, le, sizeof(bytes)) == 0);
+        fr_export_vec(bytes, &aos, FR_BIG_ENDIAN, m, &f);
+        mu_check(memcmp(bytes, be, sizeof(bytes)) == 0);
+    }
+
+    // An invalid element in a block of four, then in the tail
+    memcpy(bytes, be, sizeof(bytes));
+    memset(&bytes[101 * FR_BYTES], 0xff, FR_BYTES);
+    mu_check(fr_import_vec(&soa, bytes, FR_BIG_ENDIAN, true, &f) == 101);
+    memcpy(bytes, be, sizeof(bytes));
+    memset(&bytes[(NUM_ELEMS - 1) * FR_BYTES], 0xff, FR_BYTES);
+    mu_check(fr_import_vec(&soa, bytes, FR_BIG_ENDIAN, true, &f) == NUM_ELEMS - 1);
+
+    frvec_free(&aos);
+    frvec_free(&soa);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_import_export);
+    MU_RUN_TEST(test_validation);
+    MU_RUN_TEST(test_vectors);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,67 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../../c/field.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/bytes.h"
+#include "../data/test_mont_data.h"
+
+// A BM17 MontField holds mu = p^-1 in n0, not the -p^-1 that mont_mul_x4
+// takes, so the vertical conversion of fr_import_vec must not use it as is.
+
+#define NUM_ELEMS 203
+
+static MontField f;
+static BigInt elems[NUM_ELEMS];
+static _Alignas(64) uint8_t be[NUM_ELEMS * FR_BYTES];
+
+static void hex_to_bytes(const char *hex, uint8_t *out) {
+    for (int i = 0; i < FR_BYTES; i ++) {
+        unsigned int byte;
+        sscanf(hex + 2 * i, "%2x", &byte);
+        out[i] = byte;
+    }
+}
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_BM17_MU_4x64);
+    char** hex_strs = get_mont_test_data();
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        bigint_from_hex(hex_strs[i], &elems[i]);
+        hex_to_bytes(hex_strs[i], &be[i * FR_BYTES]);
+    }
+}
+
+MU_TEST(test_import_to_mont) {
+    FrVec aos, soa;
+    mu_check(frvec_init(&aos, NUM_ELEMS, FRVEC_AOS) == 0);
+    mu_check(frvec_init(&soa, NUM_ELEMS, FRVEC_SOA) == 0);
+    mu_check(fr_import_vec(&aos, be, FR_BIG_ENDIAN, true, &f) == NUM_ELEMS);
+    mu_check(fr_import_vec(&soa, be, FR_BIG_ENDIAN, true, &f) == NUM_ELEMS);
+    bool ok = true;
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        BigInt x = frvec_get(&soa, i);
+        BigInt expected = field_to_mont(&elems[i], &f);
+        ok &= bigint_eq(&x, &expected);
+        ok &= bigint_eq(&frvec_aos(&aos)[i], &expected);
+    }
+    mu_check(ok);
+    frvec_free(&aos);
+    frvec_free(&soa);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_import_to_mont);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
@@ -0,0 +1,217 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/addchain/addchain.h"
+#include "../../c/addchain/bn254_scalar.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/batch_inv.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_ELEMS 203
+
+static MontField f;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+}
+
+static void load(FrVec *v, int offset) {
+    char** hex_strs = get_mont_test_data();
+    for (size_t i = 0; i < v->len; i ++) {
+        BigInt x;
+        bigint_from_hex(hex_strs[((i + offset) % 1000) * 3], &x);
+        frvec_set(v, i, &x);
+    }
+}
+
+MU_TEST(test_arena) {
+    Arena a;
+    mu_check(arena_init(&a, 1000) == 0);
+    mu_check(a.capacity == 1024);
+
+    uint8_t *x = arena_alloc(&a, 1);
+    uint8_t *y = arena_alloc(&a, 100);
+    mu_check(x != NULL && y != NULL);
+    mu_check((uintptr_t)x % ARENA_ALIGN == 0);
+    mu_check((uintptr_t)y % ARENA_ALIGN == 0);
+    mu_check(y - x == ARENA_ALIGN);
+
+    size_t mark = arena_mark(&a);
+    mu_check(arena_alloc(&a, 832) != NULL);
+    mu_check(arena_alloc(&a, 1) == NULL);
+    arena_release(&a, mark);
+    uint8_t *z = arena_alloc(&a, 64);
+    mu_check(z == y + 128);
+    mu_check(a.high_water == 1024);
+
+    arena_reset(&a);
+    mu_check(arena_alloc(&a, 1) == x);
+    arena_free(&a);
+}
+
+MU_TEST(test_layouts) {
+    FrVec aos, soa, back;
+    mu_check(frvec_init(&aos, NUM_ELEMS, FRVEC_AOS) == 0);
+    mu_check(frvec_init(&soa, NUM_ELEMS, FRVEC_SOA) == 0);
+    mu_check(frvec_init(&back, NUM_ELEMS, FRVEC_AOS) == 0);
+    mu_check((uintptr_t)aos.data % ARENA_ALIGN == 0);
+    for (int j = 0; j < NUM_LIMBS; j ++) {
+        mu_check((uintptr_t)frvec_limbs(&soa, j) % ARENA_ALIGN == 0);
+    }
+
+    load(&aos, 0);
+    mu_check(frvec_copy(&soa, &aos) == 0);
+    mu_check(frvec_copy(&back, &soa) == 0);
+    bool ok = true;
+    for (size_t i = 0; i < NUM_ELEMS; i ++) {
+        BigInt x = frvec_get(&aos, i);
+        BigInt y = frvec_get(&soa, i);
+        ok &= bigint_eq(&x, &y);
+        ok &= bigint_eq(&x, &frvec_aos(&back)[i]);
+        ok &= frvec_limbs(&soa, 1)[i] == x.v[1];
+    }
+    mu_check(ok);
+
+    FrVec short_vec;
+    mu_check(frvec_init(&short_vec, NUM_ELEMS - 1, FRVEC_AOS) == 0);
+    mu_check(frvec_copy(&short_vec, &aos) == -1);
+    frvec_free(&short_vec);
+
+    frvec_zero(&soa);
+    BigInt zero = bigint_new();
+    BigInt last = frvec_get(&soa, NUM_ELEMS - 1);
+    mu_check(bigint_eq(&last, &zero));
+
+    frvec_free(&aos);
+    frvec_free(&soa);
+    frvec_free(&back);
+}
+
+MU_TEST(test_mul) {
+    char** hex_strs = get_mont_test_data();
+    Arena arena;
+    mu_check(arena_init(&arena, 16 * frvec_bytes(NUM_ELEMS, FRVEC_AOS)) == 0);
+
+    FrVecLayout layouts[] = {FRVEC_AOS, FRVEC_SOA};
+    for (int l = 0; l < 2; l ++) {
+        FrVec a, b, out;
+        mu_check(frvec_init_arena(&a, NUM_ELEMS, layouts[l], &arena) == 0);
+        mu_check(frvec_init_arena(&b, NUM_ELEMS, layouts[l], &arena) == 0);
+        mu_check(frvec_init_arena(&out, NUM_ELEMS, layouts[l], &arena) == 0);
+        for (size_t i = 0; i < NUM_ELEMS; i ++) {
+            BigInt x, y;
+            bigint_from_hex(hex_strs[i * 3], &x);
+            bigint_from_hex(hex_strs[i * 3 + 1], &y);
+            frvec_set(&a, i, &x);
+            frvec_set(&b, i, &y);
+        }
+        mu_check(frvec_mul(&out, &a, &b, &f) == 0);
+
+        bool ok = true;
+        for (size_t i = 0; i < NUM_ELEMS; i ++) {
+            BigInt expected;
+            bigint_from_hex(hex_strs[i * 3 + 2], &expected);
+            BigInt r = frvec_get(&out, i);
+            ok &= bigint_eq(&r, &expected);
+        }
+        mu_check(ok);
+
+        // In place
+        mu_check(frvec_mul(&a, &a, &b, &f) == 0);
+        ok = true;
+        for (size_t i = 0; i < NUM_ELEMS; i ++) {
+            BigInt x = frvec_get(&a, i);
+            BigInt y = frvec_get(&out, i);
+            ok &= bigint_eq(&x, &y);
+        }
+        mu_check(ok);
+    }
+
+    FrVec x, y;
+    mu_check(frvec_init_arena(&x, 4, FRVEC_AOS, &arena) == 0);
+    mu_check(frvec_init_arena(&y, 4, FRVEC_SOA, &arena) == 0);
+    mu_check(frvec_mul(&x, &x, &y, &f) == -1);
+
+    // The arena is too small for another large vector
+    FrVec big;
+    mu_check(frvec_init_arena(&big, 1 << 20, FRVEC_AOS, &arena) == -1);
+    frvec_free(&big);
+    arena_free(&arena);
+}
+
+MU_TEST(test_batch_inv) {
+    Arena scratch;
+    mu_check(arena_init(&scratch, NUM_ELEMS * sizeof(BigInt)) == 0);
+
+    FrVec in, out;
+    mu_check(frvec_init(&in, NUM_ELEMS, FRVEC_AOS) == 0);
+    mu_check(frvec_init(&out, NUM_ELEMS, FRVEC_AOS) == 0);
+    load(&in, 7);
+    BigInt *x = frvec_aos(&in);
+    for (size_t i = 0; i < NUM_ELEMS; i ++) {
+        x[i] = field_to_mont(&x[i], &f);
+    }
+    // Zeros are passed through
+    x[0] = bigint_new();
+    x[100] = bigint_new();
+    x[NUM_ELEMS - 1] = bigint_new();
+
+    mu_check(frvec_batch_inv(&out, &in, &scratch, &BN254_SCALAR_INV_CHAIN, &f) == 0);
+    mu_check(scratch.used == 0);
+    mu_check(scratch.high_water > 0);
+
+    bool ok = true;
+    BigInt zero = bigint_new();
+    for (size_t i = 0; i < NUM_ELEMS; i ++) {
+        BigInt r = frvec_aos(&out)[i];
+        if (frvec_is_zero(&x[i], &f)) {
+            ok &= bigint_eq(&r, &zero);
+        } else {
+            BigInt prod = field_mul(&x[i], &r, &f);
+            ok &= bigint_eq(&prod, &f.one);
+        }
+    }
+    mu_check(ok);
+
+    // In place gives the same result
+    mu_check(frvec_batch_inv(&in, &in, &scratch, &BN254_SCALAR_INV_CHAIN, &f) == 0);
+    ok = true;
+    for (size_t i = 0; i < NUM_ELEMS; i ++) {
+        ok &= bigint_eq(&x[i], &frvec_aos(&out)[i]);
+    }
+    mu_check(ok);
+
+    // Not enough scratch space
+    size_t mark = arena_mark(&scratch);
+    arena_alloc(&scratch, 64);
+    mu_check(frvec_batch_inv(&out, &in, &scratch, &BN254_SCALAR_INV_CHAIN, &f) == -2);
+    arena_release(&scratch, mark);
+
+    FrVec soa;
+    mu_check(frvec_init(&soa, NUM_ELEMS, FRVEC_SOA) == 0);
+    mu_check(frvec_batch_inv(&soa, &in, &scratch, &BN254_SCALAR_INV_CHAIN, &f) == -1);
+
+    frvec_free(&soa);
+    frvec_free(&in);
+    frvec_free(&out);
+    arena_free(&scratch);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_arena);
+    MU_RUN_TEST(test_layouts);
+    MU_RUN_TEST(test_mul);
+    MU_RUN_TEST(test_batch_inv);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
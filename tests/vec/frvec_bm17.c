@@ -0,0 +1,64 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_8x32/bigint.h"
+#include "../../c/bigints/bigint_8x32/hex.h"
+#include "../../c/bm17/mont.h"
+#include "../../c/field.h"
+#include "../../c/multibuf/mont_x4.h"
+#include "../../c/vec/frvec.h"
+#include "../data/test_mont_data.h"
+
+// A BM17 MontField holds mu = p^-1 in n0, not the -p^-1 that mont_mul_x4
+// takes, so the vertical path of frvec_mul must not use it as is.
+
+#define NUM_ELEMS 203
+
+static MontField f;
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_BM17_MU_4x64);
+}
+
+MU_TEST(test_mul) {
+    char** hex_strs = get_mont_test_data();
+    FrVecLayout layouts[] = {FRVEC_AOS, FRVEC_SOA};
+    for (int l = 0; l < 2; l ++) {
+        FrVec a, b, out;
+        mu_check(frvec_init(&a, NUM_ELEMS, layouts[l]) == 0);
+        mu_check(frvec_init(&b, NUM_ELEMS, layouts[l]) == 0);
+        mu_check(frvec_init(&out, NUM_ELEMS, layouts[l]) == 0);
+        for (size_t i = 0; i < NUM_ELEMS; i ++) {
+            BigInt x, y;
+            bigint_from_hex(hex_strs[i * 3], &x);
+            bigint_from_hex(hex_strs[i * 3 + 1], &y);
+            frvec_set(&a, i, &x);
+            frvec_set(&b, i, &y);
+        }
+        mu_check(frvec_mul(&out, &a, &b, &f) == 0);
+
+        bool ok = true;
+        for (size_t i = 0; i < NUM_ELEMS; i ++) {
+            BigInt expected;
+            bigint_from_hex(hex_strs[i * 3 + 2], &expected);
+            BigInt r = frvec_get(&out, i);
+            ok &= bigint_eq(&r, &expected);
+        }
+        mu_check(ok);
+        frvec_free(&a);
+        frvec_free(&b);
+        frvec_free(&out);
+    }
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_mul);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
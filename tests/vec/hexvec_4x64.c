@@ -0,0 +1,133 @@
+#include "../minunit.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/vec/frvec.h"
+#include "../../c/vec/bytes.h"
+#include "../../c/vec/hexvec.h"
+#include "../data/test_mont_data.h"
+
+#define NUM_ELEMS 203
+#define STRIDE (FR_HEX_DIGITS + 1)
+
+static MontField f;
+static BigInt elems[NUM_ELEMS];
+static char **hex_strs;
+// The elements one per line, as a text file would hold them
+static char lines[NUM_ELEMS * STRIDE + 1];
+
+static void setup(void) {
+    mont_field_init(&f, BN254_SCALAR_HEX, BN254_SCALAR_R_HEX, BN254_SCALAR_R2_HEX, BN254_SCALAR_N0_4x64);
+    hex_strs = get_mont_test_data();
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        bigint_from_hex(hex_strs[i], &elems[i]);
+        memcpy(&lines[i * STRIDE], hex_strs[i], FR_HEX_DIGITS);
+        lines[i * STRIDE + FR_HEX_DIGITS] = '\n';
+    }
+}
+
+MU_TEST(test_to_hex_r) {
+    char a[65], b[65];
+    bool ok = true;
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        ok &= bigint_to_hex_r(&elems[i], a) == a;
+        ok &= strcmp(a, hex_strs[i]) == 0;
+        ok &= strcmp(bigint_to_hex(&elems[i]), hex_strs[i]) == 0;
+    }
+    mu_check(ok);
+
+    // Each call writes to its own buffer
+    bigint_to_hex_r(&elems[0], a);
+    bigint_to_hex_r(&elems[1], b);
+    mu_check(strcmp(a, hex_strs[0]) == 0);
+    mu_check(strcmp(b, hex_strs[1]) == 0);
+}
+
+MU_TEST(test_import_export) {
+    static BigInt out[NUM_ELEMS];
+    static char text[NUM_ELEMS * STRIDE + 1];
+    for (int m = 0; m < 2; m ++) {
+        mu_check(fr_import_hex(out, lines, STRIDE, NUM_ELEMS, m, &f) == NUM_ELEMS);
+        bool ok = true;
+        for (int i = 0; i < NUM_ELEMS; i ++) {
+            BigInt expected = m ? field_to_mont(&elems[i], &f) : elems[i];
+            ok &= bigint_eq(&out[i], &expected);
+        }
+        mu_check(ok);
+
+        // The separators are left alone
+        memset(text, '\n', sizeof(text));
+        fr_export_hex(text, STRIDE, out, NUM_ELEMS, m, &f);
+        mu_check(memcmp(text, lines, NUM_ELEMS * STRIDE) == 0);
+    }
+
+    // Packed, with no separators
+    static char packed[NUM_ELEMS * FR_HEX_DIGITS];
+    fr_export_hex(packed, FR_HEX_DIGITS, elems, NUM_ELEMS, false, &f);
+    bool ok = true;
+    for (int i = 0; i < NUM_ELEMS; i ++) {
+        ok &= memcmp(&packed[i * FR_HEX_DIGITS], hex_strs[i], FR_HEX_DIGITS) == 0;
+    }
+    mu_check(ok);
+    mu_check(fr_import_hex(out, packed, FR_HEX_DIGITS, NUM_ELEMS, false, &f) == NUM_ELEMS);
+    mu_check(bigint_eq(&out[NUM_ELEMS - 1], &elems[NUM_ELEMS - 1]));
+
+    // Upper case is accepted
+    char upper[FR_HEX_DIGITS];
+    for (int i = 0; i < FR_HEX_DIGITS; i ++) {
+        upper[i] = hex_strs[3][i] >= 'a' ? hex_strs[3][i] - 'a' + 'A' : hex_strs[3][i];
+    }
+    mu_check(fr_import_hex(out, upper, FR_HEX_DIGITS, 1, false, &f) == 1);
+    mu_check(bigint_eq(&out[0], &elems[3]));
+
+    // A kernel's p for zero is written as 0
+    char zero[FR_HEX_DIGITS];
+    fr_export_hex(zero, FR_HEX_DIGITS, &f.p, 1, false, &f);
+    bool all_zero = true;
+    for (int i = 0; i < FR_HEX_DIGITS; i ++) {
+        all_zero &= zero[i] == '0';
+    }
+    mu_check(all_zero);
+}
+
+MU_TEST(test_validation) {
+    static BigInt out[NUM_ELEMS];
+    static char text[NUM_ELEMS * STRIDE];
+    // Characters just outside each range of digits, at every position in
+    // an element, so that each lane of the vector kernels is checked
+    const char bad[] = {'/', ':', '@', 'G', '`', 'g', ' ', 'x', '\0', (char)0xb0};
+    bool ok = true;
+    for (int k = 0; k < FR_HEX_DIGITS; k ++) {
+        memcpy(text, lines, sizeof(text));
+        text[17 * STRIDE + k] = bad[k % sizeof(bad)];
+        ok &= fr_import_hex(out, text, STRIDE, NUM_ELEMS, false, &f) == 17;
+    }
+    mu_check(ok);
+
+    // p itself is rejected, p - 1 accepted
+    memcpy(text, lines, sizeof(text));
+    memcpy(&text[5 * STRIDE], BN254_SCALAR_HEX, FR_HEX_DIGITS);
+    mu_check(fr_import_hex(out, text, STRIDE, NUM_ELEMS, false, &f) == 5);
+    text[5 * STRIDE + FR_HEX_DIGITS - 1] -= 1;
+    mu_check(fr_import_hex(out, text, STRIDE, NUM_ELEMS, true, &f) == NUM_ELEMS);
+    memset(&text[100 * STRIDE], 'f', FR_HEX_DIGITS);
+    mu_check(fr_import_hex(out, text, STRIDE, NUM_ELEMS, false, &f) == 100);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_to_hex_r);
+    MU_RUN_TEST(test_import_export);
+    MU_RUN_TEST(test_validation);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}
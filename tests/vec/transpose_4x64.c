@@ -0,0 +1,89 @@
+#include "../minunit.h"
+#include <stdio.h>
+
+#include "../../c/constants.h"
+#include "../../c/bigints/bigint_4x64/bigint.h"
+#include "../../c/bigints/bigint_4x64/hex.h"
+#include "../../c/acar/mont_4x64.h"
+#include "../../c/field.h"
+#include "../../c/vec/frvec.h"
+#include "../data/test_mont_data.h"
+
+#define MAX_COUNT 37
+
+static BigInt elems[MAX_COUNT];
+
+static void setup(void) {
+    char** hex_strs = get_mont_test_data();
+    for (int i = 0; i < MAX_COUNT; i ++) {
+        bigint_from_hex(hex_strs[i * 3], &elems[i]);
+    }
+}
+
+MU_TEST(test_blocks) {
+    size_t stride = frvec_stride(8);
+    static FrLimb rows[NUM_LIMBS * 16], expected[NUM_LIMBS * 16];
+    BigInt back[8];
+
+    memset(rows, 0, sizeof(rows));
+    memset(expected, 0, sizeof(expected));
+    transpose_aos_to_soa_x4(elems, rows, stride);
+    transpose_aos_to_soa_scalar(elems, 4, expected, stride);
+    mu_check(memcmp(rows, expected, sizeof(rows)) == 0);
+    transpose_soa_to_aos_x4(rows, stride, back);
+    for (int k = 0; k < 4; k ++) {
+        mu_check(bigint_eq(&back[k], &elems[k]));
+    }
+
+    transpose_aos_to_soa_x8(elems + 3, rows, stride);
+    transpose_aos_to_soa_scalar(elems + 3, 8, expected, stride);
+    mu_check(memcmp(rows, expected, sizeof(rows)) == 0);
+    transpose_soa_to_aos_x8(rows, stride, back);
+    for (int k = 0; k < 8; k ++) {
+        mu_check(bigint_eq(&back[k], &elems[k + 3]));
+    }
+}
+
+MU_TEST(test_vectors) {
+    bool ok = true;
+    for (size_t count = 0; count <= MAX_COUNT; count ++) {
+        FrVec aos, soa, back;
+        frvec_init(&aos, count, FRVEC_AOS);
+        frvec_init(&soa, count, FRVEC_SOA);
+        frvec_init(&back, count, FRVEC_AOS);
+        memcpy(aos.data, elems, count * sizeof(BigInt));
+
+        // Padding beyond count must be left alone.
+        memset(soa.data, 0xab, frvec_bytes(count, FRVEC_SOA));
+        ok &= frvec_copy(&soa, &aos) == 0;
+        for (int j = 0; j < NUM_LIMBS; j ++) {
+            FrLimb *row = frvec_limbs(&soa, j);
+            for (size_t k = 0; k < count; k ++) {
+                ok &= row[k] == (FrLimb)elems[k].v[j];
+            }
+            for (size_t k = count; k < soa.stride; k ++) {
+                ok &= row[k] == (FrLimb)0xabababababababab;
+            }
+        }
+
+        ok &= frvec_copy(&back, &soa) == 0;
+        ok &= count == 0 || memcmp(back.data, elems, count * sizeof(BigInt)) == 0;
+
+        frvec_free(&aos);
+        frvec_free(&soa);
+        frvec_free(&back);
+    }
+    mu_check(ok);
+}
+
+MU_TEST_SUITE(test_suite) {
+    setup();
+    MU_RUN_TEST(test_blocks);
+    MU_RUN_TEST(test_vectors);
+}
+
+int main(int argc, char *argv[]) {
+	MU_RUN_SUITE(test_suite);
+	MU_REPORT();
+	return MU_EXIT_CODE;
+}